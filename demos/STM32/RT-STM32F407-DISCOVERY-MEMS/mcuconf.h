@@ -182,6 +182,8 @@
 #define STM32_MAC_ETH1_CHANGE_PHY_STATE     TRUE
 #define STM32_MAC_ETH1_IRQ_PRIORITY         13
 #define STM32_MAC_IP_CHECKSUM_OFFLOAD       0
+#define STM32_MAC_USE_CHAINS                FALSE
+#define STM32_MAC_CHAIN_BUFFERS             4
 
 /*
  * PWM driver system settings.
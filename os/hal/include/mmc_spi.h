@@ -59,6 +59,70 @@
 #if !defined(MMC_NICE_WAITING) || defined(__DOXYGEN__)
 #define MMC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Size in bytes of a busy polling burst.
+ * @details The card busy state is polled by receiving this number of bytes
+ *          in a single SPI transfer, larger bursts reduce the number of
+ *          transfers when the SPI driver uses DMA.
+ */
+#if !defined(MMC_WAIT_BURST) || defined(__DOXYGEN__)
+#define MMC_WAIT_BURST              8
+#endif
+
+/**
+ * @brief   Number of polling bursts before starting to sleep.
+ */
+#if !defined(MMC_WAIT_FAST_BURSTS) || defined(__DOXYGEN__)
+#define MMC_WAIT_FAST_BURSTS        4
+#endif
+
+/**
+ * @brief   Maximum sleep interval between polling bursts.
+ * @details When @p MMC_NICE_WAITING is enabled the sleep interval starts
+ *          from one full system tick, the sleeps are performed using
+ *          @p osalThreadSleep(), and is doubled after each unsuccessful
+ *          burst up to this value.
+ * @note    There is no sub-tick wait, the shortest sleep is one system
+ *          tick. Busy periods shorter than a tick are only covered by the
+ *          @p MMC_WAIT_FAST_BURSTS polling bursts.
+ */
+#if !defined(MMC_WAIT_MAX_DELAY) || defined(__DOXYGEN__)
+#define MMC_WAIT_MAX_DELAY          OSAL_MS2ST(4)
+#endif
+
+/**
+ * @brief   Maximum time the card is allowed to stay busy.
+ */
+#if !defined(MMC_WAIT_TIMEOUT) || defined(__DOXYGEN__)
+#define MMC_WAIT_TIMEOUT            OSAL_MS2ST(500)
+#endif
+
+/**
+ * @brief   Sequential sessions reuse.
+ * @details If enabled the multi-block read or write session opened by a
+ *          block device read or write operation is kept open after the
+ *          operation, a following operation starting at the next block
+ *          continues the same session saving the stop and start commands.
+ *          The session is closed on a non-contiguous access, on
+ *          synchronization or when found idle for more than
+ *          @p MMC_SESSION_TIMEOUT.
+ * @note    The card is not released while a session is open, the
+ *          application should invoke @p mmcCloseIdleSession() periodically
+ *          or @p mmcSync() when done with the card.
+ */
+#if !defined(MMC_USE_SESSIONS) || defined(__DOXYGEN__)
+#define MMC_USE_SESSIONS            FALSE
+#endif
+
+/**
+ * @brief   Idle time after which an open session is not reused.
+ * @note    The idle condition is checked on the next access and by
+ *          @p mmcCloseIdleSession().
+ */
+#if !defined(MMC_SESSION_TIMEOUT) || defined(__DOXYGEN__)
+#define MMC_SESSION_TIMEOUT         OSAL_MS2ST(100)
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -69,10 +133,19 @@
 #error "MMC_SPI driver requires HAL_USE_SPI and SPI_USE_WAIT"
 #endif
 
+#if MMC_WAIT_BURST < 1
+#error "invalid MMC_WAIT_BURST value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type of a structure representing an MMC/SD over SPI driver.
+ */
+typedef struct MMCDriver MMCDriver;
+
 /**
  * @brief   MMC/SD over SPI driver configuration structure.
  */
@@ -91,6 +164,32 @@ typedef struct {
   const SPIConfig       *hscfg;
 } MMCConfig;
 
+/**
+ * @brief   MMC/SD over SPI driver statistics.
+ */
+typedef struct {
+  /**
+   * @brief Sequential sessions started by block device operations.
+   */
+  uint32_t              sessions;
+  /**
+   * @brief Block device operations continuing an open session.
+   */
+  uint32_t              reused;
+  /**
+   * @brief Busy waits not completed within the fast polling bursts.
+   */
+  uint32_t              busy_waits;
+  /**
+   * @brief Busy waits failed because of timeout.
+   */
+  uint32_t              busy_timeouts;
+  /**
+   * @brief Total time spent in busy waits.
+   */
+  systime_t             busy_time;
+} MMCStatistics;
+
 /**
  * @brief   @p MMCDriver specific methods.
  */
@@ -111,7 +210,7 @@ struct MMCDriverVMT {
  *
  * @brief   Structure representing a MMC/SD over SPI driver.
  */
-typedef struct {
+struct MMCDriver {
   /**
    * @brief Virtual Methods Table.
    */
@@ -125,7 +224,27 @@ typedef struct {
    * @brief Addresses use blocks instead of bytes.
    */
   bool                  block_addresses;
-} MMCDriver;
+#if MMC_USE_SESSIONS || defined(__DOXYGEN__)
+  /**
+   * @brief Open session type.
+   * @details @p BLK_READING or @p BLK_WRITING if a sequential session is
+   *          open, @p BLK_READY if there is no open session.
+   */
+  blkstate_t            session;
+  /**
+   * @brief Next block of the open session.
+   */
+  uint32_t              session_next;
+  /**
+   * @brief System time of the last access within the open session.
+   */
+  systime_t             session_time;
+#endif
+  /**
+   * @brief Driver statistics.
+   */
+  MMCStatistics         stats;
+};
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
@@ -162,6 +281,16 @@ typedef struct {
  * @api
  */
 #define mmcIsWriteProtected(mmcp) mmc_lld_is_write_protected(mmcp)
+
+/**
+ * @brief   Returns a pointer to the driver statistics.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              Pointer to the @p MMCStatistics structure.
+ *
+ * @api
+ */
+#define mmcGetStatistics(mmcp) (&(mmcp)->stats)
 /** @} */
 
 /*===========================================================================*/
@@ -186,6 +315,9 @@ extern "C" {
   bool mmcSync(MMCDriver *mmcp);
   bool mmcGetInfo(MMCDriver *mmcp, BlockDeviceInfo *bdip);
   bool mmcErase(MMCDriver *mmcp, uint32_t startblk, uint32_t endblk);
+#if MMC_USE_SESSIONS
+  void mmcCloseIdleSession(MMCDriver *mmcp);
+#endif
   bool mmc_lld_is_card_inserted(MMCDriver *mmcp);
   bool mmc_lld_is_write_protected(MMCDriver *mmcp);
 #ifdef __cplusplus
@@ -62,6 +62,22 @@
 #define SDC_UNHANDLED_ERROR                 0xFFFFFFFF
 /** @} */
 
+/**
+ * @name    Asynchronous operation types
+ * @{
+ */
+#define SDC_ASYNC_NONE                      0
+#define SDC_ASYNC_TRANSFER                  1
+#define SDC_ASYNC_STREAM                    2
+/** @} */
+
+/**
+ * @brief   Number of buffers that can be queued in a write stream.
+ * @details While a buffer is transferred the next one is already queued,
+ *          this allows to keep the card continuously busy.
+ */
+#define SDC_STREAM_BUFFERS                  2
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -96,6 +112,16 @@
 #if !defined(SDC_NICE_WAITING) || defined(__DOXYGEN__)
 #define SDC_NICE_WAITING                    TRUE
 #endif
+
+/**
+ * @brief   Enables the asynchronous APIs.
+ * @details If enabled the @p sdcStartRead(), @p sdcStartWrite() and the
+ *          write stream APIs are included.
+ * @note    Requires support in the low level driver.
+ */
+#if !defined(SDC_USE_ASYNC) || defined(__DOXYGEN__)
+#define SDC_USE_ASYNC                       FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -170,6 +196,20 @@ extern "C" {
   bool sdcSync(SDCDriver *sdcp);
   bool sdcGetInfo(SDCDriver *sdcp, BlockDeviceInfo *bdip);
   bool sdcErase(SDCDriver *mmcp, uint32_t startblk, uint32_t endblk);
+#if SDC_USE_ASYNC
+  bool sdcStartRead(SDCDriver *sdcp, uint32_t startblk,
+                    uint8_t *buf, uint32_t n, sdccallback_t callback);
+  bool sdcStartWrite(SDCDriver *sdcp, uint32_t startblk,
+                     const uint8_t *buf, uint32_t n, sdccallback_t callback);
+  bool sdcWaitCompletion(SDCDriver *sdcp);
+  bool sdcStartStream(SDCDriver *sdcp, uint32_t startblk,
+                      sdccallback_t callback);
+  msg_t sdcStreamWriteI(SDCDriver *sdcp, const uint8_t *buf, uint32_t n);
+  msg_t sdcStreamWriteTimeout(SDCDriver *sdcp, const uint8_t *buf,
+                              uint32_t n, systime_t timeout);
+  bool sdcStopStream(SDCDriver *sdcp);
+  void _sdc_isr_transfer_end(SDCDriver *sdcp, bool result);
+#endif
   bool _sdc_wait_for_transfer_state(SDCDriver *sdcp);
 #ifdef __cplusplus
 }
@@ -36,6 +36,15 @@
 
 #define BUFFER_SIZE ((((STM32_MAC_BUFFERS_SIZE - 1) | 3) + 1) / 4)
 
+#if STM32_MAC_USE_CHAINS
+/* Size of a receive buffer object in words, the storage follows the
+   buffer header and is word aligned as required by the DMA.*/
+#define RXOBJECT_SIZE                                                       \
+  (MEM_ALIGN_NEXT(CH_BUFFER_OBJECT_SIZE(BUFFER_SIZE * 4)) / 4)
+
+#define RXOBJECTS_NUM   (STM32_MAC_RECEIVE_BUFFERS + STM32_MAC_CHAIN_BUFFERS)
+#endif
+
 /* MII divider optimal value.*/
 #if (STM32_HCLK >= 150000000)
 #define MACMIIDR_CR ETH_MACMIIAR_CR_Div102
@@ -70,9 +79,22 @@ static const uint8_t default_mac_address[] = {0xAA, 0x55, 0x13,
 static stm32_eth_rx_descriptor_t rd[STM32_MAC_RECEIVE_BUFFERS];
 static stm32_eth_tx_descriptor_t td[STM32_MAC_TRANSMIT_BUFFERS];
 
+#if !STM32_MAC_USE_CHAINS
 static uint32_t rb[STM32_MAC_RECEIVE_BUFFERS][BUFFER_SIZE];
+#endif
 static uint32_t tb[STM32_MAC_TRANSMIT_BUFFERS][BUFFER_SIZE];
 
+#if STM32_MAC_USE_CHAINS
+/* Receive buffers storage, the pool is refilled by the application
+   releasing the received frames.*/
+static uint32_t rxobjects[RXOBJECTS_NUM][RXOBJECT_SIZE];
+
+/* Buffers currently attached to the descriptors, the transmit descriptors
+   refer to the first buffer of the frame chain.*/
+static buffer_t *rxbuf[STM32_MAC_RECEIVE_BUFFERS];
+static buffer_t *txbuf[STM32_MAC_TRANSMIT_BUFFERS];
+#endif
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -201,6 +223,29 @@ CH_IRQ_HANDLER(ETH_IRQHandler) {
   CH_IRQ_EPILOGUE();
 }
 
+#if STM32_MAC_USE_CHAINS || defined(__DOXYGEN__)
+/**
+ * @brief   Detaches the transmitted buffers from the descriptors.
+ * @details The descriptors released by the DMA get back their own buffer,
+ *          the reference to a chain is dropped when the descriptor of its
+ *          last buffer is released.
+ *
+ * @notapi
+ */
+static void tx_reclaim(void) {
+  unsigned i;
+
+  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
+    if ((txbuf[i] != NULL) && !(td[i].tdes0 & STM32_TDES0_OWN)) {
+      if (td[i].tdes0 & STM32_TDES0_LS)
+        chBufReleaseI(txbuf[i]);
+      txbuf[i] = NULL;
+      td[i].tdes2 = (uint32_t)tb[i];
+    }
+  }
+}
+#endif /* STM32_MAC_USE_CHAINS */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -218,9 +263,26 @@ void mac_lld_init(void) {
 
   /* Descriptor tables are initialized in chained mode, note that the first
      word is not initialized here but in mac_lld_start().*/
+#if STM32_MAC_USE_CHAINS
+  /* The receive descriptors get their buffers from the pool, the others
+     remain available for the swaps.*/
+  chPoolObjectInit(&ETHD1.rxpool, sizeof rxobjects[0], NULL);
+  chPoolLoadArray(&ETHD1.rxpool, rxobjects, RXOBJECTS_NUM);
+  chBufAllocatorObjectInit(&ETHD1.rxalloc, &ETHD1.rxpool, 1);
+  chSysLock();
+  for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++)
+    rxbuf[i] = chBufAllocI(&ETHD1.rxalloc, STM32_MAC_BUFFERS_SIZE, 0);
+  chSysUnlock();
+  for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++)
+    txbuf[i] = NULL;
+#endif
   for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
     rd[i].rdes1 = STM32_RDES1_RCH | STM32_MAC_BUFFERS_SIZE;
+#if STM32_MAC_USE_CHAINS
+    rd[i].rdes2 = (uint32_t)rxbuf[i]->b_base;
+#else
     rd[i].rdes2 = (uint32_t)rb[i];
+#endif
     rd[i].rdes3 = (uint32_t)&rd[(i + 1) % STM32_MAC_RECEIVE_BUFFERS];
   }
   for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++) {
@@ -409,6 +471,11 @@ msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
 
   chSysLock();
 
+#if STM32_MAC_USE_CHAINS
+  /* Descriptors used by chains transmissions get back their buffers.*/
+  tx_reclaim();
+#endif
+
   /* Get Current TX descriptor.*/
   tdes = macp->txptr;
 
@@ -740,6 +807,135 @@ const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
 }
 #endif /* MAC_USE_ZERO_COPY */
 
+#if STM32_MAC_USE_CHAINS || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a received frame without copying it.
+ * @details The buffer written by the DMA is detached from the receive
+ *          descriptor and replaced by a buffer taken from the pool, the
+ *          descriptor is then immediately returned to the DMA.
+ * @note    If the pool is empty the frame is dropped, the application
+ *          must release the received buffers using @p chBufRelease() in
+ *          order to keep receiving.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] bpp      pointer to a variable receiving the buffer
+ *                      containing the frame, the caller owns a reference
+ * @return              The operation status.
+ * @retval RDY_OK       a frame has been returned.
+ * @retval RDY_TIMEOUT  frame not available.
+ *
+ * @api
+ */
+msg_t mac_lld_get_receive_chain(MACDriver *macp, buffer_t **bpp) {
+  MACReceiveDescriptor rdesc;
+  buffer_t *bp, *nbp;
+  unsigned i;
+
+  if (mac_lld_get_receive_descriptor(macp, &rdesc) != RDY_OK)
+    return RDY_TIMEOUT;
+
+  chSysLock();
+  nbp = chBufAllocI(&macp->rxalloc, STM32_MAC_BUFFERS_SIZE, 0);
+  if (nbp != NULL) {
+    /* Buffers swap, the descriptor gets the fresh buffer.*/
+    i = rdesc.physdesc - rd;
+    bp = rxbuf[i];
+    rxbuf[i] = nbp;
+    rdesc.physdesc->rdes2 = (uint32_t)nbp->b_base;
+  }
+  chSysUnlock();
+
+  mac_lld_release_receive_descriptor(&rdesc);
+
+  if (nbp == NULL)
+    return RDY_TIMEOUT;
+
+  bp->b_size = rdesc.size;
+  *bpp = bp;
+  return RDY_OK;
+}
+
+/**
+ * @brief   Transmits a frame described by a buffer chain.
+ * @details Each buffer of the chain is mapped on a transmit descriptor, no
+ *          data is copied. The chain is referenced until the DMA has
+ *          transmitted it, the caller keeps its own reference.
+ * @note    The chain cannot be longer than the number of transmit
+ *          descriptors.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @return              The operation status.
+ * @retval RDY_OK       the frame has been queued for transmission.
+ * @retval RDY_TIMEOUT  not enough free descriptors.
+ *
+ * @api
+ */
+msg_t mac_lld_transmit_chain(MACDriver *macp, buffer_t *bp) {
+  stm32_eth_tx_descriptor_t *tdes, *first;
+  buffer_t *cp;
+  unsigned n;
+
+  chDbgCheck(bp != NULL, "mac_lld_transmit_chain");
+
+  if (!macp->link_up)
+    return RDY_TIMEOUT;
+
+  chSysLock();
+
+  tx_reclaim();
+
+  /* Checking that enough consecutive descriptors are available.*/
+  tdes = macp->txptr;
+  n = 0;
+  for (cp = bp; cp != NULL; cp = cp->b_next) {
+    chDbgAssert((n < STM32_MAC_TRANSMIT_BUFFERS) &&
+                (cp->b_size <= STM32_TDES1_TBS1_MASK),
+                "mac_lld_transmit_chain(), #1", "chain too large");
+    if ((tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED)) ||
+        (txbuf[tdes - td] != NULL)) {
+      chSysUnlock();
+      return RDY_TIMEOUT;
+    }
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+    n++;
+  }
+
+  /* Mapping the buffers on the descriptors, the first descriptor is given
+     to the DMA last so the frame is not started before being complete.*/
+  first = tdes = macp->txptr;
+  (void) chBufAddRefI(bp);
+  for (cp = bp; cp != NULL; cp = cp->b_next) {
+    uint32_t tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
+                     STM32_TDES0_TCH;
+
+    if (cp == bp)
+      tdes0 |= STM32_TDES0_FS;
+    else
+      tdes0 |= STM32_TDES0_OWN;
+    if (cp->b_next == NULL)
+      tdes0 |= STM32_TDES0_IC | STM32_TDES0_LS;
+
+    txbuf[tdes - td] = bp;
+    tdes->tdes2 = (uint32_t)cp->b_data;
+    tdes->tdes1 = cp->b_size;
+    tdes->tdes0 = tdes0;
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  }
+  macp->txptr = tdes;
+  first->tdes0 |= STM32_TDES0_OWN;
+
+  /* If the DMA engine is stalled then a restart request is issued.*/
+  if ((ETH->DMASR & ETH_DMASR_TPS) == ETH_DMASR_TPS_Suspended) {
+    ETH->DMASR   = ETH_DMASR_TBUS;
+    ETH->DMATPDR = ETH_DMASR_TBUS; /* Any value is OK.*/
+  }
+
+  chSysUnlock();
+  return RDY_OK;
+}
+#endif /* STM32_MAC_USE_CHAINS */
+
 #endif /* HAL_USE_MAC */
 
 /** @} */
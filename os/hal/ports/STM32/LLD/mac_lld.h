@@ -185,6 +185,29 @@
 #if !defined(STM32_MAC_IP_CHECKSUM_OFFLOAD) || defined(__DOXYGEN__)
 #define STM32_MAC_IP_CHECKSUM_OFFLOAD       0
 #endif
+
+/**
+ * @brief   Enables the buffer chains API.
+ * @details If enabled the receive buffers are kernel packet buffers taken
+ *          from a driver pool, a received frame is handed over as a
+ *          @p buffer_t while the descriptor gets a fresh buffer from the
+ *          pool. Frames can be transmitted from @p buffer_t chains mapped
+ *          directly on the transmit descriptors.
+ */
+#if !defined(STM32_MAC_USE_CHAINS) || defined(__DOXYGEN__)
+#define STM32_MAC_USE_CHAINS                FALSE
+#endif
+
+/**
+ * @brief   Number of pool buffers in addition to the receive buffers.
+ * @details This is the number of received frames that can be retained by
+ *          the application without stalling the reception.
+ * @note    The pool is only used for reception, the transmitted chains are
+ *          allocated by the application from its own buffers allocator.
+ */
+#if !defined(STM32_MAC_CHAIN_BUFFERS) || defined(__DOXYGEN__)
+#define STM32_MAC_CHAIN_BUFFERS             4
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -195,6 +218,10 @@
 #error "STM32_MAC_PHY_TIMEOUT requires the realtime counter service"
 #endif
 
+#if STM32_MAC_USE_CHAINS && !CH_CFG_USE_BUFFERS
+#error "STM32_MAC_USE_CHAINS requires CH_CFG_USE_BUFFERS"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -273,6 +300,16 @@ struct MACDriver {
    * @brief Transmit next frame pointer.
    */
   stm32_eth_tx_descriptor_t *txptr;
+#if STM32_MAC_USE_CHAINS || defined(__DOXYGEN__)
+  /**
+   * @brief Pool of the receive buffers.
+   */
+  memory_pool_t         rxpool;
+  /**
+   * @brief Allocator of the receive buffers.
+   */
+  buffers_allocator_t   rxalloc;
+#endif
 };
 
 /**
@@ -353,6 +390,10 @@ extern "C" {
   const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                  size_t *sizep);
 #endif /* MAC_USE_ZERO_COPY */
+#if STM32_MAC_USE_CHAINS
+  msg_t mac_lld_get_receive_chain(MACDriver *macp, buffer_t **bpp);
+  msg_t mac_lld_transmit_chain(MACDriver *macp, buffer_t *bp);
+#endif /* STM32_MAC_USE_CHAINS */
 #ifdef __cplusplus
 }
 #endif
@@ -250,6 +250,127 @@ static void sdc_lld_error_cleanup(SDCDriver *sdcp,
     sdc_lld_send_cmd_short_crc(sdcp, MMCSD_CMD_STOP_TRANSMISSION, 0, resp);
 }
 
+#if SDC_USE_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Ends an asynchronous transfer.
+ * @details Multiple blocks transfers are terminated by sending the stop
+ *          command, its response is awaited by interrupt and the high
+ *          level driver is notified after it.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] result    result of the data transfer
+ *
+ * @notapi
+ */
+static void sdc_lld_async_end(SDCDriver *sdcp, bool result) {
+
+  if ((sdcp->async == SDC_ASYNC_TRANSFER) && (sdcp->blocks > 1)) {
+    sdcp->stopping    = TRUE;
+    sdcp->data_result = result;
+    SDIO->ICR  = STM32_SDIO_ICR_ALL_FLAGS;
+    SDIO->MASK = SDIO_MASK_CCRCFAILIE |
+                 SDIO_MASK_CTIMEOUTIE |
+                 SDIO_MASK_CMDRENDIE;
+    SDIO->ARG  = 0;
+    SDIO->CMD  = (uint32_t)MMCSD_CMD_STOP_TRANSMISSION |
+                 SDIO_CMD_WAITRESP_0 | SDIO_CMD_CPSMEN;
+    return;
+  }
+  _sdc_isr_transfer_end(sdcp, result);
+}
+
+/**
+ * @brief   Serves the data path of an asynchronous transfer.
+ * @details The transfer is complete when the SDIO reports the data end and
+ *          the DMA has transferred all the data, the two events can happen
+ *          in any order so this function is invoked from both the SDIO and
+ *          the DMA interrupt handlers.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+static void sdc_lld_serve_data(SDCDriver *sdcp) {
+  uint32_t sta = SDIO->STA;
+
+  if ((sta & (SDIO_STA_DCRCFAIL | SDIO_STA_DTIMEOUT | SDIO_STA_STBITERR |
+              SDIO_STA_TXUNDERR | SDIO_STA_RXOVERR)) != 0) {
+    sdc_lld_collect_errors(sdcp, sta);
+    dmaStreamDisable(sdcp->dma);
+    SDIO->ICR   = STM32_SDIO_ICR_ALL_FLAGS;
+    SDIO->MASK  = 0;
+    SDIO->DCTRL = 0;
+    sdc_lld_async_end(sdcp, HAL_FAILED);
+    return;
+  }
+
+  if ((sta & SDIO_STA_DATAEND) == 0)
+    return;
+
+  /* The data end flag is not cleared until the DMA is done, the source
+     is disabled meanwhile.*/
+  SDIO->MASK = 0;
+#if (defined(STM32F4XX) || defined(STM32F2XX))
+  /* The stream is disabled by the hardware after the last data.*/
+  if ((sdcp->dma->stream->CR & STM32_DMA_CR_EN) != 0)
+    return;
+#else
+  if (dmaStreamGetTransactionSize(sdcp->dma) > 0)
+    return;
+#endif
+  dmaStreamDisable(sdcp->dma);
+  SDIO->ICR   = STM32_SDIO_ICR_ALL_FLAGS;
+  SDIO->DCTRL = 0;
+  sdc_lld_async_end(sdcp, HAL_SUCCESS);
+}
+
+/**
+ * @brief   Serves the stop command response of an asynchronous transfer.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+static void sdc_lld_serve_stop(SDCDriver *sdcp) {
+  uint32_t sta = SDIO->STA;
+  bool result;
+
+  /* The IRQ may be left pending by a data end already served from the
+     DMA handler.*/
+  if ((sta & (SDIO_STA_CMDREND | SDIO_STA_CTIMEOUT |
+              SDIO_STA_CCRCFAIL)) == 0)
+    return;
+
+  SDIO->MASK = 0;
+  SDIO->ICR  = STM32_SDIO_ICR_ALL_FLAGS;
+  sdcp->stopping = FALSE;
+  result = sdcp->data_result;
+  if ((sta & (SDIO_STA_CTIMEOUT | SDIO_STA_CCRCFAIL)) != 0) {
+    sdc_lld_collect_errors(sdcp, sta);
+    result = HAL_FAILED;
+  }
+  _sdc_isr_transfer_end(sdcp, result);
+}
+
+/**
+ * @brief   Shared end-of-transfer service routine.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ *
+ * @notapi
+ */
+static void sdc_lld_serve_dma_interrupt(SDCDriver *sdcp, uint32_t flags) {
+
+  (void)flags;
+
+  osalSysLockFromISR();
+  if ((sdcp->async != SDC_ASYNC_NONE) && !sdcp->stopping)
+    sdc_lld_serve_data(sdcp);
+  osalSysUnlockFromISR();
+}
+#endif /* SDC_USE_ASYNC */
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -260,7 +381,7 @@ static void sdc_lld_error_cleanup(SDCDriver *sdcp,
 /**
  * @brief   SDIO IRQ handler.
  * @details It just wakes transaction thread. All error  handling performs in
- *          that thread.
+ *          that thread. Asynchronous transfers are instead completed here.
  *
  * @isr
  */
@@ -270,11 +391,23 @@ OSAL_IRQ_HANDLER(STM32_SDIO_HANDLER) {
 
   osalSysLockFromISR();
 
-  /* Disables the source but the status flags are not reset because the
-     read/write functions needs to check them.*/
-  SDIO->MASK = 0;
-
-  osalThreadResumeI(&SDCD1.thread, MSG_OK);
+#if SDC_USE_ASYNC
+  /* Asynchronous transfers are finalized from the interrupt handlers,
+     there is no thread waiting for the transaction end.*/
+  if (SDCD1.async != SDC_ASYNC_NONE) {
+    if (SDCD1.stopping)
+      sdc_lld_serve_stop(&SDCD1);
+    else
+      sdc_lld_serve_data(&SDCD1);
+  }
+  else
+#endif
+  {
+    /* Disables the source but the status flags are not reset because the
+       read/write functions needs to check them.*/
+    SDIO->MASK = 0;
+    osalThreadResumeI(&SDCD1.thread, MSG_OK);
+  }
 
   osalSysUnlockFromISR();
 
@@ -295,6 +428,9 @@ void sdc_lld_init(void) {
   sdcObjectInit(&SDCD1);
   SDCD1.thread = NULL;
   SDCD1.dma    = STM32_DMA_STREAM(STM32_SDC_SDIO_DMA_STREAM);
+#if SDC_USE_ASYNC
+  SDCD1.stopping = FALSE;
+#endif
 #if CH_DBG_ENABLE_ASSERTS
   SDCD1.sdio   = SDIO;
 #endif
@@ -324,7 +460,13 @@ void sdc_lld_start(SDCDriver *sdcp) {
   if (sdcp->state == BLK_STOP) {
     /* Note, the DMA must be enabled before the IRQs.*/
     bool b;
+#if SDC_USE_ASYNC
+    b = dmaStreamAllocate(sdcp->dma, STM32_SDC_SDIO_IRQ_PRIORITY,
+                          (stm32_dmaisr_t)sdc_lld_serve_dma_interrupt,
+                          (void *)sdcp);
+#else
     b = dmaStreamAllocate(sdcp->dma, STM32_SDC_SDIO_IRQ_PRIORITY, NULL, NULL);
+#endif
     osalDbgAssert(!b, "stream already allocated");
     dmaStreamSetPeripheral(sdcp->dma, &SDIO->FIFO);
 #if (defined(STM32F4XX) || defined(STM32F2XX))
@@ -775,6 +917,204 @@ bool sdc_lld_sync(SDCDriver *sdcp) {
   return HAL_SUCCESS;
 }
 
+#if SDC_USE_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Starts an asynchronous read of one or more blocks.
+ * @details The transaction end is notified to the high level driver from
+ *          the IRQ handler.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation started.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_start_read(SDCDriver *sdcp, uint32_t startblk,
+                        uint8_t *buf, uint32_t n) {
+  uint32_t resp[1];
+
+  osalDbgCheck(n < 0x1000000 / MMCSD_BLOCK_SIZE);
+  osalDbgCheck(((unsigned)buf & 3) == 0);
+
+  SDIO->DTIMER = STM32_SDC_READ_TIMEOUT;
+
+  /* Checks for errors and waits for the card to be ready for reading.*/
+  if (_sdc_wait_for_transfer_state(sdcp))
+    return HAL_FAILED;
+
+  /* Prepares the DMA channel for reading.*/
+  dmaStreamSetMemory0(sdcp->dma, buf);
+  dmaStreamSetTransactionSize(sdcp->dma,
+                              (n * MMCSD_BLOCK_SIZE) / sizeof (uint32_t));
+  dmaStreamSetMode(sdcp->dma, sdcp->dmamode | STM32_DMA_CR_DIR_P2M |
+                              STM32_DMA_CR_TCIE);
+  dmaStreamEnable(sdcp->dma);
+
+  /* Setting up data transfer.*/
+  SDIO->ICR   = STM32_SDIO_ICR_ALL_FLAGS;
+  SDIO->MASK  = SDIO_MASK_DCRCFAILIE |
+                SDIO_MASK_DTIMEOUTIE |
+                SDIO_MASK_STBITERRIE |
+                SDIO_MASK_RXOVERRIE |
+                SDIO_MASK_DATAENDIE;
+  SDIO->DLEN  = n * MMCSD_BLOCK_SIZE;
+
+  /* Transaction starts just after DTEN bit setting.*/
+  SDIO->DCTRL = SDIO_DCTRL_DTDIR |
+                SDIO_DCTRL_DBLOCKSIZE_3 |
+                SDIO_DCTRL_DBLOCKSIZE_0 |
+                SDIO_DCTRL_DMAEN |
+                SDIO_DCTRL_DTEN;
+
+  /* Talk to card what we want from it.*/
+  if (sdc_lld_prepare_read(sdcp, startblk, n, resp) == TRUE) {
+    sdc_lld_error_cleanup(sdcp, n, resp);
+    return HAL_FAILED;
+  }
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Starts an asynchronous write of one or more blocks.
+ * @details The transaction end is notified to the high level driver from
+ *          the IRQ handler.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation started.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_start_write(SDCDriver *sdcp, uint32_t startblk,
+                         const uint8_t *buf, uint32_t n) {
+  uint32_t resp[1];
+
+  osalDbgCheck(n < 0x1000000 / MMCSD_BLOCK_SIZE);
+  osalDbgCheck(((unsigned)buf & 3) == 0);
+
+  SDIO->DTIMER = STM32_SDC_WRITE_TIMEOUT;
+
+  /* Checks for errors and waits for the card to be ready for writing.*/
+  if (_sdc_wait_for_transfer_state(sdcp))
+    return HAL_FAILED;
+
+  /* Talk to card what we want from it.*/
+  if (sdc_lld_prepare_write(sdcp, startblk, n, resp) == TRUE)
+    return HAL_FAILED;
+
+  sdc_lld_stream_data(sdcp, buf, n);
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Starts an open-ended multiple blocks write.
+ * @details The data is supplied using @p sdc_lld_stream_data(), the
+ *          write is terminated using @p sdc_lld_stop_transmission().
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation started.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_start_stream(SDCDriver *sdcp, uint32_t startblk) {
+  uint32_t resp[1];
+
+  SDIO->DTIMER = STM32_SDC_WRITE_TIMEOUT;
+
+  /* Checks for errors and waits for the card to be ready for writing.*/
+  if (_sdc_wait_for_transfer_state(sdcp))
+    return HAL_FAILED;
+
+  if (!(sdcp->cardmode & SDC_MODE_HIGH_CAPACITY))
+    startblk *= MMCSD_BLOCK_SIZE;
+
+  if (sdc_lld_send_cmd_short_crc(sdcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK,
+                                 startblk, resp) || MMCSD_R1_ERROR(resp[0]))
+    return HAL_FAILED;
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Starts the transfer of write data.
+ * @details The DMA and the data path are programmed for a transfer of
+ *          @p n blocks, the write command must have already been sent.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @notapi
+ */
+void sdc_lld_stream_data(SDCDriver *sdcp, const uint8_t *buf, uint32_t n) {
+
+  osalDbgCheck(n < 0x1000000 / MMCSD_BLOCK_SIZE);
+  osalDbgCheck(((unsigned)buf & 3) == 0);
+
+  /* Prepares the DMA channel for writing.*/
+  dmaStreamSetMemory0(sdcp->dma, buf);
+  dmaStreamSetTransactionSize(sdcp->dma,
+                              (n * MMCSD_BLOCK_SIZE) / sizeof (uint32_t));
+  dmaStreamSetMode(sdcp->dma, sdcp->dmamode | STM32_DMA_CR_DIR_M2P |
+                              STM32_DMA_CR_TCIE);
+  dmaStreamEnable(sdcp->dma);
+
+  /* Setting up data transfer.*/
+  SDIO->ICR   = STM32_SDIO_ICR_ALL_FLAGS;
+  SDIO->MASK  = SDIO_MASK_DCRCFAILIE |
+                SDIO_MASK_DTIMEOUTIE |
+                SDIO_MASK_STBITERRIE |
+                SDIO_MASK_TXUNDERRIE |
+                SDIO_MASK_DATAENDIE;
+  SDIO->DLEN  = n * MMCSD_BLOCK_SIZE;
+
+  /* Transaction starts just after DTEN bit setting.*/
+  SDIO->DCTRL = SDIO_DCTRL_DBLOCKSIZE_3 |
+                SDIO_DCTRL_DBLOCKSIZE_0 |
+                SDIO_DCTRL_DMAEN |
+                SDIO_DCTRL_DTEN;
+}
+
+/**
+ * @brief   Sends the stop transmission command.
+ * @note    The command is polled, this function must not be invoked from
+ *          the IRQ handler.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+bool sdc_lld_stop_transmission(SDCDriver *sdcp) {
+  uint32_t resp[1];
+
+  return sdc_lld_send_cmd_short_crc(sdcp, MMCSD_CMD_STOP_TRANSMISSION,
+                                    0, resp);
+}
+#endif /* SDC_USE_ASYNC */
+
 #endif /* HAL_USE_SDC */
 
 /** @} */
@@ -205,6 +205,14 @@ typedef uint32_t sdcflags_t;
  */
 typedef struct SDCDriver SDCDriver;
 
+/**
+ * @brief   Asynchronous operations notification callback type.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object triggering the
+ *                      callback
+ */
+typedef void (*sdccallback_t)(SDCDriver *sdcp);
+
 /**
  * @brief   Driver configuration structure.
  * @note    It could be empty on some architectures.
@@ -258,6 +266,56 @@ struct SDCDriver {
    * @brief Thread waiting for I/O completion IRQ.
    */
   thread_reference_t        thread;
+#if SDC_USE_ASYNC || defined(__DOXYGEN__)
+  /**
+   * @brief Asynchronous operation in progress.
+   */
+  uint8_t                   async;
+  /**
+   * @brief Result of the asynchronous operation.
+   */
+  bool                      result;
+  /**
+   * @brief Asynchronous operation notification callback or @p NULL.
+   */
+  sdccallback_t             callback;
+  /**
+   * @brief Number of blocks of the asynchronous transfer.
+   */
+  uint32_t                  blocks;
+  /**
+   * @brief Thread waiting for an asynchronous operation.
+   */
+  thread_reference_t        waiting;
+  /**
+   * @brief Buffers queued in the write stream.
+   */
+  const uint8_t             *sq_buf[SDC_STREAM_BUFFERS];
+  /**
+   * @brief Size in blocks of the buffers queued in the write stream.
+   */
+  uint32_t                  sq_n[SDC_STREAM_BUFFERS];
+  /**
+   * @brief Index of the buffer being transferred.
+   */
+  uint32_t                  sq_head;
+  /**
+   * @brief Number of buffers in the write stream queue.
+   */
+  uint32_t                  sq_count;
+  /**
+   * @brief Next block to be written by the write stream.
+   */
+  uint32_t                  sq_next;
+  /**
+   * @brief Stop command in progress after an asynchronous transfer.
+   */
+  bool                      stopping;
+  /**
+   * @brief Result of the data transfer being stopped.
+   */
+  bool                      data_result;
+#endif
   /**
    * @brief     DMA mode bit mask.
    */
@@ -309,6 +367,15 @@ extern "C" {
   bool sdc_lld_write(SDCDriver *sdcp, uint32_t startblk,
                      const uint8_t *buf, uint32_t n);
   bool sdc_lld_sync(SDCDriver *sdcp);
+#if SDC_USE_ASYNC
+  bool sdc_lld_start_read(SDCDriver *sdcp, uint32_t startblk,
+                          uint8_t *buf, uint32_t n);
+  bool sdc_lld_start_write(SDCDriver *sdcp, uint32_t startblk,
+                           const uint8_t *buf, uint32_t n);
+  bool sdc_lld_start_stream(SDCDriver *sdcp, uint32_t startblk);
+  void sdc_lld_stream_data(SDCDriver *sdcp, const uint8_t *buf, uint32_t n);
+  bool sdc_lld_stop_transmission(SDCDriver *sdcp);
+#endif
   bool sdc_lld_is_card_inserted(SDCDriver *sdcp);
   bool sdc_lld_is_write_protected(SDCDriver *sdcp);
 #ifdef __cplusplus
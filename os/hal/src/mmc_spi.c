@@ -99,35 +99,132 @@ static const uint8_t crc7_lookup_table[256] = {
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if MMC_USE_SESSIONS || defined(__DOXYGEN__)
+/**
+ * @brief   Closes the open sequential session, if any.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @notapi
+ */
+static void session_close(MMCDriver *mmcp) {
+
+  if (mmcp->session == BLK_READY)
+    return;
+
+  /* The session is resumed only to be stopped.*/
+  mmcp->state = mmcp->session;
+  mmcp->session = BLK_READY;
+  spiStart(mmcp->config->spip, mmcp->config->hscfg);
+  spiSelect(mmcp->config->spip);
+  if (mmcp->state == BLK_READING)
+    (void) mmcStopSequentialRead(mmcp);
+  else
+    (void) mmcStopSequentialWrite(mmcp);
+}
+
+/**
+ * @brief   Resumes the open sequential session if it can be continued.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] type      session type, @p BLK_READING or @p BLK_WRITING
+ * @param[in] startblk  first block of the operation
+ * @return              The resume status.
+ * @retval TRUE         the session has been resumed.
+ * @retval FALSE        the session cannot be continued.
+ *
+ * @notapi
+ */
+static bool session_resume(MMCDriver *mmcp, blkstate_t type,
+                           uint32_t startblk) {
+
+  if ((mmcp->session != type) || (mmcp->session_next != startblk) ||
+      !osalOsIsTimeWithinX(osalOsGetSystemTimeX(), mmcp->session_time,
+                           mmcp->session_time + MMC_SESSION_TIMEOUT))
+    return FALSE;
+
+  /* Same setup done when starting a sequential operation.*/
+  mmcp->session = BLK_READY;
+  mmcp->state = type;
+  spiStart(mmcp->config->spip, mmcp->config->hscfg);
+  spiSelect(mmcp->config->spip);
+  mmcp->stats.reused++;
+  return TRUE;
+}
+
+/**
+ * @brief   Leaves the current sequential operation open.
+ * @details The card is deselected so that the bus can be used by other
+ *          devices, the driver returns in the @p BLK_READY state.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] next      next block of the session
+ *
+ * @notapi
+ */
+static void session_suspend(MMCDriver *mmcp, uint32_t next) {
+
+  spiUnselect(mmcp->config->spip);
+  mmcp->session = mmcp->state;
+  mmcp->session_next = next;
+  mmcp->session_time = osalOsGetSystemTimeX();
+  mmcp->state = BLK_READY;
+}
+#endif /* MMC_USE_SESSIONS */
+
 static bool mmc_read(void *instance, uint32_t startblk,
                 uint8_t *buffer, uint32_t n) {
+  MMCDriver *mmcp = (MMCDriver *)instance;
 
-  if (mmcStartSequentialRead((MMCDriver *)instance, startblk))
-    return HAL_FAILED;
+#if MMC_USE_SESSIONS
+  if (!session_resume(mmcp, BLK_READING, startblk))
+#endif
+  {
+    if (mmcStartSequentialRead(mmcp, startblk))
+      return HAL_FAILED;
+    mmcp->stats.sessions++;
+  }
   while (n > 0) {
-    if (mmcSequentialRead((MMCDriver *)instance, buffer))
+    if (mmcSequentialRead(mmcp, buffer))
       return HAL_FAILED;
     buffer += MMCSD_BLOCK_SIZE;
+    startblk++;
     n--;
   }
-  if (mmcStopSequentialRead((MMCDriver *)instance))
+#if MMC_USE_SESSIONS
+  session_suspend(mmcp, startblk);
+#else
+  if (mmcStopSequentialRead(mmcp))
       return HAL_FAILED;
+#endif
   return HAL_SUCCESS;
 }
 
 static bool mmc_write(void *instance, uint32_t startblk,
                  const uint8_t *buffer, uint32_t n) {
+  MMCDriver *mmcp = (MMCDriver *)instance;
 
-  if (mmcStartSequentialWrite((MMCDriver *)instance, startblk))
+#if MMC_USE_SESSIONS
+  if (!session_resume(mmcp, BLK_WRITING, startblk))
+#endif
+  {
+    if (mmcStartSequentialWrite(mmcp, startblk))
       return HAL_FAILED;
+    mmcp->stats.sessions++;
+  }
   while (n > 0) {
-      if (mmcSequentialWrite((MMCDriver *)instance, buffer))
+      if (mmcSequentialWrite(mmcp, buffer))
           return HAL_FAILED;
       buffer += MMCSD_BLOCK_SIZE;
+      startblk++;
       n--;
   }
-  if (mmcStopSequentialWrite((MMCDriver *)instance))
+#if MMC_USE_SESSIONS
+  session_suspend(mmcp, startblk);
+#else
+  if (mmcStopSequentialWrite(mmcp))
       return HAL_FAILED;
+#endif
   return HAL_SUCCESS;
 }
 
@@ -148,30 +245,65 @@ static uint8_t crc7(uint8_t crc, const uint8_t *buffer, size_t len) {
 
 /**
  * @brief   Waits an idle condition.
+ * @details The card is polled using bursts of @p MMC_WAIT_BURST bytes, after
+ *          @p MMC_WAIT_FAST_BURSTS unsuccessful bursts the polling continues
+ *          with exponentially increasing sleeps between bursts if
+ *          @p MMC_NICE_WAITING is enabled.
+ * @note    The card must be selected.
+ * @note    The sleeps are performed using @p osalThreadSleep() so the
+ *          first one lasts one full system tick, there is no sub-tick
+ *          wait and the resolution of the slow path is the system tick.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the card is idle.
+ * @retval HAL_FAILED   the card is still busy after @p MMC_WAIT_TIMEOUT.
  *
  * @notapi
  */
-static void wait(MMCDriver *mmcp) {
+static bool wait(MMCDriver *mmcp) {
   int i;
-  uint8_t buf[4];
+  uint8_t buf[MMC_WAIT_BURST];
+  systime_t start;
+#if MMC_NICE_WAITING
+  systime_t delay = 1;
+#endif
 
-  for (i = 0; i < 16; i++) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFF)
-      return;
+  /* The card keeps the line low while busy, the last byte of the burst
+     is the most recent state.*/
+  start = osalOsGetSystemTimeX();
+  for (i = 0; i < MMC_WAIT_FAST_BURSTS; i++) {
+    spiReceive(mmcp->config->spip, MMC_WAIT_BURST, buf);
+    if (buf[MMC_WAIT_BURST - 1] == 0xFF) {
+      mmcp->stats.busy_time += osalOsGetSystemTimeX() - start;
+      return HAL_SUCCESS;
+    }
   }
+
   /* Looks like it is a long wait.*/
+  mmcp->stats.busy_waits++;
   while (TRUE) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFF)
-      break;
-#ifdef MMC_NICE_WAITING
+    if (!osalOsIsTimeWithinX(osalOsGetSystemTimeX(), start,
+                             start + MMC_WAIT_TIMEOUT)) {
+      mmcp->stats.busy_timeouts++;
+      mmcp->stats.busy_time += osalOsGetSystemTimeX() - start;
+      return HAL_FAILED;
+    }
+#if MMC_NICE_WAITING
     /* Trying to be nice with the other threads.*/
-    chThdSleep(1);
+    osalThreadSleep(delay);
+    if (delay < MMC_WAIT_MAX_DELAY) {
+      delay <<= 1;
+      if (delay > MMC_WAIT_MAX_DELAY)
+        delay = MMC_WAIT_MAX_DELAY;
+    }
 #endif
+    spiReceive(mmcp->config->spip, MMC_WAIT_BURST, buf);
+    if (buf[MMC_WAIT_BURST - 1] == 0xFF)
+      break;
   }
+  mmcp->stats.busy_time += osalOsGetSystemTimeX() - start;
+  return HAL_SUCCESS;
 }
 
 /**
@@ -180,14 +312,19 @@ static void wait(MMCDriver *mmcp) {
  * @param[in] mmcp      pointer to the @p MMCDriver object
  * @param[in] cmd       the command id
  * @param[in] arg       the command argument
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the command has been sent.
+ * @retval HAL_FAILED   the card is still busy, the command has not been
+ *                      sent.
  *
  * @notapi
  */
-static void send_hdr(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
+static bool send_hdr(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
   uint8_t buf[6];
 
   /* Wait for the bus to become idle if a write operation was in progress.*/
-  wait(mmcp);
+  if (wait(mmcp))
+    return HAL_FAILED;
 
   buf[0] = 0x40 | cmd;
   buf[1] = arg >> 24;
@@ -198,6 +335,7 @@ static void send_hdr(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
   buf[5] = ((crc7(0, buf, 5) & 0x7F) << 1) | 0x01;
 
   spiSend(mmcp->config->spip, 6, buf);
+  return HAL_SUCCESS;
 }
 
 /**
@@ -255,8 +393,10 @@ static uint8_t send_command_R1(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
   uint8_t r1;
 
   spiSelect(mmcp->config->spip);
-  send_hdr(mmcp, cmd, arg);
-  r1 = recvr1(mmcp);
+  if (send_hdr(mmcp, cmd, arg))
+    r1 = 0xFF;
+  else
+    r1 = recvr1(mmcp);
   spiUnselect(mmcp->config->spip);
   return r1;
 }
@@ -279,8 +419,10 @@ static uint8_t send_command_R3(MMCDriver *mmcp, uint8_t cmd, uint32_t arg,
   uint8_t r1;
 
   spiSelect(mmcp->config->spip);
-  send_hdr(mmcp, cmd, arg);
-  r1 = recvr3(mmcp, response);
+  if (send_hdr(mmcp, cmd, arg))
+    r1 = 0xFF;
+  else
+    r1 = recvr3(mmcp, response);
   spiUnselect(mmcp->config->spip);
   return r1;
 }
@@ -302,8 +444,7 @@ static bool read_CxD(MMCDriver *mmcp, uint8_t cmd, uint32_t cxd[4]) {
   uint8_t *bp, buf[16];
 
   spiSelect(mmcp->config->spip);
-  send_hdr(mmcp, cmd, 0);
-  if (recvr1(mmcp) != 0x00) {
+  if (send_hdr(mmcp, cmd, 0) || (recvr1(mmcp) != 0x00)) {
     spiUnselect(mmcp->config->spip);
     return HAL_FAILED;
   }
@@ -336,22 +477,19 @@ static bool read_CxD(MMCDriver *mmcp, uint8_t cmd, uint32_t cxd[4]) {
  * @brief   Waits that the card reaches an idle state.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the card is idle.
+ * @retval HAL_FAILED   the card is still busy after @p MMC_WAIT_TIMEOUT.
  *
  * @notapi
  */
-static void sync(MMCDriver *mmcp) {
-  uint8_t buf[1];
+static bool sync(MMCDriver *mmcp) {
+  bool result;
 
   spiSelect(mmcp->config->spip);
-  while (TRUE) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFF)
-      break;
-#ifdef MMC_NICE_WAITING
-    chThdSleep(1);      /* Trying to be nice with the other threads.*/
-#endif
-  }
+  result = wait(mmcp);
   spiUnselect(mmcp->config->spip);
+  return result;
 }
 
 /*===========================================================================*/
@@ -382,6 +520,14 @@ void mmcObjectInit(MMCDriver *mmcp) {
   mmcp->state = BLK_STOP;
   mmcp->config = NULL;
   mmcp->block_addresses = FALSE;
+#if MMC_USE_SESSIONS
+  mmcp->session = BLK_READY;
+#endif
+  mmcp->stats.sessions = 0;
+  mmcp->stats.reused = 0;
+  mmcp->stats.busy_waits = 0;
+  mmcp->stats.busy_timeouts = 0;
+  mmcp->stats.busy_time = 0;
 }
 
 /**
@@ -448,6 +594,10 @@ bool mmcConnect(MMCDriver *mmcp) {
   /* Connection procedure in progress.*/
   mmcp->state = BLK_CONNECTING;
   mmcp->block_addresses = FALSE;
+#if MMC_USE_SESSIONS
+  /* The card is going to be reset, any open session is lost.*/
+  mmcp->session = BLK_READY;
+#endif
 
   /* Slow clock mode and 128 clock pulses.*/
   spiStart(mmcp->config->spip, mmcp->config->lscfg);
@@ -545,9 +695,14 @@ failed:
  * @api
  */
 bool mmcDisconnect(MMCDriver *mmcp) {
+  bool result;
 
   osalDbgCheck(mmcp != NULL);
 
+#if MMC_USE_SESSIONS
+  session_close(mmcp);
+#endif
+
   osalSysLock();
   osalDbgAssert((mmcp->state == BLK_ACTIVE) || (mmcp->state == BLK_READY),
                 "invalid state");
@@ -560,11 +715,11 @@ bool mmcDisconnect(MMCDriver *mmcp) {
 
   /* Wait for the pending write operations to complete.*/
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
-  sync(mmcp);
+  result = sync(mmcp);
 
   spiStop(mmcp->config->spip);
   mmcp->state = BLK_ACTIVE;
-  return HAL_SUCCESS;
+  return result;
 }
 
 /**
@@ -584,6 +739,10 @@ bool mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
   osalDbgCheck(mmcp != NULL);
   osalDbgAssert(mmcp->state == BLK_READY, "invalid state");
 
+#if MMC_USE_SESSIONS
+  session_close(mmcp);
+#endif
+
   /* Read operation in progress.*/
   mmcp->state = BLK_READING;
 
@@ -592,12 +751,11 @@ bool mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
   spiSelect(mmcp->config->spip);
 
-  if (mmcp->block_addresses)
-    send_hdr(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK, startblk);
-  else
-    send_hdr(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK, startblk * MMCSD_BLOCK_SIZE);
+  if (!mmcp->block_addresses)
+    startblk *= MMCSD_BLOCK_SIZE;
 
-  if (recvr1(mmcp) != 0x00) {
+  if (send_hdr(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK, startblk) ||
+      (recvr1(mmcp) != 0x00)) {
     spiStop(mmcp->config->spip);
     mmcp->state = BLK_READY;
     return HAL_FAILED;
@@ -689,18 +847,20 @@ bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
   osalDbgCheck(mmcp != NULL);
   osalDbgAssert(mmcp->state == BLK_READY, "invalid state");
 
+#if MMC_USE_SESSIONS
+  session_close(mmcp);
+#endif
+
   /* Write operation in progress.*/
   mmcp->state = BLK_WRITING;
 
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
   spiSelect(mmcp->config->spip);
-  if (mmcp->block_addresses)
-    send_hdr(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK, startblk);
-  else
-    send_hdr(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK,
-             startblk * MMCSD_BLOCK_SIZE);
+  if (!mmcp->block_addresses)
+    startblk *= MMCSD_BLOCK_SIZE;
 
-  if (recvr1(mmcp) != 0x00) {
+  if (send_hdr(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK, startblk) ||
+      (recvr1(mmcp) != 0x00)) {
     spiStop(mmcp->config->spip);
     mmcp->state = BLK_READY;
     return HAL_FAILED;
@@ -733,10 +893,8 @@ bool mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
   spiSend(mmcp->config->spip, MMCSD_BLOCK_SIZE, buffer);/* Data.            */
   spiIgnore(mmcp->config->spip, 2);                     /* CRC ignored.     */
   spiReceive(mmcp->config->spip, 1, b);
-  if ((b[0] & 0x1F) == 0x05) {
-    wait(mmcp);
+  if (((b[0] & 0x1F) == 0x05) && (wait(mmcp) == HAL_SUCCESS))
     return HAL_SUCCESS;
-  }
 
   /* Error.*/
   spiUnselect(mmcp->config->spip);
@@ -784,21 +942,26 @@ bool mmcStopSequentialWrite(MMCDriver *mmcp) {
  * @api
  */
 bool mmcSync(MMCDriver *mmcp) {
+  bool result;
 
   osalDbgCheck(mmcp != NULL);
 
   if (mmcp->state != BLK_READY)
     return HAL_FAILED;
 
+#if MMC_USE_SESSIONS
+  session_close(mmcp);
+#endif
+
   /* Synchronization operation in progress.*/
   mmcp->state = BLK_SYNCING;
 
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
-  sync(mmcp);
+  result = sync(mmcp);
 
   /* Synchronization operation finished.*/
   mmcp->state = BLK_READY;
-  return HAL_SUCCESS;
+  return result;
 }
 
 /**
@@ -843,6 +1006,10 @@ bool mmcErase(MMCDriver *mmcp, uint32_t startblk, uint32_t endblk) {
 
   osalDbgCheck((mmcp != NULL));
 
+#if MMC_USE_SESSIONS
+  session_close(mmcp);
+#endif
+
   /* Erase operation in progress.*/
   mmcp->state = BLK_WRITING;
 
@@ -871,6 +1038,33 @@ failed:
   return HAL_FAILED;
 }
 
+#if MMC_USE_SESSIONS || defined(__DOXYGEN__)
+/**
+ * @brief   Closes the open sequential session if idle.
+ * @details The session is closed and the card released if no operation
+ *          continued it for @p MMC_SESSION_TIMEOUT. The function is meant
+ *          to be invoked periodically, for example by the thread polling
+ *          the card insertion.
+ * @note    The function must not be invoked concurrently with other
+ *          operations on the same driver.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @api
+ */
+void mmcCloseIdleSession(MMCDriver *mmcp) {
+
+  osalDbgCheck(mmcp != NULL);
+
+  if ((mmcp->state != BLK_READY) || (mmcp->session == BLK_READY) ||
+      osalOsIsTimeWithinX(osalOsGetSystemTimeX(), mmcp->session_time,
+                          mmcp->session_time + MMC_SESSION_TIMEOUT))
+    return;
+
+  session_close(mmcp);
+}
+#endif
+
 #endif /* HAL_USE_MMC_SPI */
 
 /** @} */
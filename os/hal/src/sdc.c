@@ -129,6 +129,15 @@ void sdcObjectInit(SDCDriver *sdcp) {
   sdcp->errors   = SDC_NO_ERROR;
   sdcp->config   = NULL;
   sdcp->capacity = 0;
+#if SDC_USE_ASYNC
+  sdcp->async    = SDC_ASYNC_NONE;
+  sdcp->result   = HAL_SUCCESS;
+  sdcp->callback = NULL;
+  sdcp->blocks   = 0;
+  sdcp->waiting  = NULL;
+  sdcp->sq_head  = 0;
+  sdcp->sq_count = 0;
+#endif
 }
 
 /**
@@ -567,6 +576,336 @@ failed:
   return HAL_FAILED;
 }
 
+#if SDC_USE_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Starts an asynchronous read of one or more blocks.
+ * @details The function returns as soon as the transfer has been started,
+ *          the completion is notified using the callback, if specified,
+ *          and can be awaited using @p sdcWaitCompletion().
+ * @pre     The driver must be in the @p BLK_READY state after a successful
+ *          sdcConnect() invocation.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ * @note    The callback is invoked from ISR context.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation started.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool sdcStartRead(SDCDriver *sdcp, uint32_t startblk,
+                  uint8_t *buf, uint32_t n, sdccallback_t callback) {
+
+  osalDbgCheck((sdcp != NULL) && (buf != NULL) && (n > 0));
+  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
+
+  if ((startblk + n - 1) > sdcp->capacity){
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return HAL_FAILED;
+  }
+
+  /* Read operation in progress, the completion is handled by the ISR.*/
+  sdcp->state    = BLK_READING;
+  sdcp->async    = SDC_ASYNC_TRANSFER;
+  sdcp->result   = HAL_SUCCESS;
+  sdcp->callback = callback;
+  sdcp->blocks   = n;
+
+  if (sdc_lld_start_read(sdcp, startblk, buf, n)) {
+    osalSysLock();
+    sdcp->async = SDC_ASYNC_NONE;
+    sdcp->state = BLK_READY;
+    osalSysUnlock();
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Starts an asynchronous write of one or more blocks.
+ * @details The function returns as soon as the transfer has been started,
+ *          the completion is notified using the callback, if specified,
+ *          and can be awaited using @p sdcWaitCompletion().
+ * @pre     The driver must be in the @p BLK_READY state after a successful
+ *          sdcConnect() invocation.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ * @note    The callback is invoked from ISR context.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation started.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool sdcStartWrite(SDCDriver *sdcp, uint32_t startblk,
+                   const uint8_t *buf, uint32_t n, sdccallback_t callback) {
+
+  osalDbgCheck((sdcp != NULL) && (buf != NULL) && (n > 0));
+  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
+
+  if ((startblk + n - 1) > sdcp->capacity){
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return HAL_FAILED;
+  }
+
+  /* Write operation in progress, the completion is handled by the ISR.*/
+  sdcp->state    = BLK_WRITING;
+  sdcp->async    = SDC_ASYNC_TRANSFER;
+  sdcp->result   = HAL_SUCCESS;
+  sdcp->callback = callback;
+  sdcp->blocks   = n;
+
+  if (sdc_lld_start_write(sdcp, startblk, buf, n)) {
+    osalSysLock();
+    sdcp->async = SDC_ASYNC_NONE;
+    sdcp->state = BLK_READY;
+    osalSysUnlock();
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for the end of an asynchronous transfer.
+ * @details If no transfer is in progress the result of the last one is
+ *          returned immediately.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @return              The transfer status.
+ * @retval HAL_SUCCESS  the transfer succeeded.
+ * @retval HAL_FAILED   the transfer failed.
+ *
+ * @api
+ */
+bool sdcWaitCompletion(SDCDriver *sdcp) {
+  bool result;
+
+  osalDbgCheck(sdcp != NULL);
+  osalDbgAssert(sdcp->async != SDC_ASYNC_STREAM, "stream active");
+
+  osalSysLock();
+  while (sdcp->async == SDC_ASYNC_TRANSFER)
+    osalThreadSuspendS(&sdcp->waiting);
+  result = sdcp->result;
+  osalSysUnlock();
+  return result;
+}
+
+/**
+ * @brief   Opens a write stream.
+ * @details A multiple blocks write is started at @p startblk, the data
+ *          is then supplied in buffers using @p sdcStreamWriteI() or
+ *          @p sdcStreamWriteTimeout(). While a buffer is transferred the
+ *          next one can be already queued so the card is kept busy without
+ *          gaps, the buffer can be refilled as soon as the callback reports
+ *          its release.
+ * @pre     The driver must be in the @p BLK_READY state after a successful
+ *          sdcConnect() invocation.
+ * @note    The callback is invoked from ISR context each time a buffer has
+ *          been transferred and is no more in use.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] callback  buffer release callback or @p NULL
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation started.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool sdcStartStream(SDCDriver *sdcp, uint32_t startblk,
+                    sdccallback_t callback) {
+
+  osalDbgCheck(sdcp != NULL);
+  osalDbgAssert(sdcp->state == BLK_READY, "invalid state");
+
+  if (startblk >= sdcp->capacity){
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return HAL_FAILED;
+  }
+
+  sdcp->state    = BLK_WRITING;
+  sdcp->result   = HAL_SUCCESS;
+  sdcp->callback = callback;
+  sdcp->blocks   = 0;
+  sdcp->sq_head  = 0;
+  sdcp->sq_count = 0;
+  sdcp->sq_next  = startblk;
+
+  if (sdc_lld_start_stream(sdcp, startblk)) {
+    sdcp->state = BLK_READY;
+    return HAL_FAILED;
+  }
+  sdcp->async    = SDC_ASYNC_STREAM;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Queues a buffer in the write stream.
+ * @details If the stream is idle the transfer is started immediately.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks in the buffer
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the buffer has been queued.
+ * @retval MSG_TIMEOUT  if the stream queue is full.
+ * @retval MSG_RESET    if the stream failed because a transfer error or
+ *                      the buffer would exceed the card capacity, the
+ *                      @p SDC_OVERFLOW_ERROR error is set in the latter case.
+ *
+ * @iclass
+ */
+msg_t sdcStreamWriteI(SDCDriver *sdcp, const uint8_t *buf, uint32_t n) {
+  uint32_t i;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((sdcp != NULL) && (buf != NULL) && (n > 0));
+  osalDbgAssert(sdcp->async == SDC_ASYNC_STREAM, "stream not active");
+
+  if (sdcp->result != HAL_SUCCESS)
+    return MSG_RESET;
+  if (n > sdcp->capacity - sdcp->sq_next) {
+    sdcp->errors |= SDC_OVERFLOW_ERROR;
+    return MSG_RESET;
+  }
+  if (sdcp->sq_count >= SDC_STREAM_BUFFERS)
+    return MSG_TIMEOUT;
+
+  i = (sdcp->sq_head + sdcp->sq_count) % SDC_STREAM_BUFFERS;
+  sdcp->sq_buf[i] = buf;
+  sdcp->sq_n[i]   = n;
+  sdcp->sq_next  += n;
+  if (sdcp->sq_count++ == 0)
+    sdc_lld_stream_data(sdcp, buf, n);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Queues a buffer in the write stream.
+ * @details If the stream queue is full the function waits for a buffer to
+ *          be released.
+ * @pre     The buffer must be aligned to a 32 bits boundary.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] buf       pointer to the write buffer
+ * @param[in] n         number of blocks in the buffer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the buffer has been queued.
+ * @retval MSG_TIMEOUT  if the stream queue is still full after the
+ *                      specified time.
+ * @retval MSG_RESET    if the stream failed because a transfer error or
+ *                      the buffer would exceed the card capacity.
+ *
+ * @api
+ */
+msg_t sdcStreamWriteTimeout(SDCDriver *sdcp, const uint8_t *buf,
+                            uint32_t n, systime_t timeout) {
+  msg_t msg;
+
+  osalSysLock();
+  while ((msg = sdcStreamWriteI(sdcp, buf, n)) == MSG_TIMEOUT) {
+    if (osalThreadSuspendTimeoutS(&sdcp->waiting, timeout) == MSG_TIMEOUT)
+      break;
+  }
+  osalSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Closes a write stream.
+ * @details The queued buffers are flushed then the multiple blocks write
+ *          is terminated.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @return              The stream status.
+ * @retval HAL_SUCCESS  all the data has been written.
+ * @retval HAL_FAILED   the stream failed.
+ *
+ * @api
+ */
+bool sdcStopStream(SDCDriver *sdcp) {
+  bool result;
+
+  osalDbgCheck(sdcp != NULL);
+  osalDbgAssert(sdcp->async == SDC_ASYNC_STREAM, "stream not active");
+
+  osalSysLock();
+  while ((sdcp->sq_count > 0) && (sdcp->result == HAL_SUCCESS))
+    osalThreadSuspendS(&sdcp->waiting);
+  sdcp->async = SDC_ASYNC_NONE;
+  osalSysUnlock();
+
+  /* The card is still in the receive state, the write is terminated and
+     the programming end awaited.*/
+  result = sdcp->result;
+  if (sdc_lld_stop_transmission(sdcp) ||
+      _sdc_wait_for_transfer_state(sdcp))
+    result = HAL_FAILED;
+
+  sdcp->state = BLK_READY;
+  return result;
+}
+
+/**
+ * @brief   Asynchronous transfer end handler.
+ * @details Invoked by the low level driver IRQ handler at the end of an
+ *          asynchronous transfer, multiple blocks transfers have already
+ *          been terminated with the stop command. The system must be
+ *          locked.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] result    transfer result from the low level driver
+ *
+ * @notapi
+ */
+void _sdc_isr_transfer_end(SDCDriver *sdcp, bool result) {
+
+  if (sdcp->async == SDC_ASYNC_TRANSFER) {
+    sdcp->result = result;
+    sdcp->async  = SDC_ASYNC_NONE;
+    sdcp->state  = BLK_READY;
+  }
+  else {
+    /* Stream, the head buffer is released and the next one, if already
+       queued, is started immediately.*/
+    if (result != HAL_SUCCESS)
+      sdcp->result = HAL_FAILED;
+    sdcp->sq_head = (sdcp->sq_head + 1) % SDC_STREAM_BUFFERS;
+    sdcp->sq_count--;
+    if ((sdcp->sq_count > 0) && (sdcp->result == HAL_SUCCESS))
+      sdc_lld_stream_data(sdcp, sdcp->sq_buf[sdcp->sq_head],
+                          sdcp->sq_n[sdcp->sq_head]);
+  }
+  if (sdcp->callback != NULL)
+    sdcp->callback(sdcp);
+  osalThreadResumeI(&sdcp->waiting, MSG_OK);
+}
+#endif /* SDC_USE_ASYNC */
+
 #endif /* HAL_USE_SDC */
 
 /** @} */
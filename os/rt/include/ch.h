@@ -83,15 +83,25 @@ typedef struct thread thread_t;
 #include "chsem.h"
 #include "chbsem.h"
 #include "chmtx.h"
+#include "chrwlock.h"
 #include "chcond.h"
 #include "chevents.h"
-#include "chmsg.h"
 #include "chmboxes.h"
+#include "chpmboxes.h"
+#include "chmsg.h"
 #include "chmemcore.h"
 #include "chheap.h"
 #include "chmempools.h"
+#include "chbuf.h"
+#include "chobjfifos.h"
 #include "chdynamic.h"
+#include "chthdpools.h"
+#include "chdpc.h"
+#include "chbtasks.h"
 #include "chqueues.h"
+#include "chrings.h"
+#include "chmwait.h"
+#include "chcoop.h"
 #include "chstreams.h"
 
 #endif /* _CH_H_ */
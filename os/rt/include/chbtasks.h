@@ -0,0 +1,172 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chbtasks.h
+ * @brief   Basic tasks macros and structures.
+ *
+ * @addtogroup basic_tasks
+ * @{
+ */
+
+#ifndef _CHBTASKS_H_
+#define _CHBTASKS_H_
+
+#if CH_CFG_USE_BASIC_TASKS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_WAITEXIT
+#error "CH_CFG_USE_BASIC_TASKS requires CH_CFG_USE_WAITEXIT"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Basic task function.
+ */
+typedef void (*btaskfunc_t)(void *arg);
+
+/**
+ * @brief   Type of a basic task.
+ */
+typedef struct btask btask_t;
+
+/**
+ * @brief   Basic tasks level statistics.
+ */
+typedef struct {
+  ucnt_t                activations;    /**< @brief Accepted activations.   */
+  ucnt_t                rejected;       /**< @brief Activations rejected
+                                                    because over the task
+                                                    limit.                  */
+#if CH_CFG_USE_TM || defined(__DOXYGEN__)
+  time_measurement_t    latency;        /**< @brief Time between the
+                                                    queuing of a task and
+                                                    its execution.          */
+#endif
+} btask_level_stats_t;
+
+/**
+ * @brief   Structure representing a basic tasks level.
+ * @details All the tasks of a level are executed by the same thread, on
+ *          the same stack, at the same priority.
+ */
+typedef struct {
+  btask_t               *bl_head;       /**< @brief First activated task.   */
+  btask_t               *bl_tail;       /**< @brief Last activated task.    */
+  thread_t              *bl_tp;         /**< @brief Level thread.           */
+  thread_reference_t    bl_thread;      /**< @brief Level thread while
+                                                    idle.                   */
+  btask_level_stats_t   bl_stats;       /**< @brief Level statistics.       */
+} btask_level_t;
+
+/**
+ * @brief   Structure representing a basic task.
+ */
+struct btask {
+  btask_t               *bt_next;       /**< @brief Next activated task.    */
+  btask_level_t         *bt_level;      /**< @brief Level of the task.      */
+  btaskfunc_t           bt_func;        /**< @brief Task function.          */
+  void                  *bt_arg;        /**< @brief Task function
+                                                    argument.               */
+  cnt_t                 bt_activations; /**< @brief Pending activations,
+                                                    including the running
+                                                    one.                    */
+  cnt_t                 bt_maxact;      /**< @brief Maximum pending
+                                                    activations.            */
+#if CH_CFG_USE_TM || defined(__DOXYGEN__)
+  rtcnt_t               bt_time;        /**< @brief Queuing time.           */
+#endif
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the level statistics.
+ *
+ * @param[in] blp       pointer to a @p btask_level_t structure
+ * @return              Pointer to the @p btask_level_stats_t structure.
+ *
+ * @xclass
+ */
+#define chBTaskLevelGetStatisticsX(blp) (&(blp)->bl_stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chBTaskLevelObjectInit(btask_level_t *blp);
+  void chBTaskLevelStart(btask_level_t *blp, void *wsp, size_t size,
+                         tprio_t prio);
+  void chBTaskLevelStop(btask_level_t *blp);
+  void chBTaskLevelResetStatistics(btask_level_t *blp);
+  void chBTaskObjectInit(btask_t *btp, btask_level_t *blp,
+                         btaskfunc_t func, void *arg, cnt_t maxact);
+  bool chBTaskActivateI(btask_t *btp);
+  bool chBTaskActivate(btask_t *btp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of pending activations of a basic task.
+ * @note    The returned value includes the activation being executed,
+ *          if any.
+ *
+ * @param[in] btp       pointer to a @p btask_t structure
+ * @return              The number of pending activations.
+ *
+ * @iclass
+ */
+static inline cnt_t chBTaskGetActivationsI(btask_t *btp) {
+
+  chDbgCheckClassI();
+
+  return btp->bt_activations;
+}
+
+#endif /* CH_CFG_USE_BASIC_TASKS */
+
+#endif /* _CHBTASKS_H_ */
+
+/** @} */
@@ -0,0 +1,223 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chbuf.h
+ * @brief   Packet Buffers macros and structures.
+ *
+ * @addtogroup buffers
+ * @{
+ */
+
+#ifndef _CHBUF_H_
+#define _CHBUF_H_
+
+#if CH_CFG_USE_BUFFERS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_MEMPOOLS
+#error "CH_CFG_USE_BUFFERS requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a packet buffer.
+ */
+typedef struct ch_buffer buffer_t;
+
+/**
+ * @brief   Structure representing a packet buffer.
+ * @details The buffer header is followed by the data storage in the same
+ *          memory pool object. A buffer can also refer to the storage of
+ *          another buffer, in this case it holds a reference to it.
+ */
+struct ch_buffer {
+  buffer_t              *b_next;        /**< @brief Next buffer in the
+                                                    chain or @p NULL.       */
+  memory_pool_t         *b_pool;        /**< @brief Owner pool.             */
+  buffer_t              *b_owner;       /**< @brief Buffer owning the
+                                                    referred storage or
+                                                    @p NULL.                */
+  uint8_t               *b_base;        /**< @brief Usable storage area.    */
+  uint8_t               *b_data;        /**< @brief Start of the data.      */
+  size_t                b_capacity;     /**< @brief Usable storage size.    */
+  size_t                b_size;         /**< @brief Data size.              */
+  cnt_t                 b_refs;         /**< @brief References counter.     */
+  cnt_t                 b_shares;       /**< @brief Number of buffers
+                                                    referring to this
+                                                    buffer storage.         */
+};
+
+/**
+ * @brief   Buffers allocator descriptor.
+ * @details The allocator draws buffers from a set of memory pools, each
+ *          pool represents a size class.
+ */
+typedef struct {
+  memory_pool_t         *ba_pools;      /**< @brief Array of pools ordered
+                                                    by increasing object
+                                                    size.                   */
+  unsigned              ba_n;           /**< @brief Number of pools.        */
+} buffers_allocator_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of a memory pool object able to hold @p n data bytes.
+ *
+ * @param[in] n         size of the buffer data storage
+ */
+#define CH_BUFFER_OBJECT_SIZE(n) (sizeof(buffer_t) + (n))
+
+/**
+ * @brief   Data part of a static buffers allocator initializer.
+ *
+ * @param[in] name      the name of the allocator variable
+ * @param[in] pools     array of size classes pools
+ * @param[in] n         number of pools in the array
+ */
+#define _BUFFERS_ALLOCATOR_DATA(name, pools, n) {pools, n}
+
+/**
+ * @brief   Static buffers allocator initializer.
+ *
+ * @param[in] name      the name of the allocator variable
+ * @param[in] pools     array of size classes pools
+ * @param[in] n         number of pools in the array
+ */
+#define BUFFERS_ALLOCATOR_DECL(name, pools, n)                              \
+  buffers_allocator_t name = _BUFFERS_ALLOCATOR_DATA(name, pools, n)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chBufAllocatorObjectInit(buffers_allocator_t *bap,
+                                memory_pool_t *pools, unsigned n);
+  buffer_t *chBufAllocI(buffers_allocator_t *bap, size_t size,
+                        size_t headroom);
+  buffer_t *chBufAlloc(buffers_allocator_t *bap, size_t size,
+                       size_t headroom);
+  void chBufReleaseI(buffer_t *bp);
+  void chBufRelease(buffer_t *bp);
+  uint8_t *chBufPushHeader(buffer_t *bp, size_t n);
+  uint8_t *chBufPullHeader(buffer_t *bp, size_t n);
+  uint8_t *chBufPutTail(buffer_t *bp, size_t n);
+  size_t chBufLength(buffer_t *bp);
+  void chBufCat(buffer_t *head, buffer_t *tail);
+  void chBufTrim(buffer_t *bp, size_t length);
+  buffer_t *chBufSplit(buffers_allocator_t *bap, buffer_t *bp, size_t offset);
+  size_t chBufCopyOut(buffer_t *bp, size_t offset, uint8_t *dp, size_t n);
+  buffer_t *chBufLinearize(buffers_allocator_t *bap, buffer_t *bp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Adds a reference to a buffer chain.
+ * @note    Only the first buffer of the chain gets the reference, the
+ *          following buffers are implicitly referenced by it.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @return              The buffer pointer.
+ *
+ * @iclass
+ */
+static inline buffer_t *chBufAddRefI(buffer_t *bp) {
+
+  chDbgCheckClassI();
+
+  bp->b_refs++;
+  return bp;
+}
+
+/**
+ * @brief   Adds a reference to a buffer chain.
+ * @note    Only the first buffer of the chain gets the reference, the
+ *          following buffers are implicitly referenced by it.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @return              The buffer pointer.
+ *
+ * @api
+ */
+static inline buffer_t *chBufAddRef(buffer_t *bp) {
+
+  chSysLock();
+  (void) chBufAddRefI(bp);
+  chSysUnlock();
+  return bp;
+}
+
+/**
+ * @brief   Returns the space available in front of the buffer data.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              The headroom size.
+ *
+ * @xclass
+ */
+static inline size_t chBufGetHeadroomX(buffer_t *bp) {
+
+  return (size_t)(bp->b_data - bp->b_base);
+}
+
+/**
+ * @brief   Returns the space available after the buffer data.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @return              The tailroom size.
+ *
+ * @xclass
+ */
+static inline size_t chBufGetTailroomX(buffer_t *bp) {
+
+  return bp->b_capacity - chBufGetHeadroomX(bp) - bp->b_size;
+}
+
+#endif /* CH_CFG_USE_BUFFERS */
+
+#endif /* _CHBUF_H_ */
+
+/** @} */
@@ -60,6 +60,10 @@
 typedef struct condition_variable {
   threads_queue_t       c_queue;            /**< @brief Condition variable
                                                  threads queue.             */
+  mutex_t               *c_mutex;           /**< @brief Mutex used by the
+                                                 waiting threads or
+                                                 @p NULL if they use
+                                                 different mutexes.         */
 } condition_variable_t;
 
 /*===========================================================================*/
@@ -73,7 +77,7 @@ typedef struct condition_variable {
  *
  * @param[in] name      the name of the condition variable
  */
-#define _CONDVAR_DATA(name) {_threads_queue_t_DATA(name.c_queue)}
+#define _CONDVAR_DATA(name) {_threads_queue_t_DATA(name.c_queue), NULL}
 
 /**
  * @brief Static condition variable initializer.
@@ -110,6 +114,78 @@ extern "C" {
 /* Module inline functions.                                                  */
 /*===========================================================================*/
 
+#if CH_CFG_USE_CONDVARS_TIMEOUT || defined(__DOXYGEN__)
+/**
+ * @brief   Waits on the condition variable releasing the mutex lock.
+ * @details Releases the currently owned mutex, waits on the condition
+ *          variable until the deadline, and finally acquires the mutex
+ *          again. All the sequence is performed atomically.
+ * @pre     The invoking thread <b>must</b> have at least one owned mutex.
+ * @post    Exiting the function because a timeout does not re-acquire the
+ *          mutex, the mutex ownership is lost. This is true also when the
+ *          deadline has already passed on entry.
+ *
+ * @param[in] cp        pointer to the @p condition_variable_t structure
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the condition variable.
+ * @retval MSG_OK       if the condition variable has been signaled using
+ *                      @p chCondSignal().
+ * @retval MSG_RESET    if the condition variable has been signaled using
+ *                      @p chCondBroadcast().
+ * @retval MSG_TIMEOUT  if the condition variable has not been signaled within
+ *                      the specified deadline.
+ *
+ * @sclass
+ */
+static inline msg_t chCondWaitUntilS(condition_variable_t *cp,
+                                     systime_t deadline) {
+  systime_t time = chVTTimeUntilX(deadline);
+
+  if (TIME_IMMEDIATE == time) {
+    chMtxUnlockS(chMtxGetNextMutexS());
+    chSchRescheduleS();
+    return MSG_TIMEOUT;
+  }
+  return chCondWaitTimeoutS(cp, time);
+}
+
+/**
+ * @brief   Waits on the condition variable releasing the mutex lock.
+ * @details Releases the currently owned mutex, waits on the condition
+ *          variable until the deadline, and finally acquires the mutex
+ *          again. All the sequence is performed atomically.
+ * @pre     The invoking thread <b>must</b> have at least one owned mutex.
+ * @post    Exiting the function because a timeout does not re-acquire the
+ *          mutex, the mutex ownership is lost. This is true also when the
+ *          deadline has already passed on entry.
+ *
+ * @param[in] cp        pointer to the @p condition_variable_t structure
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the condition variable.
+ * @retval MSG_OK       if the condition variable has been signaled using
+ *                      @p chCondSignal().
+ * @retval MSG_RESET    if the condition variable has been signaled using
+ *                      @p chCondBroadcast().
+ * @retval MSG_TIMEOUT  if the condition variable has not been signaled within
+ *                      the specified deadline.
+ *
+ * @api
+ */
+static inline msg_t chCondWaitUntil(condition_variable_t *cp,
+                                    systime_t deadline) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chCondWaitUntilS(cp, deadline);
+  chSysUnlock();
+  return msg;
+}
+#endif /* CH_CFG_USE_CONDVARS_TIMEOUT */
+
 #endif /* CH_CFG_USE_CONDVARS */
 
 #endif /* _CHCOND_H_ */
@@ -0,0 +1,320 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chcoop.h
+ * @brief   Cooperative tasks macros and structures.
+ *
+ * @addtogroup coop_tasks
+ * @{
+ */
+
+#ifndef _CHCOOP_H_
+#define _CHCOOP_H_
+
+#if CH_CFG_USE_COOP || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Task states
+ * @{
+ */
+#define COOP_STATE_READY        0   /**< @brief Ready to be executed.       */
+#define COOP_STATE_WAITING      1   /**< @brief Waiting on an object or
+                                         for a timeout.                     */
+#define COOP_STATE_FINAL        2   /**< @brief Terminated.                 */
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_WAITMULTIPLE
+#error "CH_CFG_USE_COOP requires CH_CFG_USE_WAITMULTIPLE"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a cooperative task.
+ */
+typedef struct coop_task coop_task_t;
+
+/**
+ * @brief   Cooperative task function.
+ * @details The function is invoked each time the task is resumed, its body
+ *          must be enclosed between @p COOP_BEGIN() and @p COOP_END().
+ */
+typedef void (*coopfunc_t)(coop_task_t *ctp);
+
+/**
+ * @brief   Structure representing a cooperative task.
+ */
+struct coop_task {
+  coop_task_t           *ct_next;       /**< @brief Next task.              */
+  coopfunc_t            ct_func;        /**< @brief Task function.          */
+  void                  *ct_arg;        /**< @brief Task function
+                                                    argument.               */
+  unsigned              ct_line;        /**< @brief Resume point, zero
+                                                    before the first
+                                                    execution.              */
+  uint8_t               ct_state;       /**< @brief Task state.             */
+  bool                  ct_timed;       /**< @brief The wait has a
+                                                    deadline.               */
+  systime_t             ct_deadline;    /**< @brief Wait deadline.          */
+  wait_object_t         ct_wobj;        /**< @brief Object the task is
+                                                    waiting on.             */
+  msg_t                 ct_msg;         /**< @brief Last wait result.       */
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  event_source_t        *ct_esp;        /**< @brief Event source the
+                                                    listener is registered
+                                                    on or @p NULL.          */
+  event_listener_t      ct_listener;    /**< @brief Listener latching the
+                                                    broadcast flags.        */
+#endif
+};
+
+/**
+ * @brief   Structure representing a cooperative tasks scheduler.
+ */
+typedef struct {
+  coop_task_t           *cs_tasks;      /**< @brief Tasks list.             */
+  cnt_t                 cs_ntasks;      /**< @brief Number of tasks.        */
+  cnt_t                 cs_size;        /**< @brief Maximum number of
+                                                    tasks.                  */
+  wait_object_t         *cs_wait;       /**< @brief Objects the tasks are
+                                                    waiting on.             */
+  coop_task_t           **cs_waiting;   /**< @brief Tasks waiting on the
+                                                    objects.                */
+} coop_scheduler_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    Task body macros
+ * @details A task function is re-entered from the beginning each time the
+ *          task is resumed, execution continues after the statement that
+ *          suspended it.
+ * @note    Local variables are not preserved across the suspension points,
+ *          the task state must be kept in the structure pointed by the
+ *          task argument.
+ * @note    The suspension macros cannot be used inside a @p switch
+ *          statement in the task body.
+ * @{
+ */
+/**
+ * @brief   Marks the beginning of a task body.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ */
+#define COOP_BEGIN(ctp) switch ((ctp)->ct_line) { case 0:
+
+/**
+ * @brief   Marks the end of a task body.
+ * @details Reaching the end terminates the task.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ */
+#define COOP_END(ctp)                                                       \
+  } (ctp)->ct_state = COOP_STATE_FINAL
+
+/**
+ * @brief   Terminates the task.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ */
+#define COOP_EXIT(ctp) do {                                                 \
+  (ctp)->ct_state = COOP_STATE_FINAL;                                       \
+  return;                                                                   \
+} while (false)
+
+/**
+ * @brief   Suspends the task until the next scheduler round.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ */
+#define COOP_YIELD(ctp) do {                                                \
+  (ctp)->ct_line = __LINE__;                                                \
+  return;                                                                   \
+  case __LINE__:;                                                           \
+} while (false)
+
+/**
+ * @brief   Suspends the task on a wait object.
+ * @details The wait result is stored in the @p ct_msg field of the task.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] type      the wait object type
+ * @param[in] objp      pointer to the object or @p NULL
+ * @param[in] msg       the data to be exchanged with the object
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define COOP_WAIT(ctp, type, objp, msg, time) do {                          \
+  _coop_wait(ctp, type, (void *)(objp), (msg_t)(msg), time);                \
+  (ctp)->ct_line = __LINE__;                                                \
+  return;                                                                   \
+  case __LINE__:;                                                           \
+} while (false)
+
+/**
+ * @brief   Suspends the task for the specified time.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] time      the number of ticks, @p TIME_INFINITE is not allowed
+ */
+#define COOP_SLEEP(ctp, time)                                               \
+  COOP_WAIT(ctp, MWAIT_SEMAPHORE, NULL, 0, time)
+
+/**
+ * @brief   Waits on a counting semaphore.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define COOP_WAIT_SEMAPHORE(ctp, sp, time)                                  \
+  COOP_WAIT(ctp, MWAIT_SEMAPHORE, sp, 0, time)
+
+/**
+ * @brief   Fetches a message from a mailbox.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT, the message is
+ *          returned by @p chCoopGetDataX().
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] mbp       pointer to a @p mailbox_t structure
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define COOP_FETCH_MAILBOX(ctp, mbp, time)                                  \
+  COOP_WAIT(ctp, MWAIT_MAILBOX, mbp, 0, time)
+
+/**
+ * @brief   Reads a byte from an input queue.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT, the byte is
+ *          returned by @p chCoopGetDataX().
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define COOP_GET_QUEUE(ctp, iqp, time)                                      \
+  COOP_WAIT(ctp, MWAIT_INPUT_QUEUE, iqp, 0, time)
+
+/**
+ * @brief   Writes a byte into an output queue.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] oqp       pointer to an @p output_queue_t structure
+ * @param[in] b         the byte to be written
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define COOP_PUT_QUEUE(ctp, oqp, b, time)                                   \
+  COOP_WAIT(ctp, MWAIT_OUTPUT_QUEUE, oqp, b, time)
+
+/**
+ * @brief   Waits for an event source broadcast.
+ * @details The result is @p MSG_OK or @p MSG_TIMEOUT, the broadcast flags
+ *          are returned by @p chCoopGetDataX().
+ * @note    The first wait registers a listener of the task on the source,
+ *          broadcasts are latched from then on, also while the task is
+ *          not waiting, and are returned by the next wait. The listener
+ *          is unregistered when the task waits on another source or
+ *          terminates.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] esp       pointer to an @p event_source_t structure
+ * @param[in] time      the number of ticks before the operation timeouts
+ */
+#define COOP_WAIT_EVENT(ctp, esp, time)                                     \
+  COOP_WAIT(ctp, MWAIT_EVENT_SOURCE, esp, 0, time)
+/** @} */
+
+/**
+ * @brief   Returns the result of the last wait.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @return              The wait result.
+ * @retval MSG_OK       if the object has been acquired.
+ * @retval MSG_TIMEOUT  if the wait timed out.
+ *
+ * @xclass
+ */
+#define chCoopGetResultX(ctp) ((ctp)->ct_msg)
+
+/**
+ * @brief   Returns the data exchanged with the object of the last wait.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @return              The exchanged data.
+ *
+ * @xclass
+ */
+#define chCoopGetDataX(ctp) ((ctp)->ct_wobj.wo_msg)
+
+/**
+ * @brief   Returns the task function argument.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @return              The task function argument.
+ *
+ * @xclass
+ */
+#define chCoopGetArgX(ctp) ((ctp)->ct_arg)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _coop_wait(coop_task_t *ctp, uint8_t type, void *objp,
+                  msg_t msg, systime_t time);
+  void chCoopObjectInit(coop_scheduler_t *csp, wait_object_t *wop,
+                        coop_task_t **tpp, cnt_t n);
+  void chCoopTaskStart(coop_scheduler_t *csp, coop_task_t *ctp,
+                       coopfunc_t func, void *arg);
+  void chCoopRun(coop_scheduler_t *csp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* CH_CFG_USE_COOP */
+
+#endif /* _CHCOOP_H_ */
+
+/** @} */
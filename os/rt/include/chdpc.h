@@ -0,0 +1,183 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chdpc.h
+ * @brief   Deferred procedure calls macros and structures.
+ *
+ * @addtogroup dpc
+ * @{
+ */
+
+#ifndef _CHDPC_H_
+#define _CHDPC_H_
+
+#if CH_CFG_USE_DPC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (CH_CFG_DPC_PRIORITY <= NORMALPRIO) || (CH_CFG_DPC_PRIORITY > HIGHPRIO)
+#error "invalid CH_CFG_DPC_PRIORITY value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Deferred procedure function.
+ */
+typedef void (*dpcfunc_t)(void *arg);
+
+/**
+ * @brief   Type of a deferred procedure call object.
+ */
+typedef struct dpc dpc_t;
+
+/**
+ * @brief   Structure representing a deferred procedure call.
+ */
+struct dpc {
+  dpc_t                 *d_next;        /**< @brief Next pending DPC.       */
+  dpcfunc_t             d_func;         /**< @brief DPC function.           */
+  void                  *d_arg;         /**< @brief DPC function argument.  */
+  bool                  d_pending;      /**< @brief DPC queued and not yet
+                                                    dispatched.             */
+#if CH_CFG_USE_TM || defined(__DOXYGEN__)
+  rtcnt_t               d_time;         /**< @brief Time of the first
+                                                    queuing.                */
+#endif
+};
+
+/**
+ * @brief   Deferred procedure calls statistics.
+ */
+typedef struct {
+  ucnt_t                queued;         /**< @brief DPCs queued.            */
+  ucnt_t                coalesced;      /**< @brief DPCs queued again while
+                                                    still pending.          */
+#if CH_CFG_USE_TM || defined(__DOXYGEN__)
+  time_measurement_t    latency;        /**< @brief Time between the first
+                                                    queuing and the
+                                                    dispatch.               */
+#endif
+} dpc_stats_t;
+
+/**
+ * @brief   Deferred procedure calls queue.
+ */
+typedef struct {
+  dpc_t                 *dq_head;       /**< @brief First pending DPC.      */
+  dpc_t                 *dq_tail;       /**< @brief Last pending DPC.       */
+  thread_reference_t    dq_thread;      /**< @brief Dispatcher thread while
+                                                    idle.                   */
+  dpc_stats_t           dq_stats;       /**< @brief DPCs statistics.        */
+} dpc_queue_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static DPC initializer.
+ * @details This macro should be used when statically initializing a
+ *          DPC that is part of a bigger structure.
+ *
+ * @param[in] func      the DPC function
+ * @param[in] arg       the DPC function argument
+ */
+#define _DPC_DATA(func, arg) {NULL, (func), (arg), false}
+
+/**
+ * @brief   Static DPC initializer.
+ * @details Statically initialized DPCs require no explicit
+ *          initialization using @p chDpcObjectInit().
+ *
+ * @param[in] name      the name of the DPC variable
+ * @param[in] func      the DPC function
+ * @param[in] arg       the DPC function argument
+ */
+#define DPC_DECL(name, func, arg) dpc_t name = _DPC_DATA(func, arg)
+
+/**
+ * @brief   Returns a pointer to the DPCs statistics.
+ *
+ * @return              Pointer to the @p dpc_stats_t structure.
+ *
+ * @xclass
+ */
+#define chDpcGetStatisticsX() (&ch_dpc.dq_stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if !defined(__DOXYGEN__)
+extern dpc_queue_t ch_dpc;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _dpc_init(void);
+  void chDpcObjectInit(dpc_t *dp, dpcfunc_t func, void *arg);
+  bool chDpcQueueI(dpc_t *dp);
+  bool chDpcQueue(dpc_t *dp);
+  bool chDpcCancelI(dpc_t *dp);
+  void chDpcResetStatistics(void);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns @p true if the DPC is queued and not yet dispatched.
+ *
+ * @param[in] dp        pointer to a @p dpc_t structure
+ * @return              The DPC state.
+ *
+ * @iclass
+ */
+static inline bool chDpcIsPendingI(dpc_t *dp) {
+
+  chDbgCheckClassI();
+
+  return dp->d_pending;
+}
+
+#endif /* CH_CFG_USE_DPC */
+
+#endif /* _CHDPC_H_ */
+
+/** @} */
@@ -53,18 +53,72 @@
 #error "CH_CFG_USE_DYNAMIC requires CH_CFG_USE_HEAP and/or CH_CFG_USE_MEMPOOLS"
 #endif
 
+#if CH_CFG_DYNAMIC_CACHE_SIZE < 0
+#error "invalid CH_CFG_DYNAMIC_CACHE_SIZE value"
+#endif
+
+/**
+ * @brief   Working areas cache enable switch.
+ */
+#define CH_DYNAMIC_USE_CACHE                                                \
+  (CH_CFG_USE_HEAP && (CH_CFG_DYNAMIC_CACHE_SIZE > 0))
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Working areas cache statistics.
+ */
+typedef struct {
+  ucnt_t                hits;           /**< @brief Threads created using a
+                                                    cached working area.    */
+  ucnt_t                misses;         /**< @brief Threads created
+                                                    allocating from the
+                                                    heap.                   */
+  ucnt_t                stored;         /**< @brief Working areas cached
+                                                    on release.             */
+  ucnt_t                discarded;      /**< @brief Working areas freed on
+                                                    release because the
+                                                    cache was full.         */
+} thread_cache_stats_t;
+
+/**
+ * @brief   Terminated threads working areas cache.
+ */
+typedef struct {
+  struct thread_cache_entry *tc_head;   /**< @brief Cached working areas,
+                                                    most recent first.      */
+  cnt_t                 tc_count;       /**< @brief Number of cached
+                                                    working areas.          */
+  thread_cache_stats_t  tc_stats;       /**< @brief Cache statistics.       */
+} thread_cache_t;
+#endif /* CH_DYNAMIC_USE_CACHE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the working areas cache statistics.
+ *
+ * @return              Pointer to the @p thread_cache_stats_t structure.
+ *
+ * @xclass
+ */
+#define chThdCacheGetStatisticsX() (&ch_thdcache.tc_stats)
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
 
+#if CH_DYNAMIC_USE_CACHE && !defined(__DOXYGEN__)
+extern thread_cache_t ch_thdcache;
+#endif
+
 /*
  * Dynamic threads APIs.
  */
@@ -77,6 +131,11 @@ extern "C" {
   thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
                                 tprio_t prio, tfunc_t pf, void *arg);
 #endif
+#if CH_DYNAMIC_USE_CACHE
+  void _thd_cache_init(void);
+  void chThdCacheFlush(void);
+  void chThdCacheResetStatistics(void);
+#endif
 #if CH_CFG_USE_MEMPOOLS
   thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, tprio_t prio,
                                       tfunc_t pf, void *arg);
@@ -32,6 +32,14 @@
 #ifndef _CHEVENTS_H_
 #define _CHEVENTS_H_
 
+/*
+ * Module dependencies check, done outside the module guard because the
+ * callbacks option is meaningless without events.
+ */
+#if CH_CFG_USE_EVENTS_CALLBACKS && !CH_CFG_USE_EVENTS
+#error "CH_CFG_USE_EVENTS_CALLBACKS requires CH_CFG_USE_EVENTS"
+#endif
+
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
 
 /*===========================================================================*/
@@ -46,12 +54,23 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_CFG_USE_EVENTS_CALLBACKS && (CH_CFG_EVENTS_CALLBACKS_MAX < 1)
+#error "invalid CH_CFG_EVENTS_CALLBACKS_MAX value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
 typedef struct event_listener event_listener_t;
 
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+/**
+ * @brief   Event listener callback function.
+ */
+typedef void (*evcallback_t)(void *p, eventflags_t flags);
+#endif
+
 /**
  * @brief   Event Listener structure.
  */
@@ -64,6 +83,12 @@ struct event_listener {
   eventmask_t           el_mask;        /**< @brief Event identifiers mask. */
   eventflags_t          el_flags;       /**< @brief Flags added to the listener
                                                     by the event source.*/
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+  evcallback_t          el_callback;    /**< @brief Callback function or
+                                                    @p NULL for thread
+                                                    listeners.              */
+  void                  *el_param;      /**< @brief Callback parameter.     */
+#endif
 };
 
 /**
@@ -73,6 +98,12 @@ typedef struct event_source {
   event_listener_t      *es_next;       /**< @brief First Event Listener
                                                     registered on the Event
                                                     Source.                 */
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+  unsigned              es_cbnext;      /**< @brief Position of the callback
+                                                    listener to be served
+                                                    first by the next
+                                                    broadcast.              */
+#endif
 } event_source_t;
 
 /**
@@ -100,7 +131,11 @@ typedef void (*evhandler_t)(eventid_t);
  *          source that is part of a bigger structure.
  * @param name the name of the event source variable
  */
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+#define _EVENTSOURCE_DATA(name) {(void *)(&name), 0}
+#else
 #define _EVENTSOURCE_DATA(name) {(void *)(&name)}
+#endif
 
 /**
  * @brief   Static event source initializer.
@@ -122,6 +157,12 @@ extern "C" {
                          event_listener_t *elp,
                          eventmask_t mask);
   void chEvtUnregister(event_source_t *esp, event_listener_t *elp);
+#if CH_CFG_USE_EVENTS_CALLBACKS
+  void chEvtRegisterCallback(event_source_t *esp,
+                             event_listener_t *elp,
+                             evcallback_t callback,
+                             void *p);
+#endif
   eventmask_t chEvtGetAndClearEvents(eventmask_t mask);
   eventmask_t chEvtAddEvents(eventmask_t mask);
   eventflags_t chEvtGetAndClearFlags(event_listener_t *elp);
@@ -140,6 +181,9 @@ extern "C" {
   eventmask_t chEvtWaitOneTimeout(eventmask_t mask, systime_t time);
   eventmask_t chEvtWaitAnyTimeout(eventmask_t mask, systime_t time);
   eventmask_t chEvtWaitAllTimeout(eventmask_t mask, systime_t time);
+  eventmask_t chEvtWaitOneUntil(eventmask_t mask, systime_t deadline);
+  eventmask_t chEvtWaitAnyUntil(eventmask_t mask, systime_t deadline);
+  eventmask_t chEvtWaitAllUntil(eventmask_t mask, systime_t deadline);
 #endif
 #ifdef __cplusplus
 }
@@ -167,6 +211,9 @@ extern "C" {
 static inline void chEvtObjectInit(event_source_t *esp) {
 
   esp->es_next = (event_listener_t *)(void *)esp;
+#if CH_CFG_USE_EVENTS_CALLBACKS
+  esp->es_cbnext = 0;
+#endif
 }
 
 /**
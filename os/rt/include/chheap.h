@@ -104,6 +104,7 @@ extern "C" {
   void *chHeapAlloc(memory_heap_t *heapp, size_t size);
   void chHeapFree(void *p);
   size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep);
+  memory_heap_t *chHeapGetOwnerX(void *p);
 #ifdef __cplusplus
 }
 #endif
@@ -112,6 +113,22 @@ extern "C" {
 /* Module inline functions.                                                  */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the size of an allocated memory block.
+ * @note    The returned value is the requested size aligned to the heap
+ *          alignment, it can be bigger when the heap did not split a free
+ *          block because the remaining fragment would have been too small.
+ *
+ * @param[in] p         pointer to the memory block
+ * @return              The size of the block.
+ *
+ * @xclass
+ */
+static inline size_t chHeapGetSize(void *p) {
+
+  return ((union heap_header *)p - 1)->h.size;
+}
+
 #endif /* CH_CFG_USE_HEAP */
 
 #endif /* _CHHEAP_H_ */
@@ -119,6 +119,14 @@ extern "C" {
   msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
   msg_t chMBFetchS(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
   msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp);
+  cnt_t chMBPostN(mailbox_t *mbp, const msg_t *msgp, cnt_t n,
+                  systime_t timeout);
+  cnt_t chMBPostNS(mailbox_t *mbp, const msg_t *msgp, cnt_t n,
+                   systime_t timeout);
+  cnt_t chMBPostNI(mailbox_t *mbp, const msg_t *msgp, cnt_t n);
+  cnt_t chMBFetchN(mailbox_t *mbp, msg_t *msgp, cnt_t n, systime_t timeout);
+  cnt_t chMBFetchNS(mailbox_t *mbp, msg_t *msgp, cnt_t n, systime_t timeout);
+  cnt_t chMBFetchNI(mailbox_t *mbp, msg_t *msgp, cnt_t n);
 #ifdef __cplusplus
 }
 #endif
@@ -193,6 +201,106 @@ static inline cnt_t chMBPeekI(mailbox_t *mbp) {
   return *mbp->mb_rdptr;
 }
 
+/**
+ * @brief   Posts a message into a mailbox with a deadline.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the deadline is reached.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+static inline msg_t chMBPostUntilS(mailbox_t *mbp, msg_t msg,
+                                   systime_t deadline) {
+
+  return chMBPostS(mbp, msg, chVTTimeUntilX(deadline));
+}
+
+/**
+ * @brief   Posts a message into a mailbox with a deadline.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the deadline is reached.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+static inline msg_t chMBPostUntil(mailbox_t *mbp, msg_t msg,
+                                  systime_t deadline) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chMBPostUntilS(mbp, msg, deadline);
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox with a deadline.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the deadline is reached.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+static inline msg_t chMBFetchUntilS(mailbox_t *mbp, msg_t *msgp,
+                                    systime_t deadline) {
+
+  return chMBFetchS(mbp, msgp, chVTTimeUntilX(deadline));
+}
+
+/**
+ * @brief   Retrieves a message from a mailbox with a deadline.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the deadline is reached.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+static inline msg_t chMBFetchUntil(mailbox_t *mbp, msg_t *msgp,
+                                   systime_t deadline) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chMBFetchUntilS(mbp, msgp, deadline);
+  chSysUnlock();
+  return rdymsg;
+}
+
 #endif /* CH_CFG_USE_MAILBOXES */
 
 #endif /* _CHMBOXES_H_ */
@@ -43,10 +43,55 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_CFG_USE_MESSAGES_ASYNC && !CH_CFG_USE_MAILBOXES
+#error "CH_CFG_USE_MESSAGES_ASYNC requires CH_CFG_USE_MAILBOXES"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+#if CH_CFG_USE_MESSAGES_ASYNC || defined(__DOXYGEN__)
+/**
+ * @extends threads_queue_t
+ *
+ * @brief   Structure representing an asynchronous message request.
+ * @details The request is queued in the server messages queue in place of
+ *          a sending thread, the first fields are shared with the
+ *          @p thread_t structure so the server can tell requests and
+ *          threads apart using the state field.
+ */
+typedef struct {
+  threads_queue_t       r_queue;    /**< @brief Messages queue links.       */
+  tprio_t               r_prio;     /**< @brief Sender priority, this field
+                                         must be at the same position of the
+                                         thread_t field.                    */
+  struct context        r_ctx;      /**< @brief Not used, present because
+                                         offsets.                           */
+#if CH_CFG_USE_REGISTRY || defined(__DOXYGEN__)
+  thread_t              *r_newer;   /**< @brief Not used, present because
+                                         offsets.                           */
+  thread_t              *r_older;   /**< @brief Not used, present because
+                                         offsets.                           */
+  const char            *r_name;    /**< @brief Not used, present because
+                                         offsets.                           */
+#endif
+#if CH_DBG_ENABLE_STACK_CHECK || defined(__DOXYGEN__)
+  /**
+   * @brief Not used, present because offsets.
+   */
+  stkalign_t            *r_stklimit;
+#endif
+  tstate_t              r_state;    /**< @brief @p CH_STATE_MSGREQ while
+                                         pending, then @p CH_STATE_FINAL.   */
+  /* End of the fields shared with the thread_t structure.*/
+  msg_t                 r_msg;      /**< @brief The message, replaced by
+                                         the answer.                        */
+  mailbox_t             *r_mbp;     /**< @brief Answers mailbox or
+                                         @p NULL.                           */
+} msg_request_t;
+#endif /* CH_CFG_USE_MESSAGES_ASYNC */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -61,6 +106,11 @@ extern "C" {
   msg_t chMsgSend(thread_t *tp, msg_t msg);
   thread_t * chMsgWait(void);
   void chMsgRelease(thread_t *tp, msg_t msg);
+#if CH_CFG_USE_MESSAGES_ASYNC
+  void chMsgSendAsync(thread_t *tp, msg_request_t *rp, msg_t msg,
+                      mailbox_t *mbp);
+  void _msg_request_done_i(msg_request_t *rp, msg_t msg);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -93,6 +143,10 @@ static inline bool chMsgIsPendingI(thread_t *tp) {
  */
 static inline msg_t chMsgGet(thread_t *tp) {
 
+#if CH_CFG_USE_MESSAGES_ASYNC
+  if (tp->p_state == CH_STATE_MSGREQ)
+    return ((msg_request_t *)tp)->r_msg;
+#endif
   return tp->p_msg;
 }
 
@@ -110,9 +164,46 @@ static inline void chMsgReleaseS(thread_t *tp, msg_t msg) {
 
   chDbgCheckClassS();
 
+#if CH_CFG_USE_MESSAGES_ASYNC
+  if (tp->p_state == CH_STATE_MSGREQ) {
+    _msg_request_done_i((msg_request_t *)tp, msg);
+    chSchRescheduleS();
+    return;
+  }
+#endif
   chSchWakeupS(tp, msg);
 }
 
+#if CH_CFG_USE_MESSAGES_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Evaluates to @p true if the server has answered the request.
+ *
+ * @param[in] rp        pointer to the @p msg_request_t structure
+ *
+ * @iclass
+ */
+static inline bool chMsgIsRequestDoneI(msg_request_t *rp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(rp->r_state == CH_STATE_FINAL);
+}
+
+/**
+ * @brief   Returns the answer to an asynchronous request.
+ * @pre     The request must have been answered by the server.
+ *
+ * @param[in] rp        pointer to the @p msg_request_t structure
+ * @return              The answer message from @p chMsgRelease().
+ *
+ * @api
+ */
+static inline msg_t chMsgGetAnswer(msg_request_t *rp) {
+
+  return rp->r_msg;
+}
+#endif /* CH_CFG_USE_MESSAGES_ASYNC */
+
 #endif /* CH_CFG_USE_MESSAGES */
 
 #endif /* _CHMSG_H_ */
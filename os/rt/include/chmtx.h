@@ -43,6 +43,21 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_CFG_USE_MUTEXES_FASTPATH && !PORT_SUPPORTS_CAS
+#error "CH_CFG_USE_MUTEXES_FASTPATH requires a port supporting CAS"
+#endif
+
+#if CH_CFG_USE_MUTEXES_FASTPATH && CH_CFG_USE_MUTEXES_RECURSIVE
+#error "CH_CFG_USE_MUTEXES_FASTPATH is not compatible with recursive mutexes"
+#endif
+
+#if CH_CFG_USE_MUTEXES_FASTPATH || defined(__DOXYGEN__)
+/**
+ * @brief   Owner pointer tag, threads are waiting on the mutex.
+ */
+#define _MTX_WAITERS            ((uintptr_t)1)
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -65,12 +80,33 @@ struct mutex {
 #if CH_CFG_USE_MUTEXES_RECURSIVE || defined(__DOXYGEN__)
   cnt_t                 m_cnt;      /**< @brief Mutex recursion counter.    */
 #endif
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  tprio_t               m_ceiling;  /**< @brief Ceiling priority or zero
+                                                for priority inheritance
+                                                mutexes.                    */
+#endif
 };
 
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the owner of a mutex.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @return              A pointer to the owner thread.
+ * @retval NULL         if the mutex is not owned.
+ *
+ * @notapi
+ */
+#if CH_CFG_USE_MUTEXES_FASTPATH || defined(__DOXYGEN__)
+#define _mtx_get_owner(mp)                                                  \
+  ((thread_t *)((uintptr_t)(mp)->m_owner & ~_MTX_WAITERS))
+#else
+#define _mtx_get_owner(mp) ((mp)->m_owner)
+#endif
+
 /**
  * @brief   Data part of a static mutex initializer.
  * @details This macro should be used when statically initializing a mutex
@@ -78,7 +114,9 @@ struct mutex {
  *
  * @param[in] name      the name of the mutex variable
  */
-#if CH_CFG_USE_MUTEXES_RECURSIVE || defined(__DOXYGEN__)
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+#define _MUTEX_DATA(name) _MUTEX_CEILING_DATA(name, 0)
+#elif CH_CFG_USE_MUTEXES_RECURSIVE
 #define _MUTEX_DATA(name) {_threads_queue_t_DATA(name.m_queue), NULL, NULL, 0}
 #else
 #define _MUTEX_DATA(name) {_threads_queue_t_DATA(name.m_queue), NULL, NULL}
@@ -93,6 +131,35 @@ struct mutex {
  */
 #define MUTEX_DECL(name) mutex_t name = _MUTEX_DATA(name)
 
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static priority ceiling mutex initializer.
+ * @details This macro should be used when statically initializing a
+ *          priority ceiling mutex that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the ceiling priority
+ */
+#if CH_CFG_USE_MUTEXES_RECURSIVE || defined(__DOXYGEN__)
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_threads_queue_t_DATA(name.m_queue), NULL, NULL, 0, ceiling}
+#else
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_threads_queue_t_DATA(name.m_queue), NULL, NULL, ceiling}
+#endif
+
+/**
+ * @brief   Static priority ceiling mutex initializer.
+ * @details Statically initialized mutexes require no explicit initialization
+ *          using @p chMtxObjectInitCeiling().
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the ceiling priority
+ */
+#define MUTEX_CEILING_DECL(name, ceiling)                                   \
+  mutex_t name = _MUTEX_CEILING_DATA(name, ceiling)
+#endif /* CH_CFG_USE_MUTEXES_CEILING */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -100,8 +167,15 @@ struct mutex {
 
 #ifdef __cplusplus
 extern "C" {
+#endif
+  tprio_t _mtx_get_prio(thread_t *tp);
+#if CH_CFG_USE_CONDVARS
+  void _mtx_morph_i(mutex_t *mp, thread_t *tp);
 #endif
   void chMtxObjectInit(mutex_t *mp);
+#if CH_CFG_USE_MUTEXES_CEILING
+  void chMtxObjectInitCeiling(mutex_t *mp, tprio_t ceiling);
+#endif
   void chMtxLock(mutex_t *mp);
   void chMtxLockS(mutex_t *mp);
   bool chMtxTryLock(mutex_t *mp);
@@ -0,0 +1,176 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chmwait.h
+ * @brief   Multiple objects wait macros and structures.
+ *
+ * @addtogroup mwait
+ * @{
+ */
+
+#ifndef _CHMWAIT_H_
+#define _CHMWAIT_H_
+
+#if CH_CFG_USE_WAITMULTIPLE || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Wait object types
+ * @{
+ */
+#define MWAIT_SEMAPHORE         0   /**< @brief Counting semaphore.         */
+#define MWAIT_MAILBOX           1   /**< @brief Mailbox message.            */
+#define MWAIT_INPUT_QUEUE       2   /**< @brief Input queue byte.           */
+#define MWAIT_OUTPUT_QUEUE      3   /**< @brief Output queue space.         */
+#define MWAIT_EVENT_SOURCE      4   /**< @brief Event source broadcast.     */
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Wait object descriptor.
+ * @details Describes one of the objects a thread is waiting on, the
+ *          @p wo_msg field is used to exchange data with the object:
+ *          - Semaphore, not used.
+ *          - Mailbox, the fetched message.
+ *          - Input queue, the read byte.
+ *          - Output queue, the byte to be written.
+ *          - Event source, the broadcast flags.
+ *          .
+ */
+typedef struct {
+  uint8_t               wo_type;    /**< @brief Object type.                */
+  void                  *wo_objp;   /**< @brief Pointer to the object.      */
+  msg_t                 wo_msg;     /**< @brief Exchanged data.             */
+} wait_object_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    Wait object initializers
+ * @{
+ */
+/**
+ * @brief   Semaphore wait object initializer.
+ * @details The object is ready when the semaphore counter is positive, the
+ *          semaphore is taken.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ */
+#define WAIT_SEMAPHORE(sp) {MWAIT_SEMAPHORE, (void *)(sp), 0}
+
+/**
+ * @brief   Mailbox wait object initializer.
+ * @details The object is ready when a message is available, the message
+ *          is fetched.
+ *
+ * @param[in] mbp       pointer to a @p mailbox_t structure
+ */
+#define WAIT_MAILBOX(mbp) {MWAIT_MAILBOX, (void *)(mbp), 0}
+
+/**
+ * @brief   Input queue wait object initializer.
+ * @details The object is ready when the queue is not empty, a byte is
+ *          read.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ */
+#define WAIT_INPUT_QUEUE(iqp) {MWAIT_INPUT_QUEUE, (void *)(iqp), 0}
+
+/**
+ * @brief   Output queue wait object initializer.
+ * @details The object is ready when the queue is not full, a byte is
+ *          written.
+ *
+ * @param[in] oqp       pointer to an @p output_queue_t structure
+ * @param[in] b         the byte to be written
+ */
+#define WAIT_OUTPUT_QUEUE(oqp, b)                                           \
+  {MWAIT_OUTPUT_QUEUE, (void *)(oqp), (msg_t)(b)}
+
+/**
+ * @brief   Event source wait object initializer.
+ * @details The object is ready when the event source is broadcasted while
+ *          the thread is waiting, broadcasts happened before the wait
+ *          are not detected.
+ *
+ * @param[in] esp       pointer to an @p event_source_t structure
+ */
+#define WAIT_EVENT_SOURCE(esp) {MWAIT_EVENT_SOURCE, (void *)(esp), 0}
+/** @} */
+
+/**
+ * @brief   Notifies a change in the state of an object.
+ * @details Threads waiting on the object are made ready if the object
+ *          can be acquired.
+ * @note    The check on the waiting threads is inlined so the cost is
+ *          minimal when there are no multiple waits pending.
+ *
+ * @param[in] objp      pointer to the object
+ * @param[in] msg       object specific data
+ *
+ * @iclass
+ */
+#define _mwait_notify_i(objp, msg) do {                                     \
+  if (queue_notempty(&ch.mwqueue))                                          \
+    _mwait_wakeup_i((void *)(objp), (msg_t)(msg));                          \
+} while (false)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _mwait_init(void);
+  void _mwait_wakeup_i(void *objp, msg_t msg);
+  msg_t chMWaitTimeout(wait_object_t *wop, cnt_t n, systime_t time);
+  msg_t chMWaitTimeoutS(wait_object_t *wop, cnt_t n, systime_t time);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* CH_CFG_USE_WAITMULTIPLE */
+
+#endif /* _CHMWAIT_H_ */
+
+/** @} */
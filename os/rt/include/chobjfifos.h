@@ -0,0 +1,143 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chobjfifos.h
+ * @brief   Objects FIFOs macros and structures.
+ *
+ * @addtogroup objects_fifos
+ * @{
+ */
+
+#ifndef _CHOBJFIFOS_H_
+#define _CHOBJFIFOS_H_
+
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_MEMPOOLS
+#error "CH_CFG_USE_OBJ_FIFOS requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if !CH_CFG_USE_MAILBOXES
+#error "CH_CFG_USE_OBJ_FIFOS requires CH_CFG_USE_MAILBOXES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Structure representing an objects FIFO.
+ */
+typedef struct {
+  memory_pool_t         of_pool;        /**< @brief Pool of the free
+                                                    objects.                */
+  semaphore_t           of_freesem;     /**< @brief Free objects counter
+                                                    @p semaphore_t.         */
+  mailbox_t             of_mbx;         /**< @brief Queue of the ready
+                                                    objects.                */
+} objects_fifo_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chFifoObjectInit(objects_fifo_t *ofp, size_t objsize, size_t objn,
+                        void *objbuf, msg_t *msgbuf);
+  void *chFifoTakeObject(objects_fifo_t *ofp, systime_t timeout);
+  void *chFifoTakeObjectS(objects_fifo_t *ofp, systime_t timeout);
+  void *chFifoTakeObjectI(objects_fifo_t *ofp);
+  void chFifoReturnObject(objects_fifo_t *ofp, void *objp);
+  void chFifoReturnObjectI(objects_fifo_t *ofp, void *objp);
+  void chFifoSendObject(objects_fifo_t *ofp, void *objp);
+  void chFifoSendObjectS(objects_fifo_t *ofp, void *objp);
+  void chFifoSendObjectI(objects_fifo_t *ofp, void *objp);
+  msg_t chFifoReceiveObject(objects_fifo_t *ofp, void **objpp,
+                            systime_t timeout);
+  msg_t chFifoReceiveObjectS(objects_fifo_t *ofp, void **objpp,
+                             systime_t timeout);
+  msg_t chFifoReceiveObjectI(objects_fifo_t *ofp, void **objpp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of free objects in an objects FIFO.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The number of free objects.
+ *
+ * @iclass
+ */
+static inline cnt_t chFifoGetFreeCountI(objects_fifo_t *ofp) {
+
+  chDbgCheckClassI();
+
+  return chSemGetCounterI(&ofp->of_freesem);
+}
+
+/**
+ * @brief   Returns the number of objects ready in an objects FIFO.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The number of ready objects.
+ *
+ * @iclass
+ */
+static inline cnt_t chFifoGetUsedCountI(objects_fifo_t *ofp) {
+
+  chDbgCheckClassI();
+
+  return chMBGetUsedCountI(&ofp->of_mbx);
+}
+
+#endif /* CH_CFG_USE_OBJ_FIFOS */
+
+#endif /* _CHOBJFIFOS_H_ */
+
+/** @} */
@@ -0,0 +1,159 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chpmboxes.h
+ * @brief   Priority mailboxes macros and structures.
+ *
+ * @addtogroup pmailboxes
+ * @{
+ */
+
+#ifndef _CHPMBOXES_H_
+#define _CHPMBOXES_H_
+
+#if CH_CFG_USE_PMAILBOXES || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_SEMAPHORES
+#error "CH_CFG_USE_PMAILBOXES requires CH_CFG_USE_SEMAPHORES"
+#endif
+
+#if CH_CFG_PMAILBOXES_LEVELS < 1
+#error "invalid CH_CFG_PMAILBOXES_LEVELS value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a priority mailbox slot.
+ */
+typedef struct pmb_slot pmb_slot_t;
+
+/**
+ * @brief   Structure representing a priority mailbox slot.
+ * @details The mailbox buffer is an array of slots, each slot holds one
+ *          message and links it in the list of its priority level.
+ */
+struct pmb_slot {
+  pmb_slot_t            *ps_next;       /**< @brief Next slot in the list.  */
+  msg_t                 ps_msg;         /**< @brief The message.            */
+};
+
+/**
+ * @brief   Structure representing a priority mailbox object.
+ */
+typedef struct {
+  pmb_slot_t            *pmb_free;      /**< @brief List of the free slots. */
+  pmb_slot_t            *pmb_head[CH_CFG_PMAILBOXES_LEVELS];
+                                        /**< @brief First slot of each
+                                                    priority level.         */
+  pmb_slot_t            *pmb_tail[CH_CFG_PMAILBOXES_LEVELS];
+                                        /**< @brief Last slot of each
+                                                    priority level.         */
+  cnt_t                 pmb_size;       /**< @brief Number of slots.        */
+  semaphore_t           pmb_fullsem;    /**< @brief Full counter
+                                                    @p semaphore_t.         */
+  semaphore_t           pmb_emptysem;   /**< @brief Empty counter
+                                                    @p semaphore_t.         */
+} pmailbox_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chPMBObjectInit(pmailbox_t *pmbp, pmb_slot_t *buf, cnt_t n);
+  void chPMBReset(pmailbox_t *pmbp);
+  msg_t chPMBPost(pmailbox_t *pmbp, msg_t msg, unsigned prio,
+                  systime_t timeout);
+  msg_t chPMBPostS(pmailbox_t *pmbp, msg_t msg, unsigned prio,
+                   systime_t timeout);
+  msg_t chPMBPostI(pmailbox_t *pmbp, msg_t msg, unsigned prio);
+  msg_t chPMBFetch(pmailbox_t *pmbp, msg_t *msgp, systime_t timeout);
+  msg_t chPMBFetchS(pmailbox_t *pmbp, msg_t *msgp, systime_t timeout);
+  msg_t chPMBFetchI(pmailbox_t *pmbp, msg_t *msgp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of free message slots into a priority mailbox.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @return              The number of empty message slots.
+ *
+ * @iclass
+ */
+static inline cnt_t chPMBGetFreeCountI(pmailbox_t *pmbp) {
+
+  chDbgCheckClassI();
+
+  return chSemGetCounterI(&pmbp->pmb_emptysem);
+}
+
+/**
+ * @brief   Returns the number of used message slots into a priority mailbox.
+ * @note    The returned value can be less than zero when there are waiting
+ *          threads on the internal semaphore.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @return              The number of queued messages.
+ *
+ * @iclass
+ */
+static inline cnt_t chPMBGetUsedCountI(pmailbox_t *pmbp) {
+
+  chDbgCheckClassI();
+
+  return chSemGetCounterI(&pmbp->pmb_fullsem);
+}
+
+#endif /* CH_CFG_USE_PMAILBOXES */
+
+#endif /* _CHPMBOXES_H_ */
+
+/** @} */
@@ -238,16 +238,22 @@ extern "C" {
   void chIQResetI(input_queue_t *iqp);
   msg_t chIQPutI(input_queue_t *iqp, uint8_t b);
   msg_t chIQGetTimeout(input_queue_t *iqp, systime_t time);
+  msg_t chIQGetUntil(input_queue_t *iqp, systime_t deadline);
   size_t chIQReadTimeout(input_queue_t *iqp, uint8_t *bp,
                          size_t n, systime_t time);
+  size_t chIQReadUntil(input_queue_t *iqp, uint8_t *bp,
+                       size_t n, systime_t deadline);
 
   void chOQObjectInit(output_queue_t *oqp, uint8_t *bp, size_t size,
                       qnotify_t onfy, void *link);
   void chOQResetI(output_queue_t *oqp);
   msg_t chOQPutTimeout(output_queue_t *oqp, uint8_t b, systime_t time);
+  msg_t chOQPutUntil(output_queue_t *oqp, uint8_t b, systime_t deadline);
   msg_t chOQGetI(output_queue_t *oqp);
   size_t chOQWriteTimeout(output_queue_t *oqp, const uint8_t *bp,
                           size_t n, systime_t time);
+  size_t chOQWriteUntil(output_queue_t *oqp, const uint8_t *bp,
+                        size_t n, systime_t deadline);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,175 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chrings.h
+ * @brief   Lock-free rings macros and structures.
+ *
+ * @addtogroup rings
+ * @{
+ */
+
+#ifndef _CHRINGS_H_
+#define _CHRINGS_H_
+
+#if CH_CFG_USE_RINGS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Returned by @p chRingGetX() when the ring is empty.
+ */
+#define RING_EMPTY              -3
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Structure representing a single producer single consumer ring.
+ * @details The write pointer is only modified by the producer and the read
+ *          pointer is only modified by the consumer, the two sides can so
+ *          access the ring without locking.<br>
+ *          The ring is made of fixed size records, a ring with one byte
+ *          records can also be accessed as a bytes ring.
+ */
+typedef struct {
+  volatile uint8_t      *r_buffer;      /**< @brief Pointer to the ring
+                                                    buffer.                 */
+  volatile uint8_t      *r_top;         /**< @brief Pointer to the first
+                                                    location after the
+                                                    buffer.                 */
+  size_t                r_size;         /**< @brief Size of a record.       */
+  volatile uint8_t * volatile r_wrptr;  /**< @brief Write pointer, owned by
+                                                    the producer.           */
+  volatile uint8_t * volatile r_rdptr;  /**< @brief Read pointer, owned by
+                                                    the consumer.           */
+  thread_reference_t    r_thread;       /**< @brief Waiting consumer.       */
+  size_t                r_threshold;    /**< @brief Records awaited by the
+                                                    consumer.               */
+} spsc_ring_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of a ring buffer.
+ * @note    One record of the buffer is always kept empty in order to tell
+ *          apart the full and empty conditions.
+ *
+ * @param[in] n         number of records the ring must be able to hold
+ * @param[in] size      size of a record
+ */
+#define RING_BUFFER_SIZE(n, size) (((n) + 1) * (size))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRingObjectInit(spsc_ring_t *rp, uint8_t *buf, size_t n,
+                        size_t size);
+  bool chRingWriteX(spsc_ring_t *rp, const void *recp);
+  bool chRingReadX(spsc_ring_t *rp, void *recp);
+  bool chRingPutX(spsc_ring_t *rp, uint8_t b);
+  msg_t chRingGetX(spsc_ring_t *rp);
+  void chRingWakeupI(spsc_ring_t *rp);
+  msg_t chRingWaitTimeout(spsc_ring_t *rp, size_t n, systime_t timeout);
+  msg_t chRingWaitTimeoutS(spsc_ring_t *rp, size_t n, systime_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of records in a ring.
+ * @note    The value is exact when invoked by the consumer, the producer
+ *          can only add records after the reading.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @return              The number of records in the ring.
+ *
+ * @xclass
+ */
+static inline size_t chRingGetUsedCountX(spsc_ring_t *rp) {
+  volatile uint8_t *wrptr = rp->r_wrptr;
+  volatile uint8_t *rdptr = rp->r_rdptr;
+
+  if (wrptr < rdptr)
+    wrptr += rp->r_top - rp->r_buffer;
+  return (size_t)(wrptr - rdptr) / rp->r_size;
+}
+
+/**
+ * @brief   Returns the number of free records in a ring.
+ * @note    The value is exact when invoked by the producer, the consumer
+ *          can only remove records after the reading.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @return              The number of free records in the ring.
+ *
+ * @xclass
+ */
+static inline size_t chRingGetFreeCountX(spsc_ring_t *rp) {
+
+  return (size_t)(rp->r_top - rp->r_buffer) / rp->r_size - 1 -
+         chRingGetUsedCountX(rp);
+}
+
+/**
+ * @brief   Checks if the consumer needs to be woken up.
+ * @details This function allows a producer to enter a critical zone and
+ *          invoke @p chRingWakeupI() only when it is required.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @return              The wakeup condition.
+ * @retval true         if the consumer is waiting for the records in the
+ *                      ring.
+ *
+ * @xclass
+ */
+static inline bool chRingIsWakeupNeededX(spsc_ring_t *rp) {
+
+  return (rp->r_thread != NULL) &&
+         (chRingGetUsedCountX(rp) >= rp->r_threshold);
+}
+
+#endif /* CH_CFG_USE_RINGS */
+
+#endif /* _CHRINGS_H_ */
+
+/** @} */
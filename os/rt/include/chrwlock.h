@@ -0,0 +1,170 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chrwlock.h
+ * @brief   Reader-writer locks macros and structures.
+ *
+ * @addtogroup rwlocks
+ * @{
+ */
+
+#ifndef _CHRWLOCK_H_
+#define _CHRWLOCK_H_
+
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_MUTEXES
+#error "CH_CFG_USE_RWLOCKS requires CH_CFG_USE_MUTEXES"
+#endif
+
+#if CH_CFG_RWLOCKS_NESTING < 1
+#error "invalid CH_CFG_RWLOCKS_NESTING value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a reader-writer lock structure.
+ */
+typedef struct rwlock rwlock_t;
+
+/**
+ * @brief   Type of a reader record.
+ */
+typedef struct rwlock_reader rwlock_reader_t;
+
+/**
+ * @brief   Reader-writer lock structure.
+ */
+struct rwlock {
+  threads_queue_t       rw_queue;   /**< @brief Queue of the threads sleeping
+                                                on this lock.               */
+  thread_t              *rw_writer; /**< @brief Writer @p thread_t pointer
+                                                or @p NULL.                 */
+  rwlock_t              *rw_next;   /**< @brief Next @p rwlock_t into a
+                                                writer owner-list or
+                                                @p NULL.                    */
+  rwlock_reader_t       *rw_readers;/**< @brief List of the readers.        */
+  cnt_t                 rw_wrwaiting;/**< @brief Number of waiting
+                                                writers.                    */
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static reader-writer lock initializer.
+ * @details This macro should be used when statically initializing a
+ *          reader-writer lock that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the reader-writer lock variable
+ */
+#define _RWLOCK_DATA(name) {_threads_queue_t_DATA(name.rw_queue), NULL, NULL, \
+                            NULL, 0}
+
+/**
+ * @brief   Static reader-writer lock initializer.
+ * @details Statically initialized reader-writer locks require no explicit
+ *          initialization using @p chRwObjectInit().
+ *
+ * @param[in] name      the name of the reader-writer lock variable
+ */
+#define RWLOCK_DECL(name) rwlock_t name = _RWLOCK_DATA(name)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRwObjectInit(rwlock_t *rwp);
+  void chRwLockRead(rwlock_t *rwp);
+  void chRwLockReadS(rwlock_t *rwp);
+  msg_t chRwLockReadTimeout(rwlock_t *rwp, systime_t time);
+  msg_t chRwLockReadTimeoutS(rwlock_t *rwp, systime_t time);
+  void chRwLockWrite(rwlock_t *rwp);
+  void chRwLockWriteS(rwlock_t *rwp);
+  msg_t chRwLockWriteTimeout(rwlock_t *rwp, systime_t time);
+  msg_t chRwLockWriteTimeoutS(rwlock_t *rwp, systime_t time);
+  void chRwUnlock(rwlock_t *rwp);
+  void chRwUnlockS(rwlock_t *rwp);
+  void _rw_boost_owners(rwlock_t *rwp, tprio_t prio);
+  tprio_t _rw_get_inherited_prio(thread_t *tp, tprio_t prio);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns @p true if the lock is owned by a writer.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The lock status.
+ *
+ * @iclass
+ */
+static inline bool chRwIsWriteLockedI(rwlock_t *rwp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(rwp->rw_writer != NULL);
+}
+
+/**
+ * @brief   Returns @p true if the lock is owned by at least a reader.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The lock status.
+ *
+ * @iclass
+ */
+static inline bool chRwIsReadLockedI(rwlock_t *rwp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(rwp->rw_readers != NULL);
+}
+
+#endif /* CH_CFG_USE_RWLOCKS */
+
+#endif /* _CHRWLOCK_H_ */
+
+/** @} */
@@ -112,6 +112,20 @@ typedef struct {
                                                 thread.                     */
 } ready_list_t;
 
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+/**
+ * @brief   Reader record of a reader-writer lock.
+ * @details Each thread owns a fixed set of records, one for each
+ *          reader-writer lock it can hold in read mode at the same time.
+ */
+struct rwlock_reader {
+  struct rwlock_reader  *rr_next;   /**< @brief Next reader of the same
+                                                lock.                       */
+  struct rwlock         *rr_lock;   /**< @brief Held lock or @p NULL.       */
+  thread_t              *rr_thread; /**< @brief Owner thread.               */
+};
+#endif
+
 /**
  * @brief   Structure representing a thread.
  * @note    Not all the listed fields are always needed, by switching off some
@@ -238,6 +252,18 @@ struct thread {
    */
   tprio_t               p_realprio;
 #endif
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+  /**
+   * @brief List of the reader-writer locks owned in write mode by this
+   *        thread.
+   * @note  The list is terminated by a @p NULL in this field.
+   */
+  struct rwlock         *p_rwlist;
+  /**
+   * @brief Records of the reader-writer locks held in read mode.
+   */
+  struct rwlock_reader  p_rdlocks[CH_CFG_RWLOCKS_NESTING];
+#endif
 #if (CH_CFG_USE_DYNAMIC && CH_CFG_USE_MEMPOOLS) || defined(__DOXYGEN__)
   /**
    * @brief Memory Pool where the thread workspace is returned.
@@ -316,6 +342,12 @@ typedef struct ch_system {
    * @brief   Virtual timers delta list header.
    */
   virtual_timers_list_t vtlist;
+#if CH_CFG_USE_WAITMULTIPLE || defined(__DOXYGEN__)
+  /**
+   * @brief   Threads waiting on multiple objects.
+   */
+  threads_queue_t       mwqueue;
+#endif
 #if CH_CFG_USE_TM || defined(__DOXYGEN__)
   /**
    * @brief   Measurement calibration value.
@@ -147,6 +147,54 @@ static inline cnt_t chSemGetCounterI(semaphore_t *sp) {
   return sp->s_cnt;
 }
 
+/**
+ * @brief   Performs a wait operation on a semaphore with a deadline.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the semaphore.
+ * @retval MSG_OK       if the thread has not stopped on the semaphore or the
+ *                      semaphore has been signaled.
+ * @retval MSG_RESET    if the semaphore has been reset using @p chSemReset().
+ * @retval MSG_TIMEOUT  if the semaphore has not been signaled or reset within
+ *                      the specified deadline.
+ *
+ * @sclass
+ */
+static inline msg_t chSemWaitUntilS(semaphore_t *sp, systime_t deadline) {
+
+  return chSemWaitTimeoutS(sp, chVTTimeUntilX(deadline));
+}
+
+/**
+ * @brief   Performs a wait operation on a semaphore with a deadline.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              A message specifying how the invoking thread has been
+ *                      released from the semaphore.
+ * @retval MSG_OK       if the thread has not stopped on the semaphore or the
+ *                      semaphore has been signaled.
+ * @retval MSG_RESET    if the semaphore has been reset using @p chSemReset().
+ * @retval MSG_TIMEOUT  if the semaphore has not been signaled or reset within
+ *                      the specified deadline.
+ *
+ * @api
+ */
+static inline msg_t chSemWaitUntil(semaphore_t *sp, systime_t deadline) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chSemWaitUntilS(sp, deadline);
+  chSysUnlock();
+  return msg;
+}
+
 #endif /* CH_CFG_USE_SEMAPHORES */
 
 #endif /* _CHSEM_H_ */
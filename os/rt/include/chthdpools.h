@@ -0,0 +1,232 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chthdpools.h
+ * @brief   Thread pools macros and structures.
+ *
+ * @addtogroup thread_pools
+ * @{
+ */
+
+#ifndef _CHTHDPOOLS_H_
+#define _CHTHDPOOLS_H_
+
+#if CH_CFG_USE_THREAD_POOLS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_DYNAMIC || !CH_CFG_USE_HEAP
+#error "CH_CFG_USE_THREAD_POOLS requires CH_CFG_USE_DYNAMIC and CH_CFG_USE_HEAP"
+#endif
+
+#if !CH_CFG_USE_MEMPOOLS
+#error "CH_CFG_USE_THREAD_POOLS requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if !CH_CFG_USE_PMAILBOXES
+#error "CH_CFG_USE_THREAD_POOLS requires CH_CFG_USE_PMAILBOXES"
+#endif
+
+#if !CH_CFG_USE_TM
+#error "CH_CFG_USE_THREAD_POOLS requires CH_CFG_USE_TM"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Job function.
+ */
+typedef void (*tpjob_t)(void *arg);
+
+/**
+ * @brief   Structure representing a queued job.
+ */
+typedef struct {
+  tpjob_t               j_func;         /**< @brief Job function.           */
+  void                  *j_arg;         /**< @brief Job function argument.  */
+  rtcnt_t               j_time;         /**< @brief Submission time.        */
+} thread_pool_job_t;
+
+/**
+ * @brief   Thread pool configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief Heap the workers working areas are allocated from, @p NULL for
+   *        the default heap.
+   */
+  memory_heap_t         *heapp;
+  /**
+   * @brief Size of the workers working areas.
+   */
+  size_t                wsize;
+  /**
+   * @brief Priority of the workers.
+   */
+  tprio_t               prio;
+  /**
+   * @brief Number of workers started by @p chThdPoolStart() and kept alive
+   *        when idle.
+   */
+  cnt_t                 minworkers;
+  /**
+   * @brief Maximum number of workers.
+   */
+  cnt_t                 maxworkers;
+  /**
+   * @brief Time an idle worker waits before exiting when there are more
+   *        than @p minworkers workers, @p TIME_INFINITE disables the
+   *        shrinking.
+   */
+  systime_t             idletime;
+  /**
+   * @brief Array of @p maxworkers elements holding the workers references.
+   */
+  thread_t              **workers;
+  /**
+   * @brief Array of jobs objects, it limits the number of queued jobs.
+   */
+  thread_pool_job_t     *jobs;
+  /**
+   * @brief Array of priority mailbox slots, one for each job object.
+   */
+  pmb_slot_t            *slots;
+  /**
+   * @brief Number of elements of the @p jobs and @p slots arrays.
+   */
+  cnt_t                 njobs;
+} thread_pool_config_t;
+
+/**
+ * @brief   Thread pool statistics.
+ */
+typedef struct {
+  ucnt_t                rejected;       /**< @brief Jobs rejected because the
+                                                    queue was full.         */
+  cnt_t                 peak;           /**< @brief Peak number of
+                                                    workers.                */
+  time_measurement_t    wait;           /**< @brief Time spent by the jobs
+                                                    in queue.               */
+  time_measurement_t    exec;           /**< @brief Jobs execution time.    */
+} thread_pool_stats_t;
+
+/**
+ * @brief   Structure representing a thread pool.
+ */
+typedef struct {
+  const thread_pool_config_t *tp_config;/**< @brief Current configuration
+                                                    data.                   */
+  pmailbox_t            tp_queue;       /**< @brief Jobs queue.             */
+  memory_pool_t         tp_jobs;        /**< @brief Free jobs objects.      */
+  cnt_t                 tp_nworkers;    /**< @brief Number of workers.      */
+  bool                  tp_growing;     /**< @brief A worker is being
+                                                    added.                  */
+  thread_pool_stats_t   tp_stats;       /**< @brief Pool statistics.        */
+} thread_pool_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the pool statistics.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @return              Pointer to the @p thread_pool_stats_t structure.
+ *
+ * @xclass
+ */
+#define chThdPoolGetStatisticsX(tpp) (&(tpp)->tp_stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chThdPoolObjectInit(thread_pool_t *tpp,
+                           const thread_pool_config_t *config);
+  bool chThdPoolStart(thread_pool_t *tpp);
+  void chThdPoolStop(thread_pool_t *tpp);
+  msg_t chThdPoolSubmitI(thread_pool_t *tpp, tpjob_t func, void *arg,
+                         unsigned prio);
+  msg_t chThdPoolSubmit(thread_pool_t *tpp, tpjob_t func, void *arg,
+                        unsigned prio);
+  void chThdPoolResetStatistics(thread_pool_t *tpp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of workers of a thread pool.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @return              The number of workers.
+ *
+ * @iclass
+ */
+static inline cnt_t chThdPoolGetWorkersI(thread_pool_t *tpp) {
+
+  chDbgCheckClassI();
+
+  return tpp->tp_nworkers;
+}
+
+/**
+ * @brief   Returns the number of jobs waiting in a thread pool queue.
+ * @note    The returned value can be less than zero when there are idle
+ *          workers waiting for jobs.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @return              The number of queued jobs.
+ *
+ * @iclass
+ */
+static inline cnt_t chThdPoolGetQueuedI(thread_pool_t *tpp) {
+
+  chDbgCheckClassI();
+
+  return chPMBGetUsedCountI(&tpp->tp_queue);
+}
+
+#endif /* CH_CFG_USE_THREAD_POOLS */
+
+#endif /* _CHTHDPOOLS_H_ */
+
+/** @} */
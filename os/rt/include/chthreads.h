@@ -56,6 +56,12 @@
                                          answer.                            */
 #define CH_STATE_WTMSG          14  /**< @brief Waiting for a message.      */
 #define CH_STATE_FINAL          15  /**< @brief Thread terminated.          */
+#define CH_STATE_WTRWLOCK       16  /**< @brief Waiting on a reader-writer
+                                         lock.                              */
+#define CH_STATE_WTMULTI        17  /**< @brief Waiting on multiple
+                                         objects.                           */
+#define CH_STATE_MSGREQ         18  /**< @brief Not a thread, asynchronous
+                                         message request.                   */
 
 /**
  * @brief   Thread states as array of strings.
@@ -65,7 +71,7 @@
 #define CH_STATE_NAMES                                                     \
   "READY", "WTSTART", "CURRENT", "SUSPENDED", "QUEUED", "WTSEM", "WTMTX",  \
   "WTCOND", "SLEEPING", "WTEXIT", "WTOREVT", "WTANDEVT", "SNDMSGQ",        \
-  "SNDMSG", "WTMSG", "FINAL"
+  "SNDMSG", "WTMSG", "FINAL", "WTRWLOCK", "WTMULTI", "MSGREQ"
 /** @} */
 
 /**
@@ -79,6 +85,8 @@
 #define CH_FLAG_MODE_MEMPOOL    2   /**< @brief Thread allocated from a
                                          Memory Pool.                       */
 #define CH_FLAG_TERMINATE       4   /**< @brief Termination requested flag. */
+#define CH_FLAG_CVTIMEOUT       8   /**< @brief Waiting on a condition
+                                         variable with timeout.             */
 /** @} */
 
 /*===========================================================================*/
@@ -252,6 +260,7 @@ extern "C" {
   void chThdTerminate(thread_t *tp);
   void chThdSleep(systime_t time);
   void chThdSleepUntil(systime_t time);
+  bool chThdSleepUntilWindowed(systime_t prev, systime_t next);
   void chThdYield(void);
   void chThdExit(msg_t msg);
   void chThdExitS(msg_t msg);
@@ -85,6 +85,7 @@ extern "C" {
   NOINLINE void chTMStopMeasurementX(time_measurement_t *tmp);
   NOINLINE void chTMChainMeasurementToX(time_measurement_t *tmp1,
                                         time_measurement_t *tmp2);
+  void chTMStopMeasurementSinceX(time_measurement_t *tmp, rtcnt_t start);
 #ifdef __cplusplus
 }
 #endif
@@ -265,6 +265,31 @@ static inline systime_t chVTTimeElapsedSinceX(systime_t start) {
   return chVTGetSystemTimeX() - start;
 }
 
+/**
+ * @brief   Returns the time remaining before the specified deadline.
+ * @details The returned value can be used as timeout by the functions
+ *          accepting a relative time, a deadline already reached or passed
+ *          results in @p TIME_IMMEDIATE.
+ * @note    Deadlines farther than half the system time range are considered
+ *          already passed, this is what makes the computation immune to the
+ *          system time wrap-around.
+ * @note    The value should be computed in the same critical zone where it
+ *          is used, otherwise it would not account for the time spent
+ *          between the computation and its use.
+ *
+ * @param[in] deadline  the absolute system time
+ * @return              The remaining time in ticks.
+ *
+ * @xclass
+ */
+static inline systime_t chVTTimeUntilX(systime_t deadline) {
+  systime_t time = deadline - chVTGetSystemTimeX();
+
+  if (time > ((systime_t)-1 / (systime_t)2))
+    return TIME_IMMEDIATE;
+  return time;
+}
+
 /**
  * @brief   Checks if the specified time is within the specified time window.
  * @note    When start==end then the function returns always true because the
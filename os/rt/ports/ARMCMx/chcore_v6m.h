@@ -74,6 +74,11 @@
  */
 #define PORT_SUPPORTS_RT                FALSE
 
+/**
+ * @brief   This port does not support an atomic compare and swap.
+ */
+#define PORT_SUPPORTS_CAS               FALSE
+
 /**
  * @brief   PendSV priority level.
  * @note    This priority is enforced to be equal to @p 0,
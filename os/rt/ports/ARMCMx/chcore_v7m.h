@@ -78,6 +78,11 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports an atomic compare and swap.
+ */
+#define PORT_SUPPORTS_CAS               TRUE
+
 /**
  * @brief   Disabled value for BASEPRI register.
  */
@@ -548,6 +553,31 @@ static inline rtcnt_t port_rt_get_counter_value(void) {
   return DWT->CYCCNT;
 }
 
+/**
+ * @brief   Atomic compare and swap of a pointer.
+ * @details The pointer is replaced with @p xchg only if it is equal to
+ *          @p cmp, the operation is atomic with respect to interrupts and
+ *          context switches.
+ * @note    Implemented using the @p LDREX and @p STREX instructions.
+ *
+ * @param[in] p         pointer to the pointer to be swapped
+ * @param[in] cmp       expected current value
+ * @param[in] xchg      new value
+ * @return              The operation status.
+ * @retval true         if the swap has been performed.
+ * @retval false        if the current value was not equal to @p cmp.
+ */
+static inline bool port_cas(void * volatile *p, void *cmp, void *xchg) {
+
+  do {
+    if ((void *)__LDREXW((volatile uint32_t *)p) != cmp) {
+      __CLREX();
+      return false;
+    }
+  } while (__STREXW((uint32_t)xchg, (volatile uint32_t *)p) != 0U);
+  return true;
+}
+
 #endif /* !defined(_FROM_ASM_) */
 
 #endif /* _CHCORE_V7M_H_ */
@@ -8,17 +8,27 @@ KERNSRC = ${CHIBIOS}/os/rt/src/chsys.c \
           ${CHIBIOS}/os/rt/src/chvt.c \
           ${CHIBIOS}/os/rt/src/chthreads.c \
           ${CHIBIOS}/os/rt/src/chdynamic.c \
+          ${CHIBIOS}/os/rt/src/chthdpools.c \
+          ${CHIBIOS}/os/rt/src/chdpc.c \
+          ${CHIBIOS}/os/rt/src/chbtasks.c \
           ${CHIBIOS}/os/rt/src/chregistry.c \
           ${CHIBIOS}/os/rt/src/chsem.c \
           ${CHIBIOS}/os/rt/src/chmtx.c \
+          ${CHIBIOS}/os/rt/src/chrwlock.c \
           ${CHIBIOS}/os/rt/src/chcond.c \
           ${CHIBIOS}/os/rt/src/chevents.c \
           ${CHIBIOS}/os/rt/src/chmsg.c \
           ${CHIBIOS}/os/rt/src/chmboxes.c \
+          ${CHIBIOS}/os/rt/src/chpmboxes.c \
           ${CHIBIOS}/os/rt/src/chqueues.c \
+          ${CHIBIOS}/os/rt/src/chrings.c \
+          ${CHIBIOS}/os/rt/src/chmwait.c \
+          ${CHIBIOS}/os/rt/src/chcoop.c \
           ${CHIBIOS}/os/rt/src/chmemcore.c \
           ${CHIBIOS}/os/rt/src/chheap.c \
-          ${CHIBIOS}/os/rt/src/chmempools.c
+          ${CHIBIOS}/os/rt/src/chmempools.c \
+          ${CHIBIOS}/os/rt/src/chbuf.c \
+          ${CHIBIOS}/os/rt/src/chobjfifos.c
 
 # Required include directories
 KERNINC = ${CHIBIOS}/os/rt/include
@@ -0,0 +1,322 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chbtasks.c
+ * @brief   Basic tasks code.
+ *
+ * @addtogroup basic_tasks
+ * @details Run-to-completion tasks sharing a stack for each priority.
+ *          <h2>Operation mode</h2>
+ *          A basic task is a function that is executed once for each
+ *          activation and runs to completion without ever blocking, as
+ *          the OSEK basic tasks. Tasks are grouped in levels, all the
+ *          tasks of a level are executed by a single thread so they share
+ *          its stack and priority, a level needs a single working area
+ *          sized for its deepest task instead of one for each task.<br>
+ *          Activations are counted, a task activated again while pending
+ *          or running is executed again up to its activations limit.
+ *          Tasks of the same level are executed in activation order and
+ *          never preempt each other, tasks of a level with higher priority
+ *          preempt them as any higher priority thread would do.
+ *          <h2>Costs</h2>
+ *          Basic tasks save RAM, not time. Activating a task of an idle
+ *          level resumes the level thread, it costs the same context
+ *          switches of signaling a dedicated thread plus the queuing of
+ *          the task, so a single activation is slightly slower than a
+ *          thread wakeup. A task cannot be executed from the activating
+ *          context without a port specific stack switch and that context
+ *          would not have the level priority.<br>
+ *          Activations happening while the level thread is ready or is
+ *          executing tasks only queue the task, a burst of activations
+ *          is served by a single wakeup of the level thread.
+ * @note    Basic tasks must never block, the other tasks of the same
+ *          level would be delayed.
+ * @pre     In order to use the basic tasks APIs the
+ *          @p CH_CFG_USE_BASIC_TASKS option must be enabled in
+ *          @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_BASIC_TASKS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Appends a task to the activated tasks of its level.
+ *
+ * @param[in] btp       pointer to a @p btask_t structure
+ */
+static void bt_enqueue(btask_t *btp) {
+  btask_level_t *blp = btp->bt_level;
+
+  btp->bt_next = NULL;
+#if CH_CFG_USE_TM
+  btp->bt_time = chSysGetRealtimeCounterX();
+#endif
+  if (blp->bl_head == NULL)
+    blp->bl_head = btp;
+  else
+    blp->bl_tail->bt_next = btp;
+  blp->bl_tail = btp;
+}
+
+/**
+ * @brief   Level thread.
+ * @details Executes the activated tasks, the thread is suspended while no
+ *          task is activated. All the tasks queued before the queue
+ *          becomes empty are executed without suspending the thread.
+ *
+ * @param[in] p         pointer to the @p btask_level_t object
+ */
+static msg_t bt_level_thread(void *p) {
+  btask_level_t *blp = (btask_level_t *)p;
+  btask_t *btp;
+
+  chSysLock();
+  while (true) {
+    btp = blp->bl_head;
+    if (btp == NULL) {
+      if (chThdShouldTerminateX())
+        break;
+      chThdSuspendS(&blp->bl_thread);
+      continue;
+    }
+
+    blp->bl_head = btp->bt_next;
+#if CH_CFG_USE_TM
+    chTMStopMeasurementSinceX(&blp->bl_stats.latency, btp->bt_time);
+#endif
+    chSysUnlock();
+
+    btp->bt_func(btp->bt_arg);
+
+    chSysLock();
+    /* The executed activation is consumed, the task is queued again if
+       it has been activated while pending or running.*/
+    if (--btp->bt_activations > 0)
+      bt_enqueue(btp);
+  }
+  chSysUnlock();
+
+  return 0;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p btask_level_t object.
+ *
+ * @param[out] blp      pointer to a @p btask_level_t structure
+ *
+ * @init
+ */
+void chBTaskLevelObjectInit(btask_level_t *blp) {
+
+  chDbgCheck(blp != NULL);
+
+  blp->bl_head   = NULL;
+  blp->bl_tail   = NULL;
+  blp->bl_tp     = NULL;
+  blp->bl_thread = NULL;
+  blp->bl_stats.activations = 0;
+  blp->bl_stats.rejected    = 0;
+#if CH_CFG_USE_TM
+  chTMObjectInit(&blp->bl_stats.latency);
+#endif
+}
+
+/**
+ * @brief   Starts a basic tasks level.
+ * @details The level thread is created, its working area is the stack
+ *          shared by all the tasks of the level.
+ *
+ * @param[in] blp       pointer to a @p btask_level_t structure
+ * @param[out] wsp      pointer to a working area dedicated to the level
+ *                      thread stack
+ * @param[in] size      size of the working area
+ * @param[in] prio      the priority level for the level thread
+ *
+ * @api
+ */
+void chBTaskLevelStart(btask_level_t *blp, void *wsp, size_t size,
+                       tprio_t prio) {
+
+  chDbgCheck(blp != NULL);
+  chDbgAssert(blp->bl_tp == NULL, "already started");
+
+  blp->bl_tp = chThdCreateStatic(wsp, size, prio, bt_level_thread, blp);
+}
+
+/**
+ * @brief   Stops a basic tasks level.
+ * @details The pending activations are executed then the level thread
+ *          terminates, the function waits for the termination.
+ *
+ * @param[in] blp       pointer to a @p btask_level_t structure
+ *
+ * @api
+ */
+void chBTaskLevelStop(btask_level_t *blp) {
+  thread_t *tp;
+
+  chDbgCheck(blp != NULL);
+  chDbgAssert(blp->bl_tp != NULL, "not started");
+
+  tp = blp->bl_tp;
+  chThdTerminate(tp);
+  chSysLock();
+  chThdResumeI(&blp->bl_thread, MSG_OK);
+  chSchRescheduleS();
+  chSysUnlock();
+  (void)chThdWait(tp);
+  blp->bl_tp = NULL;
+}
+
+/**
+ * @brief   Resets the level statistics.
+ *
+ * @param[in] blp       pointer to a @p btask_level_t structure
+ *
+ * @api
+ */
+void chBTaskLevelResetStatistics(btask_level_t *blp) {
+
+  chDbgCheck(blp != NULL);
+
+  chSysLock();
+  blp->bl_stats.activations = 0;
+  blp->bl_stats.rejected    = 0;
+#if CH_CFG_USE_TM
+  chTMObjectInit(&blp->bl_stats.latency);
+#endif
+  chSysUnlock();
+}
+
+/**
+ * @brief   Initializes a @p btask_t object.
+ *
+ * @param[out] btp      pointer to a @p btask_t structure
+ * @param[in] blp       pointer to the @p btask_level_t the task belongs to
+ * @param[in] func      the task function
+ * @param[in] arg       the task function argument
+ * @param[in] maxact    maximum number of pending activations, one allows
+ *                      a single activation as the OSEK BCC1 class
+ *
+ * @init
+ */
+void chBTaskObjectInit(btask_t *btp, btask_level_t *blp,
+                       btaskfunc_t func, void *arg, cnt_t maxact) {
+
+  chDbgCheck((btp != NULL) && (blp != NULL) && (func != NULL) &&
+             (maxact > 0));
+
+  btp->bt_next        = NULL;
+  btp->bt_level       = blp;
+  btp->bt_func        = func;
+  btp->bt_arg         = arg;
+  btp->bt_activations = 0;
+  btp->bt_maxact      = maxact;
+}
+
+/**
+ * @brief   Activates a basic task.
+ * @details If the task is not pending then it is queued for execution
+ *          and the level thread is made ready, else the activation is
+ *          counted and the task is executed again after completing.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note
+ *          that interrupt handlers always reschedule on exit so an
+ *          explicit reschedule must not be performed in ISRs.
+ *
+ * @param[in] btp       pointer to a @p btask_t structure
+ * @return              The operation status.
+ * @retval false        if the activation has been accepted.
+ * @retval true         if the activations limit has been reached.
+ *
+ * @iclass
+ */
+bool chBTaskActivateI(btask_t *btp) {
+  btask_level_t *blp;
+
+  chDbgCheckClassI();
+  chDbgCheck(btp != NULL);
+
+  blp = btp->bt_level;
+  if (btp->bt_activations >= btp->bt_maxact) {
+    blp->bl_stats.rejected++;
+    return true;
+  }
+
+  blp->bl_stats.activations++;
+  if (btp->bt_activations++ == 0) {
+    bt_enqueue(btp);
+    chThdResumeI(&blp->bl_thread, MSG_OK);
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Activates a basic task.
+ * @details If the task is not pending then it is queued for execution
+ *          and the level thread is made ready, else the activation is
+ *          counted and the task is executed again after completing.
+ *
+ * @param[in] btp       pointer to a @p btask_t structure
+ * @return              The operation status.
+ * @retval false        if the activation has been accepted.
+ * @retval true         if the activations limit has been reached.
+ *
+ * @api
+ */
+bool chBTaskActivate(btask_t *btp) {
+  bool err;
+
+  chSysLock();
+  err = chBTaskActivateI(btp);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return err;
+}
+
+#endif /* CH_CFG_USE_BASIC_TASKS */
+
+/** @} */
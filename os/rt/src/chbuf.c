@@ -0,0 +1,563 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chbuf.c
+ * @brief   Packet Buffers code.
+ *
+ * @addtogroup buffers
+ * @details Reference counted packet buffers.
+ *          <h2>Operation mode</h2>
+ *          Packet buffers are allocated from a set of memory pools, one for
+ *          each size class, and carry headroom and tailroom so protocol
+ *          layers can add headers and trailers in place. Buffers can be
+ *          linked in chains representing a single packet, a chain can be
+ *          shared among several owners using the references counter and
+ *          split without copying the data.<br>
+ *          As in other packet buffer implementations the reference held
+ *          on the first buffer of a chain implicitly covers the following
+ *          buffers, releasing a chain stops at the first buffer still
+ *          referenced elsewhere.<br>
+ *          All the I-class functions can be used from ISRs, this allows a
+ *          driver to pass a buffer filled by DMA to the application without
+ *          copying it.
+ * @pre     In order to use the packet buffers APIs the @p CH_CFG_USE_BUFFERS
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+
+#if CH_CFG_USE_BUFFERS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Storage capacity of the buffers of a pool.
+ *
+ * @param[in] mp        pointer to the pool
+ * @return              The capacity in bytes.
+ */
+static size_t pool_capacity(memory_pool_t *mp) {
+
+  return mp->mp_object_size - sizeof(buffer_t);
+}
+
+/**
+ * @brief   Allocates a buffer from the smallest pool able to contain the
+ *          specified amount of bytes.
+ * @details Larger pools are used if the best fitting one is exhausted, if
+ *          no pool is large enough then a buffer from the largest pool is
+ *          returned.
+ *
+ * @param[in] bap       pointer to the allocator
+ * @param[in] size      required storage size
+ * @return              The buffer, not initialized.
+ * @retval NULL         if there are no available buffers.
+ */
+static buffer_t *buf_get(buffers_allocator_t *bap, size_t size) {
+  unsigned i;
+  buffer_t *bp;
+
+  for (i = 0; i < bap->ba_n; i++) {
+    if ((pool_capacity(&bap->ba_pools[i]) >= size) || (i == bap->ba_n - 1)) {
+      bp = chPoolAllocI(&bap->ba_pools[i]);
+      if (bp != NULL) {
+        bp->b_pool     = &bap->ba_pools[i];
+        bp->b_next     = NULL;
+        bp->b_owner    = NULL;
+        bp->b_base     = (uint8_t *)(bp + 1);
+        bp->b_capacity = pool_capacity(&bap->ba_pools[i]);
+        bp->b_refs     = 1;
+        bp->b_shares   = 0;
+        return bp;
+      }
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Disposes a buffer whose references counter reached zero.
+ * @details The buffer is returned to its pool unless its storage is still
+ *          referred by other buffers.
+ *
+ * @param[in] bp        pointer to the buffer
+ */
+static void buf_put(buffer_t *bp) {
+  buffer_t *op = bp->b_owner;
+
+  if ((op != NULL) && (--op->b_shares == 0) && (op->b_refs == 0))
+    chPoolFreeI(op->b_pool, op);
+  if (bp->b_shares == 0)
+    chPoolFreeI(bp->b_pool, bp);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a buffers allocator.
+ * @note    The pools must be initialized with an object size obtained
+ *          using @p CH_BUFFER_OBJECT_SIZE() and loaded with objects.
+ *
+ * @param[out] bap      pointer to a @p buffers_allocator_t structure
+ * @param[in] pools     array of pools ordered by increasing object size
+ * @param[in] n         number of pools in the array
+ *
+ * @init
+ */
+void chBufAllocatorObjectInit(buffers_allocator_t *bap,
+                              memory_pool_t *pools, unsigned n) {
+
+  chDbgCheck((bap != NULL) && (pools != NULL) && (n > 0));
+
+  bap->ba_pools = pools;
+  bap->ba_n     = n;
+}
+
+/**
+ * @brief   Allocates a buffer chain.
+ * @details The smallest buffers able to contain the data are chosen, if
+ *          the data does not fit a single buffer then a chain is built.
+ *          The headroom is reserved in the first buffer only.
+ *
+ * @param[in] bap       pointer to a @p buffers_allocator_t structure
+ * @param[in] size      size of the data
+ * @param[in] headroom  space to be reserved in front of the data, it
+ *                      must be smaller than the capacity of the largest
+ *                      buffers
+ * @return              The first buffer of the chain.
+ * @retval NULL         if there are not enough buffers or the headroom is
+ *                      too large.
+ *
+ * @iclass
+ */
+buffer_t *chBufAllocI(buffers_allocator_t *bap, size_t size,
+                      size_t headroom) {
+  buffer_t *head = NULL, *tail = NULL, *bp;
+
+  chDbgCheckClassI();
+  chDbgCheck(bap != NULL);
+
+  /* The headroom must fit in the first buffer whatever its size class.*/
+  if (headroom >= pool_capacity(&bap->ba_pools[bap->ba_n - 1]))
+    return NULL;
+
+  do {
+    bp = buf_get(bap, size + headroom);
+    if (bp == NULL) {
+      if (head != NULL)
+        chBufReleaseI(head);
+      return NULL;
+    }
+
+    bp->b_data = bp->b_base + headroom;
+    bp->b_size = bp->b_capacity - headroom;
+    if (bp->b_size > size)
+      bp->b_size = size;
+    size -= bp->b_size;
+    headroom = 0;
+
+    if (head == NULL)
+      head = bp;
+    else
+      tail->b_next = bp;
+    tail = bp;
+  } while (size > 0);
+
+  return head;
+}
+
+/**
+ * @brief   Allocates a buffer chain.
+ * @details The smallest buffers able to contain the data are chosen, if
+ *          the data does not fit a single buffer then a chain is built.
+ *          The headroom is reserved in the first buffer only.
+ *
+ * @param[in] bap       pointer to a @p buffers_allocator_t structure
+ * @param[in] size      size of the data
+ * @param[in] headroom  space to be reserved in front of the data, it
+ *                      must be smaller than the capacity of the largest
+ *                      buffers
+ * @return              The first buffer of the chain.
+ * @retval NULL         if there are not enough buffers or the headroom is
+ *                      too large.
+ *
+ * @api
+ */
+buffer_t *chBufAlloc(buffers_allocator_t *bap, size_t size,
+                     size_t headroom) {
+  buffer_t *bp;
+
+  chSysLock();
+  bp = chBufAllocI(bap, size, headroom);
+  chSysUnlock();
+  return bp;
+}
+
+/**
+ * @brief   Releases a reference to a buffer chain.
+ * @details The buffers whose references counter reaches zero are returned
+ *          to their pools, the scan of the chain stops at the first buffer
+ *          still referenced.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ *
+ * @iclass
+ */
+void chBufReleaseI(buffer_t *bp) {
+  buffer_t *next;
+
+  chDbgCheckClassI();
+
+  while (bp != NULL) {
+    chDbgAssert(bp->b_refs > 0, "not referenced");
+
+    if (--bp->b_refs > 0)
+      return;
+    next = bp->b_next;
+    buf_put(bp);
+    bp = next;
+  }
+}
+
+/**
+ * @brief   Releases a reference to a buffer chain.
+ * @details The buffers whose references counter reaches zero are returned
+ *          to their pools, the scan of the chain stops at the first buffer
+ *          still referenced.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ *
+ * @api
+ */
+void chBufRelease(buffer_t *bp) {
+
+  chSysLock();
+  chBufReleaseI(bp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Prepends space to the buffer data using the headroom.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] n         number of bytes to prepend
+ * @return              Pointer to the new start of the data.
+ * @retval NULL         if there is not enough headroom.
+ *
+ * @xclass
+ */
+uint8_t *chBufPushHeader(buffer_t *bp, size_t n) {
+
+  chDbgCheck(bp != NULL);
+
+  if (n > chBufGetHeadroomX(bp))
+    return NULL;
+  bp->b_data -= n;
+  bp->b_size += n;
+  return bp->b_data;
+}
+
+/**
+ * @brief   Removes bytes from the start of the buffer data.
+ * @details The removed space becomes headroom.
+ *
+ * @param[in] bp        pointer to the buffer
+ * @param[in] n         number of bytes to remove
+ * @return              Pointer to the new start of the data.
+ * @retval NULL         if the buffer contains less than @p n bytes.
+ *
+ * @xclass
+ */
+uint8_t *chBufPullHeader(buffer_t *bp, size_t n) {
+
+  chDbgCheck(bp != NULL);
+
+  if (n > bp->b_size)
+    return NULL;
+  bp->b_data += n;
+  bp->b_size -= n;
+  return bp->b_data;
+}
+
+/**
+ * @brief   Appends space to the data of the last buffer of a chain using
+ *          its tailroom.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @param[in] n         number of bytes to append
+ * @return              Pointer to the appended space.
+ * @retval NULL         if there is not enough tailroom.
+ *
+ * @xclass
+ */
+uint8_t *chBufPutTail(buffer_t *bp, size_t n) {
+  uint8_t *p;
+
+  chDbgCheck(bp != NULL);
+
+  while (bp->b_next != NULL)
+    bp = bp->b_next;
+  if (n > chBufGetTailroomX(bp))
+    return NULL;
+  p = bp->b_data + bp->b_size;
+  bp->b_size += n;
+  return p;
+}
+
+/**
+ * @brief   Returns the total data size of a buffer chain.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @return              The data size.
+ *
+ * @xclass
+ */
+size_t chBufLength(buffer_t *bp) {
+  size_t n = 0;
+
+  while (bp != NULL) {
+    n += bp->b_size;
+    bp = bp->b_next;
+  }
+  return n;
+}
+
+/**
+ * @brief   Appends a buffer chain to another chain.
+ * @details The reference to the appended chain is transferred to the
+ *          first chain.
+ *
+ * @param[in] head      pointer to the first buffer of the first chain
+ * @param[in] tail      pointer to the first buffer of the appended chain
+ *
+ * @xclass
+ */
+void chBufCat(buffer_t *head, buffer_t *tail) {
+
+  chDbgCheck((head != NULL) && (tail != NULL));
+
+  while (head->b_next != NULL)
+    head = head->b_next;
+  head->b_next = tail;
+}
+
+/**
+ * @brief   Reduces the data size of a buffer chain.
+ * @details The buffers exceeding the new size are removed from the chain
+ *          and released.
+ * @note    If the chain is shorter than @p length then nothing is done.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @param[in] length    new data size
+ *
+ * @api
+ */
+void chBufTrim(buffer_t *bp, size_t length) {
+  buffer_t *rest;
+
+  chDbgCheck(bp != NULL);
+
+  if (length > chBufLength(bp))
+    return;
+
+  while (length > bp->b_size) {
+    length -= bp->b_size;
+    bp = bp->b_next;
+  }
+  bp->b_size = length;
+  rest = bp->b_next;
+  bp->b_next = NULL;
+  if (rest != NULL)
+    chBufRelease(rest);
+}
+
+/**
+ * @brief   Splits a buffer chain in two chains.
+ * @details If the split point falls inside a buffer then a new buffer
+ *          header is allocated that refers to the second part of the data,
+ *          the data itself is not copied.
+ * @note    The first buffer header of the allocator smallest pool is used
+ *          for the new buffer header, all pools are suitable.
+ *
+ * @param[in] bap       pointer to a @p buffers_allocator_t structure
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @param[in] offset    split offset, it must be greater than zero and lower
+ *                      than the chain data size
+ * @return              The first buffer of the second chain, the caller
+ *                      owns the reference.
+ * @retval NULL         if a buffer header could not be allocated, the
+ *                      chain is not modified.
+ *
+ * @api
+ */
+buffer_t *chBufSplit(buffers_allocator_t *bap, buffer_t *bp, size_t offset) {
+  buffer_t *rp, *op;
+  unsigned i;
+
+  chDbgCheck((bap != NULL) && (bp != NULL) && (offset > 0));
+
+  while (offset > bp->b_size) {
+    offset -= bp->b_size;
+    bp = bp->b_next;
+    chDbgAssert(bp != NULL, "offset out of range");
+  }
+
+  /* Split on a buffer boundary, the chain is simply cut.*/
+  if (offset == bp->b_size) {
+    rp = bp->b_next;
+    chDbgAssert(rp != NULL, "offset out of range");
+    bp->b_next = NULL;
+    return rp;
+  }
+
+  /* Split inside a buffer, the new header refers to the storage of the
+     buffer owning the data.*/
+  chSysLock();
+  rp = NULL;
+  for (i = 0; (i < bap->ba_n) && (rp == NULL); i++)
+    rp = chPoolAllocI(&bap->ba_pools[i]);
+  if (rp == NULL) {
+    chSysUnlock();
+    return NULL;
+  }
+  op = bp->b_owner != NULL ? bp->b_owner : bp;
+  op->b_shares++;
+  chSysUnlock();
+
+  rp->b_pool     = &bap->ba_pools[i - 1];
+  rp->b_next     = bp->b_next;
+  rp->b_owner    = op;
+  rp->b_base     = bp->b_data + offset;
+  rp->b_data     = rp->b_base;
+  rp->b_size     = bp->b_size - offset;
+  rp->b_capacity = rp->b_size;
+  rp->b_refs     = 1;
+  rp->b_shares   = 0;
+
+  /* The first part loses its tailroom because now shared.*/
+  bp->b_capacity = chBufGetHeadroomX(bp) + offset;
+  bp->b_size     = offset;
+  bp->b_next     = NULL;
+  return rp;
+}
+
+/**
+ * @brief   Copies data out of a buffer chain.
+ *
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @param[in] offset    offset of the first byte to be copied
+ * @param[out] dp       pointer to the destination area
+ * @param[in] n         number of bytes to be copied
+ * @return              The number of bytes copied, it is lower than @p n
+ *                      if the end of the chain is reached.
+ *
+ * @xclass
+ */
+size_t chBufCopyOut(buffer_t *bp, size_t offset, uint8_t *dp, size_t n) {
+  size_t copied = 0, chunk;
+
+  while ((bp != NULL) && (offset >= bp->b_size)) {
+    offset -= bp->b_size;
+    bp = bp->b_next;
+  }
+  while ((bp != NULL) && (n > 0)) {
+    chunk = bp->b_size - offset;
+    if (chunk > n)
+      chunk = n;
+    memcpy(dp, bp->b_data + offset, chunk);
+    dp += chunk;
+    copied += chunk;
+    n -= chunk;
+    offset = 0;
+    bp = bp->b_next;
+  }
+  return copied;
+}
+
+/**
+ * @brief   Makes the data of a buffer chain contiguous.
+ * @details If the chain is made of a single buffer then it is returned
+ *          unchanged, else the data is copied into a new buffer preserving
+ *          the headroom when possible and the reference to the original
+ *          chain is released.
+ *
+ * @param[in] bap       pointer to a @p buffers_allocator_t structure
+ * @param[in] bp        pointer to the first buffer of the chain
+ * @return              The buffer containing the whole data.
+ * @retval NULL         if a buffer large enough is not available, the
+ *                      original chain is not released.
+ *
+ * @api
+ */
+buffer_t *chBufLinearize(buffers_allocator_t *bap, buffer_t *bp) {
+  buffer_t *np;
+  size_t length, headroom;
+
+  chDbgCheck((bap != NULL) && (bp != NULL));
+
+  if (bp->b_next == NULL)
+    return bp;
+
+  length = chBufLength(bp);
+  headroom = chBufGetHeadroomX(bp);
+
+  chSysLock();
+  np = buf_get(bap, length + headroom);
+  if ((np != NULL) && (np->b_capacity < length)) {
+    chPoolFreeI(np->b_pool, np);
+    np = NULL;
+  }
+  chSysUnlock();
+  if (np == NULL)
+    return NULL;
+
+  if (headroom > np->b_capacity - length)
+    headroom = np->b_capacity - length;
+  np->b_data = np->b_base + headroom;
+  np->b_size = chBufCopyOut(bp, 0, np->b_data, length);
+
+  chBufRelease(bp);
+  return np;
+}
+
+#endif /* CH_CFG_USE_BUFFERS */
+
+/** @} */
@@ -33,6 +33,16 @@
  *          The condition variable is a synchronization object meant to be
  *          used inside a zone protected by a mutex. Mutexes and condition
  *          variables together can implement a Monitor construct.
+ *          <h2>Wait morphing</h2>
+ *          A broadcast does not resume the waiting threads, the threads are
+ *          moved on the queue of the mutex and resumed one at time by the
+ *          mutex unlock operations, the priority inheritance is applied to
+ *          the mutex owner. Threads waiting with a timeout are resumed
+ *          normally.<br>
+ *          The morphing requires all the threads waiting at the same time
+ *          on a condition variable to use the same mutex, if different
+ *          mutexes are used then a broadcast resumes the threads normally
+ *          until the condition variable queue is emptied.
  * @pre     In order to use the condition variable APIs the @p CH_CFG_USE_CONDVARS
  *          option must be enabled in @p chconf.h.
  * @{
@@ -62,6 +72,23 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Records the mutex used by a thread entering the queue.
+ * @details If the waiting threads use different mutexes then the recorded
+ *          mutex is cleared, this disables the wait morphing until the
+ *          queue is emptied.
+ *
+ * @param[in] cp        pointer to the @p condition_variable_t structure
+ * @param[in] mp        pointer to the mutex released by the thread
+ */
+static void cond_set_mutex(condition_variable_t *cp, mutex_t *mp) {
+
+  if (queue_isempty(&cp->c_queue))
+    cp->c_mutex = mp;
+  else if (cp->c_mutex != mp)
+    cp->c_mutex = NULL;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -78,6 +105,7 @@ void chCondObjectInit(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   queue_init(&cp->c_queue);
+  cp->c_mutex = NULL;
 }
 
 /**
@@ -147,15 +175,23 @@ void chCondBroadcast(condition_variable_t *cp) {
  * @iclass
  */
 void chCondBroadcastI(condition_variable_t *cp) {
+  mutex_t *mp = cp->c_mutex;
 
   chDbgCheckClassI();
   chDbgCheck(cp != NULL);
 
-  /* Empties the condition variable queue and inserts all the threads into the
-     ready list in FIFO order. The wakeup message is set to @p MSG_RESET in
-     order to make a chCondBroadcast() detectable from a chCondSignal().*/
-  while (cp->c_queue.p_next != (void *)&cp->c_queue)
-    chSchReadyI(queue_fifo_remove(&cp->c_queue))->p_u.rdymsg = MSG_RESET;
+  /* Empties the condition variable queue and moves all the threads on the
+     mutex queue in FIFO order. Threads waiting with a timeout or using
+     different mutexes are inserted into the ready list instead, the wakeup
+     message is set to @p MSG_RESET in order to make a chCondBroadcast()
+     detectable from a chCondSignal().*/
+  while (cp->c_queue.p_next != (void *)&cp->c_queue) {
+    thread_t *tp = queue_fifo_remove(&cp->c_queue);
+    if ((mp == NULL) || ((tp->p_flags & CH_FLAG_CVTIMEOUT) != 0))
+      chSchReadyI(tp)->p_u.rdymsg = MSG_RESET;
+    else
+      _mtx_morph_i(mp, tp);
+  }
 }
 
 /**
@@ -164,6 +200,9 @@ void chCondBroadcastI(condition_variable_t *cp) {
  *          variable, and finally acquires the mutex again. All the sequence
  *          is performed atomically.
  * @pre     The invoking thread <b>must</b> have at least one owned mutex.
+ * @note    A broadcast moves the waiting threads on the mutex queue only if
+ *          all of them use the same mutex, else the threads are resumed and
+ *          compete for their mutexes.
  *
  * @param[in] cp        pointer to the @p condition_variable_t structure
  * @return              A message specifying how the invoking thread has been
@@ -190,6 +229,9 @@ msg_t chCondWait(condition_variable_t *cp) {
  *          variable, and finally acquires the mutex again. All the sequence
  *          is performed atomically.
  * @pre     The invoking thread <b>must</b> have at least one owned mutex.
+ * @note    A broadcast moves the waiting threads on the mutex queue only if
+ *          all of them use the same mutex, else the threads are resumed and
+ *          compete for their mutexes.
  *
  * @param[in] cp        pointer to the @p condition_variable_t structure
  * @return              A message specifying how the invoking thread has been
@@ -211,10 +253,16 @@ msg_t chCondWaitS(condition_variable_t *cp) {
   chDbgAssert(ctp->p_mtxlist != NULL, "not owning a mutex");
 
   mp = chMtxGetNextMutexS();
+  cond_set_mutex(cp, mp);
   chMtxUnlockS(mp);
   ctp->p_u.wtobjp = cp;
   queue_prio_insert(ctp, &cp->c_queue);
   chSchGoSleepS(CH_STATE_WTCOND);
+
+  /* After a broadcast the mutex has already been acquired on behalf of
+     this thread.*/
+  if (_mtx_get_owner(mp) == ctp)
+    return MSG_RESET;
   msg = ctp->p_u.rdymsg;
   chMtxLockS(mp);
   return msg;
@@ -295,10 +343,16 @@ msg_t chCondWaitTimeoutS(condition_variable_t *cp, systime_t time) {
   chDbgAssert(currp->p_mtxlist != NULL, "not owning a mutex");
 
   mp = chMtxGetNextMutexS();
+  cond_set_mutex(cp, mp);
   chMtxUnlockS(mp);
   currp->p_u.wtobjp = cp;
   queue_prio_insert(currp, &cp->c_queue);
+
+  /* Threads waiting with a timeout are excluded from the wait morphing
+     because the timeout could expire while queued on the mutex.*/
+  currp->p_flags |= CH_FLAG_CVTIMEOUT;
   msg = chSchGoSleepTimeoutS(CH_STATE_WTCOND, time);
+  currp->p_flags &= ~CH_FLAG_CVTIMEOUT;
   if (msg != MSG_TIMEOUT)
     chMtxLockS(mp);
   return msg;
@@ -0,0 +1,364 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chcoop.c
+ * @brief   Cooperative tasks code.
+ *
+ * @addtogroup coop_tasks
+ * @details Stackless cooperative tasks executed by a single thread.
+ *          <h2>Operation mode</h2>
+ *          A cooperative task is a function re-entered each time the task
+ *          is resumed, the resume point is recorded in the task object so
+ *          a task costs a few words of RAM instead of a thread working
+ *          area. The technique is the same of the protothreads, the task
+ *          body is enclosed in @p COOP_BEGIN() and @p COOP_END() and
+ *          can be suspended only at its top level using the @p COOP_xxx
+ *          macros.<br>
+ *          A scheduler executes its tasks from the thread invoking
+ *          @p chCoopRun(), the tasks can yield, sleep or wait on
+ *          semaphores, mailboxes, I/O queues and event sources with an
+ *          optional timeout. While no task is ready the scheduler thread
+ *          waits on all the objects at once using the
+ *          @ref mwait service.<br>
+ *          Event sources are level triggered, each task waiting on a
+ *          source has its own listener accumulating the broadcast flags,
+ *          so broadcasts happening while the scheduler thread is
+ *          executing other tasks are not lost.
+ * @note    Tasks must never invoke blocking kernel functions, all the tasks
+ *          of the scheduler would be blocked.
+ * @pre     In order to use the cooperative tasks APIs the
+ *          @p CH_CFG_USE_COOP option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_COOP || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @brief   Unregisters the event listener of a task, if any.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ */
+static void coop_unregister(coop_task_t *ctp) {
+
+  if (ctp->ct_esp != NULL) {
+    chEvtUnregister(ctp->ct_esp, &ctp->ct_listener);
+    ctp->ct_esp = NULL;
+  }
+}
+#endif
+
+/**
+ * @brief   Makes ready a task whose wait object has been acquired.
+ * @details For event sources the flags latched by the listener of the
+ *          task are returned, the broadcast that ended the wait is
+ *          included.
+ *
+ * @param[in] ctp       pointer to the @p coop_task_t object
+ * @param[in] wop       pointer to the acquired wait object
+ */
+static void coop_ready_i(coop_task_t *ctp, wait_object_t *wop) {
+
+#if CH_CFG_USE_EVENTS
+  if (wop->wo_type == MWAIT_EVENT_SOURCE)
+    ctp->ct_wobj.wo_msg = (msg_t)chEvtGetAndClearFlagsI(&ctp->ct_listener);
+  else
+#endif
+    ctp->ct_wobj.wo_msg = wop->wo_msg;
+  ctp->ct_msg   = MSG_OK;
+  ctp->ct_state = COOP_STATE_READY;
+}
+
+/**
+ * @brief   Executes the ready tasks.
+ * @details Terminated tasks are removed from the scheduler.
+ *
+ * @param[in] csp       pointer to a @p coop_scheduler_t structure
+ */
+static void coop_execute(coop_scheduler_t *csp) {
+  coop_task_t *ctp, **ctpp;
+
+  ctpp = &csp->cs_tasks;
+  while ((ctp = *ctpp) != NULL) {
+    if (ctp->ct_state == COOP_STATE_READY)
+      ctp->ct_func(ctp);
+    if (ctp->ct_state == COOP_STATE_FINAL) {
+#if CH_CFG_USE_EVENTS
+      coop_unregister(ctp);
+#endif
+      *ctpp = ctp->ct_next;
+      csp->cs_ntasks--;
+      continue;
+    }
+    ctpp = &ctp->ct_next;
+  }
+}
+
+/**
+ * @brief   Collects the objects the tasks are waiting on.
+ *
+ * @param[in] csp       pointer to a @p coop_scheduler_t structure
+ * @param[out] timep    the time until the nearest deadline, zero if a task
+ *                      is ready or a deadline already expired
+ * @return              The number of collected objects.
+ */
+static cnt_t coop_collect(coop_scheduler_t *csp, systime_t *timep) {
+  coop_task_t *ctp;
+  systime_t time = TIME_INFINITE;
+  cnt_t n = 0;
+
+  for (ctp = csp->cs_tasks; ctp != NULL; ctp = ctp->ct_next) {
+    if (ctp->ct_state == COOP_STATE_READY) {
+      time = TIME_IMMEDIATE;
+      continue;
+    }
+    if (ctp->ct_timed && (time != TIME_IMMEDIATE)) {
+      systime_t t = chVTTimeUntilX(ctp->ct_deadline);
+
+      if (t < time)
+        time = t;
+    }
+    if (ctp->ct_wobj.wo_objp != NULL) {
+      csp->cs_wait[n]    = ctp->ct_wobj;
+      csp->cs_waiting[n] = ctp;
+      n++;
+    }
+  }
+  *timep = time;
+  return n;
+}
+
+/**
+ * @brief   Makes ready the tasks whose deadline expired.
+ *
+ * @param[in] csp       pointer to a @p coop_scheduler_t structure
+ */
+static void coop_timeouts(coop_scheduler_t *csp) {
+  coop_task_t *ctp;
+
+  for (ctp = csp->cs_tasks; ctp != NULL; ctp = ctp->ct_next) {
+    if ((ctp->ct_state == COOP_STATE_WAITING) && ctp->ct_timed &&
+        (chVTTimeUntilX(ctp->ct_deadline) == TIME_IMMEDIATE)) {
+      ctp->ct_msg   = MSG_TIMEOUT;
+      ctp->ct_state = COOP_STATE_READY;
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Suspends a task on a wait object.
+ * @note    Internal use only, the @p COOP_WAIT() macro should be used
+ *          instead.
+ *
+ * @param[in] ctp       pointer to a @p coop_task_t structure
+ * @param[in] type      the wait object type
+ * @param[in] objp      pointer to the object or @p NULL for a plain delay
+ * @param[in] msg       the data to be exchanged with the object
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ *
+ * @notapi
+ */
+void _coop_wait(coop_task_t *ctp, uint8_t type, void *objp,
+                msg_t msg, systime_t time) {
+
+  chDbgCheck((objp != NULL) || (time != TIME_INFINITE));
+
+#if CH_CFG_USE_EVENTS
+  /* The listener has no events mask, the broadcasts only latch flags and
+     do not affect the events of the scheduler thread.*/
+  if ((type == MWAIT_EVENT_SOURCE) && (objp != (void *)ctp->ct_esp)) {
+    coop_unregister(ctp);
+    chEvtRegisterMask((event_source_t *)objp, &ctp->ct_listener, 0);
+    ctp->ct_esp = (event_source_t *)objp;
+  }
+#endif
+
+  ctp->ct_wobj.wo_type = type;
+  ctp->ct_wobj.wo_objp = objp;
+  ctp->ct_wobj.wo_msg  = msg;
+  ctp->ct_timed        = (bool)(time != TIME_INFINITE);
+  ctp->ct_deadline     = chVTGetSystemTimeX() + time;
+  ctp->ct_state        = COOP_STATE_WAITING;
+}
+
+/**
+ * @brief   Initializes a @p coop_scheduler_t object.
+ *
+ * @param[out] csp      pointer to a @p coop_scheduler_t structure
+ * @param[in] wop       pointer to an array of @p n wait objects
+ * @param[in] tpp       pointer to an array of @p n tasks pointers
+ * @param[in] n         maximum number of tasks
+ *
+ * @init
+ */
+void chCoopObjectInit(coop_scheduler_t *csp, wait_object_t *wop,
+                      coop_task_t **tpp, cnt_t n) {
+
+  chDbgCheck((csp != NULL) && (wop != NULL) && (tpp != NULL) && (n > 0));
+
+  csp->cs_tasks   = NULL;
+  csp->cs_ntasks  = 0;
+  csp->cs_size    = n;
+  csp->cs_wait    = wop;
+  csp->cs_waiting = tpp;
+}
+
+/**
+ * @brief   Adds a task to a scheduler.
+ * @details The task is appended to the tasks list and is executed in the
+ *          next scheduler round.
+ * @note    This function must be called before @p chCoopRun() or from a
+ *          task of the same scheduler.
+ *
+ * @param[in] csp       pointer to a @p coop_scheduler_t structure
+ * @param[out] ctp      pointer to a @p coop_task_t structure
+ * @param[in] func      the task function
+ * @param[in] arg       the task function argument
+ *
+ * @api
+ */
+void chCoopTaskStart(coop_scheduler_t *csp, coop_task_t *ctp,
+                     coopfunc_t func, void *arg) {
+  coop_task_t **ctpp;
+
+  chDbgCheck((csp != NULL) && (ctp != NULL) && (func != NULL));
+  chDbgAssert(csp->cs_ntasks < csp->cs_size, "too many tasks");
+
+  ctp->ct_next  = NULL;
+  ctp->ct_func  = func;
+  ctp->ct_arg   = arg;
+  ctp->ct_line  = 0;
+  ctp->ct_state = COOP_STATE_READY;
+  ctp->ct_timed = false;
+  ctp->ct_msg   = MSG_OK;
+  ctp->ct_wobj.wo_objp = NULL;
+#if CH_CFG_USE_EVENTS
+  ctp->ct_esp   = NULL;
+#endif
+
+  ctpp = &csp->cs_tasks;
+  while (*ctpp != NULL)
+    ctpp = &(*ctpp)->ct_next;
+  *ctpp = ctp;
+  csp->cs_ntasks++;
+}
+
+/**
+ * @brief   Executes the tasks of a scheduler.
+ * @details Ready tasks are executed in rounds, in the order they have been
+ *          added. When no task is ready the invoking thread waits until
+ *          one of the objects the tasks are waiting on becomes ready or
+ *          the nearest deadline expires.
+ * @note    The function returns when all the tasks are terminated.
+ *
+ * @param[in] csp       pointer to a @p coop_scheduler_t structure
+ *
+ * @api
+ */
+void chCoopRun(coop_scheduler_t *csp) {
+
+  chDbgCheck(csp != NULL);
+
+  while (true) {
+    systime_t time;
+    cnt_t n;
+    msg_t i;
+
+    coop_execute(csp);
+    if (csp->cs_tasks == NULL)
+      return;
+
+    n = coop_collect(csp, &time);
+    chDbgAssert((n > 0) || (time != TIME_INFINITE), "tasks deadlock");
+
+    chSysLock();
+#if CH_CFG_USE_EVENTS
+    /* Event sources are never ready for the multiple wait, the flags
+       latched while the tasks were executed are acquired here.*/
+    i = 0;
+    while (i < (msg_t)n) {
+      coop_task_t *ctp = csp->cs_waiting[i];
+
+      if ((csp->cs_wait[i].wo_type != MWAIT_EVENT_SOURCE) ||
+          (ctp->ct_listener.el_flags == 0)) {
+        i++;
+        continue;
+      }
+      coop_ready_i(ctp, &csp->cs_wait[i]);
+      n--;
+      csp->cs_wait[i]    = csp->cs_wait[n];
+      csp->cs_waiting[i] = csp->cs_waiting[n];
+      time = TIME_IMMEDIATE;
+    }
+#endif
+    if (n == 0) {
+      if (time != TIME_IMMEDIATE)
+        chThdSleepS(time);
+    }
+    else {
+      /* All the objects already ready are acquired, the wait is performed
+         only for the first one.*/
+      while ((i = chMWaitTimeoutS(csp->cs_wait, n, time)) != MSG_TIMEOUT) {
+        coop_ready_i(csp->cs_waiting[i], &csp->cs_wait[i]);
+        n--;
+        if (n == 0)
+          break;
+        csp->cs_wait[i]    = csp->cs_wait[n];
+        csp->cs_waiting[i] = csp->cs_waiting[n];
+        time = TIME_IMMEDIATE;
+      }
+    }
+    chSysUnlock();
+
+    coop_timeouts(csp);
+  }
+}
+
+#endif /* CH_CFG_USE_COOP */
+
+/** @} */
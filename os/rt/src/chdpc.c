@@ -0,0 +1,282 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chdpc.c
+ * @brief   Deferred procedure calls code.
+ *
+ * @addtogroup dpc
+ * @details Deferred procedure calls, also known as bottom halves.
+ *          <h2>Operation mode</h2>
+ *          An ISR should do the minimum required to serve the hardware and
+ *          leave the rest of the work to a deferred procedure call, a DPC
+ *          is a function and its argument queued from the ISR and
+ *          executed later with interrupts enabled.<br>
+ *          Pending DPCs are executed in FIFO order by a dispatcher thread
+ *          created by @p chSysInit() at @p CH_CFG_DPC_PRIORITY, by default
+ *          @p HIGHPRIO, application threads should have lower priorities
+ *          so DPCs preempt them. Queuing a DPC from an ISR
+ *          makes the dispatcher ready so the switch happens in the ISR
+ *          epilogue, the DPC runs before any preempted thread is resumed.
+ *          <br>
+ *          A DPC queued again while still pending is not queued twice, the
+ *          requests are coalesced and the function is invoked once, the
+ *          function is responsible for serving all the work accumulated
+ *          since the first request.
+ * @note    DPC functions are executed in thread context but must never
+ *          block or wait, pending DPCs would be delayed.
+ * @pre     In order to use the DPC APIs the @p CH_CFG_USE_DPC option must
+ *          be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_DPC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Pending deferred procedure calls queue.
+ */
+dpc_queue_t ch_dpc;
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Dispatcher thread working area.
+ */
+static THD_WORKING_AREA(dpc_thread_wa, CH_CFG_DPC_STACK_SIZE);
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Dispatcher thread.
+ * @details Executes the pending DPCs, the thread is suspended while the
+ *          queue is empty.
+ *
+ * @param[in] p         the thread parameter, unused
+ */
+static void dpc_thread(void *p) {
+  dpc_t *dp;
+  dpcfunc_t func;
+  void *arg;
+
+  (void)p;
+  chRegSetThreadName("dpc");
+
+  chSysLock();
+  while (true) {
+    dp = ch_dpc.dq_head;
+    if (dp == NULL) {
+      chThdSuspendS(&ch_dpc.dq_thread);
+      continue;
+    }
+
+    /* The DPC is removed from the queue before invoking the function so
+       it can be queued again while executing.*/
+    ch_dpc.dq_head = dp->d_next;
+    dp->d_pending  = false;
+#if CH_CFG_USE_TM
+    chTMStopMeasurementSinceX(&ch_dpc.dq_stats.latency, dp->d_time);
+#endif
+    func = dp->d_func;
+    arg  = dp->d_arg;
+    chSysUnlock();
+
+    func(arg);
+
+    chSysLock();
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Deferred procedure calls initialization.
+ * @details The dispatcher thread is created.
+ * @note    Internal use only, invoked by @p chSysInit() after the main
+ *          thread has been initialized.
+ *
+ * @notapi
+ */
+void _dpc_init(void) {
+
+  ch_dpc.dq_head   = NULL;
+  ch_dpc.dq_tail   = NULL;
+  ch_dpc.dq_thread = NULL;
+  chDpcResetStatistics();
+  chThdCreateStatic(dpc_thread_wa, sizeof(dpc_thread_wa),
+                    CH_CFG_DPC_PRIORITY, (tfunc_t)dpc_thread, NULL);
+}
+
+/**
+ * @brief   Initializes a @p dpc_t object.
+ *
+ * @param[out] dp       pointer to a @p dpc_t structure
+ * @param[in] func      the DPC function
+ * @param[in] arg       the DPC function argument
+ *
+ * @init
+ */
+void chDpcObjectInit(dpc_t *dp, dpcfunc_t func, void *arg) {
+
+  chDbgCheck((dp != NULL) && (func != NULL));
+
+  dp->d_next    = NULL;
+  dp->d_func    = func;
+  dp->d_arg     = arg;
+  dp->d_pending = false;
+}
+
+/**
+ * @brief   Queues a DPC.
+ * @details The DPC is appended to the pending queue and the dispatcher
+ *          thread is made ready. If the DPC is already pending then the
+ *          request is coalesced with the pending one.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note
+ *          that interrupt handlers always reschedule on exit so an
+ *          explicit reschedule must not be performed in ISRs.
+ *
+ * @param[in] dp        pointer to a @p dpc_t structure
+ * @return              The coalescing state.
+ * @retval false        if the DPC has been queued.
+ * @retval true         if the DPC was already pending.
+ *
+ * @iclass
+ */
+bool chDpcQueueI(dpc_t *dp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(dp != NULL);
+
+  ch_dpc.dq_stats.queued++;
+  if (dp->d_pending) {
+    ch_dpc.dq_stats.coalesced++;
+    return true;
+  }
+
+  dp->d_next    = NULL;
+  dp->d_pending = true;
+#if CH_CFG_USE_TM
+  dp->d_time    = chSysGetRealtimeCounterX();
+#endif
+  if (ch_dpc.dq_head == NULL)
+    ch_dpc.dq_head = dp;
+  else
+    ch_dpc.dq_tail->d_next = dp;
+  ch_dpc.dq_tail = dp;
+
+  chThdResumeI(&ch_dpc.dq_thread, MSG_OK);
+
+  return false;
+}
+
+/**
+ * @brief   Queues a DPC.
+ * @details The DPC is appended to the pending queue and the dispatcher
+ *          thread is made ready. If the DPC is already pending then the
+ *          request is coalesced with the pending one.
+ *
+ * @param[in] dp        pointer to a @p dpc_t structure
+ * @return              The coalescing state.
+ * @retval false        if the DPC has been queued.
+ * @retval true         if the DPC was already pending.
+ *
+ * @api
+ */
+bool chDpcQueue(dpc_t *dp) {
+  bool coalesced;
+
+  chSysLock();
+  coalesced = chDpcQueueI(dp);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return coalesced;
+}
+
+/**
+ * @brief   Removes a pending DPC from the queue.
+ * @note    A DPC already being executed is not affected.
+ *
+ * @param[in] dp        pointer to a @p dpc_t structure
+ * @return              The operation result.
+ * @retval false        if the DPC was not pending.
+ * @retval true         if the DPC has been removed from the queue.
+ *
+ * @iclass
+ */
+bool chDpcCancelI(dpc_t *dp) {
+  dpc_t **dpp, *prev;
+
+  chDbgCheckClassI();
+  chDbgCheck(dp != NULL);
+
+  if (!dp->d_pending)
+    return false;
+
+  prev = NULL;
+  dpp  = &ch_dpc.dq_head;
+  while (*dpp != dp) {
+    prev = *dpp;
+    dpp  = &prev->d_next;
+  }
+  *dpp = dp->d_next;
+  if (ch_dpc.dq_tail == dp)
+    ch_dpc.dq_tail = prev;
+  dp->d_pending = false;
+
+  return true;
+}
+
+/**
+ * @brief   Resets the DPCs statistics.
+ *
+ * @api
+ */
+void chDpcResetStatistics(void) {
+
+  chSysLock();
+  ch_dpc.dq_stats.queued    = 0;
+  ch_dpc.dq_stats.coalesced = 0;
+#if CH_CFG_USE_TM
+  chTMObjectInit(&ch_dpc.dq_stats.latency);
+#endif
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_DPC */
+
+/** @} */
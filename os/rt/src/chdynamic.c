@@ -24,6 +24,17 @@
  *
  * @addtogroup dynamic_threads
  * @details Dynamic threads related APIs and services.
+ *          <h2>Working areas cache</h2>
+ *          When @p CH_CFG_DYNAMIC_CACHE_SIZE is greater than zero the
+ *          working areas of terminated threads allocated from the default
+ *          heap are not freed but kept in a cache, up to the configured
+ *          number. @p chThdCreateFromHeap() looks for a cached working
+ *          area of the same size before allocating from the heap, this
+ *          saves the heap walk and reduces the fragmentation caused by
+ *          short-lived threads. Cached working areas are cleaned and
+ *          refilled only when reused.
+ * @note    Cached working areas are still allocated from the heap point of
+ *          view, @p chThdCacheFlush() returns them to the heap.
  * @{
  */
 
@@ -39,10 +50,28 @@
 /* Module exported variables.                                                */
 /*===========================================================================*/
 
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Terminated threads working areas cache.
+ */
+thread_cache_t ch_thdcache;
+#endif
+
 /*===========================================================================*/
 /* Module local types.                                                       */
 /*===========================================================================*/
 
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Cached working area header.
+ * @details The header overlaps the @p thread_t structure of the terminated
+ *          thread.
+ */
+struct thread_cache_entry {
+  struct thread_cache_entry *next;      /**< @brief Next cached area.       */
+};
+#endif
+
 /*===========================================================================*/
 /* Module local variables.                                                   */
 /*===========================================================================*/
@@ -51,6 +80,71 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Takes a working area from the cache.
+ * @details A cached working area is reused if it is the same block the
+ *          heap would return for the requested size.
+ *
+ * @param[in] size      size of the working area
+ * @return              The working area.
+ * @retval NULL         if there is no cached working area of that size.
+ */
+static void *thd_cache_get(size_t size) {
+  struct thread_cache_entry *ep, **epp;
+
+  size = MEM_ALIGN_NEXT(size);
+
+  chSysLock();
+  epp = &ch_thdcache.tc_head;
+  while ((ep = *epp) != NULL) {
+    size_t bsize = chHeapGetSize(ep);
+
+    if ((bsize >= size) && (bsize < size + sizeof(union heap_header))) {
+      *epp = ep->next;
+      ch_thdcache.tc_count--;
+      ch_thdcache.tc_stats.hits++;
+      chSysUnlock();
+      return ep;
+    }
+    epp = &ep->next;
+  }
+  ch_thdcache.tc_stats.misses++;
+  chSysUnlock();
+
+  return NULL;
+}
+
+/**
+ * @brief   Puts the working area of a terminated thread in the cache.
+ *
+ * @param[in] wsp       pointer to the working area
+ * @return              The operation status.
+ * @retval false        if the working area has been cached.
+ * @retval true         if the working area must be freed.
+ */
+static bool thd_cache_put(void *wsp) {
+  struct thread_cache_entry *ep = (struct thread_cache_entry *)wsp;
+
+  if (chHeapGetOwnerX(wsp) != NULL)
+    return true;
+
+  chSysLock();
+  if (ch_thdcache.tc_count >= CH_CFG_DYNAMIC_CACHE_SIZE) {
+    ch_thdcache.tc_stats.discarded++;
+    chSysUnlock();
+    return true;
+  }
+  ep->next = ch_thdcache.tc_head;
+  ch_thdcache.tc_head = ep;
+  ch_thdcache.tc_count++;
+  ch_thdcache.tc_stats.stored++;
+  chSysUnlock();
+
+  return false;
+}
+#endif /* CH_DYNAMIC_USE_CACHE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -105,6 +199,10 @@ void chThdRelease(thread_t *tp) {
     case CH_FLAG_MODE_HEAP:
 #if CH_CFG_USE_REGISTRY
       REG_REMOVE(tp);
+#endif
+#if CH_DYNAMIC_USE_CACHE
+      if (!thd_cache_put(tp))
+        break;
 #endif
       chHeapFree(tp);
       break;
@@ -149,7 +247,14 @@ thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
   void *wsp;
   thread_t *tp;
 
+#if CH_DYNAMIC_USE_CACHE
+  /* Only working areas from the default heap are cached.*/
+  wsp = (heapp == NULL) ? thd_cache_get(size) : NULL;
+  if (wsp == NULL)
+    wsp = chHeapAlloc(heapp, size);
+#else
   wsp = chHeapAlloc(heapp, size);
+#endif
   if (wsp == NULL)
     return NULL;
   
@@ -171,6 +276,60 @@ thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
 }
 #endif /* CH_CFG_USE_HEAP */
 
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @brief   Working areas cache initialization.
+ *
+ * @notapi
+ */
+void _thd_cache_init(void) {
+
+  ch_thdcache.tc_head = NULL;
+  ch_thdcache.tc_count = 0;
+  ch_thdcache.tc_stats.hits = 0;
+  ch_thdcache.tc_stats.misses = 0;
+  ch_thdcache.tc_stats.stored = 0;
+  ch_thdcache.tc_stats.discarded = 0;
+}
+
+/**
+ * @brief   Returns all the cached working areas to the heap.
+ *
+ * @api
+ */
+void chThdCacheFlush(void) {
+  struct thread_cache_entry *ep;
+
+  chSysLock();
+  ep = ch_thdcache.tc_head;
+  ch_thdcache.tc_head = NULL;
+  ch_thdcache.tc_count = 0;
+  chSysUnlock();
+
+  while (ep != NULL) {
+    struct thread_cache_entry *next = ep->next;
+
+    chHeapFree(ep);
+    ep = next;
+  }
+}
+
+/**
+ * @brief   Resets the working areas cache statistics.
+ *
+ * @api
+ */
+void chThdCacheResetStatistics(void) {
+
+  chSysLock();
+  ch_thdcache.tc_stats.hits = 0;
+  ch_thdcache.tc_stats.misses = 0;
+  ch_thdcache.tc_stats.stored = 0;
+  ch_thdcache.tc_stats.discarded = 0;
+  chSysUnlock();
+}
+#endif /* CH_DYNAMIC_USE_CACHE */
+
 #if CH_CFG_USE_MEMPOOLS || defined(__DOXYGEN__)
 /**
  * @brief   Creates a new thread allocating the memory from the specified
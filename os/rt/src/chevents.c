@@ -50,7 +50,11 @@
  *          Event Source will be signaled with an events mask.<br>
  *          An unlimited number of Event Sources can exists in a system and
  *          each thread can be listening on an unlimited number of
- *          them.
+ *          them.<br>
+ *          Listeners can also be registered as callbacks, the callback is
+ *          invoked by the broadcast itself with the broadcasted flags and
+ *          no thread is involved, this is useful for trivial reactions
+ *          where a context switch would dominate the cost.
  * @pre     In order to use the Events APIs the @p CH_CFG_USE_EVENTS option must be
  *          enabled in @p chconf.h.
  * @post    Enabling events requires 1-4 (depending on the architecture)
@@ -82,6 +86,22 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+/**
+ * @brief   Invokes a callback listener with its accumulated flags.
+ *
+ * @param[in] elp       pointer to the @p event_listener_t structure
+ *
+ * @notapi
+ */
+static void callback_listener(event_listener_t *elp) {
+  eventflags_t flags = elp->el_flags;
+
+  elp->el_flags = 0;
+  elp->el_callback(elp->el_param, flags);
+}
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -112,8 +132,50 @@ void chEvtRegisterMask(event_source_t *esp,
   elp->el_listener = currp;
   elp->el_mask     = mask;
   elp->el_flags    = 0;
+#if CH_CFG_USE_EVENTS_CALLBACKS
+  elp->el_callback = NULL;
+#endif
+  chSysUnlock();
+}
+
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+/**
+ * @brief   Registers a callback Event Listener on an Event Source.
+ * @details The callback is invoked by @p chEvtBroadcastFlagsI() with the
+ *          broadcasted flags, no thread is signaled or rescheduled.
+ * @note    The callback is invoked from within the kernel lock zone, it
+ *          can only use I-class functions and must be kept short.
+ * @note    At most @p CH_CFG_EVENTS_CALLBACKS_MAX callbacks are invoked by
+ *          a single broadcast, each broadcast starts from the callback
+ *          listener following the last one served by the previous one.
+ *          The skipped listeners accumulate the flags, they are passed to
+ *          the callback on its next invocation.
+ *
+ * @param[in] esp       pointer to the  @p event_source_t structure
+ * @param[in] elp       pointer to the @p event_listener_t structure
+ * @param[in] callback  the callback function
+ * @param[in] p         parameter passed to the callback function
+ *
+ * @api
+ */
+void chEvtRegisterCallback(event_source_t *esp,
+                           event_listener_t *elp,
+                           evcallback_t callback,
+                           void *p) {
+
+  chDbgCheck((esp != NULL) && (elp != NULL) && (callback != NULL));
+
+  chSysLock();
+  elp->el_next     = esp->es_next;
+  esp->es_next     = elp;
+  elp->el_listener = NULL;
+  elp->el_mask     = 0;
+  elp->el_flags    = 0;
+  elp->el_callback = callback;
+  elp->el_param    = p;
   chSysUnlock();
 }
+#endif /* CH_CFG_USE_EVENTS_CALLBACKS */
 
 /**
  * @brief   Unregisters an Event Listener from its Event Source.
@@ -191,6 +253,10 @@ eventmask_t chEvtAddEvents(eventmask_t mask) {
  *          threads registered on the @p event_source_t in addition to the
  *          event flags specified by the threads themselves in the
  *          @p event_listener_t objects.
+ * @note    Callback listeners are invoked directly, up to
+ *          @p CH_CFG_EVENTS_CALLBACKS_MAX callbacks per broadcast. The
+ *          served listeners are rotated among broadcasts so that all of
+ *          them are eventually invoked.
  * @post    This function does not reschedule so a call to a rescheduling
  *          function must be performed before unlocking the kernel. Note that
  *          interrupt handlers always reschedule on exit so an explicit
@@ -203,6 +269,9 @@ eventmask_t chEvtAddEvents(eventmask_t mask) {
  */
 void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags) {
   event_listener_t *elp;
+#if CH_CFG_USE_EVENTS_CALLBACKS
+  unsigned n = 0, ncb = 0, next = 0;
+#endif
 
   chDbgCheckClassI();
   chDbgCheck(esp != NULL);
@@ -210,9 +279,46 @@ void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags) {
   elp = esp->es_next;
   while (elp != (event_listener_t *)esp) {
     elp->el_flags |= flags;
+#if CH_CFG_USE_EVENTS_CALLBACKS
+    if (elp->el_callback == NULL)
+      chEvtSignalI(elp->el_listener, elp->el_mask);
+    else {
+      /* Callback listeners are served starting from the position reached
+         by the previous broadcast.*/
+      if ((n >= esp->es_cbnext) && (ncb < CH_CFG_EVENTS_CALLBACKS_MAX)) {
+        callback_listener(elp);
+        ncb++;
+        next = n + 1;
+      }
+      n++;
+    }
+#else
     chEvtSignalI(elp->el_listener, elp->el_mask);
+#endif
     elp = elp->el_next;
   }
+#if CH_CFG_USE_EVENTS_CALLBACKS
+  /* Wrapping around to the callback listeners preceding the start
+     position.*/
+  if ((ncb < CH_CFG_EVENTS_CALLBACKS_MAX) && (esp->es_cbnext > 0)) {
+    unsigned i = 0;
+
+    elp = esp->es_next;
+    while ((i < esp->es_cbnext) && (i < n) &&
+           (ncb < CH_CFG_EVENTS_CALLBACKS_MAX)) {
+      if (elp->el_callback != NULL) {
+        callback_listener(elp);
+        ncb++;
+        next = ++i;
+      }
+      elp = elp->el_next;
+    }
+  }
+  esp->es_cbnext = next < n ? next : 0;
+#endif
+#if CH_CFG_USE_WAITMULTIPLE
+  _mwait_notify_i(esp, flags);
+#endif
 }
 
 /**
@@ -568,6 +674,136 @@ eventmask_t chEvtWaitAllTimeout(eventmask_t mask, systime_t time) {
   chSysUnlock();
   return mask;
 }
+
+/**
+ * @brief   Waits for exactly one of the specified events.
+ * @details The function waits for one event among those specified in
+ *          @p mask to become pending or the deadline is reached, then the
+ *          event is cleared and returned.
+ * @note    One and only one event is served in the function, the one with the
+ *          lowest event id. The function is meant to be invoked into a loop
+ *          in order to serve all the pending events.<br>
+ *          This means that Event Listeners with a lower event identifier have
+ *          an higher priority.
+ *
+ * @param[in] mask      mask of the event flags that the function should wait
+ *                      for, @p ALL_EVENTS enables all the events
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The mask of the lowest id served and cleared event.
+ * @retval 0            if the operation has timed out.
+ *
+ * @api
+ */
+eventmask_t chEvtWaitOneUntil(eventmask_t mask, systime_t deadline) {
+  thread_t *ctp = currp;
+  systime_t time;
+  eventmask_t m;
+
+  chSysLock();
+  time = chVTTimeUntilX(deadline);
+
+  if ((m = (ctp->p_epending & mask)) == 0) {
+    if (TIME_IMMEDIATE == time) {
+      chSysUnlock();
+      return (eventmask_t)0;
+    }
+    ctp->p_u.ewmask = mask;
+    if (chSchGoSleepTimeoutS(CH_STATE_WTOREVT, time) < MSG_OK) {
+      chSysUnlock();
+      return (eventmask_t)0;
+    }
+    m = ctp->p_epending & mask;
+  }
+  m &= -m;
+  ctp->p_epending &= ~m;
+
+  chSysUnlock();
+  return m;
+}
+
+/**
+ * @brief   Waits for any of the specified events.
+ * @details The function waits for any event among those specified in
+ *          @p mask to become pending or the deadline is reached, then the
+ *          events are cleared and returned.
+ *
+ * @param[in] mask      mask of the event flags that the function should wait
+ *                      for, @p ALL_EVENTS enables all the events
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The mask of the served and cleared events.
+ * @retval 0            if the operation has timed out.
+ *
+ * @api
+ */
+eventmask_t chEvtWaitAnyUntil(eventmask_t mask, systime_t deadline) {
+  thread_t *ctp = currp;
+  systime_t time;
+  eventmask_t m;
+
+  chSysLock();
+  time = chVTTimeUntilX(deadline);
+
+  if ((m = (ctp->p_epending & mask)) == 0) {
+    if (TIME_IMMEDIATE == time) {
+      chSysUnlock();
+      return (eventmask_t)0;
+    }
+    ctp->p_u.ewmask = mask;
+    if (chSchGoSleepTimeoutS(CH_STATE_WTOREVT, time) < MSG_OK) {
+      chSysUnlock();
+      return (eventmask_t)0;
+    }
+    m = ctp->p_epending & mask;
+  }
+  ctp->p_epending &= ~m;
+
+  chSysUnlock();
+  return m;
+}
+
+/**
+ * @brief   Waits for all the specified events.
+ * @details The function waits for all the events specified in @p mask to
+ *          become pending or the deadline is reached, then the events are
+ *          cleared and returned.
+ *
+ * @param[in] mask      mask of the event flags that the function should wait
+ *                      for, @p ALL_EVENTS requires all the events
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The mask of the served and cleared events.
+ * @retval 0            if the operation has timed out.
+ *
+ * @api
+ */
+eventmask_t chEvtWaitAllUntil(eventmask_t mask, systime_t deadline) {
+  thread_t *ctp = currp;
+  systime_t time;
+
+  chSysLock();
+  time = chVTTimeUntilX(deadline);
+
+  if ((ctp->p_epending & mask) != mask) {
+    if (TIME_IMMEDIATE == time) {
+      chSysUnlock();
+      return (eventmask_t)0;
+    }
+    ctp->p_u.ewmask = mask;
+    if (chSchGoSleepTimeoutS(CH_STATE_WTANDEVT, time) < MSG_OK) {
+      chSysUnlock();
+      return (eventmask_t)0;
+    }
+  }
+  ctp->p_epending &= ~mask;
+
+  chSysUnlock();
+  return mask;
+}
 #endif /* CH_CFG_USE_EVENTS_TIMEOUT */
 
 #endif /* CH_CFG_USE_EVENTS */
@@ -271,6 +271,26 @@ size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep) {
   return n;
 }
 
+/**
+ * @brief   Returns the heap a memory block has been allocated from.
+ *
+ * @param[in] p         pointer to the memory block
+ * @return              Pointer to the heap descriptor.
+ * @retval NULL         if the block belongs to the default heap.
+ *
+ * @xclass
+ */
+memory_heap_t *chHeapGetOwnerX(void *p) {
+  memory_heap_t *heapp;
+
+  chDbgCheck(p != NULL);
+
+  heapp = ((union heap_header *)p - 1)->h.u.heap;
+  if (heapp == &default_heap)
+    return NULL;
+  return heapp;
+}
+
 #endif /* CH_CFG_USE_HEAP */
 
 /** @} */
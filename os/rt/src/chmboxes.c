@@ -32,6 +32,9 @@
  *            priority.
  *          - <b>Fetch</b>: A message is fetched from the mailbox and removed
  *            from the queue.
+ *          - <b>Post N/Fetch N</b>: Several messages are posted or fetched
+ *            in a single operation, the thread waits only for the first
+ *            one.
  *          - <b>Reset</b>: The mailbox is emptied and all the stored messages
  *            are lost.
  *          .
@@ -70,6 +73,54 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Takes up to @p n units from a semaphore counter without waiting.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] n         maximum number of units to be taken
+ * @return              The number of units taken.
+ */
+static cnt_t sem_take(semaphore_t *sp, cnt_t n) {
+  cnt_t cnt = chSemGetCounterI(sp);
+
+  if (n > cnt)
+    n = cnt > 0 ? cnt : 0;
+  sp->s_cnt -= n;
+  return n;
+}
+
+/**
+ * @brief   Writes messages into the mailbox buffer.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the messages
+ * @param[in] n         number of messages, there must be enough free slots
+ */
+static void mb_write(mailbox_t *mbp, const msg_t *msgp, cnt_t n) {
+
+  while (n-- > 0) {
+    *mbp->mb_wrptr++ = *msgp++;
+    if (mbp->mb_wrptr >= mbp->mb_top)
+      mbp->mb_wrptr = mbp->mb_buffer;
+  }
+}
+
+/**
+ * @brief   Reads messages from the mailbox buffer.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a buffer for the messages
+ * @param[in] n         number of messages, there must be enough messages
+ */
+static void mb_read(mailbox_t *mbp, msg_t *msgp, cnt_t n) {
+
+  while (n-- > 0) {
+    *msgp++ = *mbp->mb_rdptr++;
+    if (mbp->mb_rdptr >= mbp->mb_top)
+      mbp->mb_rdptr = mbp->mb_buffer;
+  }
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -393,6 +444,190 @@ msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
   chSemSignalI(&mbp->mb_emptysem);
   return MSG_OK;
 }
+
+/**
+ * @brief   Posts several messages into a mailbox.
+ * @details The invoking thread waits until at least an empty slot in the
+ *          mailbox becomes available or the specified time runs out, then
+ *          posts as many messages as the free slots allow. The messages are
+ *          posted with a single semaphore adjustment.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the messages to be posted
+ * @param[in] n         number of messages to be posted
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of posted messages.
+ * @retval 0            if the mailbox has been reset while waiting or the
+ *                      operation has timed out.
+ *
+ * @api
+ */
+cnt_t chMBPostN(mailbox_t *mbp, const msg_t *msgp, cnt_t n, systime_t time) {
+
+  chSysLock();
+  n = chMBPostNS(mbp, msgp, n, time);
+  chSysUnlock();
+  return n;
+}
+
+/**
+ * @brief   Posts several messages into a mailbox.
+ * @details The invoking thread waits until at least an empty slot in the
+ *          mailbox becomes available or the specified time runs out, then
+ *          posts as many messages as the free slots allow. The messages are
+ *          posted with a single semaphore adjustment.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the messages to be posted
+ * @param[in] n         number of messages to be posted
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of posted messages.
+ * @retval 0            if the mailbox has been reset while waiting or the
+ *                      operation has timed out.
+ *
+ * @sclass
+ */
+cnt_t chMBPostNS(mailbox_t *mbp, const msg_t *msgp, cnt_t n, systime_t time) {
+
+  chDbgCheckClassS();
+  chDbgCheck((mbp != NULL) && (msgp != NULL) && (n > 0));
+
+  /* Waiting for the first slot only, the remaining messages are posted
+     only if there are other free slots.*/
+  if (chSemWaitTimeoutS(&mbp->mb_emptysem, time) != MSG_OK)
+    return 0;
+  n = sem_take(&mbp->mb_emptysem, n - 1) + 1;
+  mb_write(mbp, msgp, n);
+  chSemAddCounterI(&mbp->mb_fullsem, n);
+  chSchRescheduleS();
+  return n;
+}
+
+/**
+ * @brief   Posts several messages into a mailbox.
+ * @details This variant is non-blocking, the function posts as many
+ *          messages as the free slots allow.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgp      pointer to the messages to be posted
+ * @param[in] n         number of messages to be posted
+ * @return              The number of posted messages.
+ * @retval 0            if the mailbox is full.
+ *
+ * @iclass
+ */
+cnt_t chMBPostNI(mailbox_t *mbp, const msg_t *msgp, cnt_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (msgp != NULL) && (n > 0));
+
+  n = sem_take(&mbp->mb_emptysem, n);
+  if (n > 0) {
+    mb_write(mbp, msgp, n);
+    chSemAddCounterI(&mbp->mb_fullsem, n);
+  }
+  return n;
+}
+
+/**
+ * @brief   Retrieves several messages from a mailbox.
+ * @details The invoking thread waits until at least a message is posted
+ *          in the mailbox or the specified time runs out, then fetches as
+ *          many messages as available. The messages are fetched with a
+ *          single semaphore adjustment.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a buffer for the received messages
+ * @param[in] n         maximum number of messages to be fetched
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of fetched messages.
+ * @retval 0            if the mailbox has been reset while waiting or the
+ *                      operation has timed out.
+ *
+ * @api
+ */
+cnt_t chMBFetchN(mailbox_t *mbp, msg_t *msgp, cnt_t n, systime_t time) {
+
+  chSysLock();
+  n = chMBFetchNS(mbp, msgp, n, time);
+  chSysUnlock();
+  return n;
+}
+
+/**
+ * @brief   Retrieves several messages from a mailbox.
+ * @details The invoking thread waits until at least a message is posted
+ *          in the mailbox or the specified time runs out, then fetches as
+ *          many messages as available. The messages are fetched with a
+ *          single semaphore adjustment.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a buffer for the received messages
+ * @param[in] n         maximum number of messages to be fetched
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of fetched messages.
+ * @retval 0            if the mailbox has been reset while waiting or the
+ *                      operation has timed out.
+ *
+ * @sclass
+ */
+cnt_t chMBFetchNS(mailbox_t *mbp, msg_t *msgp, cnt_t n, systime_t time) {
+
+  chDbgCheckClassS();
+  chDbgCheck((mbp != NULL) && (msgp != NULL) && (n > 0));
+
+  /* Waiting for the first message only, the remaining messages are fetched
+     only if already available.*/
+  if (chSemWaitTimeoutS(&mbp->mb_fullsem, time) != MSG_OK)
+    return 0;
+  n = sem_take(&mbp->mb_fullsem, n - 1) + 1;
+  mb_read(mbp, msgp, n);
+  chSemAddCounterI(&mbp->mb_emptysem, n);
+  chSchRescheduleS();
+  return n;
+}
+
+/**
+ * @brief   Retrieves several messages from a mailbox.
+ * @details This variant is non-blocking, the function fetches as many
+ *          messages as available.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgp     pointer to a buffer for the received messages
+ * @param[in] n         maximum number of messages to be fetched
+ * @return              The number of fetched messages.
+ * @retval 0            if the mailbox is empty.
+ *
+ * @iclass
+ */
+cnt_t chMBFetchNI(mailbox_t *mbp, msg_t *msgp, cnt_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (msgp != NULL) && (n > 0));
+
+  n = sem_take(&mbp->mb_fullsem, n);
+  if (n > 0) {
+    mb_read(mbp, msgp, n);
+    chSemAddCounterI(&mbp->mb_emptysem, n);
+  }
+  return n;
+}
 #endif /* CH_CFG_USE_MAILBOXES */
 
 /** @} */
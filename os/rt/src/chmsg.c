@@ -37,6 +37,14 @@
  *          Messages are usually processed in FIFO order but it is possible to
  *          process them in priority order by enabling the
  *          @p CH_CFG_USE_MESSAGES_PRIORITY option in @p chconf.h.<br>
+ *          If the @p CH_CFG_USE_MESSAGES_ASYNC option is enabled then a
+ *          client can also send messages without waiting, each message is
+ *          carried by a request block provided by the client and the answer
+ *          is posted to a mailbox. A client can so have several requests
+ *          pending on the same server. The server handles requests and
+ *          threads in the same way, the reference returned by
+ *          @p chMsgWait() is however not a thread for asynchronous
+ *          requests.<br>
  * @pre     In order to use the message APIs the @p CH_CFG_USE_MESSAGES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling messages requires 6-12 (depending on the architecture)
@@ -123,7 +131,10 @@ thread_t *chMsgWait(void) {
   if (!chMsgIsPendingI(currp))
     chSchGoSleepS(CH_STATE_WTMSG);
   tp = queue_fifo_remove(&currp->p_msgqueue);
-  tp->p_state = CH_STATE_SNDMSG;
+#if CH_CFG_USE_MESSAGES_ASYNC
+  if (tp->p_state != CH_STATE_MSGREQ)
+#endif
+    tp->p_state = CH_STATE_SNDMSG;
   chSysUnlock();
   return tp;
 }
@@ -141,11 +152,72 @@ thread_t *chMsgWait(void) {
 void chMsgRelease(thread_t *tp, msg_t msg) {
 
   chSysLock();
-  chDbgAssert(tp->p_state == CH_STATE_SNDMSG, "invalid state");
+  chDbgAssert((tp->p_state == CH_STATE_SNDMSG) ||
+              (tp->p_state == CH_STATE_MSGREQ), "invalid state");
   chMsgReleaseS(tp, msg);
   chSysUnlock();
 }
 
+#if CH_CFG_USE_MESSAGES_ASYNC || defined(__DOXYGEN__)
+/**
+ * @brief   Sends a message to the specified thread without waiting.
+ * @details The message is queued on the server using the request block,
+ *          when the server executes a @p chMsgRelease() the answer is
+ *          stored in the request block and the pointer to the request
+ *          block is posted to the specified mailbox.
+ * @note    The request block must not be reused or deallocated until the
+ *          answer has been received.
+ * @note    The mailbox must have room for all the requests sent to it and
+ *          not yet answered.
+ *
+ * @param[in] tp        the pointer to the thread
+ * @param[out] rp       pointer to the @p msg_request_t structure carrying
+ *                      the message
+ * @param[in] msg       the message
+ * @param[in] mbp       pointer to the mailbox receiving the answered
+ *                      requests or @p NULL, in this case the request
+ *                      status can be polled using @p chMsgIsRequestDoneI()
+ *
+ * @api
+ */
+void chMsgSendAsync(thread_t *tp, msg_request_t *rp, msg_t msg,
+                    mailbox_t *mbp) {
+
+  chDbgCheck((tp != NULL) && (rp != NULL));
+
+  chSysLock();
+  rp->r_prio = currp->p_prio;
+  rp->r_state = CH_STATE_MSGREQ;
+  rp->r_msg = msg;
+  rp->r_mbp = mbp;
+  msg_insert((thread_t *)rp, &tp->p_msgqueue);
+  if (tp->p_state == CH_STATE_WTMSG)
+    chSchWakeupS(tp, MSG_OK);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Completes an asynchronous request.
+ * @note    Not an API, use @p chMsgRelease().
+ *
+ * @param[in] rp        pointer to the @p msg_request_t structure
+ * @param[in] msg       message to be returned to the sender
+ *
+ * @notapi
+ */
+void _msg_request_done_i(msg_request_t *rp, msg_t msg) {
+
+  chDbgCheckClassI();
+
+  rp->r_msg = msg;
+  rp->r_state = CH_STATE_FINAL;
+  if (rp->r_mbp != NULL) {
+    msg = chMBPostI(rp->r_mbp, (msg_t)rp);
+    chDbgAssert(msg == MSG_OK, "answers mailbox full");
+  }
+}
+#endif /* CH_CFG_USE_MESSAGES_ASYNC */
+
 #endif /* CH_CFG_USE_MESSAGES */
 
 /** @} */
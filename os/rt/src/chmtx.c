@@ -64,6 +64,14 @@
  *          The mechanism works with any number of nested mutexes and any
  *          number of involved threads. The algorithm complexity (worst case)
  *          is N with N equal to the number of nested mutexes.
+ *
+ *          <h2>Fast path</h2>
+ *          If the option @p CH_CFG_USE_MUTEXES_FASTPATH is enabled then
+ *          mutexes are locked and unlocked using an atomic compare and swap
+ *          on the owner pointer without entering the kernel, the kernel is
+ *          entered only when the mutex is owned by another thread or when
+ *          threads are waiting for it. The port must support compare and
+ *          swap, recursive mutexes are not supported.
  * @pre     In order to use the mutex APIs the @p CH_CFG_USE_MUTEXES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling mutexes requires 5-12 (depending on the architecture)
@@ -91,10 +99,235 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Assigns a mutex to a thread.
+ * @details While threads are waiting on the mutex the owner pointer is
+ *          tagged, this forces the owner into the slow path on unlock.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the new owner or @p NULL
+ */
+static inline void set_owner(mutex_t *mp, thread_t *tp) {
+
+#if CH_CFG_USE_MUTEXES_FASTPATH
+  if ((tp != NULL) && queue_notempty(&mp->m_queue))
+    tp = (thread_t *)((uintptr_t)tp | _MTX_WAITERS);
+#endif
+  mp->m_owner = tp;
+}
+
+/**
+ * @brief   Queues a thread on an owned mutex.
+ * @details Priority inheritance protocol; explores the thread-mutex
+ *          dependencies boosting the priority of all the affected threads
+ *          to equal the priority of the thread requesting the mutex.
+ * @note    The thread is not put to sleep, this is responsibility of the
+ *          caller.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the thread requesting the mutex
+ */
+static void mtx_enqueue(mutex_t *mp, thread_t *tp) {
+  thread_t *otp = _mtx_get_owner(mp);
+
+  /* Does the requesting thread have higher priority than the mutex
+     owning thread? */
+  while (otp->p_prio < tp->p_prio) {
+    /* Make priority of thread otp match the requesting thread's priority.*/
+    otp->p_prio = tp->p_prio;
+
+    /* The following states need priority queues reordering.*/
+    switch (otp->p_state) {
+    case CH_STATE_WTMTX:
+      /* Re-enqueues the mutex owner with its new priority.*/
+      queue_prio_insert(queue_dequeue(otp),
+                        (threads_queue_t *)otp->p_u.wtobjp);
+      otp = _mtx_get_owner((mutex_t *)otp->p_u.wtobjp);
+      continue;
+#if CH_CFG_USE_RWLOCKS
+    case CH_STATE_WTRWLOCK:
+      /* Re-enqueues the lock waiter with its new priority and boosts
+         all the lock owners.*/
+      queue_prio_insert(queue_dequeue(otp),
+                        (threads_queue_t *)otp->p_u.wtobjp);
+      _rw_boost_owners((rwlock_t *)otp->p_u.wtobjp, otp->p_prio);
+      break;
+#endif
+#if CH_CFG_USE_CONDVARS |                                                    \
+    (CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY) |             \
+    (CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY)
+#if CH_CFG_USE_CONDVARS
+    case CH_STATE_WTCOND:
+#endif
+#if CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY
+    case CH_STATE_WTSEM:
+#endif
+#if CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY
+    case CH_STATE_SNDMSGQ:
+#endif
+      /* Re-enqueues otp with its new priority on the queue.*/
+      queue_prio_insert(queue_dequeue(otp),
+                        (threads_queue_t *)otp->p_u.wtobjp);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS
+      /* Prevents an assertion in chSchReadyI().*/
+      otp->p_state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues otp with its new priority on the ready list.*/
+      chSchReadyI(queue_dequeue(otp));
+      break;
+    }
+    break;
+  }
+
+  queue_prio_insert(tp, &mp->m_queue);
+  set_owner(mp, _mtx_get_owner(mp));
+  tp->p_u.wtobjp = mp;
+}
+
+#if CH_CFG_USE_MUTEXES_FASTPATH || defined(__DOXYGEN__)
+/**
+ * @brief   Locks a mutex without entering the kernel.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] ctp       pointer to the current thread
+ * @return              The operation status.
+ * @retval true         if the mutex has been acquired.
+ * @retval false        if the slow path must be taken.
+ */
+static inline bool fast_lock(mutex_t *mp, thread_t *ctp) {
+
+#if CH_CFG_USE_MUTEXES_CEILING
+  /* Ceiling mutexes change the owner priority, slow path only.*/
+  if (mp->m_ceiling > 0)
+    return false;
+#endif
+  if (!port_cas((void * volatile *)&mp->m_owner, NULL, ctp))
+    return false;
+
+  /* The owned mutexes list is only accessed by the owner thread while
+     running, no need to lock.*/
+  mp->m_next = ctp->p_mtxlist;
+  ctp->p_mtxlist = mp;
+  return true;
+}
+
+/**
+ * @brief   Unlocks a mutex without entering the kernel.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] ctp       pointer to the current thread
+ * @return              The operation status.
+ * @retval true         if the mutex has been released.
+ * @retval false        if the slow path must be taken.
+ */
+static inline bool fast_unlock(mutex_t *mp, thread_t *ctp) {
+
+  chDbgAssert(ctp->p_mtxlist == mp, "not next in list");
+
+#if CH_CFG_USE_MUTEXES_CEILING
+  if (mp->m_ceiling > 0)
+    return false;
+#endif
+
+  /* The mutex is removed from the list before releasing it because after
+     the release it could be immediately taken by another thread.*/
+  ctp->p_mtxlist = mp->m_next;
+  if (port_cas((void * volatile *)&mp->m_owner, ctp, NULL))
+    return true;
+
+  /* The owner pointer is tagged, there are waiting threads.*/
+  ctp->p_mtxlist = mp;
+  return false;
+}
+#endif /* CH_CFG_USE_MUTEXES_FASTPATH */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Calculates the priority of a thread from its owned mutexes.
+ * @details The priority is the highest among the thread own priority, the
+ *          priority of the threads waiting on the owned mutexes and the
+ *          ceiling of the owned ceiling mutexes.
+ * @note    This is an internal function used by the priority inheritance
+ *          mechanism, do not use it in application code.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The priority the thread is entitled to.
+ *
+ * @notapi
+ */
+tprio_t _mtx_get_prio(thread_t *tp) {
+  tprio_t newprio = tp->p_realprio;
+  mutex_t *lmp = tp->p_mtxlist;
+
+  while (lmp != NULL) {
+    /* If the highest priority thread waiting in the mutexes list has a
+       greater priority than the current thread base priority then the
+       final priority will have at least that priority.*/
+    if (chMtxQueueNotEmptyS(lmp) && (lmp->m_queue.p_next->p_prio > newprio))
+      newprio = lmp->m_queue.p_next->p_prio;
+#if CH_CFG_USE_MUTEXES_CEILING
+    if (lmp->m_ceiling > newprio)
+      newprio = lmp->m_ceiling;
+#endif
+    lmp = lmp->m_next;
+  }
+#if CH_CFG_USE_RWLOCKS
+  newprio = _rw_get_inherited_prio(tp, newprio);
+#endif
+  return newprio;
+}
+
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+/**
+ * @brief   Locks a mutex on behalf of a sleeping thread.
+ * @details This function implements the wait morphing used by condition
+ *          variables, the thread is moved on the mutex instead of being
+ *          resumed:
+ *          - If the mutex is not owned then it is assigned to the thread
+ *            and the thread is made ready.
+ *          - If the mutex is owned then the thread is queued on it in the
+ *            @p CH_STATE_WTMTX state, the thread is resumed by the unlock
+ *            operation.
+ *          .
+ * @note    The thread must not be in any queue when this function is
+ *          invoked.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the sleeping thread
+ *
+ * @notapi
+ */
+void _mtx_morph_i(mutex_t *mp, thread_t *tp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mp != NULL) && (tp != NULL));
+
+  if (mp->m_owner != NULL) {
+    mtx_enqueue(mp, tp);
+    tp->p_state = CH_STATE_WTMTX;
+    return;
+  }
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE
+  mp->m_cnt++;
+#endif
+  mp->m_owner = tp;
+  mp->m_next = tp->p_mtxlist;
+  tp->p_mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING
+  if (tp->p_prio < mp->m_ceiling)
+    tp->p_prio = mp->m_ceiling;
+#endif
+  chSchReadyI(tp);
+}
+#endif /* CH_CFG_USE_CONDVARS */
+
 /**
  * @brief   Initializes s @p mutex_t structure.
  *
@@ -111,7 +344,37 @@ void chMtxObjectInit(mutex_t *mp) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE
   mp->m_cnt = 0;
 #endif
+#if CH_CFG_USE_MUTEXES_CEILING
+  mp->m_ceiling = 0;
+#endif
+}
+
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes s @p mutex_t structure using the priority ceiling
+ *          protocol.
+ * @details The thread locking the mutex is immediately raised to the
+ *          ceiling priority, the priority is restored when the mutex is
+ *          unlocked. Because the owner runs at the highest priority of all
+ *          the threads using the mutex there is no contention unless the
+ *          owner waits while holding the mutex.
+ * @note    The base priority of all the threads locking the mutex must not
+ *          exceed the ceiling.
+ *
+ * @param[out] mp       pointer to a @p mutex_t structure
+ * @param[in] ceiling   the ceiling priority, it must be greater than
+ *                      @p IDLEPRIO
+ *
+ * @init
+ */
+void chMtxObjectInitCeiling(mutex_t *mp, tprio_t ceiling) {
+
+  chDbgCheck((ceiling > IDLEPRIO) && (ceiling <= HIGHPRIO));
+
+  chMtxObjectInit(mp);
+  mp->m_ceiling = ceiling;
 }
+#endif /* CH_CFG_USE_MUTEXES_CEILING */
 
 /**
  * @brief   Locks the specified mutex.
@@ -124,6 +387,13 @@ void chMtxObjectInit(mutex_t *mp) {
  */
 void chMtxLock(mutex_t *mp) {
 
+#if CH_CFG_USE_MUTEXES_FASTPATH
+  chDbgCheck(mp != NULL);
+
+  if (fast_lock(mp, currp))
+    return;
+#endif
+
   chSysLock();
 
   chMtxLockS(mp);
@@ -145,6 +415,10 @@ void chMtxLockS(mutex_t *mp) {
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
+#if CH_CFG_USE_MUTEXES_CEILING
+  chDbgAssert((mp->m_ceiling == 0) || (ctp->p_realprio <= mp->m_ceiling),
+              "ceiling violation");
+#endif
 
   /* Is the mutex already locked? */
   if (mp->m_owner != NULL) {
@@ -158,62 +432,13 @@ void chMtxLockS(mutex_t *mp) {
       mp->m_cnt++;
     else {
 #endif
-      /* Priority inheritance protocol; explores the thread-mutex dependencies
-         boosting the priority of all the affected threads to equal the
-         priority of the running thread requesting the mutex.*/
-      thread_t *tp = mp->m_owner;
-
-      /* Does the running thread have higher priority than the mutex
-         owning thread? */
-      while (tp->p_prio < ctp->p_prio) {
-        /* Make priority of thread tp match the running thread's priority.*/
-        tp->p_prio = ctp->p_prio;
-
-        /* The following states need priority queues reordering.*/
-        switch (tp->p_state) {
-        case CH_STATE_WTMTX:
-          /* Re-enqueues the mutex owner with its new priority.*/
-          queue_prio_insert(queue_dequeue(tp),
-                            (threads_queue_t *)tp->p_u.wtobjp);
-          tp = ((mutex_t *)tp->p_u.wtobjp)->m_owner;
-          continue;
-  #if CH_CFG_USE_CONDVARS |                                                       \
-      (CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY) |                     \
-      (CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY)
-  #if CH_CFG_USE_CONDVARS
-        case CH_STATE_WTCOND:
-  #endif
-  #if CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY
-        case CH_STATE_WTSEM:
-  #endif
-  #if CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY
-        case CH_STATE_SNDMSGQ:
-  #endif
-          /* Re-enqueues tp with its new priority on the queue.*/
-          queue_prio_insert(queue_dequeue(tp),
-                            (threads_queue_t *)tp->p_u.wtobjp);
-          break;
-  #endif
-        case CH_STATE_READY:
-  #if CH_DBG_ENABLE_ASSERTS
-          /* Prevents an assertion in chSchReadyI().*/
-          tp->p_state = CH_STATE_CURRENT;
-  #endif
-          /* Re-enqueues tp with its new priority on the ready list.*/
-          chSchReadyI(queue_dequeue(tp));
-          break;
-        }
-        break;
-      }
-
       /* Sleep on the mutex.*/
-      queue_prio_insert(ctp, &mp->m_queue);
-      ctp->p_u.wtobjp = mp;
+      mtx_enqueue(mp, ctp);
       chSchGoSleepS(CH_STATE_WTMTX);
 
       /* It is assumed that the thread performing the unlock operation assigns
          the mutex to this thread.*/
-      chDbgAssert(mp->m_owner == ctp, "not owner");
+      chDbgAssert(_mtx_get_owner(mp) == ctp, "not owner");
       chDbgAssert(ctp->p_mtxlist == mp, "not owned");
 #if CH_CFG_USE_MUTEXES_RECURSIVE
       chDbgAssert(mp->m_cnt == 1, "counter is not one");
@@ -230,6 +455,11 @@ void chMtxLockS(mutex_t *mp) {
     mp->m_owner = ctp;
     mp->m_next = ctp->p_mtxlist;
     ctp->p_mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING
+    /* Immediate priority ceiling, the owner is raised at lock time.*/
+    if (ctp->p_prio < mp->m_ceiling)
+      ctp->p_prio = mp->m_ceiling;
+#endif
   }
 }
 
@@ -253,6 +483,13 @@ void chMtxLockS(mutex_t *mp) {
 bool chMtxTryLock(mutex_t *mp) {
   bool b;
 
+#if CH_CFG_USE_MUTEXES_FASTPATH
+  chDbgCheck(mp != NULL);
+
+  if (fast_lock(mp, currp))
+    return true;
+#endif
+
   chSysLock();
 
   b = chMtxTryLockS(mp);
@@ -282,6 +519,10 @@ bool chMtxTryLockS(mutex_t *mp) {
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
+#if CH_CFG_USE_MUTEXES_CEILING
+  chDbgAssert((mp->m_ceiling == 0) || (currp->p_realprio <= mp->m_ceiling),
+              "ceiling violation");
+#endif
 
   if (mp->m_owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE
@@ -304,6 +545,10 @@ bool chMtxTryLockS(mutex_t *mp) {
   mp->m_owner = currp;
   mp->m_next = currp->p_mtxlist;
   currp->p_mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING
+  if (currp->p_prio < mp->m_ceiling)
+    currp->p_prio = mp->m_ceiling;
+#endif
   return true;
 }
 
@@ -319,14 +564,18 @@ bool chMtxTryLockS(mutex_t *mp) {
  */
 void chMtxUnlock(mutex_t *mp) {
   thread_t *ctp = currp;
-  mutex_t *lmp;
 
   chDbgCheck(mp != NULL);
 
+#if CH_CFG_USE_MUTEXES_FASTPATH
+  if (fast_unlock(mp, ctp))
+    return;
+#endif
+
   chSysLock();
 
   chDbgAssert(ctp->p_mtxlist != NULL, "owned mutexes list empty");
-  chDbgAssert(ctp->p_mtxlist->m_owner == ctp, "ownership failure");
+  chDbgAssert(_mtx_get_owner(ctp->p_mtxlist) == ctp, "ownership failure");
 #if CH_CFG_USE_MUTEXES_RECURSIVE
   chDbgAssert(mp->m_cnt >= 1, "counter is not positive");
 
@@ -344,22 +593,9 @@ void chMtxUnlock(mutex_t *mp) {
     if (chMtxQueueNotEmptyS(mp)) {
       thread_t *tp;
 
-      /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = ctp->p_realprio;
-      lmp = ctp->p_mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) && (lmp->m_queue.p_next->p_prio > newprio))
-          newprio = lmp->m_queue.p_next->p_prio;
-        lmp = lmp->m_next;
-      }
-
       /* Assigns to the current thread the highest priority among all the
          waiting threads.*/
-      ctp->p_prio = newprio;
+      ctp->p_prio = _mtx_get_prio(ctp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
@@ -367,13 +603,24 @@ void chMtxUnlock(mutex_t *mp) {
       mp->m_cnt = 1;
 #endif
       tp = queue_fifo_remove(&mp->m_queue);
-      mp->m_owner = tp;
+      set_owner(mp, tp);
       mp->m_next = tp->p_mtxlist;
       tp->p_mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING
+      /* The new owner is raised to the mutex ceiling.*/
+      if (tp->p_prio < mp->m_ceiling)
+        tp->p_prio = mp->m_ceiling;
+#endif
       chSchWakeupS(tp, MSG_OK);
     }
-    else
+    else {
       mp->m_owner = NULL;
+#if CH_CFG_USE_MUTEXES_CEILING
+      /* The priority raised by a ceiling mutex is restored.*/
+      if (mp->m_ceiling > 0)
+        ctp->p_prio = _mtx_get_prio(ctp);
+#endif
+    }
 #if CH_CFG_USE_MUTEXES_RECURSIVE
   }
 #endif
@@ -395,13 +642,12 @@ void chMtxUnlock(mutex_t *mp) {
  */
 void chMtxUnlockS(mutex_t *mp) {
   thread_t *ctp = currp;
-  mutex_t *lmp;
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
 
   chDbgAssert(ctp->p_mtxlist != NULL, "owned mutexes list empty");
-  chDbgAssert(ctp->p_mtxlist->m_owner == ctp, "ownership failure");
+  chDbgAssert(_mtx_get_owner(ctp->p_mtxlist) == ctp, "ownership failure");
 #if CH_CFG_USE_MUTEXES_RECURSIVE
   chDbgAssert(mp->m_cnt >= 1, "counter is not positive");
 
@@ -419,22 +665,9 @@ void chMtxUnlockS(mutex_t *mp) {
     if (chMtxQueueNotEmptyS(mp)) {
       thread_t *tp;
 
-      /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = ctp->p_realprio;
-      lmp = ctp->p_mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) && (lmp->m_queue.p_next->p_prio > newprio))
-          newprio = lmp->m_queue.p_next->p_prio;
-        lmp = lmp->m_next;
-      }
-
       /* Assigns to the current thread the highest priority among all the
          waiting threads.*/
-      ctp->p_prio = newprio;
+      ctp->p_prio = _mtx_get_prio(ctp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
@@ -442,13 +675,24 @@ void chMtxUnlockS(mutex_t *mp) {
       mp->m_cnt = 1;
 #endif
       tp = queue_fifo_remove(&mp->m_queue);
-      mp->m_owner = tp;
+      set_owner(mp, tp);
       mp->m_next = tp->p_mtxlist;
       tp->p_mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING
+      /* The new owner is raised to the mutex ceiling.*/
+      if (tp->p_prio < mp->m_ceiling)
+        tp->p_prio = mp->m_ceiling;
+#endif
       chSchReadyI(tp);
     }
-    else
+    else {
       mp->m_owner = NULL;
+#if CH_CFG_USE_MUTEXES_CEILING
+      /* The priority raised by a ceiling mutex is restored.*/
+      if (mp->m_ceiling > 0)
+        ctp->p_prio = _mtx_get_prio(ctp);
+#endif
+    }
 #if CH_CFG_USE_MUTEXES_RECURSIVE
   }
 #endif
@@ -478,9 +722,13 @@ void chMtxUnlockAll(void) {
         mp->m_cnt = 1;
 #endif
         thread_t *tp = queue_fifo_remove(&mp->m_queue);
-        mp->m_owner = tp;
+        set_owner(mp, tp);
         mp->m_next = tp->p_mtxlist;
         tp->p_mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_CEILING
+        if (tp->p_prio < mp->m_ceiling)
+          tp->p_prio = mp->m_ceiling;
+#endif
         chSchReadyI(tp);
       }
       else {
@@ -490,7 +738,11 @@ void chMtxUnlockAll(void) {
         mp->m_owner = NULL;
       }
     } while (ctp->p_mtxlist != NULL);
+#if CH_CFG_USE_RWLOCKS
+    ctp->p_prio = _rw_get_inherited_prio(ctp, ctp->p_realprio);
+#else
     ctp->p_prio = ctp->p_realprio;
+#endif
     chSchRescheduleS();
   }
   chSysUnlock();
@@ -0,0 +1,322 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chmwait.c
+ * @brief   Multiple objects wait code.
+ *
+ * @addtogroup mwait
+ * @details Multiple objects wait related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A thread can wait on several objects at the same time, the
+ *          wait ends when the first of the objects becomes ready or when
+ *          the timeout expires. The following objects are supported:
+ *          - Counting semaphores, including the semaphore embedded in
+ *            binary semaphores.
+ *          - Mailboxes, waiting for an incoming message.
+ *          - Input queues, waiting for an incoming byte.
+ *          - Output queues, waiting for space.
+ *          - Event sources, waiting for a broadcast.
+ *          .
+ *          The object that became ready is also acquired atomically, the
+ *          semaphore is taken, the message is fetched from the mailbox and
+ *          the byte is read from or written into the queue, this way the
+ *          object cannot be stolen by other threads before the waiting
+ *          thread is resumed.<br>
+ *          If several objects are ready when the wait is started then the
+ *          first one in the array is acquired.
+ *
+ *          <h2>Precedence</h2>
+ *          Threads waiting directly on an object are served before the
+ *          threads waiting on it as part of a multiple wait, multiple
+ *          waits are served in priority order.
+ * @pre     In order to use the multiple objects wait APIs the
+ *          @p CH_CFG_USE_WAITMULTIPLE option must be enabled in
+ *          @p chconf.h.
+ * @post    Enabling multiple waits adds a check to all the functions
+ *          signaling the supported objects.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_WAITMULTIPLE || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Multiple wait context.
+ * @note    The context is allocated on the stack of the waiting thread.
+ */
+typedef struct {
+  wait_object_t         *wop;       /**< @brief Array of wait objects.      */
+  cnt_t                 n;          /**< @brief Number of wait objects.     */
+} mwait_context_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the pointer notified on state changes of an object.
+ *
+ * @param[in] wop       pointer to the wait object
+ * @return              The notified pointer.
+ */
+static void *get_key(wait_object_t *wop) {
+
+#if CH_CFG_USE_MAILBOXES
+  /* Mailboxes notify messages through the full counter semaphore.*/
+  if (wop->wo_type == MWAIT_MAILBOX)
+    return &((mailbox_t *)wop->wo_objp)->mb_fullsem;
+#endif
+  return wop->wo_objp;
+}
+
+/**
+ * @brief   Verifies if an object can be acquired.
+ * @note    Event sources are never ready, they are only acquired when
+ *          broadcasted.
+ *
+ * @param[in] wop       pointer to the wait object
+ * @return              The object state.
+ * @retval true         if the object can be acquired.
+ * @retval false        if the object is not ready.
+ */
+static bool is_ready(wait_object_t *wop) {
+
+  switch (wop->wo_type) {
+#if CH_CFG_USE_SEMAPHORES
+  case MWAIT_SEMAPHORE:
+    return (bool)(chSemGetCounterI((semaphore_t *)wop->wo_objp) > 0);
+#endif
+#if CH_CFG_USE_MAILBOXES
+  case MWAIT_MAILBOX:
+    return (bool)(chMBGetUsedCountI((mailbox_t *)wop->wo_objp) > 0);
+#endif
+#if CH_CFG_USE_QUEUES
+  case MWAIT_INPUT_QUEUE:
+    return !chIQIsEmptyI((input_queue_t *)wop->wo_objp);
+  case MWAIT_OUTPUT_QUEUE:
+    return !chOQIsFullI((output_queue_t *)wop->wo_objp);
+#endif
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief   Acquires a ready object.
+ *
+ * @param[in] wop       pointer to the wait object
+ */
+static void acquire(wait_object_t *wop) {
+#if CH_CFG_USE_QUEUES
+  io_queue_t *qp;
+#endif
+
+  switch (wop->wo_type) {
+#if CH_CFG_USE_SEMAPHORES
+  case MWAIT_SEMAPHORE:
+    chSemFastWaitI((semaphore_t *)wop->wo_objp);
+    break;
+#endif
+#if CH_CFG_USE_MAILBOXES
+  case MWAIT_MAILBOX:
+    (void) chMBFetchI((mailbox_t *)wop->wo_objp, &wop->wo_msg);
+    break;
+#endif
+#if CH_CFG_USE_QUEUES
+  case MWAIT_INPUT_QUEUE:
+    qp = (io_queue_t *)wop->wo_objp;
+    qp->q_counter--;
+    wop->wo_msg = (msg_t)*qp->q_rdptr++;
+    if (qp->q_rdptr >= qp->q_top)
+      qp->q_rdptr = qp->q_buffer;
+    break;
+  case MWAIT_OUTPUT_QUEUE:
+    qp = (io_queue_t *)wop->wo_objp;
+    qp->q_counter--;
+    *qp->q_wrptr++ = (uint8_t)wop->wo_msg;
+    if (qp->q_wrptr >= qp->q_top)
+      qp->q_wrptr = qp->q_buffer;
+    if (qp->q_notify)
+      qp->q_notify(qp);
+    break;
+#endif
+  default:
+    break;
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the multiple wait subsystem.
+ *
+ * @notapi
+ */
+void _mwait_init(void) {
+
+  queue_init(&ch.mwqueue);
+}
+
+/**
+ * @brief   Resumes the threads waiting on an object.
+ * @details Waiting threads are scanned in priority order, each thread
+ *          waiting on the object is resumed after acquiring it until the
+ *          object is no more ready.
+ * @note    This function is not meant to be invoked directly, the
+ *          @p _mwait_notify_i() macro should be used instead.
+ *
+ * @param[in] objp      pointer to the object
+ * @param[in] msg       object specific data, the flags for event sources
+ *
+ * @iclass
+ */
+void _mwait_wakeup_i(void *objp, msg_t msg) {
+  thread_t *tp;
+
+  chDbgCheckClassI();
+  chDbgCheck(objp != NULL);
+
+  tp = ch.mwqueue.p_next;
+  while (tp != (thread_t *)&ch.mwqueue) {
+    mwait_context_t *ctxp = (mwait_context_t *)tp->p_u.wtobjp;
+    wait_object_t *wop = ctxp->wop;
+    cnt_t i;
+
+    for (i = 0; i < ctxp->n; i++, wop++) {
+      if (get_key(wop) == objp)
+        break;
+    }
+    if (i >= ctxp->n) {
+      tp = tp->p_next;
+      continue;
+    }
+
+    if (wop->wo_type == MWAIT_EVENT_SOURCE)
+      wop->wo_msg = msg;
+    else if (!is_ready(wop)) {
+      /* The object has been exhausted, no other thread can acquire it.*/
+      return;
+    }
+
+    /* The thread is removed from the queue before acquiring the object
+       because the operation could trigger further notifications.*/
+    queue_dequeue(tp);
+    acquire(wop);
+    tp->p_u.rdymsg = (msg_t)i;
+    chSchReadyI(tp);
+
+    /* Restarting the scan because the queue could have been changed.*/
+    tp = ch.mwqueue.p_next;
+  }
+}
+
+/**
+ * @brief   Waits on multiple objects.
+ * @details The function returns as soon as one of the objects becomes
+ *          ready, the object is acquired and the data exchanged with it,
+ *          if any, is stored in the @p wo_msg field of its descriptor.
+ *
+ * @param[in] wop       pointer to an array of @p wait_object_t structures
+ * @param[in] n         number of elements in the array
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The index of the acquired object or a timeout.
+ * @retval MSG_TIMEOUT  if no object became ready within the specified
+ *                      timeout.
+ *
+ * @api
+ */
+msg_t chMWaitTimeout(wait_object_t *wop, cnt_t n, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chMWaitTimeoutS(wop, n, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Waits on multiple objects.
+ * @details The function returns as soon as one of the objects becomes
+ *          ready, the object is acquired and the data exchanged with it,
+ *          if any, is stored in the @p wo_msg field of its descriptor.
+ *
+ * @param[in] wop       pointer to an array of @p wait_object_t structures
+ * @param[in] n         number of elements in the array
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The index of the acquired object or a timeout.
+ * @retval MSG_TIMEOUT  if no object became ready within the specified
+ *                      timeout.
+ *
+ * @sclass
+ */
+msg_t chMWaitTimeoutS(wait_object_t *wop, cnt_t n, systime_t time) {
+  thread_t *ctp = currp;
+  mwait_context_t ctx;
+  cnt_t i;
+
+  chDbgCheckClassS();
+  chDbgCheck((wop != NULL) && (n > 0));
+
+  for (i = 0; i < n; i++) {
+    if (is_ready(&wop[i])) {
+      acquire(&wop[i]);
+      return (msg_t)i;
+    }
+  }
+
+  if (TIME_IMMEDIATE == time)
+    return MSG_TIMEOUT;
+
+  ctx.wop = wop;
+  ctx.n = n;
+  ctp->p_u.wtobjp = &ctx;
+  queue_prio_insert(ctp, &ch.mwqueue);
+  return chSchGoSleepTimeoutS(CH_STATE_WTMULTI, time);
+}
+
+#endif /* CH_CFG_USE_WAITMULTIPLE */
+
+/** @} */
@@ -0,0 +1,347 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chobjfifos.c
+ * @brief   Objects FIFOs code.
+ *
+ * @addtogroup objects_fifos
+ * @details Zero-copy exchange of fixed size objects between threads.
+ *          <h2>Operation mode</h2>
+ *          An objects FIFO owns a set of fixed size objects, each object is
+ *          either free, owned by a producer or consumer, or ready in the FIFO
+ *          queue. Operations defined for objects FIFOs:
+ *          - <b>Take</b>: A free object is taken by a producer, the producer
+ *            can wait for an object to become free.
+ *          - <b>Send</b>: The object is queued in the FIFO, this operation
+ *            never waits because there is always room for all the objects.
+ *          - <b>Receive</b>: The oldest ready object is removed from the
+ *            FIFO, the consumer can wait for an object to become ready.
+ *          - <b>Return</b>: The object is returned among the free ones.
+ *          .
+ *          Objects are never copied, only pointers are exchanged. Each
+ *          operation requires a single critical zone.
+ * @pre     In order to use the objects FIFOs APIs the @p CH_CFG_USE_OBJ_FIFOS
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p objects_fifo_t object.
+ * @pre     The objects must be aligned to the size of @p stkalign_t type.
+ *
+ * @param[out] ofp      pointer to the @p objects_fifo_t structure to be
+ *                      initialized
+ * @param[in] objsize   size of the objects, it must be a multiple of the
+ *                      @p stkalign_t type size
+ * @param[in] objn      number of objects
+ * @param[in] objbuf    pointer to the objects buffer, an array of @p objn
+ *                      elements of @p objsize bytes
+ * @param[in] msgbuf    pointer to the messages buffer, an array of @p objn
+ *                      elements of @p msg_t type
+ *
+ * @init
+ */
+void chFifoObjectInit(objects_fifo_t *ofp, size_t objsize, size_t objn,
+                      void *objbuf, msg_t *msgbuf) {
+
+  chDbgCheck((ofp != NULL) && (objbuf != NULL) && (msgbuf != NULL) &&
+             (objn > 0));
+
+  chPoolObjectInit(&ofp->of_pool, objsize, NULL);
+  chPoolLoadArray(&ofp->of_pool, objbuf, objn);
+  chSemObjectInit(&ofp->of_freesem, (cnt_t)objn);
+  chMBObjectInit(&ofp->of_mbx, msgbuf, (cnt_t)objn);
+}
+
+/**
+ * @brief   Takes a free object from an objects FIFO.
+ * @details The invoking thread waits until an object becomes free or the
+ *          specified time runs out.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the taken object.
+ * @retval NULL         if the operation has timed out.
+ *
+ * @api
+ */
+void *chFifoTakeObject(objects_fifo_t *ofp, systime_t time) {
+  void *objp;
+
+  chSysLock();
+  objp = chFifoTakeObjectS(ofp, time);
+  chSysUnlock();
+  return objp;
+}
+
+/**
+ * @brief   Takes a free object from an objects FIFO.
+ * @details The invoking thread waits until an object becomes free or the
+ *          specified time runs out.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the taken object.
+ * @retval NULL         if the operation has timed out.
+ *
+ * @sclass
+ */
+void *chFifoTakeObjectS(objects_fifo_t *ofp, systime_t time) {
+
+  chDbgCheckClassS();
+  chDbgCheck(ofp != NULL);
+
+  if (chSemWaitTimeoutS(&ofp->of_freesem, time) != MSG_OK)
+    return NULL;
+  return chPoolAllocI(&ofp->of_pool);
+}
+
+/**
+ * @brief   Takes a free object from an objects FIFO.
+ * @details This variant is non-blocking, the function returns @p NULL if
+ *          there are no free objects.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @return              The pointer to the taken object.
+ * @retval NULL         if there are no free objects.
+ *
+ * @iclass
+ */
+void *chFifoTakeObjectI(objects_fifo_t *ofp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(ofp != NULL);
+
+  if (chSemGetCounterI(&ofp->of_freesem) <= 0)
+    return NULL;
+  chSemFastWaitI(&ofp->of_freesem);
+  return chPoolAllocI(&ofp->of_pool);
+}
+
+/**
+ * @brief   Returns an object to the free objects of an objects FIFO.
+ * @pre     The object must have been taken from or received through the
+ *          same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be returned
+ *
+ * @api
+ */
+void chFifoReturnObject(objects_fifo_t *ofp, void *objp) {
+
+  chSysLock();
+  chFifoReturnObjectI(ofp, objp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns an object to the free objects of an objects FIFO.
+ * @pre     The object must have been taken from or received through the
+ *          same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be returned
+ *
+ * @iclass
+ */
+void chFifoReturnObjectI(objects_fifo_t *ofp, void *objp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((ofp != NULL) && (objp != NULL));
+
+  chPoolFreeI(&ofp->of_pool, objp);
+  chSemSignalI(&ofp->of_freesem);
+}
+
+/**
+ * @brief   Queues an object in an objects FIFO.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be queued
+ *
+ * @api
+ */
+void chFifoSendObject(objects_fifo_t *ofp, void *objp) {
+
+  chSysLock();
+  chFifoSendObjectS(ofp, objp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Queues an object in an objects FIFO.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be queued
+ *
+ * @sclass
+ */
+void chFifoSendObjectS(objects_fifo_t *ofp, void *objp) {
+
+  chDbgCheckClassS();
+
+  chFifoSendObjectI(ofp, objp);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Queues an object in an objects FIFO.
+ * @pre     The object must have been taken from the same objects FIFO.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[in] objp      pointer to the object to be queued
+ *
+ * @iclass
+ */
+void chFifoSendObjectI(objects_fifo_t *ofp, void *objp) {
+  msg_t msg;
+
+  chDbgCheckClassI();
+  chDbgCheck((ofp != NULL) && (objp != NULL));
+
+  msg = chMBPostI(&ofp->of_mbx, (msg_t)objp);
+  chDbgAssert(msg == MSG_OK, "FIFO full");
+}
+
+/**
+ * @brief   Retrieves an object from an objects FIFO.
+ * @details The invoking thread waits until an object is queued in the FIFO
+ *          or the specified time runs out.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to a variable for the received object pointer
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly received.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chFifoReceiveObject(objects_fifo_t *ofp, void **objpp,
+                          systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chFifoReceiveObjectS(ofp, objpp, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Retrieves an object from an objects FIFO.
+ * @details The invoking thread waits until an object is queued in the FIFO
+ *          or the specified time runs out.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to a variable for the received object pointer
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly received.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chFifoReceiveObjectS(objects_fifo_t *ofp, void **objpp,
+                           systime_t time) {
+
+  msg_t msg, rdymsg;
+
+  chDbgCheck(objpp != NULL);
+
+  rdymsg = chMBFetchS(&ofp->of_mbx, &msg, time);
+  if (rdymsg == MSG_OK)
+    *objpp = (void *)msg;
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves an object from an objects FIFO.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the FIFO is empty.
+ *
+ * @param[in] ofp       pointer to a @p objects_fifo_t structure
+ * @param[out] objpp    pointer to a variable for the received object pointer
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly received.
+ * @retval MSG_TIMEOUT  if the FIFO is empty.
+ *
+ * @iclass
+ */
+msg_t chFifoReceiveObjectI(objects_fifo_t *ofp, void **objpp) {
+
+  msg_t msg, rdymsg;
+
+  chDbgCheck(objpp != NULL);
+
+  rdymsg = chMBFetchI(&ofp->of_mbx, &msg);
+  if (rdymsg == MSG_OK)
+    *objpp = (void *)msg;
+  return rdymsg;
+}
+
+#endif /* CH_CFG_USE_OBJ_FIFOS */
+
+/** @} */
@@ -0,0 +1,358 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chpmboxes.c
+ * @brief   Priority mailboxes code.
+ *
+ * @addtogroup pmailboxes
+ * @details Asynchronous messages with priority.
+ *          <h2>Operation mode</h2>
+ *          A priority mailbox is a mailbox where each message carries a
+ *          priority level, messages are fetched in priority order and in
+ *          FIFO order within the same level. Urgent messages can so overtake
+ *          a backlog of less important ones without reordering them.<br>
+ *          Operations defined for priority mailboxes:
+ *          - <b>Post</b>: Posts a message on the mailbox with the specified
+ *            priority level.
+ *          - <b>Fetch</b>: The oldest message of the highest non-empty
+ *            priority level is fetched from the mailbox and removed from
+ *            the queue.
+ *          - <b>Reset</b>: The mailbox is emptied and all the stored messages
+ *            are lost.
+ *          .
+ *          The number of priority levels is fixed by the
+ *          @p CH_CFG_PMAILBOXES_LEVELS setting, level zero is the lowest.
+ *          Both operations execute in a time that does not depend on the
+ *          number of queued messages so they can be used from ISRs.
+ * @pre     In order to use the priority mailboxes APIs the
+ *          @p CH_CFG_USE_PMAILBOXES option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_PMAILBOXES || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Queues a message in the list of its priority level.
+ * @pre     A free slot must be available.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[in] msg       the message to be queued
+ * @param[in] prio      the message priority level
+ */
+static void pmb_insert(pmailbox_t *pmbp, msg_t msg, unsigned prio) {
+  pmb_slot_t *sp = pmbp->pmb_free;
+
+  pmbp->pmb_free = sp->ps_next;
+  sp->ps_next = NULL;
+  sp->ps_msg = msg;
+  if (pmbp->pmb_head[prio] == NULL)
+    pmbp->pmb_head[prio] = sp;
+  else
+    pmbp->pmb_tail[prio]->ps_next = sp;
+  pmbp->pmb_tail[prio] = sp;
+}
+
+/**
+ * @brief   Dequeues the oldest message of the highest priority level.
+ * @pre     A message must be queued.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @return              The dequeued message.
+ */
+static msg_t pmb_remove(pmailbox_t *pmbp) {
+  unsigned prio = CH_CFG_PMAILBOXES_LEVELS - 1;
+  pmb_slot_t *sp;
+
+  while (pmbp->pmb_head[prio] == NULL)
+    prio--;
+  sp = pmbp->pmb_head[prio];
+  pmbp->pmb_head[prio] = sp->ps_next;
+  sp->ps_next = pmbp->pmb_free;
+  pmbp->pmb_free = sp;
+  return sp->ps_msg;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p pmailbox_t object.
+ *
+ * @param[out] pmbp     the pointer to the @p pmailbox_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the messages buffer as an array of
+ *                      @p pmb_slot_t
+ * @param[in] n         number of elements in the buffer array
+ *
+ * @init
+ */
+void chPMBObjectInit(pmailbox_t *pmbp, pmb_slot_t *buf, cnt_t n) {
+  cnt_t i;
+
+  chDbgCheck((pmbp != NULL) && (buf != NULL) && (n > 0));
+
+  pmbp->pmb_free = NULL;
+  for (i = 0; i < n; i++) {
+    buf[i].ps_next = pmbp->pmb_free;
+    pmbp->pmb_free = &buf[i];
+  }
+  for (i = 0; i < CH_CFG_PMAILBOXES_LEVELS; i++)
+    pmbp->pmb_head[i] = NULL;
+  pmbp->pmb_size = n;
+  chSemObjectInit(&pmbp->pmb_emptysem, n);
+  chSemObjectInit(&pmbp->pmb_fullsem, 0);
+}
+
+/**
+ * @brief   Resets a @p pmailbox_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued messages are lost.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ *
+ * @api
+ */
+void chPMBReset(pmailbox_t *pmbp) {
+  unsigned i;
+
+  chDbgCheck(pmbp != NULL);
+
+  chSysLock();
+  for (i = 0; i < CH_CFG_PMAILBOXES_LEVELS; i++) {
+    if (pmbp->pmb_head[i] != NULL) {
+      pmbp->pmb_tail[i]->ps_next = pmbp->pmb_free;
+      pmbp->pmb_free = pmbp->pmb_head[i];
+      pmbp->pmb_head[i] = NULL;
+    }
+  }
+  chSemResetI(&pmbp->pmb_emptysem, pmbp->pmb_size);
+  chSemResetI(&pmbp->pmb_fullsem, 0);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Posts a message into a priority mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the specified time runs out.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] prio      the message priority level, from zero (lowest) to
+ *                      @p CH_CFG_PMAILBOXES_LEVELS-1 (highest)
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chPMBPost(pmailbox_t *pmbp, msg_t msg, unsigned prio, systime_t time) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chPMBPostS(pmbp, msg, prio, time);
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into a priority mailbox.
+ * @details The invoking thread waits until a empty slot in the mailbox becomes
+ *          available or the specified time runs out.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] prio      the message priority level, from zero (lowest) to
+ *                      @p CH_CFG_PMAILBOXES_LEVELS-1 (highest)
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chPMBPostS(pmailbox_t *pmbp, msg_t msg, unsigned prio, systime_t time) {
+  msg_t rdymsg;
+
+  chDbgCheckClassS();
+  chDbgCheck((pmbp != NULL) && (prio < CH_CFG_PMAILBOXES_LEVELS));
+
+  rdymsg = chSemWaitTimeoutS(&pmbp->pmb_emptysem, time);
+  if (rdymsg == MSG_OK) {
+    pmb_insert(pmbp, msg, prio);
+    chSemSignalI(&pmbp->pmb_fullsem);
+    chSchRescheduleS();
+  }
+  return rdymsg;
+}
+
+/**
+ * @brief   Posts a message into a priority mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is full.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] prio      the message priority level, from zero (lowest) to
+ *                      @p CH_CFG_PMAILBOXES_LEVELS-1 (highest)
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the mailbox is full and the message cannot be
+ *                      posted.
+ *
+ * @iclass
+ */
+msg_t chPMBPostI(pmailbox_t *pmbp, msg_t msg, unsigned prio) {
+
+  chDbgCheckClassI();
+  chDbgCheck((pmbp != NULL) && (prio < CH_CFG_PMAILBOXES_LEVELS));
+
+  if (chSemGetCounterI(&pmbp->pmb_emptysem) <= 0)
+    return MSG_TIMEOUT;
+  chSemFastWaitI(&pmbp->pmb_emptysem);
+  pmb_insert(pmbp, msg, prio);
+  chSemSignalI(&pmbp->pmb_fullsem);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Retrieves a message from a priority mailbox.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the specified time runs out.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chPMBFetch(pmailbox_t *pmbp, msg_t *msgp, systime_t time) {
+  msg_t rdymsg;
+
+  chSysLock();
+  rdymsg = chPMBFetchS(pmbp, msgp, time);
+  chSysUnlock();
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a priority mailbox.
+ * @details The invoking thread waits until a message is posted in the mailbox
+ *          or the specified time runs out.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the mailbox has been reset while waiting.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chPMBFetchS(pmailbox_t *pmbp, msg_t *msgp, systime_t time) {
+  msg_t rdymsg;
+
+  chDbgCheckClassS();
+  chDbgCheck((pmbp != NULL) && (msgp != NULL));
+
+  rdymsg = chSemWaitTimeoutS(&pmbp->pmb_fullsem, time);
+  if (rdymsg == MSG_OK) {
+    *msgp = pmb_remove(pmbp);
+    chSemSignalI(&pmbp->pmb_emptysem);
+    chSchRescheduleS();
+  }
+  return rdymsg;
+}
+
+/**
+ * @brief   Retrieves a message from a priority mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is empty.
+ *
+ * @param[in] pmbp      the pointer to an initialized @p pmailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the mailbox is empty and a message cannot be
+ *                      fetched.
+ *
+ * @iclass
+ */
+msg_t chPMBFetchI(pmailbox_t *pmbp, msg_t *msgp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((pmbp != NULL) && (msgp != NULL));
+
+  if (chSemGetCounterI(&pmbp->pmb_fullsem) <= 0)
+    return MSG_TIMEOUT;
+  chSemFastWaitI(&pmbp->pmb_fullsem);
+  *msgp = pmb_remove(pmbp);
+  chSemSignalI(&pmbp->pmb_emptysem);
+  return MSG_OK;
+}
+
+#endif /* CH_CFG_USE_PMAILBOXES */
+
+/** @} */
@@ -141,6 +141,13 @@ msg_t chIQPutI(input_queue_t *iqp, uint8_t b) {
   if (iqp->q_wrptr >= iqp->q_top)
     iqp->q_wrptr = iqp->q_buffer;
 
+#if CH_CFG_USE_WAITMULTIPLE
+  /* Threads waiting on the queue have precedence on multiple waits.*/
+  if (queue_isempty(&iqp->q_waiting)) {
+    _mwait_notify_i(iqp, Q_OK);
+    return Q_OK;
+  }
+#endif
   chThdDequeueNextI(&iqp->q_waiting, Q_OK);
 
   return Q_OK;
@@ -190,6 +197,49 @@ msg_t chIQGetTimeout(input_queue_t *iqp, systime_t time) {
   return b;
 }
 
+/**
+ * @brief   Input queue read with deadline.
+ * @details This function reads a byte value from an input queue. If the queue
+ *          is empty then the calling thread is suspended until a byte arrives
+ *          in the queue or the deadline is reached.
+ * @note    The callback is invoked before reading the character from the
+ *          buffer or before entering the state @p CH_STATE_WTQUEUE.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              A byte value from the queue.
+ * @retval Q_TIMEOUT    if the deadline has been reached.
+ * @retval Q_RESET      if the queue has been reset.
+ *
+ * @api
+ */
+msg_t chIQGetUntil(input_queue_t *iqp, systime_t deadline) {
+  uint8_t b;
+
+  chSysLock();
+  if (iqp->q_notify)
+    iqp->q_notify(iqp);
+
+  while (chIQIsEmptyI(iqp)) {
+    msg_t msg;
+    if ((msg = chThdEnqueueTimeoutS(&iqp->q_waiting,
+                                    chVTTimeUntilX(deadline))) < Q_OK) {
+      chSysUnlock();
+      return msg;
+    }
+  }
+
+  iqp->q_counter--;
+  b = *iqp->q_rdptr++;
+  if (iqp->q_rdptr >= iqp->q_top)
+    iqp->q_rdptr = iqp->q_buffer;
+
+  chSysUnlock();
+  return b;
+}
+
 /**
  * @brief   Input queue read with timeout.
  * @details The function reads data from an input queue into a buffer. The
@@ -247,6 +297,62 @@ size_t chIQReadTimeout(input_queue_t *iqp, uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Input queue read with deadline.
+ * @details The function reads data from an input queue into a buffer. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or when the deadline is reached or if the queue has
+ *          been reset.
+ * @note    The function is not atomic, if you need atomicity it is suggested
+ *          to use a semaphore or a mutex for mutual exclusion.
+ * @note    The callback is invoked before reading each character from the
+ *          buffer or before entering the state @p CH_STATE_WTQUEUE.
+ *
+ * @param[in] iqp       pointer to an @p input_queue_t structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chIQReadUntil(input_queue_t *iqp, uint8_t *bp,
+                     size_t n, systime_t deadline) {
+  qnotify_t nfy = iqp->q_notify;
+  size_t r = 0;
+
+  chDbgCheck(n > 0);
+
+  chSysLock();
+  while (true) {
+    if (nfy)
+      nfy(iqp);
+
+    while (chIQIsEmptyI(iqp)) {
+      if (chThdEnqueueTimeoutS(&iqp->q_waiting,
+                               chVTTimeUntilX(deadline)) != Q_OK) {
+        chSysUnlock();
+        return r;
+      }
+    }
+
+    iqp->q_counter--;
+    *bp++ = *iqp->q_rdptr++;
+    if (iqp->q_rdptr >= iqp->q_top)
+      iqp->q_rdptr = iqp->q_buffer;
+
+    chSysUnlock(); /* Gives a preemption chance in a controlled point.*/
+    r++;
+    if (--n == 0)
+      return r;
+
+    chSysLock();
+  }
+}
+
 /**
  * @brief   Initializes an output queue.
  * @details A Semaphore is internally initialized and works as a counter of
@@ -292,6 +398,9 @@ void chOQResetI(output_queue_t *oqp) {
   oqp->q_rdptr = oqp->q_wrptr = oqp->q_buffer;
   oqp->q_counter = chQSizeI(oqp);
   chThdDequeueAllI(&oqp->q_waiting, Q_RESET);
+#if CH_CFG_USE_WAITMULTIPLE
+  _mwait_notify_i(oqp, Q_OK);
+#endif
 }
 
 /**
@@ -340,6 +449,51 @@ msg_t chOQPutTimeout(output_queue_t *oqp, uint8_t b, systime_t time) {
   return Q_OK;
 }
 
+/**
+ * @brief   Output queue write with deadline.
+ * @details This function writes a byte value to an output queue. If the queue
+ *          is full then the calling thread is suspended until there is space
+ *          in the queue or the deadline is reached.
+ * @note    The callback is invoked after writing the character into the
+ *          buffer.
+ *
+ * @param[in] oqp       pointer to an @p output_queue_t structure
+ * @param[in] b         the byte value to be written in the queue
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The operation status.
+ * @retval Q_OK         if the operation succeeded.
+ * @retval Q_TIMEOUT    if the deadline has been reached.
+ * @retval Q_RESET      if the queue has been reset.
+ *
+ * @api
+ */
+msg_t chOQPutUntil(output_queue_t *oqp, uint8_t b, systime_t deadline) {
+
+  chSysLock();
+  while (chOQIsFullI(oqp)) {
+    msg_t msg;
+
+    if ((msg = chThdEnqueueTimeoutS(&oqp->q_waiting,
+                                    chVTTimeUntilX(deadline))) < Q_OK) {
+      chSysUnlock();
+      return msg;
+    }
+  }
+
+  oqp->q_counter--;
+  *oqp->q_wrptr++ = b;
+  if (oqp->q_wrptr >= oqp->q_top)
+    oqp->q_wrptr = oqp->q_buffer;
+
+  if (oqp->q_notify)
+    oqp->q_notify(oqp);
+
+  chSysUnlock();
+  return Q_OK;
+}
+
 /**
  * @brief   Output queue read.
  * @details A byte value is read from the low end of an output queue.
@@ -363,6 +517,13 @@ msg_t chOQGetI(output_queue_t *oqp) {
   if (oqp->q_rdptr >= oqp->q_top)
     oqp->q_rdptr = oqp->q_buffer;
 
+#if CH_CFG_USE_WAITMULTIPLE
+  /* Threads waiting on the queue have precedence on multiple waits.*/
+  if (queue_isempty(&oqp->q_waiting)) {
+    _mwait_notify_i(oqp, Q_OK);
+    return b;
+  }
+#endif
   chThdDequeueNextI(&oqp->q_waiting, Q_OK);
 
   return b;
@@ -422,6 +583,60 @@ size_t chOQWriteTimeout(output_queue_t *oqp, const uint8_t *bp,
     chSysLock();
   }
 }
+
+/**
+ * @brief   Output queue write with deadline.
+ * @details The function writes data from a buffer to an output queue. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or when the deadline is reached or if the queue has
+ *          been reset.
+ * @note    The function is not atomic, if you need atomicity it is suggested
+ *          to use a semaphore or a mutex for mutual exclusion.
+ * @note    The callback is invoked after writing each character into the
+ *          buffer.
+ *
+ * @param[in] oqp       pointer to an @p output_queue_t structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred, the
+ *                      value 0 is reserved
+ * @param[in] deadline  the absolute system time before the operation
+ *                      timeouts, a deadline already passed results in an
+ *                      immediate timeout
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chOQWriteUntil(output_queue_t *oqp, const uint8_t *bp,
+                      size_t n, systime_t deadline) {
+  qnotify_t nfy = oqp->q_notify;
+  size_t w = 0;
+
+  chDbgCheck(n > 0);
+
+  chSysLock();
+  while (true) {
+    while (chOQIsFullI(oqp)) {
+      if (chThdEnqueueTimeoutS(&oqp->q_waiting,
+                               chVTTimeUntilX(deadline)) != Q_OK) {
+        chSysUnlock();
+        return w;
+      }
+    }
+    oqp->q_counter--;
+    *oqp->q_wrptr++ = *bp++;
+    if (oqp->q_wrptr >= oqp->q_top)
+      oqp->q_wrptr = oqp->q_buffer;
+
+    if (nfy)
+      nfy(oqp);
+
+    chSysUnlock(); /* Gives a preemption chance in a controlled point.*/
+    w++;
+    if (--n == 0)
+      return w;
+    chSysLock();
+  }
+}
 #endif  /* CH_CFG_USE_QUEUES */
 
 /** @} */
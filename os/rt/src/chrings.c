@@ -0,0 +1,283 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chrings.c
+ * @brief   Lock-free rings code.
+ *
+ * @addtogroup rings
+ * @details Single producer single consumer lock-free rings.
+ *          <h2>Operation mode</h2>
+ *          A ring is a circular buffer of fixed size records connecting
+ *          exactly one producer and one consumer, for example an interrupt
+ *          handler and a thread. The producer only moves the write pointer
+ *          and the consumer only moves the read pointer so both sides
+ *          access the ring without entering a critical zone and without
+ *          waiting.<br>
+ *          Records are copied before the write pointer is updated and after
+ *          the read pointer has been read, the pointers and the buffer are
+ *          accessed as volatile data so the compiler cannot reorder those
+ *          accesses. This is sufficient when the producer and consumer run
+ *          on the same core.<br>
+ *          A consumer thread can optionally wait for a number of records to
+ *          be available, the producer is then responsible for invoking
+ *          @p chRingWakeupI(), @p chRingIsWakeupNeededX() allows it to enter
+ *          the critical zone only when the consumer has to be resumed.
+ * @pre     In order to use the rings APIs the @p CH_CFG_USE_RINGS option
+ *          must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_RINGS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p spsc_ring_t object.
+ *
+ * @param[out] rp       pointer to the @p spsc_ring_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the ring buffer, its size must be
+ *                      @p RING_BUFFER_SIZE(n, size)
+ * @param[in] n         number of records the ring can hold
+ * @param[in] size      size of a record
+ *
+ * @init
+ */
+void chRingObjectInit(spsc_ring_t *rp, uint8_t *buf, size_t n, size_t size) {
+
+  chDbgCheck((rp != NULL) && (buf != NULL) && (n > 0) && (size > 0));
+
+  rp->r_buffer = rp->r_wrptr = rp->r_rdptr = buf;
+  rp->r_top = buf + RING_BUFFER_SIZE(n, size);
+  rp->r_size = size;
+  rp->r_thread = NULL;
+  rp->r_threshold = 0;
+}
+
+/**
+ * @brief   Writes a record into a ring.
+ * @note    This function must only be invoked by the producer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @param[in] recp      pointer to the record to be written
+ * @return              The operation status.
+ * @retval true         if the record has been written.
+ * @retval false        if the ring is full.
+ *
+ * @xclass
+ */
+bool chRingWriteX(spsc_ring_t *rp, const void *recp) {
+  volatile uint8_t *wrptr = rp->r_wrptr;
+  volatile uint8_t *next = wrptr + rp->r_size;
+  const uint8_t *p = recp;
+  size_t n;
+
+  if (next >= rp->r_top)
+    next = rp->r_buffer;
+  if (next == rp->r_rdptr)
+    return false;
+  for (n = rp->r_size; n > 0; n--)
+    *wrptr++ = *p++;
+  rp->r_wrptr = next;
+  return true;
+}
+
+/**
+ * @brief   Reads a record from a ring.
+ * @note    This function must only be invoked by the consumer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @param[out] recp     pointer to a buffer for the record
+ * @return              The operation status.
+ * @retval true         if a record has been read.
+ * @retval false        if the ring is empty.
+ *
+ * @xclass
+ */
+bool chRingReadX(spsc_ring_t *rp, void *recp) {
+  volatile uint8_t *rdptr = rp->r_rdptr;
+  uint8_t *p = recp;
+  size_t n;
+
+  if (rdptr == rp->r_wrptr)
+    return false;
+  for (n = rp->r_size; n > 0; n--)
+    *p++ = *rdptr++;
+  if (rdptr >= rp->r_top)
+    rdptr = rp->r_buffer;
+  rp->r_rdptr = rdptr;
+  return true;
+}
+
+/**
+ * @brief   Writes a byte into a bytes ring.
+ * @pre     The ring records size must be one.
+ * @note    This function must only be invoked by the producer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @param[in] b         the byte to be written
+ * @return              The operation status.
+ * @retval true         if the byte has been written.
+ * @retval false        if the ring is full.
+ *
+ * @xclass
+ */
+bool chRingPutX(spsc_ring_t *rp, uint8_t b) {
+  volatile uint8_t *wrptr = rp->r_wrptr;
+  volatile uint8_t *next = wrptr + 1;
+
+  chDbgCheck(rp->r_size == 1);
+
+  if (next >= rp->r_top)
+    next = rp->r_buffer;
+  if (next == rp->r_rdptr)
+    return false;
+  *wrptr = b;
+  rp->r_wrptr = next;
+  return true;
+}
+
+/**
+ * @brief   Reads a byte from a bytes ring.
+ * @pre     The ring records size must be one.
+ * @note    This function must only be invoked by the consumer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @return              A byte value from the ring.
+ * @retval RING_EMPTY   if the ring is empty.
+ *
+ * @xclass
+ */
+msg_t chRingGetX(spsc_ring_t *rp) {
+  volatile uint8_t *rdptr = rp->r_rdptr;
+  uint8_t b;
+
+  chDbgCheck(rp->r_size == 1);
+
+  if (rdptr == rp->r_wrptr)
+    return RING_EMPTY;
+  b = *rdptr++;
+  if (rdptr >= rp->r_top)
+    rdptr = rp->r_buffer;
+  rp->r_rdptr = rdptr;
+  return (msg_t)b;
+}
+
+/**
+ * @brief   Resumes the consumer waiting on a ring.
+ * @details The consumer is resumed only if the number of records it is
+ *          waiting for has been reached.
+ * @note    This function must only be invoked by the producer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ *
+ * @iclass
+ */
+void chRingWakeupI(spsc_ring_t *rp) {
+
+  chDbgCheckClassI();
+
+  if (chRingIsWakeupNeededX(rp))
+    chThdResumeI(&rp->r_thread, MSG_OK);
+}
+
+/**
+ * @brief   Waits for records in a ring.
+ * @details The invoking thread waits until at least @p n records are in
+ *          the ring or the specified time runs out.
+ * @note    This function must only be invoked by the consumer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @param[in] n         number of records to wait for
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the records are available.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chRingWaitTimeout(spsc_ring_t *rp, size_t n, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRingWaitTimeoutS(rp, n, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Waits for records in a ring.
+ * @details The invoking thread waits until at least @p n records are in
+ *          the ring or the specified time runs out.
+ * @note    This function must only be invoked by the consumer.
+ *
+ * @param[in] rp        pointer to a @p spsc_ring_t structure
+ * @param[in] n         number of records to wait for
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the records are available.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chRingWaitTimeoutS(spsc_ring_t *rp, size_t n, systime_t time) {
+
+  chDbgCheckClassS();
+  chDbgCheck((rp != NULL) && (n > 0));
+
+  if (chRingGetUsedCountX(rp) >= n)
+    return MSG_OK;
+  rp->r_threshold = n;
+  return chThdSuspendTimeoutS(&rp->r_thread, time);
+}
+
+#endif /* CH_CFG_USE_RINGS */
+
+/** @} */
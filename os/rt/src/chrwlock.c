@@ -0,0 +1,667 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chrwlock.c
+ * @brief   Reader-writer locks code.
+ *
+ * @addtogroup rwlocks
+ * @details Reader-writer locks related APIs and services.
+ *
+ *          <h2>Operation mode</h2>
+ *          A reader-writer lock is a threads synchronization object that
+ *          can be in three distinct states:
+ *          - Not owned (unlocked).
+ *          - Owned by one or more readers (read locked).
+ *          - Owned by a single writer (write locked).
+ *          .
+ *          Operations defined for reader-writer locks:
+ *          - <b>Read Lock</b>: The lock is acquired in shared mode if it is
+ *            not owned by a writer and there are no writers waiting for it,
+ *            else the thread is queued on the lock in a list ordered by
+ *            priority.
+ *          - <b>Write Lock</b>: The lock is acquired in exclusive mode if it
+ *            is not owned, else the thread is queued on the lock in a list
+ *            ordered by priority.
+ *          - <b>Unlock</b>: The lock is released by the owner, when the lock
+ *            becomes available the waiting threads are made owners in
+ *            priority order, a writer is resumed alone while consecutive
+ *            readers are resumed together.
+ *          .
+ *          <h2>Writers preference</h2>
+ *          New readers are queued as soon as a writer is waiting, this way
+ *          a continuous flow of readers cannot starve the writers. Waiting
+ *          readers with a priority higher than the waiting writers are
+ *          still served first.
+ *
+ *          <h2>The priority inversion problem</h2>
+ *          Reader-writer locks implement the same priority inheritance
+ *          mechanism of mutexes, a thread queued on a lock boosts the
+ *          priority of the writer owning it or of all the readers owning
+ *          it. The mechanism is integrated with the mutexes one, chains of
+ *          mutexes and reader-writer locks are followed.<br>
+ *          If a waiting thread exits because a timeout then the priority
+ *          of the owners is recalculated immediately, the chains are
+ *          followed again in order to remove the inherited priority.
+ *
+ *          <h2>Constraints</h2>
+ *          Locks are not recursive, a thread cannot acquire again a lock
+ *          that it already owns in either mode. The number of locks that a
+ *          thread can hold in read mode at the same time is limited by the
+ *          @p CH_CFG_RWLOCKS_NESTING option, there is no limit for locks
+ *          held in write mode. Locks can be released in any order.
+ * @pre     In order to use the reader-writer lock APIs the
+ *          @p CH_CFG_USE_RWLOCKS option must be enabled in @p chconf.h.
+ * @post    Enabling reader-writer locks requires extra space in the
+ *          @p thread_t structure for each allowed read lock.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the reader record of a thread associated to a lock.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] rwp       pointer to the lock or @p NULL for a free record
+ * @return              The reader record.
+ * @retval NULL         if there is no such record.
+ */
+static rwlock_reader_t *get_record(thread_t *tp, rwlock_t *rwp) {
+  unsigned i;
+
+  for (i = 0; i < CH_CFG_RWLOCKS_NESTING; i++) {
+    if (tp->p_rdlocks[i].rr_lock == rwp)
+      return &tp->p_rdlocks[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Raises the priority of a thread and of the threads it depends
+ *          on.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] prio      the priority to be inherited
+ */
+static void boost_thread(thread_t *tp, tprio_t prio) {
+
+  while (tp->p_prio < prio) {
+    tp->p_prio = prio;
+
+    /* The following states need priority queues reordering.*/
+    switch (tp->p_state) {
+    case CH_STATE_WTMTX:
+      /* Re-enqueues the thread with its new priority and follows the
+         mutex owner.*/
+      queue_prio_insert(queue_dequeue(tp),
+                        (threads_queue_t *)tp->p_u.wtobjp);
+      tp = _mtx_get_owner((mutex_t *)tp->p_u.wtobjp);
+      continue;
+    case CH_STATE_WTRWLOCK:
+      /* Re-enqueues the thread with its new priority and follows all the
+         lock owners.*/
+      queue_prio_insert(queue_dequeue(tp),
+                        (threads_queue_t *)tp->p_u.wtobjp);
+      _rw_boost_owners((rwlock_t *)tp->p_u.wtobjp, prio);
+      break;
+#if CH_CFG_USE_CONDVARS |                                                   \
+    (CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY) |             \
+    (CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY)
+#if CH_CFG_USE_CONDVARS
+    case CH_STATE_WTCOND:
+#endif
+#if CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY
+    case CH_STATE_WTSEM:
+#endif
+#if CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY
+    case CH_STATE_SNDMSGQ:
+#endif
+      /* Re-enqueues tp with its new priority on the queue.*/
+      queue_prio_insert(queue_dequeue(tp),
+                        (threads_queue_t *)tp->p_u.wtobjp);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->p_state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      chSchReadyI(queue_dequeue(tp));
+      break;
+    }
+    break;
+  }
+}
+
+/**
+ * @brief   Lowers the priority of a thread and of the threads it depends
+ *          on.
+ * @details The priority of each thread is recalculated from the objects it
+ *          owns, this is required after a waiting thread left a queue
+ *          because a timeout.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+static void restore_thread(thread_t *tp) {
+  tprio_t newprio;
+
+  while ((newprio = _mtx_get_prio(tp)) < tp->p_prio) {
+    tp->p_prio = newprio;
+
+    /* The following states need priority queues reordering.*/
+    switch (tp->p_state) {
+    case CH_STATE_WTMTX:
+      /* Re-enqueues the thread with its new priority and follows the
+         mutex owner.*/
+      queue_prio_insert(queue_dequeue(tp),
+                        (threads_queue_t *)tp->p_u.wtobjp);
+      tp = _mtx_get_owner((mutex_t *)tp->p_u.wtobjp);
+      continue;
+    case CH_STATE_WTRWLOCK:
+      {
+        rwlock_t *rwp = (rwlock_t *)tp->p_u.wtobjp;
+        rwlock_reader_t *rrp;
+
+        /* Re-enqueues the thread with its new priority and follows all
+           the lock owners.*/
+        queue_prio_insert(queue_dequeue(tp), &rwp->rw_queue);
+        if (rwp->rw_writer != NULL) {
+          tp = rwp->rw_writer;
+          continue;
+        }
+        for (rrp = rwp->rw_readers; rrp != NULL; rrp = rrp->rr_next)
+          restore_thread(rrp->rr_thread);
+      }
+      break;
+#if CH_CFG_USE_CONDVARS |                                                   \
+    (CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY) |             \
+    (CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY)
+#if CH_CFG_USE_CONDVARS
+    case CH_STATE_WTCOND:
+#endif
+#if CH_CFG_USE_SEMAPHORES && CH_CFG_USE_SEMAPHORES_PRIORITY
+    case CH_STATE_WTSEM:
+#endif
+#if CH_CFG_USE_MESSAGES && CH_CFG_USE_MESSAGES_PRIORITY
+    case CH_STATE_SNDMSGQ:
+#endif
+      /* Re-enqueues tp with its new priority on the queue.*/
+      queue_prio_insert(queue_dequeue(tp),
+                        (threads_queue_t *)tp->p_u.wtobjp);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->p_state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      chSchReadyI(queue_dequeue(tp));
+      break;
+    }
+    break;
+  }
+}
+
+/**
+ * @brief   Lowers the priority of the owners of a reader-writer lock.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ */
+static void restore_owners(rwlock_t *rwp) {
+  rwlock_reader_t *rrp;
+
+  if (rwp->rw_writer != NULL)
+    restore_thread(rwp->rw_writer);
+  else {
+    for (rrp = rwp->rw_readers; rrp != NULL; rrp = rrp->rr_next)
+      restore_thread(rrp->rr_thread);
+  }
+}
+
+/**
+ * @brief   Makes the waiting threads owners of the lock when possible.
+ * @details The waiting threads are scanned in priority order, a writer
+ *          is made owner only if the lock is not owned, readers are made
+ *          owners if the lock is not owned by a writer. The scan stops at
+ *          the first thread that cannot become owner.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ */
+static void grant(rwlock_t *rwp) {
+
+  while (queue_notempty(&rwp->rw_queue)) {
+    thread_t *tp = rwp->rw_queue.p_next;
+    rwlock_reader_t *rrp = get_record(tp, rwp);
+
+    if (rrp == NULL) {
+      /* Writer, it requires exclusive ownership.*/
+      if ((rwp->rw_writer != NULL) || (rwp->rw_readers != NULL))
+        return;
+      rwp->rw_wrwaiting--;
+      rwp->rw_writer = tp;
+      rwp->rw_next = tp->p_rwlist;
+      tp->p_rwlist = rwp;
+      tp = queue_fifo_remove(&rwp->rw_queue);
+      tp->p_u.rdymsg = MSG_OK;
+      chSchReadyI(tp);
+      return;
+    }
+
+    /* Reader, the record reserved while waiting is linked to the lock.*/
+    if (rwp->rw_writer != NULL)
+      return;
+    rrp->rr_next = rwp->rw_readers;
+    rwp->rw_readers = rrp;
+    tp = queue_fifo_remove(&rwp->rw_queue);
+    tp->p_u.rdymsg = MSG_OK;
+    chSchReadyI(tp);
+  }
+}
+
+/**
+ * @brief   Enqueues the current thread on the lock.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] time      the number of ticks before the operation timeouts
+ * @return              The wakeup message.
+ */
+static msg_t sleep_on(rwlock_t *rwp, systime_t time) {
+  thread_t *ctp = currp;
+
+  /* Priority inheritance protocol, all the owners gain at least the
+     priority of the waiting thread.*/
+  _rw_boost_owners(rwp, ctp->p_prio);
+
+  queue_prio_insert(ctp, &rwp->rw_queue);
+  ctp->p_u.wtobjp = rwp;
+  return chSchGoSleepTimeoutS(CH_STATE_WTRWLOCK, time);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Raises the priority of the owners of a reader-writer lock.
+ * @note    This is an internal function used by the priority inheritance
+ *          mechanism, do not use it in application code.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] prio      the priority to be inherited
+ *
+ * @notapi
+ */
+void _rw_boost_owners(rwlock_t *rwp, tprio_t prio) {
+  rwlock_reader_t *rrp;
+
+  if (rwp->rw_writer != NULL)
+    boost_thread(rwp->rw_writer, prio);
+  else {
+    for (rrp = rwp->rw_readers; rrp != NULL; rrp = rrp->rr_next)
+      boost_thread(rrp->rr_thread, prio);
+  }
+}
+
+/**
+ * @brief   Calculates the priority inherited by a thread through the owned
+ *          reader-writer locks.
+ * @note    This is an internal function used by the priority inheritance
+ *          mechanism, do not use it in application code.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] prio      the priority inherited by other means
+ * @return              The highest between @p prio and the priority of the
+ *                      threads waiting on the owned locks.
+ *
+ * @notapi
+ */
+tprio_t _rw_get_inherited_prio(thread_t *tp, tprio_t prio) {
+  rwlock_t *rwp;
+  unsigned i;
+
+  for (rwp = tp->p_rwlist; rwp != NULL; rwp = rwp->rw_next) {
+    if (queue_notempty(&rwp->rw_queue) && (rwp->rw_queue.p_next->p_prio > prio))
+      prio = rwp->rw_queue.p_next->p_prio;
+  }
+  for (i = 0; i < CH_CFG_RWLOCKS_NESTING; i++) {
+    rwp = tp->p_rdlocks[i].rr_lock;
+    if ((rwp != NULL) && queue_notempty(&rwp->rw_queue) &&
+        (rwp->rw_queue.p_next->p_prio > prio))
+      prio = rwp->rw_queue.p_next->p_prio;
+  }
+  return prio;
+}
+
+/**
+ * @brief   Initializes s @p rwlock_t structure.
+ *
+ * @param[out] rwp      pointer to a @p rwlock_t structure
+ *
+ * @init
+ */
+void chRwObjectInit(rwlock_t *rwp) {
+
+  chDbgCheck(rwp != NULL);
+
+  queue_init(&rwp->rw_queue);
+  rwp->rw_writer = NULL;
+  rwp->rw_readers = NULL;
+  rwp->rw_next = NULL;
+  rwp->rw_wrwaiting = 0;
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in read mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+void chRwLockRead(rwlock_t *rwp) {
+
+  chSysLock();
+  chRwLockReadS(rwp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in read mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRwLockReadS(rwlock_t *rwp) {
+
+  (void) chRwLockReadTimeoutS(rwp, TIME_INFINITE);
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in read mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chRwLockReadTimeout(rwlock_t *rwp, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRwLockReadTimeoutS(rwp, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in read mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @sclass
+ */
+msg_t chRwLockReadTimeoutS(rwlock_t *rwp, systime_t time) {
+  thread_t *ctp = currp;
+  rwlock_reader_t *rrp;
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+  chDbgAssert(rwp->rw_writer != ctp, "owned in write mode");
+  chDbgAssert(get_record(ctp, rwp) == NULL, "owned in read mode");
+
+  /* The reader record is reserved before waiting, it also marks the
+     thread as a reader while queued.*/
+  rrp = get_record(ctp, NULL);
+  chDbgAssert(rrp != NULL, "too many read locks");
+  rrp->rr_lock = rwp;
+
+  /* Readers are queued if there is a writer owning the lock or waiting
+     for it.*/
+  if ((rwp->rw_writer == NULL) && (rwp->rw_wrwaiting == 0)) {
+    rrp->rr_next = rwp->rw_readers;
+    rwp->rw_readers = rrp;
+    return MSG_OK;
+  }
+
+  if (TIME_IMMEDIATE == time) {
+    rrp->rr_lock = NULL;
+    return MSG_TIMEOUT;
+  }
+
+  msg = sleep_on(rwp, time);
+  if (msg != MSG_OK) {
+    /* The owners could have inherited the priority of this thread.*/
+    rrp->rr_lock = NULL;
+    restore_owners(rwp);
+  }
+  return msg;
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in write mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+void chRwLockWrite(rwlock_t *rwp) {
+
+  chSysLock();
+  chRwLockWriteS(rwp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in write mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRwLockWriteS(rwlock_t *rwp) {
+
+  (void) chRwLockWriteTimeoutS(rwp, TIME_INFINITE);
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in write mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chRwLockWriteTimeout(rwlock_t *rwp, systime_t time) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRwLockWriteTimeoutS(rwp, time);
+  chSysUnlock();
+  return msg;
+}
+
+/**
+ * @brief   Locks the specified reader-writer lock in write mode.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @sclass
+ */
+msg_t chRwLockWriteTimeoutS(rwlock_t *rwp, systime_t time) {
+  thread_t *ctp = currp;
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+  chDbgAssert(rwp->rw_writer != ctp, "owned in write mode");
+  chDbgAssert(get_record(ctp, rwp) == NULL, "owned in read mode");
+
+  if ((rwp->rw_writer == NULL) && (rwp->rw_readers == NULL)) {
+    rwp->rw_writer = ctp;
+    rwp->rw_next = ctp->p_rwlist;
+    ctp->p_rwlist = rwp;
+    return MSG_OK;
+  }
+
+  if (TIME_IMMEDIATE == time)
+    return MSG_TIMEOUT;
+
+  rwp->rw_wrwaiting++;
+  msg = sleep_on(rwp, time);
+  if (msg != MSG_OK) {
+    /* The readers held back by this writer could now be able to acquire
+       the lock, then the owners priority is recalculated because they
+       could have inherited the priority of this thread or of the readers
+       just made owners.*/
+    rwp->rw_wrwaiting--;
+    grant(rwp);
+    restore_owners(rwp);
+    chSchRescheduleS();
+  }
+  return msg;
+}
+
+/**
+ * @brief   Unlocks the specified reader-writer lock.
+ * @details The lock is released in the mode it was acquired, if the lock
+ *          becomes available then the waiting threads are made owners.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+void chRwUnlock(rwlock_t *rwp) {
+
+  chSysLock();
+  chRwUnlockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Unlocks the specified reader-writer lock.
+ * @details The lock is released in the mode it was acquired, if the lock
+ *          becomes available then the waiting threads are made owners.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRwUnlockS(rwlock_t *rwp) {
+  thread_t *ctp = currp;
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  if (rwp->rw_writer == ctp) {
+    rwlock_t **rwpp = &ctp->p_rwlist;
+
+    /* Removes the lock from the thread's owned locks list.*/
+    while (*rwpp != rwp) {
+      chDbgAssert(*rwpp != NULL, "not in list");
+      rwpp = &(*rwpp)->rw_next;
+    }
+    *rwpp = rwp->rw_next;
+    rwp->rw_writer = NULL;
+  }
+  else {
+    rwlock_reader_t *rrp = get_record(ctp, rwp);
+    rwlock_reader_t **rrpp = &rwp->rw_readers;
+
+    chDbgAssert(rrp != NULL, "not owned");
+
+    /* Removes the thread's record from the lock readers list.*/
+    while (*rrpp != rrp) {
+      chDbgAssert(*rrpp != NULL, "not in list");
+      rrpp = &(*rrpp)->rr_next;
+    }
+    *rrpp = rrp->rr_next;
+    rrp->rr_lock = NULL;
+  }
+
+  /* The priority inherited through this lock is no more valid.*/
+  if (ctp->p_prio != ctp->p_realprio)
+    ctp->p_prio = _mtx_get_prio(ctp);
+
+  grant(rwp);
+}
+
+#endif /* CH_CFG_USE_RWLOCKS */
+
+/** @} */
@@ -285,6 +285,12 @@ static void wakeup(void *p) {
 #endif
 #if CH_CFG_USE_CONDVARS && CH_CFG_USE_CONDVARS_TIMEOUT
   case CH_STATE_WTCOND:
+#endif
+#if CH_CFG_USE_RWLOCKS
+  case CH_STATE_WTRWLOCK:
+#endif
+#if CH_CFG_USE_WAITMULTIPLE
+  case CH_STATE_WTMULTI:
 #endif
   case CH_STATE_QUEUED:
     /* States requiring dequeuing.*/
@@ -159,6 +159,10 @@ void chSemResetI(semaphore_t *sp, cnt_t n) {
   sp->s_cnt = n;
   while (++cnt <= 0)
     chSchReadyI(queue_lifo_remove(&sp->s_queue))->p_u.rdymsg = MSG_RESET;
+#if CH_CFG_USE_WAITMULTIPLE
+  if (n > 0)
+    _mwait_notify_i(sp, MSG_OK);
+#endif
 }
 
 /**
@@ -295,6 +299,12 @@ void chSemSignal(semaphore_t *sp) {
   chSysLock();
   if (++sp->s_cnt <= 0)
     chSchWakeupS(queue_fifo_remove(&sp->s_queue), MSG_OK);
+#if CH_CFG_USE_WAITMULTIPLE
+  else {
+    _mwait_notify_i(sp, MSG_OK);
+    chSchRescheduleS();
+  }
+#endif
   chSysUnlock();
 }
 
@@ -324,6 +334,10 @@ void chSemSignalI(semaphore_t *sp) {
     tp->p_u.rdymsg = MSG_OK;
     chSchReadyI(tp);
   }
+#if CH_CFG_USE_WAITMULTIPLE
+  else
+    _mwait_notify_i(sp, MSG_OK);
+#endif
 }
 
 /**
@@ -352,6 +366,10 @@ void chSemAddCounterI(semaphore_t *sp, cnt_t n) {
       chSchReadyI(queue_fifo_remove(&sp->s_queue))->p_u.rdymsg = MSG_OK;
     n--;
   }
+#if CH_CFG_USE_WAITMULTIPLE
+  if (sp->s_cnt > 0)
+    _mwait_notify_i(sp, MSG_OK);
+#endif
 }
 
 /**
@@ -381,6 +399,10 @@ msg_t chSemSignalWait(semaphore_t *sps, semaphore_t *spw) {
   chSysLock();
   if (++sps->s_cnt <= 0)
     chSchReadyI(queue_fifo_remove(&sps->s_queue))->p_u.rdymsg = MSG_OK;
+#if CH_CFG_USE_WAITMULTIPLE
+  else
+    _mwait_notify_i(sps, MSG_OK);
+#endif
   if (--spw->s_cnt < 0) {
     thread_t *ctp = currp;
     sem_insert(ctp, &spw->s_queue);
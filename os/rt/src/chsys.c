@@ -115,6 +115,12 @@ void chSysInit(void) {
 #if CH_CFG_USE_HEAP
   _heap_init();
 #endif
+#if CH_CFG_USE_DYNAMIC && CH_DYNAMIC_USE_CACHE
+  _thd_cache_init();
+#endif
+#if CH_CFG_USE_WAITMULTIPLE
+  _mwait_init();
+#endif
 #if CH_DBG_STATISTICS
   _stats_init();
 #endif
@@ -149,6 +155,12 @@ void chSysInit(void) {
   chThdCreateStatic(_idle_thread_wa, sizeof(_idle_thread_wa), IDLEPRIO,
                     (tfunc_t)_idle_thread, NULL);
 #endif
+
+#if CH_CFG_USE_DPC
+  /* The DPCs dispatcher thread is created last, it is immediately
+     suspended because there are no pending DPCs.*/
+  _dpc_init();
+#endif
 }
 
 /**
@@ -0,0 +1,355 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012,2013 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/**
+ * @file    chthdpools.c
+ * @brief   Thread pools code.
+ *
+ * @addtogroup thread_pools
+ * @details Pools of worker threads serving a jobs queue.
+ *          <h2>Operation mode</h2>
+ *          A thread pool is a set of worker threads allocated from a heap
+ *          and serving a bounded queue of jobs, a job is a function and its
+ *          argument. Submitting a job costs a memory pool allocation and a
+ *          priority mailbox post, it can be done from ISRs, while creating
+ *          a thread for each job would also cost the working area
+ *          allocation and the thread initialization.<br>
+ *          Jobs are served in priority order and in FIFO order within the
+ *          same priority level, the levels are those of the underlying
+ *          @ref pmailboxes.<br>
+ *          The pool starts with a minimum number of workers, more workers
+ *          are added when jobs are submitted from thread context and no
+ *          worker is idle, up to a maximum. Workers idle for longer than
+ *          a configured time exit until the minimum is reached again.
+ * @pre     In order to use the thread pools APIs the
+ *          @p CH_CFG_USE_THREAD_POOLS option must be enabled in
+ *          @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if CH_CFG_USE_THREAD_POOLS || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Worker thread.
+ * @details Serves the jobs queue until a @p NULL job is received or, when
+ *          there are more workers than the minimum, until the idle time
+ *          expires.
+ *
+ * @param[in] p         pointer to the @p thread_pool_t structure
+ */
+static msg_t tp_worker(void *p) {
+  thread_pool_t *tpp = p;
+  thread_pool_job_t *jp;
+  tpjob_t func;
+  void *arg;
+  rtcnt_t start;
+  msg_t msg;
+
+  chSysLock();
+  while (true) {
+    if (chPMBFetchS(&tpp->tp_queue, &msg, tpp->tp_config->idletime) != MSG_OK) {
+      if (tpp->tp_nworkers > tpp->tp_config->minworkers)
+        break;
+      continue;
+    }
+    if (msg == (msg_t)NULL)
+      break;
+
+    jp   = (thread_pool_job_t *)msg;
+    chTMStopMeasurementSinceX(&tpp->tp_stats.wait, jp->j_time);
+    func = jp->j_func;
+    arg  = jp->j_arg;
+    chPoolFreeI(&tpp->tp_jobs, jp);
+    start = chSysGetRealtimeCounterX();
+    chSysUnlock();
+
+    func(arg);
+
+    chSysLock();
+    /* Workers run concurrently so the start time stamp is kept locally.*/
+    chTMStopMeasurementSinceX(&tpp->tp_stats.exec, start);
+  }
+
+  /* The counter is decreased in the same critical zone of the exit so the
+     thread is terminated when the pool sees it gone.*/
+  tpp->tp_nworkers--;
+  chThdExitS(MSG_OK);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Adds a worker to the pool.
+ * @details The memory of the workers exited because idle is reclaimed
+ *          before allocating the new one.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @return              The operation status.
+ * @retval false        if the worker has been added.
+ * @retval true         if the pool is at its maximum size, another worker
+ *                      is being added or the memory is exhausted.
+ */
+static bool tp_add_worker(thread_pool_t *tpp) {
+  const thread_pool_config_t *cfg = tpp->tp_config;
+  thread_t *tp;
+  cnt_t i, slot = 0;
+
+  chSysLock();
+  if (tpp->tp_growing || (tpp->tp_nworkers >= cfg->maxworkers)) {
+    chSysUnlock();
+    return true;
+  }
+  tpp->tp_growing = true;
+  tpp->tp_nworkers++;
+  chSysUnlock();
+
+  /* There is always a free slot because the exited workers are no more
+     accounted in the workers counter.*/
+  for (i = cfg->maxworkers; i > 0; i--) {
+    tp = cfg->workers[i - 1];
+    if ((tp != NULL) && chThdTerminatedX(tp)) {
+      (void) chThdWait(tp);
+      cfg->workers[i - 1] = tp = NULL;
+    }
+    if (tp == NULL)
+      slot = i - 1;
+  }
+
+  tp = chThdCreateFromHeap(cfg->heapp, cfg->wsize, cfg->prio, tp_worker, tpp);
+
+  chSysLock();
+  if (tp == NULL)
+    tpp->tp_nworkers--;
+  else {
+    cfg->workers[slot] = tp;
+    if (tpp->tp_nworkers > tpp->tp_stats.peak)
+      tpp->tp_stats.peak = tpp->tp_nworkers;
+  }
+  tpp->tp_growing = false;
+  chSysUnlock();
+  return tp == NULL;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p thread_pool_t object.
+ * @note    No workers are started, see @p chThdPoolStart().
+ *
+ * @param[out] tpp      pointer to a @p thread_pool_t structure
+ * @param[in] config    pointer to the @p thread_pool_config_t structure,
+ *                      the arrays it refers to are owned by the pool
+ *
+ * @init
+ */
+void chThdPoolObjectInit(thread_pool_t *tpp,
+                         const thread_pool_config_t *config) {
+  cnt_t i;
+
+  chDbgCheck((tpp != NULL) && (config != NULL) &&
+             (config->minworkers <= config->maxworkers) &&
+             (config->maxworkers > 0) && (config->njobs > 0));
+
+  tpp->tp_config   = config;
+  tpp->tp_nworkers = 0;
+  tpp->tp_growing  = false;
+  chPMBObjectInit(&tpp->tp_queue, config->slots, config->njobs);
+  chPoolObjectInit(&tpp->tp_jobs, sizeof (thread_pool_job_t), NULL);
+  chPoolLoadArray(&tpp->tp_jobs, config->jobs, config->njobs);
+  for (i = 0; i < config->maxworkers; i++)
+    config->workers[i] = NULL;
+  chThdPoolResetStatistics(tpp);
+}
+
+/**
+ * @brief   Starts the minimum number of workers.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @return              The operation status.
+ * @retval false        if the workers have been started.
+ * @retval true         if the heap memory is exhausted, the workers already
+ *                      started keep running.
+ *
+ * @api
+ */
+bool chThdPoolStart(thread_pool_t *tpp) {
+  cnt_t i;
+
+  chDbgCheck(tpp != NULL);
+
+  for (i = 0; i < tpp->tp_config->minworkers; i++) {
+    if (tp_add_worker(tpp))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief   Stops all the workers.
+ * @details The jobs already queued are served before the workers exit, then
+ *          the workers memory is returned to the heap.
+ * @note    Jobs must not be submitted while the pool is being stopped.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ *
+ * @api
+ */
+void chThdPoolStop(thread_pool_t *tpp) {
+  const thread_pool_config_t *cfg = tpp->tp_config;
+  cnt_t i, n;
+
+  chDbgCheck(tpp != NULL);
+
+  chSysLock();
+  n = tpp->tp_nworkers;
+  chSysUnlock();
+
+  /* One exit request for each worker, queued at the lowest level.*/
+  for (i = 0; i < n; i++)
+    (void) chPMBPost(&tpp->tp_queue, (msg_t)NULL, 0, TIME_INFINITE);
+
+  for (i = 0; i < cfg->maxworkers; i++) {
+    if (cfg->workers[i] != NULL) {
+      (void) chThdWait(cfg->workers[i]);
+      cfg->workers[i] = NULL;
+    }
+  }
+
+  /* Requests left by workers exited because idle in the meantime.*/
+  chPMBReset(&tpp->tp_queue);
+}
+
+/**
+ * @brief   Submits a job to the pool.
+ * @details The job is queued and served by the first available worker,
+ *          no workers are added.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @param[in] func      the job function
+ * @param[in] arg       the job function argument
+ * @param[in] prio      the job priority level, from 0 (lowest) to
+ *                      @p CH_CFG_PMAILBOXES_LEVELS-1 (highest)
+ * @return              The operation status.
+ * @retval MSG_OK       if the job has been queued.
+ * @retval MSG_TIMEOUT  if the jobs queue is full.
+ *
+ * @iclass
+ */
+msg_t chThdPoolSubmitI(thread_pool_t *tpp, tpjob_t func, void *arg,
+                       unsigned prio) {
+  thread_pool_job_t *jp;
+
+  chDbgCheckClassI();
+  chDbgCheck((tpp != NULL) && (func != NULL));
+
+  jp = chPoolAllocI(&tpp->tp_jobs);
+  if (jp == NULL) {
+    tpp->tp_stats.rejected++;
+    return MSG_TIMEOUT;
+  }
+  jp->j_func = func;
+  jp->j_arg  = arg;
+  jp->j_time = chSysGetRealtimeCounterX();
+
+  /* There is a mailbox slot for each job object so the post cannot fail.*/
+  (void) chPMBPostI(&tpp->tp_queue, (msg_t)jp, prio);
+  return MSG_OK;
+}
+
+/**
+ * @brief   Submits a job to the pool.
+ * @details The job is queued and served by the first available worker. If
+ *          all the workers are busy and the pool is not at its maximum size
+ *          then a worker is added.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ * @param[in] func      the job function
+ * @param[in] arg       the job function argument
+ * @param[in] prio      the job priority level, from 0 (lowest) to
+ *                      @p CH_CFG_PMAILBOXES_LEVELS-1 (highest)
+ * @return              The operation status.
+ * @retval MSG_OK       if the job has been queued.
+ * @retval MSG_TIMEOUT  if the jobs queue is full.
+ *
+ * @api
+ */
+msg_t chThdPoolSubmit(thread_pool_t *tpp, tpjob_t func, void *arg,
+                      unsigned prio) {
+  msg_t msg;
+  bool grow;
+
+  chSysLock();
+  msg = chThdPoolSubmitI(tpp, func, arg, prio);
+  grow = (msg == MSG_OK) && (chPMBGetUsedCountI(&tpp->tp_queue) > 0) &&
+         (tpp->tp_nworkers < tpp->tp_config->maxworkers);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  if (grow)
+    (void) tp_add_worker(tpp);
+  return msg;
+}
+
+/**
+ * @brief   Resets the pool statistics.
+ *
+ * @param[in] tpp       pointer to a @p thread_pool_t structure
+ *
+ * @api
+ */
+void chThdPoolResetStatistics(thread_pool_t *tpp) {
+
+  chDbgCheck(tpp != NULL);
+
+  chSysLock();
+  tpp->tp_stats.rejected = 0;
+  tpp->tp_stats.peak     = tpp->tp_nworkers;
+  chTMObjectInit(&tpp->tp_stats.wait);
+  chTMObjectInit(&tpp->tp_stats.exec);
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_THREAD_POOLS */
+
+/** @} */
@@ -102,6 +102,17 @@ thread_t *_thread_init(thread_t *tp, tprio_t prio) {
   tp->p_realprio = prio;
   tp->p_mtxlist = NULL;
 #endif
+#if CH_CFG_USE_RWLOCKS
+  {
+    unsigned i;
+
+    tp->p_rwlist = NULL;
+    for (i = 0; i < CH_CFG_RWLOCKS_NESTING; i++) {
+      tp->p_rdlocks[i].rr_lock = NULL;
+      tp->p_rdlocks[i].rr_thread = tp;
+    }
+  }
+#endif
 #if CH_CFG_USE_EVENTS
   tp->p_epending = 0;
 #endif
@@ -324,6 +335,54 @@ void chThdSleepUntil(systime_t time) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Suspends the invoking thread until the end of a time window.
+ * @details The thread sleeps until @p next if the current system time is
+ *          within the window starting at @p prev and ending at @p next,
+ *          if the current system time is equal to @p next then the
+ *          function returns immediately without an overrun, otherwise the
+ *          window has been overrun and the function returns immediately.
+ * @note    This function is meant for periodic threads, the window is
+ *          the thread period and @p prev is the end of the previous one:
+ *          @code
+ *          systime_t time = chVTGetSystemTime();
+ *          while (true) {
+ *            systime_t prev = time;
+ *            time += MS2ST(10);
+ *            do_work();
+ *            if (chThdSleepUntilWindowed(prev, time))
+ *              handle_overrun();
+ *          }
+ *          @endcode
+ *
+ * @param[in] prev      the start of the time window, usually the end of the
+ *                      previous period
+ * @param[in] next      the end of the time window, it must be different
+ *                      from @p prev
+ * @return              The overrun state.
+ * @retval false        if the thread slept until @p next.
+ * @retval true         if the window has been overrun.
+ *
+ * @api
+ */
+bool chThdSleepUntilWindowed(systime_t prev, systime_t next) {
+  systime_t time;
+  bool overrun = true;
+
+  chDbgCheck(prev != next);
+
+  chSysLock();
+  time = chVTGetSystemTimeX();
+  if (time == next)
+    overrun = false;
+  else if (chVTIsTimeWithinX(time, prev, next)) {
+    chThdSleepS(next - time);
+    overrun = false;
+  }
+  chSysUnlock();
+  return overrun;
+}
+
 /**
  * @brief   Yields the time slot.
  * @details Yields the CPU control to the next thread in the ready list with
@@ -466,7 +525,7 @@ msg_t chThdSuspendS(thread_reference_t *trp) {
   chDbgAssert(*trp == NULL, "not NULL");
 
   *trp = tp;
-  tp->p_u.wtobjp = &trp;
+  tp->p_u.wtobjp = trp;
   chSchGoSleepS(CH_STATE_SUSPENDED);
   return chThdGetSelfX()->p_msg;
 }
@@ -499,7 +558,7 @@ msg_t chThdSuspendTimeoutS(thread_reference_t *trp, systime_t timeout) {
     return MSG_TIMEOUT;
 
   *trp = tp;
-  tp->p_u.wtobjp = &trp;
+  tp->p_u.wtobjp = trp;
   return chSchGoSleepTimeoutS(CH_STATE_SUSPENDED, timeout);
 }
 
@@ -150,6 +150,27 @@ NOINLINE void chTMChainMeasurementToX(time_measurement_t *tmp1,
   tm_stop(tmp1, tmp2->last, 0);
 }
 
+/**
+ * @brief   Stops a measurement started at the specified time stamp.
+ * @details This function is meant for measurements started in a different
+ *          context, for example when several measurements of the same
+ *          object overlap, the start time stamp is then kept by the caller.
+ *          The calibration offset is subtracted as in
+ *          @p chTMStopMeasurementX().
+ * @pre     The @p time_measurement_t structure must be initialized.
+ *
+ * @param[in,out] tmp   pointer to a @p time_measurement_t structure
+ * @param[in] start     the time stamp of the measurement start as returned
+ *                      by @p chSysGetRealtimeCounterX()
+ *
+ * @xclass
+ */
+void chTMStopMeasurementSinceX(time_measurement_t *tmp, rtcnt_t start) {
+
+  tmp->last = start;
+  tm_stop(tmp, chSysGetRealtimeCounterX(), ch.measurement_offset);
+}
+
 #endif /* CH_CFG_USE_TM */
 
 /** @} */
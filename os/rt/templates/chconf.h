@@ -192,6 +192,48 @@
  */
 #define CH_CFG_USE_MUTEXES_RECURSIVE        FALSE
 
+/**
+ * @brief   Enables the priority ceiling protocol on mutexes.
+ * @details If enabled then mutexes can be initialized to use the immediate
+ *          priority ceiling protocol instead of priority inheritance.
+ * @note    Ceiling mutexes have an increased memory footprint.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_MUTEXES_CEILING          FALSE
+
+/**
+ * @brief   Enables the mutexes fast path.
+ * @details If enabled then uncontended mutexes are locked and unlocked
+ *          using an atomic compare and swap without entering the kernel.
+ * @note    Requires a port supporting compare and swap, not compatible
+ *          with recursive mutexes.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_MUTEXES_FASTPATH         FALSE
+
+/**
+ * @brief   Reader-Writer Locks APIs.
+ * @details If enabled then the reader-writer locks APIs are included in
+ *          the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#define CH_CFG_USE_RWLOCKS                  FALSE
+
+/**
+ * @brief   Reader-Writer Locks read nesting.
+ * @details Maximum number of reader-writer locks a thread can hold in read
+ *          mode at the same time.
+ *
+ * @note    The default is 2.
+ * @note    Each level requires a reader record in the @p thread_t
+ *          structure.
+ */
+#define CH_CFG_RWLOCKS_NESTING              2
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -230,6 +272,28 @@
  */
 #define CH_CFG_USE_EVENTS_TIMEOUT           TRUE
 
+/**
+ * @brief   Events callbacks APIs.
+ * @details If enabled then event listeners can be registered as callbacks
+ *          invoked directly by the broadcasting event source.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_EVENTS.
+ */
+#define CH_CFG_USE_EVENTS_CALLBACKS         FALSE
+
+/**
+ * @brief   Maximum number of callbacks invoked by a single broadcast.
+ * @details Callback listeners exceeding this limit are skipped, their
+ *          flags are accumulated and passed to the callback on its next
+ *          invocation.
+ *
+ * @note    The default is 16.
+ * @note    This value bounds the time spent in the broadcast critical
+ *          zone.
+ */
+#define CH_CFG_EVENTS_CALLBACKS_MAX         16
+
 /**
  * @brief   Synchronous Messages APIs.
  * @details If enabled then the synchronous messages APIs are included
@@ -250,6 +314,16 @@
  */
 #define CH_CFG_USE_MESSAGES_PRIORITY        FALSE
 
+/**
+ * @brief   Asynchronous Messages APIs.
+ * @details If enabled then messages can also be sent without waiting for
+ *          the answer, the answer is delivered to a mailbox.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MESSAGES and @p CH_CFG_USE_MAILBOXES.
+ */
+#define CH_CFG_USE_MESSAGES_ASYNC           FALSE
+
 /**
  * @brief   Mailboxes APIs.
  * @details If enabled then the asynchronous messages (mailboxes) APIs are
@@ -260,6 +334,25 @@
  */
 #define CH_CFG_USE_MAILBOXES                TRUE
 
+/**
+ * @brief   Priority Mailboxes APIs.
+ * @details If enabled then the priority ordered mailboxes APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires @p CH_CFG_USE_SEMAPHORES.
+ */
+#define CH_CFG_USE_PMAILBOXES               TRUE
+
+/**
+ * @brief   Priority Mailboxes levels.
+ * @details Number of message priority levels in priority mailboxes.
+ *
+ * @note    The default is 4.
+ * @note    The fetch time grows linearly with this value, keep it small.
+ */
+#define CH_CFG_PMAILBOXES_LEVELS            4
+
 /**
  * @brief   I/O Queues APIs.
  * @details If enabled then the I/O queues APIs are included in the kernel.
@@ -268,6 +361,36 @@
  */
 #define CH_CFG_USE_QUEUES                   TRUE
 
+/**
+ * @brief   Lock-free Rings APIs.
+ * @details If enabled then the single producer single consumer lock-free
+ *          rings APIs are included in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ */
+#define CH_CFG_USE_RINGS                    TRUE
+
+/**
+ * @brief   Multiple objects wait APIs.
+ * @details If enabled then a thread can wait on semaphores, mailboxes,
+ *          I/O queues and event sources at the same time.
+ * @note    Enabling this option adds a check to all the functions
+ *          signaling those objects.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_WAITMULTIPLE             FALSE
+
+/**
+ * @brief   Cooperative tasks APIs.
+ * @details If enabled then the stackless cooperative tasks APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_WAITMULTIPLE.
+ */
+#define CH_CFG_USE_COOP                     FALSE
+
 /**
  * @brief   Core Memory Manager APIs.
  * @details If enabled then the core memory manager APIs are included
@@ -298,6 +421,26 @@
  */
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 
+/**
+ * @brief   Packet Buffers APIs.
+ * @details If enabled then the reference counted packet buffers APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#define CH_CFG_USE_BUFFERS                  FALSE
+
+/**
+ * @brief   Objects FIFOs APIs.
+ * @details If enabled then the objects FIFOs APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_MAILBOXES.
+ */
+#define CH_CFG_USE_OBJ_FIFOS                FALSE
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -309,6 +452,60 @@
  */
 #define CH_CFG_USE_DYNAMIC                  TRUE
 
+/**
+ * @brief   Dynamic threads working areas cache size.
+ * @details Number of working areas of terminated threads kept for reuse
+ *          by @p chThdCreateFromHeap(), zero disables the cache.
+ *
+ * @note    The default is zero.
+ * @note    Only working areas allocated from the default heap are cached.
+ */
+#define CH_CFG_DYNAMIC_CACHE_SIZE           0
+
+/**
+ * @brief   Thread pools APIs.
+ * @details If enabled then the thread pools APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_DYNAMIC and @p CH_CFG_USE_HEAP.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS, @p CH_CFG_USE_PMAILBOXES and
+ *          @p CH_CFG_USE_TM.
+ */
+#define CH_CFG_USE_THREAD_POOLS             FALSE
+
+/**
+ * @brief   Deferred procedure calls APIs.
+ * @details If enabled then the DPC APIs are included in the kernel and a
+ *          dispatcher thread is created by @p chSysInit().
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_DPC                      FALSE
+
+/**
+ * @brief   Priority of the DPCs dispatcher thread.
+ * @note    The value must be greater than @p NORMALPRIO, application
+ *          threads should have lower priorities.
+ */
+#define CH_CFG_DPC_PRIORITY                 HIGHPRIO
+
+/**
+ * @brief   Working area size of the DPCs dispatcher thread.
+ * @note    DPC functions are executed on this stack.
+ */
+#define CH_CFG_DPC_STACK_SIZE               256
+
+/**
+ * @brief   Basic tasks APIs.
+ * @details If enabled then the run-to-completion basic tasks APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires @p CH_CFG_USE_WAITEXIT.
+ */
+#define CH_CFG_USE_BASIC_TASKS              TRUE
+
 /** @} */
 
 /*===========================================================================*/
@@ -0,0 +1,616 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkcache.c
+ * @brief   Block cache code.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "blkcache.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static bool is_inserted(void *instance) {
+
+  return blkIsInserted(((BlockCache *)instance)->config->blkp);
+}
+
+static bool is_protected(void *instance) {
+
+  return blkIsWriteProtected(((BlockCache *)instance)->config->blkp);
+}
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct BlockCacheVMT bc_vmt = {
+  is_inserted,
+  is_protected,
+  (bool (*)(void *))bcConnect,
+  (bool (*)(void *))bcDisconnect,
+  (bool (*)(void *, uint32_t, uint8_t *, uint32_t))bcRead,
+  (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))bcWrite,
+  (bool (*)(void *))bcSync,
+  (bool (*)(void *, BlockDeviceInfo *))bcGetInfo
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Moves a buffer in the most recently used position.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] bp        pointer to the buffer
+ *
+ * @notapi
+ */
+static void touch(BlockCache *bcp, BlockCacheBuffer *bp) {
+
+  if (bcp->mru == bp)
+    return;
+
+  /* Unlinking.*/
+  bp->prev->next = bp->next;
+  if (bp->next != NULL)
+    bp->next->prev = bp->prev;
+  else
+    bcp->lru = bp->prev;
+
+  /* Insertion in head position.*/
+  bp->prev = NULL;
+  bp->next = bcp->mru;
+  bcp->mru->prev = bp;
+  bcp->mru = bp;
+}
+
+/**
+ * @brief   Searches a block in the cache.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] blk       block number
+ * @return              The buffer containing the block.
+ * @retval NULL         if the block is not cached.
+ *
+ * @notapi
+ */
+static BlockCacheBuffer *lookup(BlockCache *bcp, uint32_t blk) {
+  BlockCacheBuffer *bp = bcp->mru;
+
+  while (bp != NULL) {
+    if (bp->blk == blk)
+      return bp;
+    bp = bp->next;
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Searches a dirty block in the cache.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] blk       block number
+ * @return              The buffer containing the dirty block.
+ * @retval NULL         if the block is not cached or it is clean.
+ *
+ * @notapi
+ */
+static BlockCacheBuffer *lookup_dirty(BlockCache *bcp, uint32_t blk) {
+  BlockCacheBuffer *bp;
+
+  if (blk == BLKCACHE_NO_BLOCK)
+    return NULL;
+  bp = lookup(bcp, blk);
+  if ((bp != NULL) && (bp->flags & BLKCACHE_BUF_DIRTY))
+    return bp;
+  return NULL;
+}
+
+/**
+ * @brief   Writes back the run of dirty blocks containing a buffer.
+ * @details The run is extended in both directions to the adjacent dirty
+ *          blocks and written with a single multi-block command, up to the
+ *          size of the merge buffer.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] bp        pointer to a dirty buffer
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool writeback(BlockCache *bcp, BlockCacheBuffer *bp) {
+  const BlockCacheConfig *cfg = bcp->config;
+  BlockCacheBuffer *rbp;
+  uint32_t startblk, n;
+
+  /* Without a merge buffer the block is written alone.*/
+  if ((cfg->mrgbuf == NULL) || (cfg->mrgblocks < 2)) {
+    if (blkWrite(cfg->blkp, bp->blk, bp->data, 1))
+      return HAL_FAILED;
+    bp->flags &= ~BLKCACHE_BUF_DIRTY;
+    bcp->stats.writebacks++;
+    bcp->stats.wrcmds++;
+    return HAL_SUCCESS;
+  }
+
+  /* Searching the start of the run, it must not be farther than the merge
+     buffer size from the buffer being written back.*/
+  startblk = bp->blk;
+  while ((bp->blk - startblk + 1 < cfg->mrgblocks) &&
+         (lookup_dirty(bcp, startblk - 1) != NULL))
+    startblk--;
+
+  /* Gathering the run into the merge buffer.*/
+  n = 0;
+  while ((n < cfg->mrgblocks) &&
+         ((rbp = lookup_dirty(bcp, startblk + n)) != NULL)) {
+    memcpy(cfg->mrgbuf + n * bcp->blksize, rbp->data, bcp->blksize);
+    n++;
+  }
+
+  if (blkWrite(cfg->blkp, startblk, cfg->mrgbuf, n))
+    return HAL_FAILED;
+
+  /* The whole run is now clean.*/
+  while (n > 0) {
+    n--;
+    lookup(bcp, startblk + n)->flags &= ~BLKCACHE_BUF_DIRTY;
+    bcp->stats.writebacks++;
+  }
+  bcp->stats.wrcmds++;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Obtains a buffer for a new block.
+ * @details The least recently used buffer is recycled, if it is dirty then
+ *          it is written back first.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] blk       block number to be assigned to the buffer
+ * @return              The buffer, already in the most recently used
+ *                      position.
+ * @retval NULL         if the write-back of the old content failed.
+ *
+ * @notapi
+ */
+static BlockCacheBuffer *get_buffer(BlockCache *bcp, uint32_t blk) {
+  BlockCacheBuffer *bp = bcp->lru;
+
+  if (bp->flags & BLKCACHE_BUF_DIRTY) {
+    if (writeback(bcp, bp))
+      return NULL;
+  }
+  if (bp->flags & BLKCACHE_BUF_VALID)
+    bcp->stats.evictions++;
+
+  bp->blk   = blk;
+  bp->flags = 0;
+  touch(bcp, bp);
+  return bp;
+}
+
+/**
+ * @brief   Discards a buffer content.
+ *
+ * @param[in] bp        pointer to the buffer
+ *
+ * @notapi
+ */
+static void discard(BlockCacheBuffer *bp) {
+
+  bp->blk   = BLKCACHE_NO_BLOCK;
+  bp->flags = 0;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] bcp      pointer to the @p BlockCache object
+ *
+ * @init
+ */
+void bcObjectInit(BlockCache *bcp) {
+
+  bcp->vmt     = &bc_vmt;
+  bcp->state   = BLK_STOP;
+  bcp->config  = NULL;
+  bcp->mru     = NULL;
+  bcp->lru     = NULL;
+  bcp->blksize = 0;
+  bcResetStatistics(bcp);
+}
+
+/**
+ * @brief   Configures and activates the block cache.
+ * @note    The underlying block device must have already been started.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] config    pointer to the @p BlockCacheConfig object
+ *
+ * @api
+ */
+void bcStart(BlockCache *bcp, const BlockCacheConfig *config) {
+  uint32_t i;
+
+  osalDbgCheck((bcp != NULL) && (config != NULL) &&
+               (config->blkp != NULL) && (config->buffers != NULL) &&
+               (config->n > 0));
+  osalDbgAssert((bcp->state == BLK_STOP) || (bcp->state == BLK_ACTIVE),
+                "invalid state");
+
+  bcp->config = config;
+
+  /* Building the LRU list, all buffers initially empty.*/
+  for (i = 0; i < config->n; i++) {
+    BlockCacheBuffer *bp = &config->buffers[i];
+
+    bp->prev = i > 0 ? &config->buffers[i - 1] : NULL;
+    bp->next = i < config->n - 1 ? &config->buffers[i + 1] : NULL;
+    discard(bp);
+  }
+  bcp->mru = &config->buffers[0];
+  bcp->lru = &config->buffers[config->n - 1];
+
+  bcp->state = BLK_ACTIVE;
+}
+
+/**
+ * @brief   Deactivates the block cache.
+ * @note    Dirty buffers are not written back, use @p bcDisconnect() before
+ *          stopping the cache.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcStop(BlockCache *bcp) {
+
+  osalDbgCheck(bcp != NULL);
+  osalDbgAssert((bcp->state == BLK_STOP) || (bcp->state == BLK_ACTIVE),
+                "invalid state");
+
+  bcp->state = BLK_STOP;
+}
+
+/**
+ * @brief   Connects the underlying block device.
+ * @details The underlying device is connected and the cache content is
+ *          invalidated.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcConnect(BlockCache *bcp) {
+  BlockDeviceInfo bdi;
+
+  osalDbgCheck(bcp != NULL);
+  osalDbgAssert((bcp->state == BLK_ACTIVE) || (bcp->state == BLK_READY),
+                "invalid state");
+
+  bcp->state = BLK_CONNECTING;
+
+  if (blkConnect(bcp->config->blkp) ||
+      blkGetInfo(bcp->config->blkp, &bdi) ||
+      (bdi.blk_size > BLKCACHE_BLOCK_SIZE)) {
+    bcp->state = BLK_ACTIVE;
+    return HAL_FAILED;
+  }
+  bcp->blksize = bdi.blk_size;
+  bcInvalidate(bcp);
+
+  bcp->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Disconnects the underlying block device.
+ * @details Dirty buffers are written back before disconnecting.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcDisconnect(BlockCache *bcp) {
+  bool result;
+
+  osalDbgCheck(bcp != NULL);
+  osalDbgAssert((bcp->state == BLK_ACTIVE) || (bcp->state == BLK_READY),
+                "invalid state");
+
+  if (bcp->state == BLK_ACTIVE)
+    return HAL_SUCCESS;
+
+  result = bcSync(bcp);
+
+  bcp->state = BLK_DISCONNECTING;
+  if (blkDisconnect(bcp->config->blkp))
+    result = HAL_FAILED;
+  bcInvalidate(bcp);
+  bcp->state = BLK_ACTIVE;
+  return result;
+}
+
+/**
+ * @brief   Reads one or more blocks.
+ * @details Single block reads are served through the cache. Blocks missing
+ *          from the cache in multi-block reads are read directly into the
+ *          caller buffer in order to not pollute the cache with streamed
+ *          data, the cached blocks are moved in the most recently used
+ *          position as in single block reads.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] startblk  first block to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcRead(BlockCache *bcp, uint32_t startblk,
+            uint8_t *buffer, uint32_t n) {
+  BaseBlockDevice *blkp;
+  BlockCacheBuffer *bp;
+  uint32_t i, j;
+
+  osalDbgCheck((bcp != NULL) && (buffer != NULL) && (n > 0));
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  blkp = bcp->config->blkp;
+  bcp->state = BLK_READING;
+
+  if (n == 1) {
+    bp = lookup(bcp, startblk);
+    if (bp != NULL)
+      bcp->stats.hits++;
+    else {
+      bp = get_buffer(bcp, startblk);
+      if ((bp == NULL) || blkRead(blkp, startblk, bp->data, 1)) {
+        if (bp != NULL)
+          discard(bp);
+        bcp->state = BLK_READY;
+        return HAL_FAILED;
+      }
+      bp->flags = BLKCACHE_BUF_VALID;
+      bcp->stats.misses++;
+    }
+    touch(bcp, bp);
+    memcpy(buffer, bp->data, bcp->blksize);
+    bcp->state = BLK_READY;
+    return HAL_SUCCESS;
+  }
+
+  i = 0;
+  while (i < n) {
+    bp = lookup(bcp, startblk + i);
+    if (bp != NULL) {
+      touch(bcp, bp);
+      memcpy(buffer + i * bcp->blksize, bp->data, bcp->blksize);
+      bcp->stats.hits++;
+      i++;
+      continue;
+    }
+
+    /* Run of non-cached blocks, read with a single command.*/
+    j = i + 1;
+    while ((j < n) && (lookup(bcp, startblk + j) == NULL))
+      j++;
+    if (blkRead(blkp, startblk + i, buffer + i * bcp->blksize, j - i)) {
+      bcp->state = BLK_READY;
+      return HAL_FAILED;
+    }
+    bcp->stats.misses += j - i;
+    i = j;
+  }
+
+  bcp->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ * @details Single block writes are deferred, the block is marked as dirty
+ *          and written back on eviction or synchronization. Multi-block
+ *          writes are performed directly on the device and the cached
+ *          copies, if any, are updated.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] startblk  first block to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcWrite(BlockCache *bcp, uint32_t startblk,
+             const uint8_t *buffer, uint32_t n) {
+  BlockCacheBuffer *bp;
+  uint32_t i;
+
+  osalDbgCheck((bcp != NULL) && (buffer != NULL) && (n > 0));
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  bcp->state = BLK_WRITING;
+
+  if (n == 1) {
+    bp = lookup(bcp, startblk);
+    if (bp == NULL) {
+      bp = get_buffer(bcp, startblk);
+      if (bp == NULL) {
+        bcp->state = BLK_READY;
+        return HAL_FAILED;
+      }
+    }
+    else
+      bcp->stats.hits++;
+    touch(bcp, bp);
+    memcpy(bp->data, buffer, bcp->blksize);
+    bp->flags = BLKCACHE_BUF_VALID | BLKCACHE_BUF_DIRTY;
+    bcp->state = BLK_READY;
+    return HAL_SUCCESS;
+  }
+
+  if (blkWrite(bcp->config->blkp, startblk, buffer, n)) {
+    bcp->state = BLK_READY;
+    return HAL_FAILED;
+  }
+
+  /* Cached copies now clean and updated.*/
+  for (i = 0; i < n; i++) {
+    bp = lookup(bcp, startblk + i);
+    if (bp != NULL) {
+      touch(bcp, bp);
+      memcpy(bp->data, buffer + i * bcp->blksize, bcp->blksize);
+      bp->flags = BLKCACHE_BUF_VALID;
+    }
+  }
+
+  bcp->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes back all the dirty buffers.
+ * @details Dirty blocks are written back merging the runs of consecutive
+ *          blocks, then the underlying device is synchronized.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcSync(BlockCache *bcp) {
+  BlockCacheBuffer *bp;
+  bool result = HAL_SUCCESS;
+
+  osalDbgCheck(bcp != NULL);
+
+  if (bcp->state != BLK_READY)
+    return HAL_FAILED;
+
+  bcp->state = BLK_SYNCING;
+
+  for (bp = bcp->mru; bp != NULL; bp = bp->next) {
+    if ((bp->flags & BLKCACHE_BUF_DIRTY) && writeback(bcp, bp))
+      result = HAL_FAILED;
+  }
+  if (blkSync(bcp->config->blkp))
+    result = HAL_FAILED;
+
+  bcp->state = BLK_READY;
+  return result;
+}
+
+/**
+ * @brief   Returns the media info.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[out] bdip     pointer to a @p BlockDeviceInfo structure
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcGetInfo(BlockCache *bcp, BlockDeviceInfo *bdip) {
+
+  osalDbgCheck((bcp != NULL) && (bdip != NULL));
+
+  if (bcp->state != BLK_READY)
+    return HAL_FAILED;
+
+  return blkGetInfo(bcp->config->blkp, bdip);
+}
+
+/**
+ * @brief   Discards the whole cache content.
+ * @note    Dirty buffers are discarded without being written back, this
+ *          function is meant to be used after a media change.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcInvalidate(BlockCache *bcp) {
+  BlockCacheBuffer *bp;
+
+  osalDbgCheck(bcp != NULL);
+
+  for (bp = bcp->mru; bp != NULL; bp = bp->next)
+    discard(bp);
+}
+
+/**
+ * @brief   Resets the cache statistics.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcResetStatistics(BlockCache *bcp) {
+
+  osalDbgCheck(bcp != NULL);
+
+  bcp->stats.hits       = 0;
+  bcp->stats.misses     = 0;
+  bcp->stats.evictions  = 0;
+  bcp->stats.writebacks = 0;
+  bcp->stats.wrcmds     = 0;
+}
+
+/** @} */
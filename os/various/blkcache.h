@@ -0,0 +1,224 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkcache.h
+ * @brief   Block cache structures and macros.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#ifndef _BLKCACHE_H_
+#define _BLKCACHE_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Block number marking an unused cache buffer.
+ */
+#define BLKCACHE_NO_BLOCK           0xFFFFFFFFU
+
+/**
+ * @name    Cache buffer flags
+ * @{
+ */
+#define BLKCACHE_BUF_VALID          1       /**< @brief Contains a block.   */
+#define BLKCACHE_BUF_DIRTY          2       /**< @brief Not yet written.    */
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum block size handled by the cache.
+ * @details Devices reporting a larger block size are refused on connection.
+ */
+#if !defined(BLKCACHE_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define BLKCACHE_BLOCK_SIZE         512
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a cache buffer.
+ * @details Buffers are kept in a list ordered from the most recently used
+ *          to the least recently used one.
+ */
+typedef struct BlockCacheBuffer BlockCacheBuffer;
+
+/**
+ * @brief   Structure representing a cache buffer.
+ */
+struct BlockCacheBuffer {
+  BlockCacheBuffer      *next;              /**< @brief Next in LRU order.  */
+  BlockCacheBuffer      *prev;              /**< @brief Previous in LRU
+                                                 order.                     */
+  uint32_t              blk;                /**< @brief Cached block number
+                                                 or @p BLKCACHE_NO_BLOCK.   */
+  uint8_t               flags;              /**< @brief Buffer flags.       */
+  uint8_t               data[BLKCACHE_BLOCK_SIZE];
+                                            /**< @brief Block data.         */
+};
+
+/**
+ * @brief   Block cache configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief Underlying block device.
+   */
+  BaseBlockDevice       *blkp;
+  /**
+   * @brief Array of cache buffers.
+   */
+  BlockCacheBuffer      *buffers;
+  /**
+   * @brief Number of cache buffers.
+   */
+  uint32_t              n;
+  /**
+   * @brief Optional merge buffer used to coalesce runs of consecutive dirty
+   *        blocks into single multi-block writes.
+   * @note  Can be @p NULL, in this case dirty blocks are written back one at
+   *        time.
+   */
+  uint8_t               *mrgbuf;
+  /**
+   * @brief Size of the merge buffer in blocks.
+   */
+  uint32_t              mrgblocks;
+} BlockCacheConfig;
+
+/**
+ * @brief   Block cache statistics.
+ */
+typedef struct {
+  uint32_t              hits;               /**< @brief Blocks served from
+                                                 the cache.                 */
+  uint32_t              misses;             /**< @brief Blocks read from the
+                                                 device.                    */
+  uint32_t              evictions;          /**< @brief Valid buffers
+                                                 reused.                    */
+  uint32_t              writebacks;         /**< @brief Dirty blocks written
+                                                 back.                      */
+  uint32_t              wrcmds;             /**< @brief Write commands issued
+                                                 for write-back.            */
+} BlockCacheStatistics;
+
+/**
+ * @brief   @p BlockCache specific methods.
+ */
+#define _block_cache_methods                                                \
+  _base_block_device_methods
+
+/**
+ * @extends BaseBlockDeviceVMT
+ *
+ * @brief   @p BlockCache virtual methods table.
+ */
+struct BlockCacheVMT {
+  _block_cache_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Block cache object.
+ * @details The cache implements the @p BaseBlockDevice interface on top of
+ *          another block device, single block accesses are served through
+ *          a pool of LRU-managed buffers with write-back policy.
+ * @note    The object does not perform any locking, concurrent access must
+ *          be serialized by the upper layer as for any other block device.
+ */
+typedef struct {
+  /**
+   * @brief Virtual Methods Table.
+   */
+  const struct BlockCacheVMT *vmt;
+  _base_block_device_data
+  /**
+   * @brief Current configuration data.
+   */
+  const BlockCacheConfig *config;
+  /**
+   * @brief Most recently used buffer.
+   */
+  BlockCacheBuffer      *mru;
+  /**
+   * @brief Least recently used buffer.
+   */
+  BlockCacheBuffer      *lru;
+  /**
+   * @brief Block size of the underlying device.
+   */
+  uint32_t              blksize;
+  /**
+   * @brief Cache statistics.
+   */
+  BlockCacheStatistics  stats;
+} BlockCache;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the cache statistics.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              Pointer to the @p BlockCacheStatistics structure.
+ *
+ * @api
+ */
+#define bcGetStatistics(bcp) (&(bcp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bcObjectInit(BlockCache *bcp);
+  void bcStart(BlockCache *bcp, const BlockCacheConfig *config);
+  void bcStop(BlockCache *bcp);
+  bool bcConnect(BlockCache *bcp);
+  bool bcDisconnect(BlockCache *bcp);
+  bool bcRead(BlockCache *bcp, uint32_t startblk,
+              uint8_t *buffer, uint32_t n);
+  bool bcWrite(BlockCache *bcp, uint32_t startblk,
+               const uint8_t *buffer, uint32_t n);
+  bool bcSync(BlockCache *bcp);
+  bool bcGetInfo(BlockCache *bcp, BlockDeviceInfo *bdip);
+  void bcInvalidate(BlockCache *bcp);
+  void bcResetStatistics(BlockCache *bcp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BLKCACHE_H_ */
+
+/** @} */
@@ -0,0 +1,769 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blksched.c
+ * @brief   Block I/O scheduler code.
+ *
+ * @addtogroup block_scheduler
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "blksched.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+static bool is_inserted(void *instance) {
+
+  return blkIsInserted(((BlockScheduler *)instance)->config->blkp);
+}
+
+static bool is_protected(void *instance) {
+
+  return blkIsWriteProtected(((BlockScheduler *)instance)->config->blkp);
+}
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct BlockSchedulerVMT bs_vmt = {
+  is_inserted,
+  is_protected,
+  (bool (*)(void *))bsConnect,
+  (bool (*)(void *))bsDisconnect,
+  (bool (*)(void *, uint32_t, uint8_t *, uint32_t))bsRead,
+  (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))bsWrite,
+  (bool (*)(void *))bsSync,
+  (bool (*)(void *, BlockDeviceInfo *))bsGetInfo
+};
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks if two requests must be served in submission order.
+ * @details This is the case when the requests access common blocks and at
+ *          least one of them is a write.
+ *
+ * @param[in] rp1       pointer to the first request
+ * @param[in] rp2       pointer to the second request
+ * @return              The ordering requirement.
+ *
+ * @notapi
+ */
+static bool conflicting(BlockRequest *rp1, BlockRequest *rp2) {
+
+  return ((rp1->op == BLKSCHED_OP_WRITE) || (rp2->op == BLKSCHED_OP_WRITE)) &&
+         (rp1->startblk < rp2->startblk + rp2->n) &&
+         (rp2->startblk < rp1->startblk + rp1->n);
+}
+
+/**
+ * @brief   Moves the submitted requests into the queue.
+ * @details Requests on the same block keep the submission order.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        list of the submitted requests, most recent first
+ *
+ * @notapi
+ */
+static void enqueue(BlockScheduler *bsp, BlockRequest *rp) {
+  BlockRequest *list, *next, **rpp;
+
+  /* Restoring the submission order.*/
+  list = NULL;
+  while (rp != NULL) {
+    next = rp->next;
+    rp->next = list;
+    list = rp;
+    rp = next;
+  }
+
+  /* Ordered insertion.*/
+  while (list != NULL) {
+    rp = list;
+    list = rp->next;
+    rpp = &bsp->queue;
+    while ((*rpp != NULL) && ((*rpp)->startblk <= rp->startblk))
+      rpp = &(*rpp)->next;
+    rp->next = *rpp;
+    *rpp = rp;
+  }
+}
+
+/**
+ * @brief   Searches the oldest queued request that must precede a request.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        pointer to the request
+ * @return              The preceding request.
+ * @retval NULL         if the request can be served.
+ *
+ * @notapi
+ */
+static BlockRequest *preceding(BlockScheduler *bsp, BlockRequest *rp) {
+  BlockRequest *qp, *pp = NULL;
+
+  for (qp = bsp->queue; qp != NULL; qp = qp->next) {
+    if (((int32_t)(qp->seq - rp->seq) < 0) && conflicting(qp, rp) &&
+        ((pp == NULL) || ((int32_t)(qp->seq - pp->seq) < 0)))
+      pp = qp;
+  }
+  return pp;
+}
+
+/**
+ * @brief   Removes a request from the queue.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        pointer to the queued request
+ *
+ * @notapi
+ */
+static void dequeue(BlockScheduler *bsp, BlockRequest *rp) {
+  BlockRequest **rpp = &bsp->queue;
+
+  while (*rpp != rp)
+    rpp = &(*rpp)->next;
+  *rpp = rp->next;
+  rp->next = NULL;
+  rp->state = BLKSCHED_REQ_ACTIVE;
+}
+
+/**
+ * @brief   Searches a queued request that can be merged at one end of a run.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] op        operation of the run
+ * @param[in] startblk  first block of the run
+ * @param[in] n         number of blocks in the run
+ * @param[in] after     search after the run if @p true, before otherwise
+ * @return              The adjacent request.
+ * @retval NULL         if there is no mergeable request.
+ *
+ * @notapi
+ */
+static BlockRequest *adjacent(BlockScheduler *bsp, uint8_t op,
+                              uint32_t startblk, uint32_t n, bool after) {
+  BlockRequest *qp;
+
+  for (qp = bsp->queue; qp != NULL; qp = qp->next) {
+    if ((qp->op != op) ||
+        (n + qp->n > bsp->config->mrgblocks) ||
+        (after ? (qp->startblk != startblk + n) :
+                 (qp->startblk + qp->n != startblk)))
+      continue;
+    if (preceding(bsp, qp) == NULL)
+      return qp;
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Selects the next requests to be served.
+ * @details Requests past their deadline are served first, oldest first.
+ *          Otherwise the queue is scanned in ascending block order starting
+ *          from the current position and wrapping to the lowest block, the
+ *          selected request is then extended with the adjacent requests of
+ *          the same kind.
+ * @note    The queue must not be empty.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @return              The list of the requests to be served, ordered by
+ *                      block number.
+ *
+ * @notapi
+ */
+static BlockRequest *next_batch(BlockScheduler *bsp) {
+  const BlockSchedulerConfig *cfg = bsp->config;
+  BlockRequest *rp, *qp, *head, *tail;
+  uint32_t startblk, n;
+
+  /* Expired requests have precedence.*/
+  rp = NULL;
+  for (qp = bsp->queue; qp != NULL; qp = qp->next) {
+    systime_t deadline = qp->op == BLKSCHED_OP_READ ? cfg->rddeadline :
+                                                      cfg->wrdeadline;
+    if ((chVTTimeElapsedSinceX(qp->time) >= deadline) &&
+        ((rp == NULL) || ((int32_t)(qp->seq - rp->seq) < 0)))
+      rp = qp;
+  }
+  if (rp != NULL)
+    bsp->stats.expired++;
+  else {
+    /* Elevator order, the queue is sorted by block number.*/
+    rp = bsp->queue;
+    while ((rp != NULL) && (rp->startblk < bsp->position))
+      rp = rp->next;
+    if (rp == NULL)
+      rp = bsp->queue;
+  }
+
+  /* Requests accessing the same blocks must not be reordered.*/
+  while ((qp = preceding(bsp, rp)) != NULL)
+    rp = qp;
+
+  dequeue(bsp, rp);
+  head = tail = rp;
+  startblk = rp->startblk;
+  n = rp->n;
+
+  /* Merging adjacent requests, if possible.*/
+  if ((cfg->mrgbuf != NULL) && (cfg->mrgblocks >= 2)) {
+    while ((qp = adjacent(bsp, rp->op, startblk, n, true)) != NULL) {
+      dequeue(bsp, qp);
+      tail->next = qp;
+      tail = qp;
+      n += qp->n;
+    }
+    while ((qp = adjacent(bsp, rp->op, startblk, n, false)) != NULL) {
+      dequeue(bsp, qp);
+      qp->next = head;
+      head = qp;
+      startblk = qp->startblk;
+      n += qp->n;
+    }
+  }
+
+  bsp->position = startblk + n;
+  return head;
+}
+
+/**
+ * @brief   Performs the I/O for a list of adjacent requests.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] head      list of requests ordered by block number
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool serve(BlockScheduler *bsp, BlockRequest *head) {
+  const BlockSchedulerConfig *cfg = bsp->config;
+  BlockRequest *rp;
+  uint8_t *p;
+  uint32_t n;
+
+  bsp->stats.commands++;
+
+  /* Single request, no need to pass through the merge buffer.*/
+  if (head->next == NULL) {
+    bsp->stats.requests++;
+    if (head->op == BLKSCHED_OP_READ)
+      return blkRead(cfg->blkp, head->startblk, head->buf, head->n);
+    return blkWrite(cfg->blkp, head->startblk, head->buf, head->n);
+  }
+
+  n = 0;
+  for (rp = head; rp != NULL; rp = rp->next) {
+    bsp->stats.requests++;
+    bsp->stats.merged++;
+    n += rp->n;
+  }
+
+  if (head->op == BLKSCHED_OP_READ) {
+    if (blkRead(cfg->blkp, head->startblk, cfg->mrgbuf, n))
+      return HAL_FAILED;
+    for (rp = head, p = cfg->mrgbuf; rp != NULL; rp = rp->next) {
+      memcpy(rp->buf, p, rp->n * bsp->blksize);
+      p += rp->n * bsp->blksize;
+    }
+    return HAL_SUCCESS;
+  }
+
+  for (rp = head, p = cfg->mrgbuf; rp != NULL; rp = rp->next) {
+    memcpy(p, rp->buf, rp->n * bsp->blksize);
+    p += rp->n * bsp->blksize;
+  }
+  return blkWrite(cfg->blkp, head->startblk, cfg->mrgbuf, n);
+}
+
+/**
+ * @brief   Completes a list of requests.
+ * @details The threads waiting for the queue to be drained are woken up
+ *          when no more requests are pending.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        list of requests
+ * @param[in] result    result of the requests
+ *
+ * @notapi
+ */
+static void complete(BlockScheduler *bsp, BlockRequest *rp, bool result) {
+  BlockRequest *next;
+
+  while (rp != NULL) {
+    next = rp->next;
+    rp->next   = NULL;
+    rp->result = result;
+    rp->state  = BLKSCHED_REQ_DONE;
+    if (rp->thread != NULL)
+      chEvtSignalI(rp->thread, rp->events);
+    chThdResumeI(&rp->waiting, MSG_OK);
+    bsp->pending--;
+    rp = next;
+  }
+  if (bsp->pending == 0)
+    chThdDequeueAllI(&bsp->drain, MSG_OK);
+}
+
+/**
+ * @brief   Worker thread.
+ * @details The queue is only accessed by this thread, the submitted
+ *          requests are taken in a critical zone of constant duration and
+ *          the batches are selected outside of it.
+ *
+ * @param[in] p         pointer to the @p BlockScheduler object
+ */
+static msg_t bs_thread(void *p) {
+  BlockScheduler *bsp = p;
+  BlockRequest *rp;
+  bool result;
+
+  chRegSetThreadName("blksched");
+
+  chSysLock();
+  while (true) {
+    rp = bsp->incoming;
+    bsp->incoming = NULL;
+    if (chThdShouldTerminateX())
+      break;
+    if ((rp == NULL) && (bsp->queue == NULL)) {
+      chThdSuspendS(&bsp->idle);
+      continue;
+    }
+    chSysUnlock();
+
+    enqueue(bsp, rp);
+    rp = next_batch(bsp);
+    result = serve(bsp, rp);
+
+    chSysLock();
+    complete(bsp, rp, result);
+    chSchRescheduleS();
+  }
+
+  /* The requests still pending on termination are failed.*/
+  complete(bsp, rp, HAL_FAILED);
+  complete(bsp, bsp->queue, HAL_FAILED);
+  bsp->queue = NULL;
+  chSysUnlock();
+  return MSG_OK;
+}
+
+/**
+ * @brief   Submits a request to the worker thread.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        pointer to the request
+ *
+ * @notapi
+ */
+static void submit(BlockScheduler *bsp, BlockRequest *rp) {
+
+  chDbgAssert(rp->state != BLKSCHED_REQ_QUEUED &&
+              rp->state != BLKSCHED_REQ_ACTIVE, "request in use");
+
+  chSysLock();
+  chDbgAssert(bsp->state == BLK_READY, "invalid state");
+
+  rp->state = BLKSCHED_REQ_QUEUED;
+  rp->seq   = bsp->seq++;
+  rp->time  = chVTGetSystemTimeX();
+  rp->next  = bsp->incoming;
+  bsp->incoming = rp;
+  bsp->pending++;
+
+  chThdResumeS(&bsp->idle, MSG_OK);
+  chSysUnlock();
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] bsp      pointer to the @p BlockScheduler object
+ *
+ * @init
+ */
+void bsObjectInit(BlockScheduler *bsp) {
+
+  bsp->vmt      = &bs_vmt;
+  bsp->state    = BLK_STOP;
+  bsp->config   = NULL;
+  bsp->incoming = NULL;
+  bsp->queue    = NULL;
+  bsp->pending  = 0;
+  bsp->position = 0;
+  bsp->seq      = 0;
+  bsp->blksize  = 0;
+  bsp->worker   = NULL;
+  bsp->idle     = NULL;
+  chThdQueueObjectInit(&bsp->drain);
+  bsResetStatistics(bsp);
+}
+
+/**
+ * @brief   Configures and activates the scheduler.
+ * @details The worker thread is created.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] config    pointer to the @p BlockSchedulerConfig object
+ *
+ * @api
+ */
+void bsStart(BlockScheduler *bsp, const BlockSchedulerConfig *config) {
+
+  chDbgCheck((bsp != NULL) && (config != NULL) &&
+             (config->blkp != NULL) && (config->wsp != NULL));
+  chDbgAssert((bsp->state == BLK_STOP) || (bsp->state == BLK_ACTIVE),
+              "invalid state");
+
+  if (bsp->state == BLK_ACTIVE)
+    return;
+
+  bsp->config = config;
+  bsp->worker = chThdCreateStatic(config->wsp, config->wsize,
+                                  config->prio, bs_thread, bsp);
+  bsp->state  = BLK_ACTIVE;
+}
+
+/**
+ * @brief   Deactivates the scheduler.
+ * @details The worker thread is terminated, the requests still pending are
+ *          completed with an error.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ *
+ * @api
+ */
+void bsStop(BlockScheduler *bsp) {
+
+  chDbgCheck(bsp != NULL);
+  chDbgAssert((bsp->state == BLK_STOP) || (bsp->state == BLK_ACTIVE),
+              "invalid state");
+
+  if (bsp->state == BLK_STOP)
+    return;
+
+  chThdTerminate(bsp->worker);
+  chSysLock();
+  chThdResumeS(&bsp->idle, MSG_OK);
+  chSysUnlock();
+  chThdWait(bsp->worker);
+  bsp->worker = NULL;
+  bsp->state  = BLK_STOP;
+}
+
+/**
+ * @brief   Connects the underlying device.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsConnect(BlockScheduler *bsp) {
+  BlockDeviceInfo bdi;
+
+  chDbgCheck(bsp != NULL);
+  chDbgAssert((bsp->state == BLK_ACTIVE) || (bsp->state == BLK_READY),
+              "invalid state");
+
+  if (bsp->state == BLK_READY)
+    return HAL_SUCCESS;
+
+  bsp->state = BLK_CONNECTING;
+  if (blkConnect(bsp->config->blkp) ||
+      blkGetInfo(bsp->config->blkp, &bdi)) {
+    bsp->state = BLK_ACTIVE;
+    return HAL_FAILED;
+  }
+  bsp->blksize  = bdi.blk_size;
+  bsp->position = 0;
+  bsp->state    = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Disconnects the underlying device.
+ * @details The pending requests are completed first.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsDisconnect(BlockScheduler *bsp) {
+  bool result;
+
+  chDbgCheck(bsp != NULL);
+  chDbgAssert((bsp->state == BLK_ACTIVE) || (bsp->state == BLK_READY),
+              "invalid state");
+
+  if (bsp->state == BLK_ACTIVE)
+    return HAL_SUCCESS;
+
+  result = bsSync(bsp);
+
+  bsp->state = BLK_DISCONNECTING;
+  if (blkDisconnect(bsp->config->blkp))
+    result = HAL_FAILED;
+  bsp->state = BLK_ACTIVE;
+  return result;
+}
+
+/**
+ * @brief   Reads one or more blocks.
+ * @details A request is queued and the function waits for its completion.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] startblk  first block to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsRead(BlockScheduler *bsp, uint32_t startblk,
+            uint8_t *buffer, uint32_t n) {
+  BlockRequest req;
+
+  bsRequestObjectInit(&req, NULL, 0);
+  bsSubmitRead(bsp, &req, startblk, buffer, n);
+  return bsWaitRequest(&req);
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ * @details A request is queued and the function waits for its completion.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] startblk  first block to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsWrite(BlockScheduler *bsp, uint32_t startblk,
+             const uint8_t *buffer, uint32_t n) {
+  BlockRequest req;
+
+  bsRequestObjectInit(&req, NULL, 0);
+  bsSubmitWrite(bsp, &req, startblk, buffer, n);
+  return bsWaitRequest(&req);
+}
+
+/**
+ * @brief   Waits for the queued requests to complete then synchronizes
+ *          the underlying device.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsSync(BlockScheduler *bsp) {
+
+  chDbgCheck(bsp != NULL);
+
+  if (bsp->state != BLK_READY)
+    return HAL_FAILED;
+
+  chSysLock();
+  while (bsp->pending > 0)
+    chThdEnqueueTimeoutS(&bsp->drain, TIME_INFINITE);
+  chSysUnlock();
+
+  return blkSync(bsp->config->blkp);
+}
+
+/**
+ * @brief   Returns the media info.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[out] bdip     pointer to a @p BlockDeviceInfo structure
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsGetInfo(BlockScheduler *bsp, BlockDeviceInfo *bdip) {
+
+  chDbgCheck((bsp != NULL) && (bdip != NULL));
+
+  if (bsp->state != BLK_READY)
+    return HAL_FAILED;
+
+  return blkGetInfo(bsp->config->blkp, bdip);
+}
+
+/**
+ * @brief   Initializes a request object.
+ *
+ * @param[out] rp       pointer to the @p BlockRequest object
+ * @param[in] tp        thread to be signaled on completion or @p NULL
+ * @param[in] events    events to be signaled on completion
+ *
+ * @init
+ */
+void bsRequestObjectInit(BlockRequest *rp, thread_t *tp,
+                         eventmask_t events) {
+
+  rp->next    = NULL;
+  rp->state   = BLKSCHED_REQ_IDLE;
+  rp->result  = HAL_SUCCESS;
+  rp->thread  = tp;
+  rp->events  = events;
+  rp->waiting = NULL;
+}
+
+/**
+ * @brief   Queues a read request.
+ * @details The function returns immediately, the completion is notified
+ *          by signaling the events specified in the request object.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        pointer to the @p BlockRequest object
+ * @param[in] startblk  first block to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ *
+ * @api
+ */
+void bsSubmitRead(BlockScheduler *bsp, BlockRequest *rp,
+                  uint32_t startblk, uint8_t *buffer, uint32_t n) {
+
+  chDbgCheck((bsp != NULL) && (rp != NULL) && (buffer != NULL) && (n > 0));
+
+  rp->op       = BLKSCHED_OP_READ;
+  rp->startblk = startblk;
+  rp->n        = n;
+  rp->buf      = buffer;
+  submit(bsp, rp);
+}
+
+/**
+ * @brief   Queues a write request.
+ * @details The function returns immediately, the completion is notified
+ *          by signaling the events specified in the request object. The
+ *          buffer must not be modified until completion.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @param[in] rp        pointer to the @p BlockRequest object
+ * @param[in] startblk  first block to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ *
+ * @api
+ */
+void bsSubmitWrite(BlockScheduler *bsp, BlockRequest *rp,
+                   uint32_t startblk, const uint8_t *buffer, uint32_t n) {
+
+  chDbgCheck((bsp != NULL) && (rp != NULL) && (buffer != NULL) && (n > 0));
+
+  rp->op       = BLKSCHED_OP_WRITE;
+  rp->startblk = startblk;
+  rp->n        = n;
+  rp->buf      = (uint8_t *)buffer;
+  submit(bsp, rp);
+}
+
+/**
+ * @brief   Waits for the completion of a request.
+ *
+ * @param[in] rp        pointer to the @p BlockRequest object
+ *
+ * @return              The request result.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bsWaitRequest(BlockRequest *rp) {
+  bool result;
+
+  chDbgCheck(rp != NULL);
+
+  chSysLock();
+  chDbgAssert(rp->state != BLKSCHED_REQ_IDLE, "not submitted");
+  if (rp->state != BLKSCHED_REQ_DONE)
+    chThdSuspendS(&rp->waiting);
+  result = rp->result;
+  chSysUnlock();
+  return result;
+}
+
+/**
+ * @brief   Resets the scheduler statistics.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ *
+ * @api
+ */
+void bsResetStatistics(BlockScheduler *bsp) {
+
+  chDbgCheck(bsp != NULL);
+
+  bsp->stats.requests = 0;
+  bsp->stats.commands = 0;
+  bsp->stats.merged   = 0;
+  bsp->stats.expired  = 0;
+}
+
+/** @} */
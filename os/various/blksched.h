@@ -0,0 +1,281 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blksched.h
+ * @brief   Block I/O scheduler structures and macros.
+ *
+ * @addtogroup block_scheduler
+ * @{
+ */
+
+#ifndef _BLKSCHED_H_
+#define _BLKSCHED_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Request operations
+ * @{
+ */
+#define BLKSCHED_OP_READ            0       /**< @brief Read blocks.        */
+#define BLKSCHED_OP_WRITE           1       /**< @brief Write blocks.       */
+/** @} */
+
+/**
+ * @name    Request states
+ * @{
+ */
+#define BLKSCHED_REQ_IDLE           0       /**< @brief Not submitted.      */
+#define BLKSCHED_REQ_QUEUED         1       /**< @brief Waiting in queue.   */
+#define BLKSCHED_REQ_ACTIVE         2       /**< @brief Being served.       */
+#define BLKSCHED_REQ_DONE           3       /**< @brief Completed.          */
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_WAITEXIT
+#error "BLKSCHED requires CH_CFG_USE_WAITEXIT"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a block I/O request.
+ */
+typedef struct BlockRequest BlockRequest;
+
+/**
+ * @brief   Structure representing a block I/O request.
+ * @details The request object is owned by the submitter and must not be
+ *          reused or deallocated until completion.
+ */
+struct BlockRequest {
+  BlockRequest          *next;              /**< @brief Next in queue.      */
+  uint32_t              seq;                /**< @brief Submission order.   */
+  systime_t             time;               /**< @brief Submission time.    */
+  uint8_t               op;                 /**< @brief Request operation.  */
+  uint8_t               state;              /**< @brief Request state.      */
+  bool                  result;             /**< @brief Request result.     */
+  uint32_t              startblk;           /**< @brief First block.        */
+  uint32_t              n;                  /**< @brief Number of blocks.   */
+  uint8_t               *buf;               /**< @brief Data buffer.        */
+  thread_t              *thread;            /**< @brief Thread to be
+                                                 notified or @p NULL.       */
+  eventmask_t           events;             /**< @brief Events signaled on
+                                                 completion.                */
+  thread_reference_t    waiting;            /**< @brief Thread waiting for
+                                                 completion.                */
+};
+
+/**
+ * @brief   Block I/O scheduler configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief Underlying block device.
+   */
+  BaseBlockDevice       *blkp;
+  /**
+   * @brief Merge buffer used to coalesce adjacent requests into a single
+   *        multi-block command.
+   * @note  Can be @p NULL, in this case requests are served one at time.
+   */
+  uint8_t               *mrgbuf;
+  /**
+   * @brief Size of the merge buffer in blocks.
+   */
+  uint32_t              mrgblocks;
+  /**
+   * @brief Maximum time a read request waits before being served out of
+   *        the elevator order.
+   */
+  systime_t             rddeadline;
+  /**
+   * @brief Maximum time a write request waits before being served out of
+   *        the elevator order.
+   */
+  systime_t             wrdeadline;
+  /**
+   * @brief Working area of the worker thread.
+   */
+  void                  *wsp;
+  /**
+   * @brief Size of the worker thread working area.
+   */
+  size_t                wsize;
+  /**
+   * @brief Priority of the worker thread.
+   */
+  tprio_t               prio;
+} BlockSchedulerConfig;
+
+/**
+ * @brief   Block I/O scheduler statistics.
+ */
+typedef struct {
+  uint32_t              requests;           /**< @brief Requests served.    */
+  uint32_t              commands;           /**< @brief Commands issued to
+                                                 the device.                */
+  uint32_t              merged;             /**< @brief Requests merged in
+                                                 a command with others.     */
+  uint32_t              expired;            /**< @brief Requests served
+                                                 because past deadline.     */
+} BlockSchedulerStatistics;
+
+/**
+ * @brief   @p BlockScheduler specific methods.
+ */
+#define _block_scheduler_methods                                            \
+  _base_block_device_methods
+
+/**
+ * @extends BaseBlockDeviceVMT
+ *
+ * @brief   @p BlockScheduler virtual methods table.
+ */
+struct BlockSchedulerVMT {
+  _block_scheduler_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Block I/O scheduler object.
+ * @details The scheduler queues the requests coming from several threads
+ *          and serves them from a worker thread in elevator order, adjacent
+ *          requests are merged into multi-block commands.
+ */
+typedef struct {
+  /**
+   * @brief Virtual Methods Table.
+   */
+  const struct BlockSchedulerVMT *vmt;
+  _base_block_device_data
+  /**
+   * @brief Current configuration data.
+   */
+  const BlockSchedulerConfig *config;
+  /**
+   * @brief Submitted requests not yet taken by the worker thread, most
+   *        recent first.
+   */
+  BlockRequest          *incoming;
+  /**
+   * @brief Queued requests ordered by block number.
+   * @note  Only accessed by the worker thread.
+   */
+  BlockRequest          *queue;
+  /**
+   * @brief Requests submitted and not yet completed.
+   */
+  uint32_t              pending;
+  /**
+   * @brief Block following the last served one, elevator position.
+   */
+  uint32_t              position;
+  /**
+   * @brief Submission counter.
+   */
+  uint32_t              seq;
+  /**
+   * @brief Block size of the underlying device.
+   */
+  uint32_t              blksize;
+  /**
+   * @brief Worker thread.
+   */
+  thread_t              *worker;
+  /**
+   * @brief Reference to the worker thread while idle.
+   */
+  thread_reference_t    idle;
+  /**
+   * @brief Threads waiting for the queue to be drained.
+   */
+  threads_queue_t       drain;
+  /**
+   * @brief Scheduler statistics.
+   */
+  BlockSchedulerStatistics stats;
+} BlockScheduler;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the scheduler statistics.
+ *
+ * @param[in] bsp       pointer to the @p BlockScheduler object
+ * @return              Pointer to the @p BlockSchedulerStatistics structure.
+ *
+ * @api
+ */
+#define bsGetStatistics(bsp) (&(bsp)->stats)
+
+/**
+ * @brief   Returns @p true if the request has been completed.
+ *
+ * @param[in] rp        pointer to the @p BlockRequest object
+ *
+ * @iclass
+ */
+#define bsIsRequestDoneI(rp) ((rp)->state == BLKSCHED_REQ_DONE)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bsObjectInit(BlockScheduler *bsp);
+  void bsStart(BlockScheduler *bsp, const BlockSchedulerConfig *config);
+  void bsStop(BlockScheduler *bsp);
+  bool bsConnect(BlockScheduler *bsp);
+  bool bsDisconnect(BlockScheduler *bsp);
+  bool bsRead(BlockScheduler *bsp, uint32_t startblk,
+              uint8_t *buffer, uint32_t n);
+  bool bsWrite(BlockScheduler *bsp, uint32_t startblk,
+               const uint8_t *buffer, uint32_t n);
+  bool bsSync(BlockScheduler *bsp);
+  bool bsGetInfo(BlockScheduler *bsp, BlockDeviceInfo *bdip);
+  void bsRequestObjectInit(BlockRequest *rp, thread_t *tp,
+                           eventmask_t events);
+  void bsSubmitRead(BlockScheduler *bsp, BlockRequest *rp,
+                    uint32_t startblk, uint8_t *buffer, uint32_t n);
+  void bsSubmitWrite(BlockScheduler *bsp, BlockRequest *rp,
+                     uint32_t startblk, const uint8_t *buffer, uint32_t n);
+  bool bsWaitRequest(BlockRequest *rp);
+  void bsResetStatistics(BlockScheduler *bsp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BLKSCHED_H_ */
+
+/** @} */
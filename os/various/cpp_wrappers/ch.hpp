@@ -2209,6 +2209,160 @@ namespace chibios_rt {
   };
 #endif /* CH_USE_MEMPOOLS */
 
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ObjectsFifo                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating an objects FIFO and its buffers.
+   * @note    Constructors and destructors of the objects are not invoked.
+   *
+   * @param T                   type of the objects
+   * @param N                   number of objects
+   */
+  template<class T, size_t N>
+  class ObjectsFifo {
+  private:
+    /* The objects are rounded up to a multiple of stkalign_t in order to
+       keep them aligned.*/
+    stkalign_t obj_buf[N][(sizeof (T) + sizeof (stkalign_t) - 1) /
+                          sizeof (stkalign_t)];
+    msg_t msg_buf[N];
+
+  public:
+    /**
+     * @brief   Embedded @p ::objects_fifo_t structure.
+     */
+    ::objects_fifo_t fifo;
+
+    /**
+     * @brief   ObjectsFifo constructor.
+     *
+     * @init
+     */
+    ObjectsFifo(void) {
+
+      chFifoObjectInit(&fifo, sizeof obj_buf[0], N, obj_buf, msg_buf);
+    }
+
+    /**
+     * @brief   Takes a free object.
+     *
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The pointer to the taken object.
+     * @retval NULL         if the operation has timed out.
+     *
+     * @api
+     */
+    T *takeObject(systime_t time) {
+
+      return (T *)chFifoTakeObject(&fifo, time);
+    }
+
+    /**
+     * @brief   Takes a free object.
+     *
+     * @return              The pointer to the taken object.
+     * @retval NULL         if there are no free objects.
+     *
+     * @iclass
+     */
+    T *takeObjectI(void) {
+
+      return (T *)chFifoTakeObjectI(&fifo);
+    }
+
+    /**
+     * @brief   Returns an object to the free objects.
+     *
+     * @param[in] objp      pointer to the object to be returned
+     *
+     * @api
+     */
+    void returnObject(T *objp) {
+
+      chFifoReturnObject(&fifo, objp);
+    }
+
+    /**
+     * @brief   Returns an object to the free objects.
+     *
+     * @param[in] objp      pointer to the object to be returned
+     *
+     * @iclass
+     */
+    void returnObjectI(T *objp) {
+
+      chFifoReturnObjectI(&fifo, objp);
+    }
+
+    /**
+     * @brief   Queues an object in the FIFO.
+     *
+     * @param[in] objp      pointer to the object to be queued
+     *
+     * @api
+     */
+    void sendObject(T *objp) {
+
+      chFifoSendObject(&fifo, objp);
+    }
+
+    /**
+     * @brief   Queues an object in the FIFO.
+     *
+     * @param[in] objp      pointer to the object to be queued
+     *
+     * @iclass
+     */
+    void sendObjectI(T *objp) {
+
+      chFifoSendObjectI(&fifo, objp);
+    }
+
+    /**
+     * @brief   Retrieves an object from the FIFO.
+     *
+     * @param[out] objpp    pointer to a variable for the received object
+     *                      pointer
+     * @param[in] time      the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been correctly received.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t receiveObject(T **objpp, systime_t time) {
+
+      return chFifoReceiveObject(&fifo, (void **)objpp, time);
+    }
+
+    /**
+     * @brief   Retrieves an object from the FIFO.
+     *
+     * @param[out] objpp    pointer to a variable for the received object
+     *                      pointer
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been correctly received.
+     * @retval MSG_TIMEOUT  if the FIFO is empty.
+     *
+     * @iclass
+     */
+    msg_t receiveObjectI(T **objpp) {
+
+      return chFifoReceiveObjectI(&fifo, (void **)objpp);
+    }
+  };
+#endif /* CH_CFG_USE_OBJ_FIFOS */
+
   /*------------------------------------------------------------------------*
    * chibios_rt::BaseSequentialStreamInterface                              *
    *------------------------------------------------------------------------*/
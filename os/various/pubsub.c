@@ -0,0 +1,352 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    pubsub.c
+ * @brief   Publish/subscribe broker code.
+ *
+ * @addtogroup pubsub
+ * @{
+ */
+
+#include "ch.h"
+#include "pubsub.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static pubsub_topic_t *find_topic(pubsub_broker_t *brp, uint32_t id) {
+  pubsub_topic_t *tp = brp->pb_topics;
+
+  while ((tp != NULL) && (tp->pt_id != id))
+    tp = tp->pt_next;
+  return tp;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p pubsub_broker_t structure.
+ *
+ * @param[out] brp      the @p pubsub_broker_t structure to be initialized
+ * @param[in] bap       allocator of the messages buffers
+ *
+ * @init
+ */
+void psObjectInit(pubsub_broker_t *brp, buffers_allocator_t *bap) {
+
+  chDbgCheck((brp != NULL) && (bap != NULL));
+
+  brp->pb_topics    = NULL;
+  brp->pb_allocator = bap;
+}
+
+/**
+ * @brief   Adds a topic to the broker.
+ *
+ * @param[in] brp       pointer to a @p pubsub_broker_t structure
+ * @param[out] tp       the @p pubsub_topic_t structure to be initialized
+ * @param[in] id        the topic identifier, it must be unique within the
+ *                      broker
+ *
+ * @api
+ */
+void psAddTopic(pubsub_broker_t *brp, pubsub_topic_t *tp, uint32_t id) {
+
+  chDbgCheck((brp != NULL) && (tp != NULL));
+
+  tp->pt_id          = id;
+  tp->pt_subscribers = NULL;
+  psResetStatistics(tp);
+
+  chSysLock();
+  chDbgAssert(find_topic(brp, id) == NULL, "duplicated topic");
+  tp->pt_next     = brp->pb_topics;
+  brp->pb_topics  = tp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Finds a topic by identifier.
+ *
+ * @param[in] brp       pointer to a @p pubsub_broker_t structure
+ * @param[in] id        the topic identifier
+ * @return              Pointer to the topic or @p NULL if not found.
+ *
+ * @api
+ */
+pubsub_topic_t *psFindTopic(pubsub_broker_t *brp, uint32_t id) {
+  pubsub_topic_t *tp;
+
+  chDbgCheck(brp != NULL);
+
+  chSysLock();
+  tp = find_topic(brp, id);
+  chSysUnlock();
+  return tp;
+}
+
+/**
+ * @brief   Subscribes to a topic.
+ * @details The subscriber receives the messages published on the topic
+ *          having at least one flag in common with @p filter, all the
+ *          messages if @p filter is zero.
+ *
+ * @param[in] brp       pointer to a @p pubsub_broker_t structure
+ * @param[out] sp       the @p pubsub_subscriber_t structure to be
+ *                      initialized
+ * @param[in] id        identifier of the topic
+ * @param[in] filter    flags of interest or zero
+ * @param[in] buf       pointer to the subscriber mailbox buffer area
+ * @param[in] n         number of elements in the buffer area, it is the
+ *                      maximum number of messages pending for the
+ *                      subscriber
+ * @return              The operation status.
+ * @retval false        if the operation succeeded.
+ * @retval true         if the topic does not exist.
+ *
+ * @api
+ */
+bool psSubscribe(pubsub_broker_t *brp, pubsub_subscriber_t *sp,
+                 uint32_t id, eventflags_t filter, msg_t *buf, cnt_t n) {
+  pubsub_topic_t *tp;
+
+  chDbgCheck((brp != NULL) && (sp != NULL) && (buf != NULL) && (n > 0));
+
+  chMBObjectInit(&sp->ps_mbx, buf, n);
+  sp->ps_filter  = filter;
+  sp->ps_dropped = 0;
+
+  chSysLock();
+  tp = find_topic(brp, id);
+  if (tp == NULL) {
+    chSysUnlock();
+    return true;
+  }
+  sp->ps_topic       = tp;
+  sp->ps_next        = tp->pt_subscribers;
+  tp->pt_subscribers = sp;
+  chSysUnlock();
+  return false;
+}
+
+/**
+ * @brief   Unsubscribes from a topic.
+ * @details The messages still pending for the subscriber are discarded and
+ *          their buffers released.
+ * @note    The subscriber mailbox must not have waiting threads.
+ *
+ * @param[in] sp        pointer to a @p pubsub_subscriber_t structure
+ *
+ * @api
+ */
+void psUnsubscribe(pubsub_subscriber_t *sp) {
+  pubsub_subscriber_t **spp;
+  msg_t msg;
+
+  chDbgCheck(sp != NULL);
+
+  chSysLock();
+  spp = &sp->ps_topic->pt_subscribers;
+  while (*spp != sp) {
+    chDbgAssert(*spp != NULL, "not subscribed");
+    spp = &(*spp)->ps_next;
+  }
+  *spp = sp->ps_next;
+  while (chMBFetchI(&sp->ps_mbx, &msg) == MSG_OK)
+    chBufReleaseI((buffer_t *)msg);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Allocates a message buffer.
+ * @details The buffer is taken from the broker allocator, the publisher
+ *          fills it and then passes it to @p psPublish().
+ *
+ * @param[in] brp       pointer to a @p pubsub_broker_t structure
+ * @param[in] size      size of the message
+ * @return              Pointer to the buffer chain or @p NULL if the
+ *                      buffers are exhausted.
+ *
+ * @iclass
+ */
+buffer_t *psAllocI(pubsub_broker_t *brp, size_t size) {
+
+  chDbgCheckClassI();
+  chDbgCheck(brp != NULL);
+
+  return chBufAllocI(brp->pb_allocator, size, 0);
+}
+
+/**
+ * @brief   Allocates a message buffer.
+ * @details The buffer is taken from the broker allocator, the publisher
+ *          fills it and then passes it to @p psPublish().
+ *
+ * @param[in] brp       pointer to a @p pubsub_broker_t structure
+ * @param[in] size      size of the message
+ * @return              Pointer to the buffer chain or @p NULL if the
+ *                      buffers are exhausted.
+ *
+ * @api
+ */
+buffer_t *psAlloc(pubsub_broker_t *brp, size_t size) {
+
+  chDbgCheck(brp != NULL);
+
+  return chBufAlloc(brp->pb_allocator, size, 0);
+}
+
+/**
+ * @brief   Publishes a message on a topic.
+ * @details The buffer is not copied, each matching subscriber receives a
+ *          reference to it. Subscribers whose mailbox is full miss the
+ *          message, the drop is accounted in the topic statistics and in
+ *          the subscriber.
+ * @note    The caller reference to the buffer is consumed by this function.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel. Note that
+ *          interrupt handlers always reschedule on exit so an explicit
+ *          reschedule must not be performed in ISRs.
+ *
+ * @param[in] tp        pointer to a @p pubsub_topic_t structure
+ * @param[in] bp        buffer chain containing the message
+ * @param[in] flags     message flags, matched against the subscribers
+ *                      filters
+ * @return              The number of subscribers the message has been
+ *                      delivered to.
+ *
+ * @iclass
+ */
+unsigned psPublishI(pubsub_topic_t *tp, buffer_t *bp, eventflags_t flags) {
+  pubsub_subscriber_t *sp;
+  unsigned n = 0;
+
+  chDbgCheckClassI();
+  chDbgCheck((tp != NULL) && (bp != NULL));
+
+  tp->pt_stats.published++;
+  for (sp = tp->pt_subscribers; sp != NULL; sp = sp->ps_next) {
+    if ((sp->ps_filter != 0) && ((sp->ps_filter & flags) == 0))
+      continue;
+    (void) chBufAddRefI(bp);
+    if (chMBPostI(&sp->ps_mbx, (msg_t)bp) != MSG_OK) {
+      chBufReleaseI(bp);
+      sp->ps_dropped++;
+      tp->pt_stats.dropped++;
+    }
+    else
+      n++;
+  }
+  tp->pt_stats.delivered += n;
+  if (n > tp->pt_stats.maxfanout)
+    tp->pt_stats.maxfanout = n;
+  chBufReleaseI(bp);
+  return n;
+}
+
+/**
+ * @brief   Publishes a message on a topic.
+ * @details The buffer is not copied, each matching subscriber receives a
+ *          reference to it. Subscribers whose mailbox is full miss the
+ *          message, the drop is accounted in the topic statistics and in
+ *          the subscriber.
+ * @note    The caller reference to the buffer is consumed by this function.
+ *
+ * @param[in] tp        pointer to a @p pubsub_topic_t structure
+ * @param[in] bp        buffer chain containing the message
+ * @param[in] flags     message flags, matched against the subscribers
+ *                      filters
+ * @return              The number of subscribers the message has been
+ *                      delivered to.
+ *
+ * @api
+ */
+unsigned psPublish(pubsub_topic_t *tp, buffer_t *bp, eventflags_t flags) {
+  unsigned n;
+
+  chSysLock();
+  n = psPublishI(tp, bp, flags);
+  chSchRescheduleS();
+  chSysUnlock();
+  return n;
+}
+
+/**
+ * @brief   Receives a message.
+ * @note    The received buffer must be released using @p chBufRelease()
+ *          after use.
+ *
+ * @param[in] sp        pointer to a @p pubsub_subscriber_t structure
+ * @param[in] time      the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The buffer chain containing the message or @p NULL
+ *                      if no message arrived within the specified time.
+ *
+ * @api
+ */
+buffer_t *psReceive(pubsub_subscriber_t *sp, systime_t time) {
+  msg_t msg;
+
+  chDbgCheck(sp != NULL);
+
+  if (chMBFetch(&sp->ps_mbx, &msg, time) != MSG_OK)
+    return NULL;
+  return (buffer_t *)msg;
+}
+
+/**
+ * @brief   Resets the topic statistics.
+ *
+ * @param[in] tp        pointer to a @p pubsub_topic_t structure
+ *
+ * @api
+ */
+void psResetStatistics(pubsub_topic_t *tp) {
+
+  chDbgCheck(tp != NULL);
+
+  chSysLock();
+  tp->pt_stats.published = 0;
+  tp->pt_stats.delivered = 0;
+  tp->pt_stats.maxfanout = 0;
+  tp->pt_stats.dropped   = 0;
+  chSysUnlock();
+}
+
+/** @} */
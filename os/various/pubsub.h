@@ -0,0 +1,156 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    pubsub.h
+ * @brief   Publish/subscribe broker macros and structures.
+ *
+ * @addtogroup pubsub
+ * @{
+ */
+
+#ifndef _PUBSUB_H_
+#define _PUBSUB_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*
+ * Module dependencies check.
+ */
+#if !CH_CFG_USE_BUFFERS
+#error "PUBSUB requires CH_CFG_USE_BUFFERS"
+#endif
+
+#if !CH_CFG_USE_MAILBOXES
+#error "PUBSUB requires CH_CFG_USE_MAILBOXES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a topic structure.
+ */
+typedef struct pubsub_topic pubsub_topic_t;
+
+/**
+ * @brief   Type of a subscriber structure.
+ */
+typedef struct pubsub_subscriber pubsub_subscriber_t;
+
+/**
+ * @brief   Structure representing a subscriber.
+ * @details The published buffers are delivered in the subscriber mailbox,
+ *          only the subscriber thread is woken up.
+ */
+struct pubsub_subscriber {
+  pubsub_subscriber_t   *ps_next;       /**< @brief Next subscriber of the
+                                                    same topic.             */
+  pubsub_topic_t        *ps_topic;      /**< @brief Subscribed topic.       */
+  eventflags_t          ps_filter;      /**< @brief Flags of interest, zero
+                                                    for all messages.       */
+  mailbox_t             ps_mbx;         /**< @brief Delivered buffers.      */
+  uint32_t              ps_dropped;     /**< @brief Messages dropped because
+                                                    the mailbox was full.   */
+};
+
+/**
+ * @brief   Topic statistics.
+ */
+typedef struct {
+  uint32_t              published;      /**< @brief Messages published.     */
+  uint32_t              delivered;      /**< @brief Total deliveries, the
+                                                    average fan-out is
+                                                    delivered/published.    */
+  uint32_t              maxfanout;      /**< @brief Largest number of
+                                                    deliveries of a single
+                                                    message.                */
+  uint32_t              dropped;        /**< @brief Deliveries dropped
+                                                    because a subscriber
+                                                    mailbox was full.       */
+} pubsub_statistics_t;
+
+/**
+ * @brief   Structure representing a topic.
+ */
+struct pubsub_topic {
+  pubsub_topic_t        *pt_next;       /**< @brief Next topic of the
+                                                    broker.                 */
+  uint32_t              pt_id;          /**< @brief Topic identifier.       */
+  pubsub_subscriber_t   *pt_subscribers;/**< @brief Subscribers list.       */
+  pubsub_statistics_t   pt_stats;       /**< @brief Topic statistics.       */
+};
+
+/**
+ * @brief   Structure representing a broker.
+ */
+typedef struct {
+  pubsub_topic_t        *pb_topics;     /**< @brief Topics list.            */
+  buffers_allocator_t   *pb_allocator;  /**< @brief Messages buffers
+                                                    allocator.              */
+} pubsub_broker_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the topic statistics.
+ *
+ * @param[in] tp        pointer to a @p pubsub_topic_t structure
+ * @return              Pointer to the @p pubsub_statistics_t structure.
+ *
+ * @api
+ */
+#define psGetStatistics(tp) (&(tp)->pt_stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void psObjectInit(pubsub_broker_t *brp, buffers_allocator_t *bap);
+  void psAddTopic(pubsub_broker_t *brp, pubsub_topic_t *tp, uint32_t id);
+  pubsub_topic_t *psFindTopic(pubsub_broker_t *brp, uint32_t id);
+  bool psSubscribe(pubsub_broker_t *brp, pubsub_subscriber_t *sp,
+                   uint32_t id, eventflags_t filter, msg_t *buf, cnt_t n);
+  void psUnsubscribe(pubsub_subscriber_t *sp);
+  buffer_t *psAllocI(pubsub_broker_t *brp, size_t size);
+  buffer_t *psAlloc(pubsub_broker_t *brp, size_t size);
+  unsigned psPublishI(pubsub_topic_t *tp, buffer_t *bp, eventflags_t flags);
+  unsigned psPublish(pubsub_topic_t *tp, buffer_t *bp, eventflags_t flags);
+  buffer_t *psReceive(pubsub_subscriber_t *sp, systime_t time);
+  void psResetStatistics(pubsub_topic_t *tp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PUBSUB_H_ */
+
+/** @} */
@@ -29,13 +29,23 @@
 #include "testthd.h"
 #include "testsem.h"
 #include "testmtx.h"
+#include "testrw.h"
 #include "testmsg.h"
 #include "testmbox.h"
+#include "testpmbox.h"
 #include "testevt.h"
 #include "testheap.h"
 #include "testpools.h"
+#include "testbuf.h"
+#include "testobjfifo.h"
 #include "testdyn.h"
+#include "testthdpool.h"
+#include "testdpc.h"
+#include "testbtasks.h"
 #include "testqueues.h"
+#include "testrings.h"
+#include "testmwait.h"
+#include "testcoop.h"
 #include "testbmk.h"
 
 /*
@@ -45,13 +55,23 @@ static ROMCONST struct testcase * ROMCONST *patterns[] = {
   patternthd,
   patternsem,
   patternmtx,
+  patternrw,
   patternmsg,
   patternmbox,
+  patternpmbox,
   patternevt,
   patternheap,
   patternpools,
+  patternbuf,
+  patternobjfifo,
   patterndyn,
+  patternthdpool,
+  patterndpc,
+  patternbtasks,
   patternqueues,
+  patternrings,
+  patternmwait,
+  patterncoop,
   patternbmk,
   NULL
 };
@@ -151,6 +171,16 @@ void test_emit_token(char token) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Emits a token into the tokens buffer from a locked context.
+ *
+ * @param[in] token     the token as a char
+ */
+void test_emit_token_i(char token) {
+
+  *tokp++ = token;
+}
+
 /*
  * Assertions.
  */
@@ -84,6 +84,7 @@ extern "C" {
   void test_print(const char *msgp);
   void test_println(const char *msgp);
   void test_emit_token(char token);
+  void test_emit_token_i(char token);
   bool _test_fail(unsigned point);
   bool _test_assert(unsigned point, bool condition);
   bool _test_assert_sequence(unsigned point, char *expected);
@@ -3,13 +3,23 @@ TESTSRC = ${CHIBIOS}/test/rt/test.c \
           ${CHIBIOS}/test/rt/testthd.c \
           ${CHIBIOS}/test/rt/testsem.c \
           ${CHIBIOS}/test/rt/testmtx.c \
+          ${CHIBIOS}/test/rt/testrw.c \
           ${CHIBIOS}/test/rt/testmsg.c \
           ${CHIBIOS}/test/rt/testmbox.c \
+          ${CHIBIOS}/test/rt/testpmbox.c \
           ${CHIBIOS}/test/rt/testevt.c \
           ${CHIBIOS}/test/rt/testheap.c \
           ${CHIBIOS}/test/rt/testpools.c \
+          ${CHIBIOS}/test/rt/testbuf.c \
+          ${CHIBIOS}/test/rt/testobjfifo.c \
           ${CHIBIOS}/test/rt/testdyn.c \
+          ${CHIBIOS}/test/rt/testthdpool.c \
+          ${CHIBIOS}/test/rt/testdpc.c \
+          ${CHIBIOS}/test/rt/testbtasks.c \
           ${CHIBIOS}/test/rt/testqueues.c \
+          ${CHIBIOS}/test/rt/testrings.c \
+          ${CHIBIOS}/test/rt/testmwait.c \
+          ${CHIBIOS}/test/rt/testcoop.c \
           ${CHIBIOS}/test/rt/testbmk.c
 
 # Required include directories
@@ -49,6 +49,14 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
+ * - @subpage test_benchmarks_015
+ * - @subpage test_benchmarks_016
+ * - @subpage test_benchmarks_017
+ * - @subpage test_benchmarks_018
+ * - @subpage test_benchmarks_019
+ * - @subpage test_benchmarks_020
+ * - @subpage test_benchmarks_021
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -60,6 +68,12 @@ static semaphore_t sem1;
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
 static mutex_t mtx1;
 #endif
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+static rwlock_t rw1;
+#endif
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+static condition_variable_t cv1;
+#endif
 
 static msg_t thread1(void *p) {
   thread_t *tp;
@@ -586,7 +600,10 @@ ROMCONST struct testcase testbmk11 = {
  * A mutex is locked/unlocked into a continuous loop, no Context Switch happens
  * because there are no other threads asking for the mutex.<br>
  * The performance is calculated by measuring the number of iterations after
- * a second of continuous operations.
+ * a second of continuous operations.<br>
+ * The test is then repeated using the S-class API in order to measure the
+ * kernel path, if the mutexes fast path is enabled the difference between
+ * the two scores is the gain of the fast path.
  */
 
 static void bmk12_setup(void) {
@@ -616,6 +633,29 @@ static void bmk12_execute(void) {
   test_print("--- Score : ");
   test_printn(n * 4);
   test_println(" lock+unlock/S");
+
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    chMtxLockS(&mtx1);
+    chMtxUnlockS(&mtx1);
+    chMtxLockS(&mtx1);
+    chMtxUnlockS(&mtx1);
+    chMtxLockS(&mtx1);
+    chMtxUnlockS(&mtx1);
+    chMtxLockS(&mtx1);
+    chMtxUnlockS(&mtx1);
+    chSysUnlock();
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Kernel: ");
+  test_printn(n * 4);
+  test_println(" lock+unlock/S");
 }
 
 ROMCONST struct testcase testbmk12 = {
@@ -664,6 +704,11 @@ static void bmk13_execute(void) {
   test_printn(sizeof(mutex_t));
   test_println(" bytes");
 #endif
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+  test_print("--- RWLock: ");
+  test_printn(sizeof(rwlock_t));
+  test_println(" bytes");
+#endif
 #if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
   test_print("--- CondV.: ");
   test_printn(sizeof(condition_variable_t));
@@ -679,6 +724,11 @@ static void bmk13_execute(void) {
   test_printn(sizeof(mailbox_t));
   test_println(" bytes");
 #endif
+#if CH_CFG_USE_COOP || defined(__DOXYGEN__)
+  test_print("--- CoopT.: ");
+  test_printn(sizeof(coop_task_t));
+  test_println(" bytes");
+#endif
 }
 
 ROMCONST struct testcase testbmk13 = {
@@ -688,6 +738,670 @@ ROMCONST struct testcase testbmk13 = {
   bmk13_execute
 };
 
+#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+/*
+ * Read-mostly workload shared by the following benchmarks, one access out of
+ * sixteen is a write. Readers hold the lock while waiting for the next
+ * system tick, as when waiting for a device.
+ */
+#define RM_THREADS              4
+#define RM_WRITE_MASK           15
+
+static uint32_t rm_counters[RM_THREADS];
+
+static void rm_print(void) {
+  uint32_t n = 0;
+  unsigned i;
+
+  for (i = 0; i < RM_THREADS; i++)
+    n += rm_counters[i];
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" accesses/S");
+}
+#endif
+
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_014 Reader-Writer Locks read-mostly throughput
+ *
+ * <h2>Description</h2>
+ * Four threads at equal priority access a reader-writer lock, most accesses
+ * are reads and the thread sleeps while holding the lock in read mode, the
+ * other readers are able to share the lock meanwhile.<br>
+ * The performance is calculated by measuring the number of accesses after
+ * a second of continuous operations, the score can be compared with the
+ * one of the next benchmark.
+ */
+
+static msg_t thread14(void *p) {
+  uint32_t *np = (uint32_t *)p;
+
+  do {
+    if ((*np & RM_WRITE_MASK) == RM_WRITE_MASK) {
+      chRwLockWrite(&rw1);
+      (*np)++;
+      chRwUnlock(&rw1);
+    }
+    else {
+      chRwLockRead(&rw1);
+      chThdSleep(1);
+      (*np)++;
+      chRwUnlock(&rw1);
+    }
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while(!chThdShouldTerminateX());
+  return 0;
+}
+
+static void bmk14_setup(void) {
+  unsigned i;
+
+  chRwObjectInit(&rw1);
+  for (i = 0; i < RM_THREADS; i++)
+    rm_counters[i] = 0;
+}
+
+static void bmk14_execute(void) {
+  unsigned i;
+
+  test_wait_tick();
+  for (i = 0; i < RM_THREADS; i++)
+    threads[i] = chThdCreateStatic(wa[i], WA_SIZE, chThdGetPriorityX()-1,
+                                   thread14, (void *)&rm_counters[i]);
+
+  chThdSleepSeconds(1);
+  test_terminate_threads();
+  test_wait_threads();
+  rm_print();
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, reader-writer locks read-mostly",
+  bmk14_setup,
+  NULL,
+  bmk14_execute
+};
+#endif /* CH_CFG_USE_RWLOCKS */
+
+#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_015 Mutexes read-mostly throughput
+ *
+ * <h2>Description</h2>
+ * Same workload of the previous benchmark but the accesses are serialized
+ * by a mutex, the threads sleeping inside the critical zone block the
+ * other threads.<br>
+ * The performance is calculated by measuring the number of accesses after
+ * a second of continuous operations.
+ */
+
+static msg_t thread15(void *p) {
+  uint32_t *np = (uint32_t *)p;
+
+  do {
+    chMtxLock(&mtx1);
+    if ((*np & RM_WRITE_MASK) != RM_WRITE_MASK)
+      chThdSleep(1);
+    (*np)++;
+    chMtxUnlock(&mtx1);
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while(!chThdShouldTerminateX());
+  return 0;
+}
+
+static void bmk15_setup(void) {
+  unsigned i;
+
+  chMtxObjectInit(&mtx1);
+  for (i = 0; i < RM_THREADS; i++)
+    rm_counters[i] = 0;
+}
+
+static void bmk15_execute(void) {
+  unsigned i;
+
+  test_wait_tick();
+  for (i = 0; i < RM_THREADS; i++)
+    threads[i] = chThdCreateStatic(wa[i], WA_SIZE, chThdGetPriorityX()-1,
+                                   thread15, (void *)&rm_counters[i]);
+
+  chThdSleepSeconds(1);
+  test_terminate_threads();
+  test_wait_threads();
+  rm_print();
+}
+
+ROMCONST struct testcase testbmk15 = {
+  "Benchmark, mutexes read-mostly",
+  bmk15_setup,
+  NULL,
+  bmk15_execute
+};
+#endif /* CH_CFG_USE_MUTEXES */
+
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_016 Condition variables broadcast
+ *
+ * <h2>Description</h2>
+ * Eight threads wait on a condition variable, the broadcasting thread has a
+ * lower priority and broadcasts while holding the mutex. The waiting threads
+ * acquire the mutex one at time then wait again.<br>
+ * The performance is calculated by measuring the number of broadcasts after
+ * a second of continuous operations. If the kernel statistics are enabled
+ * then the number of context switches required by each broadcast is also
+ * printed, the minimum is one for each waiting thread plus one.
+ */
+
+#define CV_WAITERS              8
+
+static stkalign_t cv_wa[CV_WAITERS - MAX_THREADS]
+                       [WA_SIZE / sizeof(stkalign_t)];
+
+static msg_t thread16(void *p) {
+
+  (void)p;
+  chMtxLock(&mtx1);
+  while (!chThdShouldTerminateX())
+    chCondWait(&cv1);
+  chMtxUnlock(&mtx1);
+  return 0;
+}
+
+static void bmk16_setup(void) {
+
+  chMtxObjectInit(&mtx1);
+  chCondObjectInit(&cv1);
+}
+
+static void bmk16_execute(void) {
+  thread_t *tps[CV_WAITERS];
+  uint32_t n = 0;
+  unsigned i;
+#if CH_DBG_STATISTICS
+  ucnt_t ctxswc;
+#endif
+
+  for (i = 0; i < CV_WAITERS; i++) {
+    void *wsp = i < MAX_THREADS ? wa[i] : (void *)cv_wa[i - MAX_THREADS];
+    tps[i] = chThdCreateStatic(wsp, WA_SIZE, chThdGetPriorityX()+1,
+                               thread16, NULL);
+  }
+
+  test_wait_tick();
+  test_start_timer(1000);
+#if CH_DBG_STATISTICS
+  ctxswc = ch.kernel_stats.n_ctxswc;
+#endif
+  do {
+    chMtxLock(&mtx1);
+    chCondBroadcast(&cv1);
+    chMtxUnlock(&mtx1);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+#if CH_DBG_STATISTICS
+  ctxswc = ch.kernel_stats.n_ctxswc - ctxswc;
+#endif
+
+  for (i = 0; i < CV_WAITERS; i++)
+    chThdTerminate(tps[i]);
+  chMtxLock(&mtx1);
+  chCondBroadcast(&cv1);
+  chMtxUnlock(&mtx1);
+  for (i = 0; i < CV_WAITERS; i++)
+    chThdWait(tps[i]);
+
+  test_print("--- Score : ");
+  test_printn(n);
+  test_print(" broadcasts/S, ");
+  test_printn(n * CV_WAITERS);
+  test_println(" wakeups/S");
+#if CH_DBG_STATISTICS
+  test_print("--- Switch: ");
+  test_printn(ctxswc / n);
+  test_println(" ctxswc/broadcast");
+#endif
+}
+
+ROMCONST struct testcase testbmk16 = {
+  "Benchmark, condition variables broadcast",
+  bmk16_setup,
+  NULL,
+  bmk16_execute
+};
+#endif /* CH_CFG_USE_CONDVARS */
+
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_017 Mailboxes batch operations
+ *
+ * <h2>Description</h2>
+ * A thread posts messages in batches of 1, 8 and 32 messages to a mailbox,
+ * a consumer thread with higher priority fetches them in batches.<br>
+ * The performance is calculated by measuring the number of messages
+ * transferred after a second of continuous operations for each batch size.
+ */
+
+#define MB_BATCH_SIZE           32
+
+static mailbox_t mb1;
+static msg_t mb_buffer[MB_BATCH_SIZE];
+static msg_t mb_msgs[MB_BATCH_SIZE];
+
+static msg_t thread17(void *p) {
+  msg_t msgs[MB_BATCH_SIZE];
+
+  (void)p;
+  while (!chThdShouldTerminateX())
+    (void)chMBFetchN(&mb1, msgs, MB_BATCH_SIZE, TIME_INFINITE);
+  return 0;
+}
+
+static void bmk17_setup(void) {
+
+  chMBObjectInit(&mb1, mb_buffer, MB_BATCH_SIZE);
+}
+
+static void bmk17_execute(void) {
+  static const cnt_t sizes[] = {1, 8, MB_BATCH_SIZE};
+  uint32_t n;
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread17, NULL);
+
+  for (i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++) {
+    n = 0;
+    test_wait_tick();
+    test_start_timer(1000);
+    do {
+      n += chMBPostN(&mb1, mb_msgs, sizes[i], TIME_INFINITE);
+#if defined(SIMULATOR)
+      ChkIntSources();
+#endif
+    } while (!test_timer_done);
+
+    test_print("--- Batch ");
+    test_printn(sizes[i]);
+    test_print(": ");
+    test_printn(n);
+    test_println(" msgs/S");
+  }
+
+  chThdTerminate(threads[0]);
+  chMBReset(&mb1);
+  test_wait_threads();
+}
+
+ROMCONST struct testcase testbmk17 = {
+  "Benchmark, mailboxes batch operations",
+  bmk17_setup,
+  NULL,
+  bmk17_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES */
+
+#if (CH_CFG_USE_RINGS && CH_CFG_USE_QUEUES) || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_018 Lock-free rings throughput
+ *
+ * <h2>Description</h2>
+ * Four bytes are written and then read from a lock-free ring into a
+ * continuous loop, then the same is done with an @p input_queue_t using
+ * @p chIQPutI() and @p chIQReadTimeout().<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk18_execute(void) {
+  uint32_t n;
+  static uint8_t ib[16];
+  static uint8_t rb[RING_BUFFER_SIZE(16, 1)];
+  static uint8_t buf[4];
+  static input_queue_t iq;
+  static spsc_ring_t ring;
+
+  chRingObjectInit(&ring, rb, 16, 1);
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    (void)chRingPutX(&ring, 0);
+    (void)chRingPutX(&ring, 1);
+    (void)chRingPutX(&ring, 2);
+    (void)chRingPutX(&ring, 3);
+    (void)chRingGetX(&ring);
+    (void)chRingGetX(&ring);
+    (void)chRingGetX(&ring);
+    (void)chRingGetX(&ring);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Ring  : ");
+  test_printn(n * 4);
+  test_println(" bytes/S");
+
+  chIQObjectInit(&iq, ib, sizeof(ib), NULL, NULL);
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSysLock();
+    chIQPutI(&iq, 0);
+    chIQPutI(&iq, 1);
+    chIQPutI(&iq, 2);
+    chIQPutI(&iq, 3);
+    chSysUnlock();
+    (void)chIQReadTimeout(&iq, buf, 4, TIME_IMMEDIATE);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Queue : ");
+  test_printn(n * 4);
+  test_println(" bytes/S");
+}
+
+ROMCONST struct testcase testbmk18 = {
+  "Benchmark, lock-free rings throughput",
+  NULL,
+  NULL,
+  bmk18_execute
+};
+#endif /* CH_CFG_USE_RINGS && CH_CFG_USE_QUEUES */
+
+#if (CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_CALLBACKS && PORT_SUPPORTS_RT) || \
+    defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_019 Events broadcast latency
+ *
+ * <h2>Description</h2>
+ * An event source with 1, 4 and 16 callback listeners is broadcasted into a
+ * continuous loop, the time between the start of the broadcast and the
+ * invocation of the last callback is measured. Then the same is done with
+ * the same number of threads with higher priority waiting for the events,
+ * the time is measured until the last thread wakes up.<br>
+ * The result is the average latency expressed in realtime counter ticks,
+ * CPU cycles on most architectures.
+ */
+
+#define BMK_LISTENERS           16
+
+static event_source_t es1;
+static event_listener_t els[BMK_LISTENERS];
+static stkalign_t bmk19_wa[BMK_LISTENERS][WA_SIZE / sizeof (stkalign_t)];
+static thread_t *bmk19_threads[BMK_LISTENERS];
+static volatile rtcnt_t bmk19_last;
+
+static void bmk19_callback(void *p, eventflags_t flags) {
+
+  (void)p;
+  (void)flags;
+  bmk19_last = chSysGetRealtimeCounterX();
+}
+
+static msg_t thread19(void *p) {
+
+  chEvtRegisterMask(&es1, (event_listener_t *)p, EVENT_MASK(0));
+  while (!chThdShouldTerminateX()) {
+    (void)chEvtWaitAny(ALL_EVENTS);
+    bmk19_last = chSysGetRealtimeCounterX();
+  }
+  chEvtUnregister(&es1, (event_listener_t *)p);
+  return 0;
+}
+
+static uint32_t bmk19_broadcast(void) {
+  uint32_t n = 0, total = 0;
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    rtcnt_t start = chSysGetRealtimeCounterX();
+
+    chEvtBroadcastFlags(&es1, 1);
+    total += (uint32_t)(bmk19_last - start);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  return total / n;
+}
+
+static void bmk19_setup(void) {
+
+  chEvtObjectInit(&es1);
+}
+
+static void bmk19_execute(void) {
+  static const unsigned sizes[] = {1, 4, BMK_LISTENERS};
+  uint32_t n;
+  unsigned i, j;
+
+  for (i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++) {
+    for (j = 0; j < sizes[i]; j++)
+      chEvtRegisterCallback(&es1, &els[j], bmk19_callback, NULL);
+    n = bmk19_broadcast();
+    for (j = 0; j < sizes[i]; j++)
+      chEvtUnregister(&es1, &els[j]);
+    test_print("--- Callbacks ");
+    test_printn(sizes[i]);
+    test_print(": ");
+    test_printn(n);
+    test_println(" cycles");
+
+    for (j = 0; j < sizes[i]; j++)
+      bmk19_threads[j] = chThdCreateStatic(bmk19_wa[j], sizeof bmk19_wa[j],
+                                           chThdGetPriorityX() + 1,
+                                           thread19, (void *)&els[j]);
+    n = bmk19_broadcast();
+    for (j = 0; j < sizes[i]; j++)
+      chThdTerminate(bmk19_threads[j]);
+    chEvtBroadcastFlags(&es1, 1);
+    for (j = 0; j < sizes[i]; j++)
+      chThdWait(bmk19_threads[j]);
+    test_print("--- Threads   ");
+    test_printn(sizes[i]);
+    test_print(": ");
+    test_printn(n);
+    test_println(" cycles");
+  }
+}
+
+ROMCONST struct testcase testbmk19 = {
+  "Benchmark, events broadcast latency",
+  bmk19_setup,
+  NULL,
+  bmk19_execute
+};
+#endif /* CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_CALLBACKS &&
+          PORT_SUPPORTS_RT */
+
+#if CH_CFG_USE_THREAD_POOLS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_020 Thread pool jobs
+ *
+ * <h2>Description</h2>
+ * Empty jobs are submitted into a continuous loop to a thread pool whose
+ * worker has higher priority, then the same jobs are executed by creating
+ * a thread from the heap for each job and waiting for it.<br>
+ * The performance is calculated by measuring the number of jobs executed
+ * after a second of continuous operations.
+ */
+
+#define BMK_JOBS                4
+
+static thread_t *tp_workers[1];
+static thread_pool_job_t tp_jobs[BMK_JOBS];
+static pmb_slot_t tp_slots[BMK_JOBS];
+
+static void bmk20_job(void *arg) {
+
+  (void)arg;
+}
+
+static msg_t thread20(void *p) {
+
+  bmk20_job(p);
+  return 0;
+}
+
+static void bmk20_execute(void) {
+  static thread_pool_t tp;
+  thread_pool_config_t config = {
+    NULL, WA_SIZE, chThdGetPriorityX() + 1, 1, 1, TIME_INFINITE,
+    tp_workers, tp_jobs, tp_slots, BMK_JOBS
+  };
+  uint32_t n;
+
+  chThdPoolObjectInit(&tp, &config);
+  (void)chThdPoolStart(&tp);
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    (void)chThdPoolSubmit(&tp, bmk20_job, NULL, 0);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  chThdPoolStop(&tp);
+  test_print("--- Pool  : ");
+  test_printn(n);
+  test_println(" jobs/S");
+
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chThdWait(chThdCreateFromHeap(NULL, WA_SIZE, chThdGetPriorityX() + 1,
+                                  thread20, NULL));
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Create: ");
+  test_printn(n);
+  test_println(" jobs/S");
+}
+
+ROMCONST struct testcase testbmk20 = {
+  "Benchmark, thread pool jobs",
+  NULL,
+  NULL,
+  bmk20_execute
+};
+#endif /* CH_CFG_USE_THREAD_POOLS */
+
+#if CH_CFG_USE_BASIC_TASKS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_021 Basic tasks activation
+ *
+ * <h2>Description</h2>
+ * A basic task of a level with higher priority is activated into a
+ * continuous loop, then a thread with the same priority is signaled
+ * through a semaphore into a continuous loop.<br>
+ * The performance is calculated by measuring the number of activations
+ * after a second of continuous operations. Both the models perform a
+ * thread wakeup for each activation so the scores are expected to be
+ * close, the RAM required by a group of handlers with the same priority
+ * is printed for both the models.
+ */
+
+#define BMK_HANDLERS            8
+
+static void bmk21_task(void *arg) {
+
+  (void)arg;
+}
+
+static msg_t thread21(void *p) {
+
+  (void)p;
+  while (!chThdShouldTerminateX())
+    chSemWait(&sem1);
+  return 0;
+}
+
+static void bmk21_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+}
+
+static void bmk21_execute(void) {
+  static btask_level_t bl;
+  static btask_t bt;
+  uint32_t n;
+
+  chBTaskLevelObjectInit(&bl);
+  chBTaskLevelStart(&bl, wa[0], WA_SIZE, chThdGetPriorityX() + 1);
+  chBTaskObjectInit(&bt, &bl, bmk21_task, NULL, 1);
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    (void)chBTaskActivate(&bt);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  chBTaskLevelStop(&bl);
+  test_print("--- Tasks  : ");
+  test_printn(n);
+  test_println(" activations/S");
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                 thread21, NULL);
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chSemSignal(&sem1);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  chThdTerminate(threads[0]);
+  chSemSignal(&sem1);
+  test_wait_threads();
+  test_print("--- Threads: ");
+  test_printn(n);
+  test_println(" activations/S");
+
+  test_print("--- RAM x");
+  test_printn(BMK_HANDLERS);
+  test_print(": ");
+  test_printn(sizeof(btask_level_t) + WA_SIZE +
+              BMK_HANDLERS * sizeof(btask_t));
+  test_print(" bytes as tasks, ");
+  test_printn(BMK_HANDLERS * WA_SIZE);
+  test_println(" bytes as threads");
+}
+
+ROMCONST struct testcase testbmk21 = {
+  "Benchmark, basic tasks activation",
+  bmk21_setup,
+  NULL,
+  bmk21_execute
+};
+#endif /* CH_CFG_USE_BASIC_TASKS */
+
 /**
  * @brief   Test sequence for benchmarks.
  */
@@ -710,6 +1424,31 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
   &testbmk12,
 #endif
   &testbmk13,
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+  &testbmk14,
+#endif
+#if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
+  &testbmk15,
+#endif
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+  &testbmk16,
+#endif
+#if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
+  &testbmk17,
+#endif
+#if (CH_CFG_USE_RINGS && CH_CFG_USE_QUEUES) || defined(__DOXYGEN__)
+  &testbmk18,
+#endif
+#if (CH_CFG_USE_EVENTS && CH_CFG_USE_EVENTS_CALLBACKS && PORT_SUPPORTS_RT) || \
+    defined(__DOXYGEN__)
+  &testbmk19,
+#endif
+#if CH_CFG_USE_THREAD_POOLS || defined(__DOXYGEN__)
+  &testbmk20,
+#endif
+#if CH_CFG_USE_BASIC_TASKS || defined(__DOXYGEN__)
+  &testbmk21,
+#endif
 #endif
   NULL
 };
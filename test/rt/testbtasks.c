@@ -0,0 +1,169 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_btasks Basic tasks test
+ *
+ * File: @ref testbtasks.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref basic_tasks
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref basic_tasks
+ * subsystem code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_BASIC_TASKS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_btasks_001
+ * - @subpage test_btasks_002
+ * .
+ * @file testbtasks.c
+ * @brief Basic tasks test source file
+ * @file testbtasks.h
+ * @brief Basic tasks header file
+ */
+
+#if CH_CFG_USE_BASIC_TASKS || defined(__DOXYGEN__)
+
+static btask_level_t bl1, bl2;
+static btask_t bt1, bt2, bt3;
+
+static void btask(void *arg) {
+
+  test_emit_token(*(char *)arg);
+}
+
+static void btasks_setup(void) {
+
+  chBTaskLevelObjectInit(&bl1);
+  chBTaskLevelObjectInit(&bl2);
+}
+
+/**
+ * @page test_btasks_001 Activations counting and limits
+ *
+ * <h2>Description</h2>
+ * Two tasks of a level with lower priority than the test thread are
+ * activated beyond their limits. The extra activations are expected to be
+ * rejected and the accepted ones to be executed in activation order when
+ * the test thread sleeps.
+ */
+
+static void btasks1_execute(void) {
+  btask_level_stats_t *sp = chBTaskLevelGetStatisticsX(&bl1);
+
+  chBTaskLevelStart(&bl1, wa[0], WA_SIZE, chThdGetPriorityX() - 1);
+  chBTaskObjectInit(&bt1, &bl1, btask, "A", 2);
+  chBTaskObjectInit(&bt2, &bl1, btask, "B", 1);
+
+  test_assert(1, !chBTaskActivate(&bt1), "rejected");
+  test_assert(2, !chBTaskActivate(&bt2), "rejected");
+  test_assert(3, !chBTaskActivate(&bt1), "rejected");
+  test_assert(4, chBTaskActivate(&bt1), "not rejected");
+  test_assert(5, chBTaskActivate(&bt2), "not rejected");
+  test_assert_lock(6, chBTaskGetActivationsI(&bt1) == 2,
+                   "wrong activations count");
+
+  chThdSleepMilliseconds(1);
+  test_assert_sequence(7, "ABA");
+  test_assert_lock(8, chBTaskGetActivationsI(&bt1) == 0,
+                   "wrong activations count");
+  test_assert(9, sp->activations == 3, "wrong activations");
+  test_assert(10, sp->rejected == 2, "wrong rejected");
+#if CH_CFG_USE_TM
+  test_assert(11, sp->latency.n == 3, "wrong executions");
+#endif
+
+  chBTaskLevelStop(&bl1);
+}
+
+ROMCONST struct testcase testbtasks1 = {
+  "Basic tasks, activations counting and limits",
+  btasks_setup,
+  NULL,
+  btasks1_execute
+};
+
+/**
+ * @page test_btasks_002 Preemption between levels
+ *
+ * <h2>Description</h2>
+ * A task activates a task of a higher priority level and a task of its
+ * own level. The first one is expected to preempt it and the second one
+ * to be executed after its completion. Activations still pending when a
+ * level is stopped are expected to be executed.
+ */
+
+static void lowtask(void *arg) {
+
+  (void)arg;
+  test_emit_token('A');
+  (void)chBTaskActivate(&bt2);
+  (void)chBTaskActivate(&bt3);
+  test_emit_token('C');
+}
+
+static void btasks2_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  chBTaskLevelStart(&bl1, wa[0], WA_SIZE, prio + 1);
+  chBTaskLevelStart(&bl2, wa[1], WA_SIZE, prio + 2);
+  chBTaskObjectInit(&bt1, &bl1, lowtask, NULL, 1);
+  chBTaskObjectInit(&bt2, &bl2, btask, "B", 1);
+  chBTaskObjectInit(&bt3, &bl1, btask, "D", 1);
+
+  (void)chBTaskActivate(&bt1);
+  test_assert_sequence(1, "ABCD");
+  chBTaskLevelStop(&bl2);
+
+  /* Pending activations are executed before stopping.*/
+  chBTaskLevelStop(&bl1);
+  chBTaskLevelStart(&bl1, wa[0], WA_SIZE, prio - 1);
+  (void)chBTaskActivate(&bt3);
+  chBTaskLevelStop(&bl1);
+  test_assert_sequence(2, "D");
+}
+
+ROMCONST struct testcase testbtasks2 = {
+  "Basic tasks, preemption between levels",
+  btasks_setup,
+  NULL,
+  btasks2_execute
+};
+
+#endif /* CH_CFG_USE_BASIC_TASKS */
+
+/**
+ * @brief   Test sequence for basic tasks.
+ */
+ROMCONST struct testcase * ROMCONST patternbtasks[] = {
+#if CH_CFG_USE_BASIC_TASKS || defined(__DOXYGEN__)
+  &testbtasks1,
+  &testbtasks2,
+#endif
+  NULL
+};
@@ -0,0 +1,263 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_buffers Packet Buffers test
+ *
+ * File: @ref testbuf.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref buffers subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref buffers code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_BUFFERS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_buffers_001
+ * - @subpage test_buffers_002
+ * - @subpage test_buffers_003
+ * .
+ * @file testbuf.c
+ * @brief Packet Buffers test source file
+ * @file testbuf.h
+ * @brief Packet Buffers test header file
+ */
+
+#if CH_CFG_USE_BUFFERS || defined(__DOXYGEN__)
+
+#define SMALL_SIZE      MEM_ALIGN_NEXT(CH_BUFFER_OBJECT_SIZE(16))
+#define SMALL_NUM       4
+#define LARGE_SIZE      MEM_ALIGN_NEXT(CH_BUFFER_OBJECT_SIZE(64))
+#define LARGE_NUM       2
+
+static memory_pool_t pools[2];
+static buffers_allocator_t ba1;
+
+static unsigned count_free(memory_pool_t *mp) {
+  struct pool_header *php;
+  unsigned n = 0;
+
+  chSysLock();
+  for (php = mp->mp_next; php != NULL; php = php->ph_next)
+    n++;
+  chSysUnlock();
+  return n;
+}
+
+static void buf_setup(void) {
+
+  chPoolObjectInit(&pools[0], SMALL_SIZE, NULL);
+  chPoolLoadArray(&pools[0], test.buffer, SMALL_NUM);
+  chPoolObjectInit(&pools[1], LARGE_SIZE, NULL);
+  chPoolLoadArray(&pools[1], test.buffer + SMALL_SIZE * SMALL_NUM, LARGE_NUM);
+  chBufAllocatorObjectInit(&ba1, pools, 2);
+}
+
+/**
+ * @page test_buffers_001 Allocation, headroom and tailroom
+ *
+ * <h2>Description</h2>
+ * Buffers are allocated with headroom, headers and trailers are added and
+ * removed, then all buffers are allocated and released.<br>
+ * The test expects the smallest suitable size class to be used, the
+ * pools to be refilled after the release and a headroom larger than the
+ * largest size class to be rejected.
+ */
+
+static void buf1_execute(void) {
+  buffer_t *bp, *bufs[SMALL_NUM + LARGE_NUM];
+  uint8_t *p;
+  unsigned i;
+
+  bp = chBufAlloc(&ba1, 8, 4);
+  test_assert(1, bp != NULL, "allocation failed");
+  test_assert(2, bp->b_pool == &pools[0], "wrong size class");
+  test_assert(3, (bp->b_size == 8) && (chBufGetHeadroomX(bp) == 4),
+              "wrong layout");
+
+  /* Headroom.*/
+  p = bp->b_data;
+  test_assert(4, chBufPushHeader(bp, 4) == p - 4, "push failed");
+  test_assert(5, chBufPushHeader(bp, 1) == NULL, "headroom exceeded");
+  test_assert(6, chBufPullHeader(bp, 4) == p, "pull failed");
+  test_assert(7, chBufPullHeader(bp, 9) == NULL, "data exceeded");
+
+  /* Tailroom.*/
+  i = chBufGetTailroomX(bp);
+  test_assert(8, chBufPutTail(bp, i) == p + 8, "put failed");
+  test_assert(9, chBufPutTail(bp, 1) == NULL, "tailroom exceeded");
+  chBufRelease(bp);
+
+  /* Exhausting all the size classes, larger classes are used when the best
+     fitting one is empty.*/
+  for (i = 0; i < SMALL_NUM + LARGE_NUM; i++) {
+    bufs[i] = chBufAlloc(&ba1, 4, 0);
+    test_assert(10, bufs[i] != NULL, "allocation failed");
+  }
+  test_assert(11, bufs[SMALL_NUM]->b_pool == &pools[1], "wrong size class");
+  test_assert(12, chBufAlloc(&ba1, 4, 0) == NULL, "pools not empty");
+  for (i = 0; i < SMALL_NUM + LARGE_NUM; i++)
+    chBufRelease(bufs[i]);
+  test_assert(13, count_free(&pools[0]) == SMALL_NUM, "small buffers lost");
+  test_assert(14, count_free(&pools[1]) == LARGE_NUM, "large buffers lost");
+
+  /* A headroom not fitting the largest size class is rejected.*/
+  test_assert(15, chBufAlloc(&ba1, 4, LARGE_SIZE) == NULL,
+              "headroom exceeded");
+  test_assert(16, (count_free(&pools[0]) == SMALL_NUM) &&
+                  (count_free(&pools[1]) == LARGE_NUM), "buffers lost");
+}
+
+ROMCONST struct testcase testbuf1 = {
+  "Packet Buffers, headroom and tailroom",
+  buf_setup,
+  NULL,
+  buf1_execute
+};
+
+/**
+ * @page test_buffers_002 Chains, split and trim
+ *
+ * <h2>Description</h2>
+ * A chain larger than a single buffer is allocated, then split in the
+ * middle of a buffer and trimmed.<br>
+ * The test expects the data to be preserved without copies and the
+ * storage to be returned to the pools only after all references are
+ * released.
+ */
+
+static void buf2_execute(void) {
+  buffer_t *bp, *cp, *rp;
+  uint8_t data[40];
+  unsigned i, n;
+
+  bp = chBufAlloc(&ba1, 100, 0);
+  test_assert(1, bp != NULL, "allocation failed");
+  test_assert(2, bp->b_next != NULL, "not a chain");
+  test_assert(3, chBufLength(bp) == 100, "wrong length");
+
+  /* Filling the chain with a known pattern.*/
+  n = 0;
+  for (cp = bp; cp != NULL; cp = cp->b_next)
+    for (i = 0; i < cp->b_size; i++)
+      cp->b_data[i] = (uint8_t)n++;
+
+  /* Split inside the first buffer.*/
+  rp = chBufSplit(&ba1, bp, 10);
+  test_assert(4, rp != NULL, "split failed");
+  test_assert(5, rp->b_owner == bp, "data copied");
+  test_assert(6, chBufLength(bp) == 10, "wrong first length");
+  test_assert(7, chBufLength(rp) == 90, "wrong second length");
+  test_assert(8, chBufGetTailroomX(bp) == 0, "shared storage writable");
+  test_assert(9, chBufCopyOut(rp, 0, data, sizeof(data)) == sizeof(data),
+              "copy failed");
+  for (i = 0; i < sizeof(data); i++)
+    test_assert(10, data[i] == (uint8_t)(i + 10), "wrong data");
+  test_assert(11, chBufCopyOut(rp, 80, data, sizeof(data)) == 10,
+              "copy past end");
+
+  /* Trimming releases the second buffer of the chain.*/
+  chBufTrim(rp, 30);
+  test_assert(12, chBufLength(rp) == 30, "wrong trimmed length");
+  test_assert(13, count_free(&pools[1]) == 1, "buffer not released");
+
+  /* The storage is shared, the first buffer is freed after both the
+     parts are released.*/
+  chBufRelease(bp);
+  test_assert(14, count_free(&pools[1]) == 1, "shared buffer released");
+  chBufRelease(rp);
+  test_assert(15, count_free(&pools[0]) == SMALL_NUM, "small buffers lost");
+  test_assert(16, count_free(&pools[1]) == LARGE_NUM, "large buffers lost");
+}
+
+ROMCONST struct testcase testbuf2 = {
+  "Packet Buffers, chains split and trim",
+  buf_setup,
+  NULL,
+  buf2_execute
+};
+
+/**
+ * @page test_buffers_003 Linearization and references
+ *
+ * <h2>Description</h2>
+ * Two small buffers are concatenated and the chain is shared, then the
+ * chain is linearized.<br>
+ * The test expects a single buffer with the whole data and the original
+ * chain to be released only by its last owner.
+ */
+
+static void buf3_execute(void) {
+  buffer_t *ap, *bp, *lp;
+  unsigned i;
+
+  ap = chBufAlloc(&ba1, 10, 4);
+  bp = chBufAlloc(&ba1, 10, 0);
+  test_assert(1, (ap != NULL) && (bp != NULL), "allocation failed");
+  for (i = 0; i < 10; i++) {
+    ap->b_data[i] = (uint8_t)i;
+    bp->b_data[i] = (uint8_t)(i + 10);
+  }
+  chBufCat(ap, bp);
+  test_assert(2, chBufLength(ap) == 20, "wrong length");
+  test_assert(3, chBufLinearize(&ba1, bp) == bp, "single buffer copied");
+
+  /* Second owner of the chain.*/
+  chBufAddRef(ap);
+  lp = chBufLinearize(&ba1, ap);
+  test_assert(4, (lp != NULL) && (lp->b_next == NULL), "not linear");
+  test_assert(5, lp->b_size == 20, "wrong length");
+  test_assert(6, chBufGetHeadroomX(lp) == 4, "headroom not preserved");
+  for (i = 0; i < 20; i++)
+    test_assert(7, lp->b_data[i] == (uint8_t)i, "wrong data");
+  test_assert(8, count_free(&pools[0]) == SMALL_NUM - 2, "chain released");
+
+  chBufRelease(ap);
+  chBufRelease(lp);
+  test_assert(9, count_free(&pools[0]) == SMALL_NUM, "small buffers lost");
+  test_assert(10, count_free(&pools[1]) == LARGE_NUM, "large buffers lost");
+}
+
+ROMCONST struct testcase testbuf3 = {
+  "Packet Buffers, linearization",
+  buf_setup,
+  NULL,
+  buf3_execute
+};
+
+#endif /* CH_CFG_USE_BUFFERS */
+
+/*
+ * @brief   Test sequence for packet buffers.
+ */
+ROMCONST struct testcase * ROMCONST patternbuf[] = {
+#if CH_CFG_USE_BUFFERS || defined(__DOXYGEN__)
+  &testbuf1,
+  &testbuf2,
+  &testbuf3,
+#endif
+  NULL
+};
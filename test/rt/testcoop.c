@@ -0,0 +1,270 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_coop Cooperative tasks test
+ *
+ * File: @ref testcoop.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref coop_tasks
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref coop_tasks
+ * subsystem code.<br>
+ * Note that the @ref coop_tasks subsystem depends on the @ref mwait
+ * subsystem that has to met its testing objectives as well.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_COOP
+ * - @p CH_CFG_USE_SEMAPHORES
+ * - @p CH_CFG_USE_MAILBOXES
+ * - @p CH_CFG_USE_EVENTS (test_coop_003 only)
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_coop_001
+ * - @subpage test_coop_002
+ * - @subpage test_coop_003
+ * .
+ * @file testcoop.c
+ * @brief Cooperative tasks test source file
+ * @file testcoop.h
+ * @brief Cooperative tasks header file
+ */
+
+#if (CH_CFG_USE_COOP && CH_CFG_USE_SEMAPHORES && CH_CFG_USE_MAILBOXES) ||  \
+    defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY   MS2ST(5)
+#define COOP_TASKS      3
+#define COOP_MB_SIZE    2
+
+static coop_scheduler_t cs1;
+static coop_task_t tasks[COOP_TASKS];
+static wait_object_t cs_wait[COOP_TASKS];
+static coop_task_t *cs_waiting[COOP_TASKS];
+static msg_t mb_buffer[COOP_MB_SIZE];
+
+static SEMAPHORE_DECL(sem1, 0);
+static MAILBOX_DECL(mb1, mb_buffer, COOP_MB_SIZE);
+#if CH_CFG_USE_EVENTS
+static EVENTSOURCE_DECL(es1);
+#endif
+
+static void coop_setup(void) {
+
+  chCoopObjectInit(&cs1, cs_wait, cs_waiting, COOP_TASKS);
+  chSemObjectInit(&sem1, 0);
+  chMBObjectInit(&mb1, mb_buffer, COOP_MB_SIZE);
+#if CH_CFG_USE_EVENTS
+  chEvtObjectInit(&es1);
+#endif
+}
+
+/**
+ * @page test_coop_001 Yield and sleep
+ *
+ * <h2>Description</h2>
+ * Two tasks emit tokens yielding between them while a third task sleeps,
+ * the tasks are expected to be executed in rounds and the scheduler to
+ * return after the sleep when all the tasks terminated.
+ */
+
+static void yielder(coop_task_t *ctp) {
+  const char *tokens = chCoopGetArgX(ctp);
+
+  COOP_BEGIN(ctp);
+  test_emit_token(tokens[0]);
+  COOP_YIELD(ctp);
+  test_emit_token(tokens[1]);
+  COOP_END(ctp);
+}
+
+static void sleeper(coop_task_t *ctp) {
+
+  COOP_BEGIN(ctp);
+  COOP_SLEEP(ctp, MS2ST(10));
+  test_emit_token(*(char *)chCoopGetArgX(ctp));
+  COOP_END(ctp);
+}
+
+static void coop1_execute(void) {
+  systime_t target_time;
+
+  chCoopTaskStart(&cs1, &tasks[0], yielder, "AC");
+  chCoopTaskStart(&cs1, &tasks[1], yielder, "BD");
+  chCoopTaskStart(&cs1, &tasks[2], sleeper, "E");
+
+  target_time = test_wait_tick() + MS2ST(10);
+  chCoopRun(&cs1);
+  test_assert_sequence(1, "ABCDE");
+  test_assert_time_window(2, target_time, target_time + ALLOWED_DELAY);
+}
+
+ROMCONST struct testcase testcoop1 = {
+  "Cooperative tasks, yield and sleep",
+  coop_setup,
+  NULL,
+  coop1_execute
+};
+
+/**
+ * @page test_coop_002 Waits on objects
+ *
+ * <h2>Description</h2>
+ * A task waits on a semaphore with a timeout and then without a timeout,
+ * the semaphore is signaled by a second task after a delay. A third task
+ * waits on a mailbox, the message is posted by a thread. The tokens
+ * emitted by the tasks are expected in order of the events.
+ */
+
+static void semwaiter(coop_task_t *ctp) {
+
+  COOP_BEGIN(ctp);
+  COOP_WAIT_SEMAPHORE(ctp, &sem1, MS2ST(5));
+  if (chCoopGetResultX(ctp) == MSG_TIMEOUT)
+    test_emit_token('A');
+  COOP_WAIT_SEMAPHORE(ctp, &sem1, TIME_INFINITE);
+  if (chCoopGetResultX(ctp) == MSG_OK)
+    test_emit_token('C');
+  COOP_END(ctp);
+}
+
+static void signaler(coop_task_t *ctp) {
+
+  COOP_BEGIN(ctp);
+  COOP_SLEEP(ctp, MS2ST(10));
+  test_emit_token('B');
+  chSemSignal(&sem1);
+  COOP_END(ctp);
+}
+
+static void mbwaiter(coop_task_t *ctp) {
+
+  COOP_BEGIN(ctp);
+  COOP_FETCH_MAILBOX(ctp, &mb1, TIME_INFINITE);
+  if (chCoopGetResultX(ctp) == MSG_OK)
+    test_emit_token((char)chCoopGetDataX(ctp));
+  COOP_END(ctp);
+}
+
+static msg_t poster(void *p) {
+
+  (void)p;
+  chThdSleepMilliseconds(20);
+  (void)chMBPost(&mb1, 'D', TIME_INFINITE);
+  return 0;
+}
+
+static void coop2_execute(void) {
+
+  chCoopTaskStart(&cs1, &tasks[0], semwaiter, NULL);
+  chCoopTaskStart(&cs1, &tasks[1], signaler, NULL);
+  chCoopTaskStart(&cs1, &tasks[2], mbwaiter, NULL);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                 poster, NULL);
+
+  chCoopRun(&cs1);
+  test_wait_threads();
+  test_assert_sequence(1, "ABCD");
+  test_assert(2, queue_isempty(&ch.mwqueue), "still queued");
+}
+
+ROMCONST struct testcase testcoop2 = {
+  "Cooperative tasks, waits on objects",
+  coop_setup,
+  NULL,
+  coop2_execute
+};
+
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+/**
+ * @page test_coop_003 Event sources
+ *
+ * <h2>Description</h2>
+ * A task waits on an event source while a second task broadcasts it
+ * twice from the same scheduler thread, the flags are expected to be
+ * latched and returned by a single wait. A further broadcast happening
+ * while the first task is not waiting is expected to be returned by its
+ * next wait, the listener is expected to be unregistered when the task
+ * terminates.
+ */
+
+static void evtwaiter(coop_task_t *ctp) {
+
+  COOP_BEGIN(ctp);
+  COOP_WAIT_EVENT(ctp, &es1, TIME_INFINITE);
+  if (chCoopGetResultX(ctp) == MSG_OK)
+    test_emit_token('A' + (char)chCoopGetDataX(ctp));
+  COOP_YIELD(ctp);
+  COOP_WAIT_EVENT(ctp, &es1, MS2ST(10));
+  if (chCoopGetResultX(ctp) == MSG_OK)
+    test_emit_token('A' + (char)chCoopGetDataX(ctp));
+  COOP_END(ctp);
+}
+
+static void broadcaster(coop_task_t *ctp) {
+
+  COOP_BEGIN(ctp);
+  chEvtBroadcastFlags(&es1, 1);
+  chEvtBroadcastFlags(&es1, 2);
+  COOP_YIELD(ctp);
+  chEvtBroadcastFlags(&es1, 4);
+  COOP_END(ctp);
+}
+
+static void coop3_execute(void) {
+
+  chCoopTaskStart(&cs1, &tasks[0], evtwaiter, NULL);
+  chCoopTaskStart(&cs1, &tasks[1], broadcaster, NULL);
+
+  chCoopRun(&cs1);
+  test_assert_sequence(1, "DE");
+  test_assert(2, !chEvtIsListeningI(&es1), "still listening");
+}
+
+ROMCONST struct testcase testcoop3 = {
+  "Cooperative tasks, event sources",
+  coop_setup,
+  NULL,
+  coop3_execute
+};
+#endif /* CH_CFG_USE_EVENTS */
+
+#endif /* CH_CFG_USE_COOP */
+
+/**
+ * @brief   Test sequence for cooperative tasks.
+ */
+ROMCONST struct testcase * ROMCONST patterncoop[] = {
+#if (CH_CFG_USE_COOP && CH_CFG_USE_SEMAPHORES && CH_CFG_USE_MAILBOXES) ||  \
+    defined(__DOXYGEN__)
+  &testcoop1,
+  &testcoop2,
+#if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
+  &testcoop3,
+#endif
+#endif
+  NULL
+};
@@ -0,0 +1,178 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_dpc Deferred procedure calls test
+ *
+ * File: @ref testdpc.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref dpc subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref dpc subsystem
+ * code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_DPC
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_dpc_001
+ * - @subpage test_dpc_002
+ * .
+ * @file testdpc.c
+ * @brief Deferred procedure calls test source file
+ * @file testdpc.h
+ * @brief Deferred procedure calls header file
+ */
+
+#if CH_CFG_USE_DPC || defined(__DOXYGEN__)
+
+static dpc_t dpc1, dpc2, dpc3;
+static virtual_timer_t vt1;
+static unsigned requeue;
+
+static void dpcfunc(void *arg) {
+
+  test_emit_token(*(char *)arg);
+}
+
+static void dpc_setup(void) {
+
+  chDpcObjectInit(&dpc1, dpcfunc, "A");
+  chDpcObjectInit(&dpc2, dpcfunc, "B");
+  chDpcObjectInit(&dpc3, dpcfunc, "C");
+  chDpcResetStatistics();
+}
+
+/**
+ * @page test_dpc_001 Ordering, coalescing and cancellation
+ *
+ * <h2>Description</h2>
+ * Three DPCs are queued from a critical zone, the first one is queued
+ * twice and the second one is removed from the queue. After exiting the
+ * critical zone the remaining DPCs are expected to be executed once, in
+ * FIFO order and before the test thread is resumed.
+ */
+
+static void dpc1_execute(void) {
+  dpc_stats_t *sp = chDpcGetStatisticsX();
+  bool queued, coalesced, cancelled, pending;
+
+  /* The results are checked after leaving the critical zone, the DPCs
+     would be executed otherwise.*/
+  chSysLock();
+  queued    = !chDpcQueueI(&dpc1) && !chDpcQueueI(&dpc2) &&
+              !chDpcQueueI(&dpc3);
+  coalesced = chDpcQueueI(&dpc1);
+  cancelled = chDpcCancelI(&dpc2) && !chDpcCancelI(&dpc2);
+  pending   = chDpcIsPendingI(&dpc1) && !chDpcIsPendingI(&dpc2) &&
+              chDpcIsPendingI(&dpc3);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  test_assert(1, queued, "not queued");
+  test_assert(2, coalesced, "not coalesced");
+  test_assert(3, cancelled, "wrong cancel result");
+  test_assert(4, pending, "wrong pending state");
+  test_assert_sequence(5, "AC");
+  test_assert(6, sp->queued == 4, "wrong queued count");
+  test_assert(7, sp->coalesced == 1, "wrong coalesced count");
+#if CH_CFG_USE_TM
+  test_assert(8, sp->latency.n == 2, "wrong dispatched count");
+#endif
+
+  /* Cancelling the last DPC of the queue.*/
+  chSysLock();
+  (void)chDpcQueueI(&dpc1);
+  (void)chDpcQueueI(&dpc2);
+  cancelled = chDpcCancelI(&dpc2);
+  (void)chDpcQueueI(&dpc3);
+  chSchRescheduleS();
+  chSysUnlock();
+  test_assert(9, cancelled, "not cancelled");
+  test_assert_sequence(10, "AC");
+}
+
+ROMCONST struct testcase testdpc1 = {
+  "DPC, ordering, coalescing and cancellation",
+  dpc_setup,
+  NULL,
+  dpc1_execute
+};
+
+/**
+ * @page test_dpc_002 Dispatch from ISR context
+ *
+ * <h2>Description</h2>
+ * A DPC is queued from a virtual timer callback and is expected to be
+ * executed. A DPC queuing itself again while executing is expected to be
+ * executed again.
+ */
+
+static void vtcb(void *p) {
+
+  chSysLockFromISR();
+  (void)chDpcQueueI((dpc_t *)p);
+  chSysUnlockFromISR();
+}
+
+static void dpcrequeue(void *arg) {
+
+  test_emit_token(*(char *)arg);
+  if (++requeue < 3)
+    (void)chDpcQueue(&dpc2);
+}
+
+static void dpc2_execute(void) {
+
+  chVTSet(&vt1, MS2ST(5), vtcb, &dpc1);
+  chThdSleepMilliseconds(10);
+  test_assert_sequence(1, "A");
+
+  requeue = 0;
+  chDpcObjectInit(&dpc2, dpcrequeue, "B");
+  test_assert(2, !chDpcQueue(&dpc2), "coalesced");
+  test_emit_token('C');
+  test_assert_sequence(3, "BBBC");
+}
+
+ROMCONST struct testcase testdpc2 = {
+  "DPC, dispatch from ISR context",
+  dpc_setup,
+  NULL,
+  dpc2_execute
+};
+
+#endif /* CH_CFG_USE_DPC */
+
+/**
+ * @brief   Test sequence for deferred procedure calls.
+ */
+ROMCONST struct testcase * ROMCONST patterndpc[] = {
+#if CH_CFG_USE_DPC || defined(__DOXYGEN__)
+  &testdpc1,
+  &testdpc2,
+#endif
+  NULL
+};
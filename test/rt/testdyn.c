@@ -42,6 +42,7 @@
  * - @subpage test_dynamic_001
  * - @subpage test_dynamic_002
  * - @subpage test_dynamic_003
+ * - @subpage test_dynamic_004
  * .
  * @file testdyn.c
  * @brief Dynamic thread APIs test source file
@@ -245,6 +246,70 @@ ROMCONST struct testcase testdyn3 = {
   dyn3_execute
 };
 #endif /* CH_CFG_USE_HEAP && CH_CFG_USE_REGISTRY */
+
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+/**
+ * @page test_dynamic_004 Working areas cache
+ *
+ * <h2>Description</h2>
+ * Threads are created from the default heap and waited. The working area
+ * of a terminated thread is expected to be reused by a thread of the same
+ * size and not by a thread of a different size. Working areas released
+ * while the cache is full are expected to be freed.
+ */
+
+static void dyn4_setup(void) {
+
+  chThdCacheFlush();
+  chThdCacheResetStatistics();
+}
+
+static void dyn4_execute(void) {
+  thread_t *tps[CH_CFG_DYNAMIC_CACHE_SIZE + 1];
+  thread_cache_stats_t *sp = chThdCacheGetStatisticsX();
+  tprio_t prio = chThdGetPriorityX();
+  thread_t *tp;
+  unsigned i;
+
+  /* Reuse of a working area of the same size.*/
+  tp = chThdCreateFromHeap(NULL, WA_SIZE, prio - 1, thread, "A");
+  test_assert(1, tp != NULL, "thread creation failed");
+  chThdWait(tp);
+  test_assert(2, sp->stored == 1, "not cached");
+  test_assert(3, chThdCreateFromHeap(NULL, WA_SIZE, prio - 1,
+                                     thread, "B") == tp, "not reused");
+  chThdWait(tp);
+  test_assert(4, sp->hits == 1, "wrong hits count");
+
+  /* A different size is served by the heap.*/
+  tp = chThdCreateFromHeap(NULL, WA_SIZE + 64, prio - 1, thread, "C");
+  test_assert(5, tp != NULL, "thread creation failed");
+  chThdWait(tp);
+  test_assert(6, sp->misses == 2, "wrong misses count");
+  test_assert_sequence(7, "ABC");
+
+  /* Cache overflow.*/
+  chThdCacheFlush();
+  for (i = 0; i < CH_CFG_DYNAMIC_CACHE_SIZE + 1; i++) {
+    tps[i] = chThdCreateFromHeap(NULL, WA_SIZE, prio - 1, thread, "D");
+    test_assert(8, tps[i] != NULL, "thread creation failed");
+  }
+  for (i = 0; i < CH_CFG_DYNAMIC_CACHE_SIZE + 1; i++)
+    chThdWait(tps[i]);
+  test_assert(9, ch_thdcache.tc_count == CH_CFG_DYNAMIC_CACHE_SIZE,
+              "wrong cached count");
+  test_assert(10, sp->discarded == 1, "wrong discarded count");
+  chThdCacheFlush();
+  test_assert(11, ch_thdcache.tc_count == 0, "not flushed");
+}
+
+ROMCONST struct testcase testdyn4 = {
+  "Dynamic APIs, working areas cache",
+  dyn4_setup,
+  NULL,
+  dyn4_execute
+};
+#endif /* CH_DYNAMIC_USE_CACHE */
 #endif /* CH_CFG_USE_DYNAMIC */
 
 /**
@@ -262,6 +327,9 @@ ROMCONST struct testcase * ROMCONST patterndyn[] = {
     defined(__DOXYGEN__)
   &testdyn3,
 #endif
+#if CH_DYNAMIC_USE_CACHE || defined(__DOXYGEN__)
+  &testdyn4,
+#endif
 #endif
   NULL
 };
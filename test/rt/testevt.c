@@ -32,6 +32,7 @@
  * The module requires the following kernel options:
  * - @p CH_CFG_USE_EVENTS
  * - @p CH_CFG_USE_EVENTS_TIMEOUT
+ * - @p CH_CFG_USE_EVENTS_CALLBACKS
  * .
  * In case some of the required options are not enabled then some or all tests
  * may be skipped.
@@ -40,6 +41,7 @@
  * - @subpage test_events_001
  * - @subpage test_events_002
  * - @subpage test_events_003
+ * - @subpage test_events_004
  * .
  * @file testevt.c
  * @brief Events test source file
@@ -277,6 +279,99 @@ ROMCONST struct testcase testevt3 = {
 };
 #endif /* CH_CFG_USE_EVENTS_TIMEOUT */
 
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+/**
+ * @page test_events_004 Events callback listeners
+ *
+ * <h2>Description</h2>
+ * A thread listener and two callback listeners are registered on an event
+ * source, the source is broadcasted and the test verifies that the
+ * callbacks are invoked in reverse registration order with the broadcasted
+ * flags while the thread is signaled as usual.<br>
+ * In the second part more callback listeners than
+ * @p CH_CFG_EVENTS_CALLBACKS_MAX are registered and the test verifies that
+ * the exceeding listener is skipped, its flags accumulated and that it is
+ * served first by the next broadcast.
+ */
+
+static eventflags_t cbflags;
+static unsigned cbcnt;
+
+static void evt4_setup(void) {
+
+  chEvtGetAndClearEvents(ALL_EVENTS);
+}
+
+static void cb1(void *p, eventflags_t flags) {
+
+  test_emit_token_i(*(char *)p);
+  cbflags |= flags;
+}
+
+static void cb2(void *p, eventflags_t flags) {
+
+  (void)p;
+  cbcnt++;
+  cbflags |= flags;
+}
+
+static void evt4_execute(void) {
+  event_listener_t el1, el2, el3, els[CH_CFG_EVENTS_CALLBACKS_MAX];
+  unsigned i;
+  eventmask_t m;
+
+  /*
+   * Callbacks and thread listeners on the same source.
+   */
+  chEvtObjectInit(&es1);
+  cbflags = 0;
+  chEvtRegisterMask(&es1, &el1, 1);
+  chEvtRegisterCallback(&es1, &el2, cb1, "A");
+  chEvtRegisterCallback(&es1, &el3, cb1, "B");
+  chEvtBroadcastFlags(&es1, 4);
+  test_assert_sequence(1, "BA");
+  test_assert(2, cbflags == 4, "wrong flags");
+  test_assert(3, chEvtGetAndClearFlags(&el2) == 0, "stuck flags");
+  m = chEvtGetAndClearEvents(ALL_EVENTS);
+  test_assert(4, m == 1, "thread not signaled");
+  test_assert(5, chEvtGetAndClearFlags(&el1) == 4, "wrong flags");
+  chEvtUnregister(&es1, &el3);
+  chEvtUnregister(&es1, &el2);
+  chEvtUnregister(&es1, &el1);
+  test_assert(6, !chEvtIsListeningI(&es1), "stuck listener");
+
+  /*
+   * Callbacks limit, the first registered listener is scanned last and
+   * skipped, the next broadcast starts from it.
+   */
+  cbflags = 0;
+  cbcnt = 0;
+  chEvtRegisterCallback(&es1, &el1, cb1, "X");
+  for (i = 0; i < CH_CFG_EVENTS_CALLBACKS_MAX; i++)
+    chEvtRegisterCallback(&es1, &els[i], cb2, NULL);
+  chEvtBroadcastFlags(&es1, 8);
+  test_assert(7, cbcnt == CH_CFG_EVENTS_CALLBACKS_MAX, "wrong count");
+  test_assert(8, cbflags == 8, "wrong flags");
+  cbflags = 0;
+  cbcnt = 0;
+  chEvtBroadcastFlags(&es1, 16);
+  test_assert_sequence(9, "X");
+  test_assert(10, cbflags == (8 | 16), "flags not accumulated");
+  test_assert(11, cbcnt == CH_CFG_EVENTS_CALLBACKS_MAX - 1, "wrong count");
+  for (i = 0; i < CH_CFG_EVENTS_CALLBACKS_MAX; i++)
+    chEvtUnregister(&es1, &els[i]);
+  chEvtUnregister(&es1, &el1);
+  test_assert(12, !chEvtIsListeningI(&es1), "stuck listener");
+}
+
+ROMCONST struct testcase testevt4 = {
+  "Events, callback listeners",
+  evt4_setup,
+  NULL,
+  evt4_execute
+};
+#endif /* CH_CFG_USE_EVENTS_CALLBACKS */
+
 /**
  * @brief   Test sequence for events.
  */
@@ -287,6 +382,9 @@ ROMCONST struct testcase * ROMCONST patternevt[] = {
 #if CH_CFG_USE_EVENTS_TIMEOUT || defined(__DOXYGEN__)
   &testevt3,
 #endif
+#if CH_CFG_USE_EVENTS_CALLBACKS || defined(__DOXYGEN__)
+  &testevt4,
+#endif
 #endif
   NULL
 };
@@ -40,6 +40,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage test_mbox_001
+ * - @subpage test_mbox_002
  * .
  * @file testmbox.c
  * @brief Mailboxes test source file
@@ -226,6 +227,85 @@ ROMCONST struct testcase testmbox1 = {
   mbox1_execute
 };
 
+/**
+ * @page test_mbox_002 Batch operations
+ *
+ * <h2>Description</h2>
+ * Messages are posted/fetched in batches larger and smaller than the
+ * available space, then a thread waiting for a batch is resumed by a
+ * batch post.<br>
+ * The test expects the operations to be limited by the mailbox status and
+ * the messages order to be preserved across the buffer boundary.
+ */
+
+static msg_t thread2(void *p) {
+  msg_t msgs[MB_SIZE];
+  cnt_t i, n;
+
+  (void)p;
+  n = chMBFetchN(&mb1, msgs, MB_SIZE, TIME_INFINITE);
+  for (i = 0; i < n; i++)
+    test_emit_token(msgs[i]);
+  return 0;
+}
+
+static void mbox2_execute(void) {
+  static const msg_t msgs[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G'};
+  msg_t buf[MB_SIZE + 1];
+  cnt_t i, n;
+
+  n = chMBPostN(&mb1, msgs, 3, TIME_INFINITE);
+  test_assert(1, n == 3, "wrong count");
+  n = chMBPostN(&mb1, &msgs[3], 4, TIME_IMMEDIATE);
+  test_assert(2, n == 2, "wrong count");
+  n = chMBPostN(&mb1, msgs, 1, TIME_IMMEDIATE);
+  test_assert(3, n == 0, "not full");
+  chSysLock();
+  n = chMBPostNI(&mb1, msgs, 1);
+  chSysUnlock();
+  test_assert(4, n == 0, "not full");
+
+  n = chMBFetchN(&mb1, buf, 2, TIME_INFINITE);
+  test_assert(5, n == 2, "wrong count");
+  chSysLock();
+  n += chMBFetchNI(&mb1, &buf[2], MB_SIZE + 1 - 2);
+  chSysUnlock();
+  test_assert(6, n == MB_SIZE, "wrong count");
+  for (i = 0; i < n; i++)
+    test_emit_token(buf[i]);
+  test_assert_sequence(7, "ABCDE");
+  n = chMBFetchN(&mb1, buf, 1, TIME_IMMEDIATE);
+  test_assert(8, n == 0, "not empty");
+
+  /* Crossing the buffer boundary.*/
+  chSysLock();
+  n = chMBPostNI(&mb1, &msgs[2], 4);
+  chSysUnlock();
+  test_assert(9, n == 4, "wrong count");
+  n = chMBFetchN(&mb1, buf, 4, TIME_INFINITE);
+  test_assert(10, n == 4, "wrong count");
+  for (i = 0; i < n; i++)
+    test_emit_token(buf[i]);
+  test_assert_sequence(11, "CDEF");
+
+  /* Waking a waiting thread.*/
+  threads[0] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread2, NULL);
+  n = chMBPostN(&mb1, &msgs[4], 3, TIME_INFINITE);
+  test_assert(12, n == 3, "wrong count");
+  test_wait_threads();
+  test_assert_sequence(13, "EFG");
+  test_assert_lock(14, chMBGetFreeCountI(&mb1) == MB_SIZE, "not empty");
+  test_assert(15, mb1.mb_rdptr == mb1.mb_wrptr, "pointers not aligned");
+}
+
+ROMCONST struct testcase testmbox2 = {
+  "Mailboxes, batch operations",
+  mbox1_setup,
+  NULL,
+  mbox2_execute
+};
+
 #endif /* CH_CFG_USE_MAILBOXES */
 
 /**
@@ -234,6 +314,7 @@ ROMCONST struct testcase testmbox1 = {
 ROMCONST struct testcase * ROMCONST patternmbox[] = {
 #if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
   &testmbox1,
+  &testmbox2,
 #endif
   NULL
 };
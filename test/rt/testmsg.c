@@ -38,6 +38,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage test_msg_001
+ * - @subpage test_msg_002
  * .
  * @file testmsg.c
  * @brief Messages test source file
@@ -95,6 +96,67 @@ ROMCONST struct testcase testmsg1 = {
   msg1_execute
 };
 
+#if CH_CFG_USE_MESSAGES_ASYNC || defined(__DOXYGEN__)
+/**
+ * @page test_msg_002 Asynchronous messages
+ *
+ * <h2>Description</h2>
+ * Two asynchronous requests and then a synchronous message are sent to a
+ * lower priority server thread, then an asynchronous request without
+ * answers mailbox is sent.<br>
+ * The test expects the requests and messages to be served in the sending
+ * order and the answers to be delivered to the mailbox.
+ */
+
+static msg_t server(void *p) {
+  thread_t *tp;
+  msg_t msg;
+
+  (void)p;
+  do {
+    tp = chMsgWait();
+    msg = chMsgGet(tp);
+    chMsgRelease(tp, msg == 0 ? 0 : msg - 'A' + 'a');
+  } while (msg != 0);
+  return 0;
+}
+
+static void msg2_execute(void) {
+  static msg_t mb_buffer[2];
+  static mailbox_t mb;
+  msg_request_t req[3];
+  msg_t msg;
+
+  chMBObjectInit(&mb, mb_buffer, 2);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                                 server, NULL);
+  chMsgSendAsync(threads[0], &req[0], 'A', &mb);
+  chMsgSendAsync(threads[0], &req[1], 'B', &mb);
+  test_assert_lock(1, !chMsgIsRequestDoneI(&req[0]), "request done");
+  test_assert_lock(2, chMBGetUsedCountI(&mb) == 0, "answers posted");
+  msg = chMsgSend(threads[0], 'C');
+  test_emit_token(msg);
+  while (chMBFetch(&mb, &msg, TIME_IMMEDIATE) == MSG_OK)
+    test_emit_token(chMsgGetAnswer((msg_request_t *)msg));
+  test_assert_sequence(3, "cab");
+  test_assert_lock(4, chMsgIsRequestDoneI(&req[1]), "request not done");
+
+  chMsgSendAsync(threads[0], &req[2], 'D', NULL);
+  msg = chMsgSend(threads[0], 0);
+  test_assert(5, msg == 0, "wrong answer");
+  test_assert_lock(6, chMsgIsRequestDoneI(&req[2]), "request not done");
+  test_assert(7, chMsgGetAnswer(&req[2]) == 'd', "wrong answer");
+  test_wait_threads();
+}
+
+ROMCONST struct testcase testmsg2 = {
+  "Messages, asynchronous requests",
+  NULL,
+  NULL,
+  msg2_execute
+};
+#endif /* CH_CFG_USE_MESSAGES_ASYNC */
+
 #endif /* CH_CFG_USE_MESSAGES */
 
 /**
@@ -103,6 +165,9 @@ ROMCONST struct testcase testmsg1 = {
 ROMCONST struct testcase * ROMCONST patternmsg[] = {
 #if CH_CFG_USE_MESSAGES || defined(__DOXYGEN__)
   &testmsg1,
+#if CH_CFG_USE_MESSAGES_ASYNC || defined(__DOXYGEN__)
+  &testmsg2,
+#endif
 #endif
   NULL
 };
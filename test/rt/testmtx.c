@@ -49,6 +49,7 @@
  * - @subpage test_mtx_006
  * - @subpage test_mtx_007
  * - @subpage test_mtx_008
+ * - @subpage test_mtx_009
  * .
  * @file testmtx.c
  * @brief Mutexes and CondVars test source file
@@ -159,7 +160,7 @@ static msg_t thread2L(void *p) {
   (void)p;
   chMtxLock(&m1);
   test_cpu_pulse(40);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_cpu_pulse(10);
   test_emit_token('C');
   return 0;
@@ -182,7 +183,7 @@ static msg_t thread2H(void *p) {
   chThdSleepMilliseconds(40);
   chMtxLock(&m1);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_emit_token('A');
   return 0;
 }
@@ -250,7 +251,7 @@ static msg_t thread3LL(void *p) {
   (void)p;
   chMtxLock(&m1);
   test_cpu_pulse(30);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_emit_token('E');
   return 0;
 }
@@ -264,9 +265,9 @@ static msg_t thread3L(void *p) {
   test_cpu_pulse(20);
   chMtxLock(&m1);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m1);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m2);
   test_emit_token('D');
   return 0;
 }
@@ -278,7 +279,7 @@ static msg_t thread3M(void *p) {
   chThdSleepMilliseconds(20);
   chMtxLock(&m2);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m2);
   test_emit_token('C');
   return 0;
 }
@@ -300,7 +301,7 @@ static msg_t thread3HH(void *p) {
   chThdSleepMilliseconds(50);
   chMtxLock(&m2);
   test_cpu_pulse(10);
-  chMtxUnlock();
+  chMtxUnlock(&m2);
   test_emit_token('A');
   return 0;
 }
@@ -524,7 +525,8 @@ ROMCONST struct testcase testmtx6 = {
  *
  * <h2>Description</h2>
  * Five threads take a mutex and then enter a conditional variable queue, the
- * tester thread then proceeds to broadcast the conditional variable.<br>
+ * tester thread then proceeds to broadcast the conditional variable. The
+ * sequence is repeated with threads taking two different mutexes.<br>
  * The test expects the threads to reach their goal in increasing priority
  * order regardless of the initial order.
  */
@@ -533,6 +535,16 @@ static void mtx7_setup(void) {
 
   chCondObjectInit(&c1);
   chMtxObjectInit(&m1);
+  chMtxObjectInit(&m2);
+}
+
+static msg_t thread15(void *p) {
+
+  chMtxLock(&m2);
+  chCondWait(&c1);
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&m2);
+  return 0;
 }
 
 static void mtx7_execute(void) {
@@ -546,6 +558,16 @@ static void mtx7_execute(void) {
   chCondBroadcast(&c1);
   test_wait_threads();
   test_assert_sequence(1, "ABCDE");
+
+  /* Waiters using different mutexes are not moved on the mutex queue.*/
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread10, "E");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, thread15, "D");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, thread10, "C");
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+4, thread15, "B");
+  threads[4] = chThdCreateStatic(wa[4], WA_SIZE, prio+5, thread10, "A");
+  chCondBroadcast(&c1);
+  test_wait_threads();
+  test_assert_sequence(2, "ABCDE");
 }
 
 ROMCONST struct testcase testmtx7 = {
@@ -613,6 +635,88 @@ ROMCONST struct testcase testmtx8 = {
   mtx8_execute
 };
 #endif /* CH_CFG_USE_CONDVARS */
+
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @page test_mtx_009 Priority ceiling
+ *
+ * <h2>Description</h2>
+ * A priority ceiling mutex is locked alone, while waited by another thread
+ * and nested with a priority inheritance mutex.<br>
+ * The test expects the owner to run at the ceiling priority while holding
+ * the mutex and the priority to be restored after each unlock operation.
+ */
+
+static void mtx9_setup(void) {
+
+  chMtxObjectInitCeiling(&m1, chThdGetPriorityX()+3);
+  chMtxObjectInit(&m2);
+}
+
+static msg_t thread13(void *p) {
+  tprio_t prio = chThdGetPriorityX();
+
+  chMtxLock(&m1);
+  if (chThdGetPriorityX() == *(tprio_t *)p)
+    test_emit_token('A');
+  chMtxUnlock(&m1);
+  if (chThdGetPriorityX() == prio)
+    test_emit_token('B');
+  return 0;
+}
+
+static msg_t thread14(void *p) {
+
+  chMtxLock(&m2);
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&m2);
+  return 0;
+}
+
+static void mtx9_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+  tprio_t ceiling = prio+3;
+
+  /* Simple lock, the priority is raised at lock time.*/
+  chMtxLock(&m1);
+  test_assert(1, chThdGetPriorityX() == ceiling, "not raised");
+  test_assert(2, chMtxTryLock(&m2), "already locked");
+  chMtxUnlock(&m2);
+  test_assert(3, chThdGetPriorityX() == ceiling, "wrong priority level");
+  chMtxUnlock(&m1);
+  test_assert(4, chThdGetPriorityX() == prio, "wrong priority level");
+
+  /* Owner waiting while holding the mutex, the mutex is passed to the
+     waiting thread that is raised to the ceiling.*/
+  chMtxLock(&m1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread13, &ceiling);
+  chThdSleepMilliseconds(10);
+  chMtxUnlock(&m1);
+  test_assert(5, chThdGetPriorityX() == prio, "wrong priority level");
+  test_wait_threads();
+  test_assert_sequence(6, "AB");
+
+  /* Ceiling mutex nested inside an inheritance mutex.*/
+  chMtxLock(&m2);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+5, thread14, "C");
+  test_assert(7, chThdGetPriorityX() == prio+5, "not boosted");
+  chMtxLock(&m1);
+  test_assert(8, chThdGetPriorityX() == prio+5, "wrong priority level");
+  chMtxUnlock(&m1);
+  test_assert(9, chThdGetPriorityX() == prio+5, "wrong priority level");
+  chMtxUnlock(&m2);
+  test_assert(10, chThdGetPriorityX() == prio, "wrong priority level");
+  test_wait_threads();
+  test_assert_sequence(11, "C");
+}
+
+ROMCONST struct testcase testmtx9 = {
+  "Mutexes, priority ceiling",
+  mtx9_setup,
+  NULL,
+  mtx9_execute
+};
+#endif /* CH_CFG_USE_MUTEXES_CEILING */
 #endif /* CH_CFG_USE_MUTEXES */
 
 /**
@@ -632,6 +736,9 @@ ROMCONST struct testcase * ROMCONST patternmtx[] = {
   &testmtx7,
   &testmtx8,
 #endif
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  &testmtx9,
+#endif
 #endif
   NULL
 };
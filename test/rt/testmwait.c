@@ -0,0 +1,268 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_mwait Multiple Objects Wait test
+ *
+ * File: @ref testmwait.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref mwait subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref mwait code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_WAITMULTIPLE
+ * - @p CH_CFG_USE_SEMAPHORES
+ * - @p CH_CFG_USE_MAILBOXES
+ * - @p CH_CFG_USE_QUEUES
+ * - @p CH_CFG_USE_EVENTS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_mwait_001
+ * - @subpage test_mwait_002
+ * - @subpage test_mwait_003
+ * .
+ * @file testmwait.c
+ * @brief Multiple Objects Wait test source file
+ * @file testmwait.h
+ * @brief Multiple Objects Wait test header file
+ */
+
+#if (CH_CFG_USE_WAITMULTIPLE && CH_CFG_USE_SEMAPHORES &&                    \
+     CH_CFG_USE_MAILBOXES && CH_CFG_USE_QUEUES && CH_CFG_USE_EVENTS) ||     \
+    defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY   MS2ST(5)
+#define MW_MB_SIZE      2
+#define MW_QUEUES_SIZE  2
+
+static msg_t mb_buffer[MW_MB_SIZE];
+static uint8_t iq_buffer[MW_QUEUES_SIZE];
+static uint8_t oq_buffer[MW_QUEUES_SIZE];
+
+static SEMAPHORE_DECL(sem1, 0);
+static MAILBOX_DECL(mb1, mb_buffer, MW_MB_SIZE);
+static INPUTQUEUE_DECL(iq1, iq_buffer, MW_QUEUES_SIZE, NULL, NULL);
+static OUTPUTQUEUE_DECL(oq1, oq_buffer, MW_QUEUES_SIZE, NULL, NULL);
+static EVENTSOURCE_DECL(es1);
+
+static void mwait_setup(void) {
+
+  chSemObjectInit(&sem1, 0);
+  chMBObjectInit(&mb1, mb_buffer, MW_MB_SIZE);
+  chIQObjectInit(&iq1, iq_buffer, MW_QUEUES_SIZE, NULL, NULL);
+  chOQObjectInit(&oq1, oq_buffer, MW_QUEUES_SIZE, NULL, NULL);
+  chEvtObjectInit(&es1);
+}
+
+/**
+ * @page test_mwait_001 Ready objects and timeouts
+ *
+ * <h2>Description</h2>
+ * Multiple waits are performed on objects that are already ready and on
+ * objects that are not ready.<br>
+ * The test expects the first ready object in the array to be acquired and
+ * the wait to timeout when no object is ready.
+ */
+
+static void mwait1_execute(void) {
+  wait_object_t wobjs[] = {WAIT_SEMAPHORE(&sem1), WAIT_MAILBOX(&mb1),
+                           WAIT_INPUT_QUEUE(&iq1),
+                           WAIT_OUTPUT_QUEUE(&oq1, 'C'),
+                           WAIT_EVENT_SOURCE(&es1)};
+  msg_t msg;
+  systime_t target_time;
+
+  /* The output queue is the only ready object.*/
+  msg = chMWaitTimeout(wobjs, 4, TIME_IMMEDIATE);
+  test_assert(1, msg == 3, "wrong object");
+  test_assert_lock(2, chOQGetFullI(&oq1) == 1, "not written");
+
+  /* Objects before the output queue take precedence.*/
+  chSemSignal(&sem1);
+  (void) chMBPost(&mb1, 'B', TIME_IMMEDIATE);
+  msg = chMWaitTimeout(wobjs, 4, TIME_IMMEDIATE);
+  test_assert(3, msg == 0, "wrong object");
+  test_assert_lock(4, chSemGetCounterI(&sem1) == 0, "not taken");
+  msg = chMWaitTimeout(wobjs, 4, TIME_IMMEDIATE);
+  test_assert(5, msg == 1, "wrong object");
+  test_assert(6, wobjs[1].wo_msg == 'B', "wrong message");
+  test_assert_lock(7, chMBGetUsedCountI(&mb1) == 0, "not fetched");
+
+  /* Nothing ready, the output queue is full and the event source is never
+     ready in advance.*/
+  (void) chOQPut(&oq1, 'D');
+  chEvtBroadcast(&es1);
+  msg = chMWaitTimeout(wobjs, 5, TIME_IMMEDIATE);
+  test_assert(8, msg == MSG_TIMEOUT, "wrong wake-up message");
+  target_time = chVTGetSystemTime() + MS2ST(5);
+  msg = chMWaitTimeout(wobjs, 5, MS2ST(5));
+  test_assert(9, msg == MSG_TIMEOUT, "wrong wake-up message");
+  test_assert_time_window(10, target_time, target_time + ALLOWED_DELAY);
+  test_assert(11, queue_isempty(&ch.mwqueue), "still queued");
+}
+
+ROMCONST struct testcase testmwait1 = {
+  "Multiple wait, ready objects and timeouts",
+  mwait_setup,
+  NULL,
+  mwait1_execute
+};
+
+/**
+ * @page test_mwait_002 Wake-up by objects
+ *
+ * <h2>Description</h2>
+ * A thread waits on a mailbox, an input queue and an output queue while
+ * other threads post a message, put a byte into the input queue and get
+ * bytes from the full output queue.<br>
+ * The test expects the waiting thread to acquire each object when it
+ * becomes ready.
+ */
+
+static msg_t mb_poster(void *p) {
+
+  (void) chMBPost(&mb1, *(char *)p, TIME_INFINITE);
+  return 0;
+}
+
+static msg_t iq_writer(void *p) {
+
+  chSysLock();
+  (void) chIQPutI(&iq1, *(char *)p);
+  chSchRescheduleS();
+  chSysUnlock();
+  return 0;
+}
+
+static msg_t oq_reader(void *p) {
+
+  (void)p;
+  chSysLock();
+  (void) chOQGetI(&oq1);
+  chSchRescheduleS();
+  chSysUnlock();
+  return 0;
+}
+
+static void mwait2_execute(void) {
+  wait_object_t wobjs[] = {WAIT_MAILBOX(&mb1), WAIT_INPUT_QUEUE(&iq1),
+                           WAIT_OUTPUT_QUEUE(&oq1, 'C')};
+  tprio_t prio = chThdGetPriorityX();
+  msg_t msg;
+
+  (void) chOQPut(&oq1, 'X');
+  (void) chOQPut(&oq1, 'Y');
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio-1, mb_poster, "A");
+  msg = chMWaitTimeout(wobjs, 3, TIME_INFINITE);
+  test_assert(1, msg == 0, "wrong object");
+  test_assert(2, wobjs[0].wo_msg == 'A', "wrong message");
+
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio-1, iq_writer, "B");
+  msg = chMWaitTimeout(wobjs, 3, TIME_INFINITE);
+  test_assert(3, msg == 1, "wrong object");
+  test_assert(4, wobjs[1].wo_msg == 'B', "wrong byte");
+  test_assert_lock(5, chIQIsEmptyI(&iq1), "not read");
+
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio-1, oq_reader, NULL);
+  msg = chMWaitTimeout(wobjs, 3, TIME_INFINITE);
+  test_assert(6, msg == 2, "wrong object");
+  test_assert_lock(7, chOQIsFullI(&oq1), "not written");
+  test_assert_lock(8, chOQGetI(&oq1) == 'Y', "wrong byte");
+  test_assert_lock(9, chOQGetI(&oq1) == 'C', "wrong byte");
+  test_wait_threads();
+}
+
+ROMCONST struct testcase testmwait2 = {
+  "Multiple wait, wake-up by objects",
+  mwait_setup,
+  NULL,
+  mwait2_execute
+};
+
+/**
+ * @page test_mwait_003 Priority order and event sources
+ *
+ * <h2>Description</h2>
+ * Five threads with different priorities wait on a semaphore and on an
+ * event source, the semaphore is signaled three times then the event
+ * source is broadcasted.<br>
+ * The test expects the semaphore to be acquired by the threads in
+ * priority order and the remaining threads to receive the broadcast
+ * flags.
+ */
+
+static msg_t waiter(void *p) {
+  wait_object_t wobjs[] = {WAIT_SEMAPHORE(&sem1), WAIT_EVENT_SOURCE(&es1)};
+
+  if (chMWaitTimeout(wobjs, 2, TIME_INFINITE) == 0)
+    test_emit_token(*(char *)p);
+  else if (wobjs[1].wo_msg == 0x55)
+    test_emit_token(*(char *)p + 'a' - 'A');
+  return 0;
+}
+
+static void mwait3_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+5, waiter, "E");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+4, waiter, "D");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, waiter, "C");
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+2, waiter, "B");
+  threads[4] = chThdCreateStatic(wa[4], WA_SIZE, prio+1, waiter, "A");
+  chSysLock();
+  chSemAddCounterI(&sem1, 2);
+  chSemSignalI(&sem1);
+  chSchRescheduleS();
+  chSysUnlock();
+  chEvtBroadcastFlags(&es1, 0x55);
+  test_wait_threads();
+  test_assert_sequence(1, "EDCba");
+  test_assert_lock(2, chSemGetCounterI(&sem1) == 0, "wrong counter");
+}
+
+ROMCONST struct testcase testmwait3 = {
+  "Multiple wait, priority order and event sources",
+  mwait_setup,
+  NULL,
+  mwait3_execute
+};
+
+#endif /* CH_CFG_USE_WAITMULTIPLE */
+
+/**
+ * @brief   Test sequence for multiple objects wait.
+ */
+ROMCONST struct testcase * ROMCONST patternmwait[] = {
+#if (CH_CFG_USE_WAITMULTIPLE && CH_CFG_USE_SEMAPHORES &&                    \
+     CH_CFG_USE_MAILBOXES && CH_CFG_USE_QUEUES && CH_CFG_USE_EVENTS) ||     \
+    defined(__DOXYGEN__)
+  &testmwait1,
+  &testmwait2,
+  &testmwait3,
+#endif
+  NULL
+};
@@ -0,0 +1,196 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_objfifo Objects FIFOs test
+ *
+ * File: @ref testobjfifo.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref objects_fifos
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref objects_fifos
+ * subsystem code.<br>
+ * Note that the @ref objects_fifos subsystem depends on the @ref pools and
+ * @ref mailboxes subsystems that have to met their testing objectives as
+ * well.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_OBJ_FIFOS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_objfifo_001
+ * - @subpage test_objfifo_002
+ * .
+ * @file testobjfifo.c
+ * @brief Objects FIFOs test source file
+ * @file testobjfifo.h
+ * @brief Objects FIFOs header file
+ */
+
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+
+#define FIFO_SIZE 4
+
+typedef union {
+  stkalign_t            align[2];
+  char                  c;
+} fifo_obj_t;
+
+static objects_fifo_t of1;
+static fifo_obj_t fifo_objs[FIFO_SIZE];
+static msg_t fifo_msgs[FIFO_SIZE];
+
+static void objfifo_setup(void) {
+
+  chFifoObjectInit(&of1, sizeof (fifo_obj_t), FIFO_SIZE,
+                   fifo_objs, fifo_msgs);
+}
+
+/**
+ * @page test_objfifo_001 Allocation and queuing
+ *
+ * <h2>Description</h2>
+ * All the objects are taken from the FIFO, sent and then received and
+ * returned.<br>
+ * The test expects the objects to be exhausted after taking all of them
+ * and to be received in the sending order.
+ */
+
+static void objfifo1_execute(void) {
+  fifo_obj_t *objp;
+  msg_t msg;
+  unsigned i;
+
+  for (i = 0; i < FIFO_SIZE - 1; i++) {
+    objp = chFifoTakeObject(&of1, TIME_INFINITE);
+    test_assert(1, objp != NULL, "object not available");
+    objp->c = 'A' + i;
+    chFifoSendObject(&of1, objp);
+  }
+  chSysLock();
+  objp = chFifoTakeObjectI(&of1);
+  test_assert(2, objp != NULL, "object not available");
+  objp->c = 'A' + i;
+  chFifoSendObjectI(&of1, objp);
+  objp = chFifoTakeObjectI(&of1);
+  chSysUnlock();
+  test_assert(3, objp == NULL, "object available");
+  objp = chFifoTakeObject(&of1, TIME_IMMEDIATE);
+  test_assert(4, objp == NULL, "object available");
+  test_assert_lock(5, chFifoGetUsedCountI(&of1) == FIFO_SIZE,
+                   "wrong ready count");
+
+  msg = chFifoReceiveObject(&of1, (void **)&objp, TIME_INFINITE);
+  test_assert(6, msg == MSG_OK, "wrong wake-up message");
+  test_emit_token(objp->c);
+  chFifoReturnObject(&of1, objp);
+  while (true) {
+    chSysLock();
+    msg = chFifoReceiveObjectI(&of1, (void **)&objp);
+    chSysUnlock();
+    if (msg != MSG_OK)
+      break;
+    test_emit_token(objp->c);
+    chSysLock();
+    chFifoReturnObjectI(&of1, objp);
+    chSysUnlock();
+  }
+  test_assert_sequence(7, "ABCD");
+  test_assert(8, msg == MSG_TIMEOUT, "wrong wake-up message");
+  msg = chFifoReceiveObject(&of1, (void **)&objp, TIME_IMMEDIATE);
+  test_assert(9, msg == MSG_TIMEOUT, "wrong wake-up message");
+  test_assert_lock(10, chFifoGetFreeCountI(&of1) == FIFO_SIZE,
+                   "wrong free count");
+}
+
+ROMCONST struct testcase testobjfifo1 = {
+  "Objects FIFOs, allocation and queuing",
+  objfifo_setup,
+  NULL,
+  objfifo1_execute
+};
+
+/**
+ * @page test_objfifo_002 Producer and consumer
+ *
+ * <h2>Description</h2>
+ * A consumer thread receives objects sent by the test thread and returns
+ * them to the FIFO, the test thread sends more objects than the FIFO
+ * can hold.<br>
+ * The test expects the objects to be received in the sending order and
+ * all the objects to be free at the end.
+ */
+
+static msg_t thread1(void *p) {
+  fifo_obj_t *objp;
+  unsigned i;
+
+  (void)p;
+  for (i = 0; i < 2 * FIFO_SIZE; i++) {
+    if (chFifoReceiveObject(&of1, (void **)&objp, TIME_INFINITE) != MSG_OK)
+      break;
+    test_emit_token(objp->c);
+    chFifoReturnObject(&of1, objp);
+  }
+  return 0;
+}
+
+static void objfifo2_execute(void) {
+  fifo_obj_t *objp;
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1,
+                                 thread1, NULL);
+  for (i = 0; i < 2 * FIFO_SIZE; i++) {
+    objp = chFifoTakeObject(&of1, MS2ST(500));
+    test_assert(1, objp != NULL, "object not available");
+    objp->c = 'A' + i;
+    chFifoSendObject(&of1, objp);
+  }
+  test_wait_threads();
+  test_assert_sequence(2, "ABCDEFGH");
+  test_assert_lock(3, chFifoGetFreeCountI(&of1) == FIFO_SIZE,
+                   "wrong free count");
+}
+
+ROMCONST struct testcase testobjfifo2 = {
+  "Objects FIFOs, producer and consumer",
+  objfifo_setup,
+  NULL,
+  objfifo2_execute
+};
+#endif /* CH_CFG_USE_OBJ_FIFOS */
+
+/**
+ * @brief   Test sequence for objects FIFOs.
+ */
+ROMCONST struct testcase * ROMCONST patternobjfifo[] = {
+#if CH_CFG_USE_OBJ_FIFOS || defined(__DOXYGEN__)
+  &testobjfifo1,
+  &testobjfifo2,
+#endif
+  NULL
+};
@@ -0,0 +1,191 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_pmbox Priority mailboxes test
+ *
+ * File: @ref testpmbox.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref pmailboxes
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref pmailboxes
+ * subsystem code.<br>
+ * Note that the @ref pmailboxes subsystem depends on the @ref semaphores
+ * subsystem that has to met its testing objectives as well.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_PMAILBOXES
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_pmbox_001
+ * - @subpage test_pmbox_002
+ * .
+ * @file testpmbox.c
+ * @brief Priority mailboxes test source file
+ * @file testpmbox.h
+ * @brief Priority mailboxes header file
+ */
+
+#if CH_CFG_USE_PMAILBOXES || defined(__DOXYGEN__)
+
+#define PMB_SIZE 5
+#define PMB_HIGH (CH_CFG_PMAILBOXES_LEVELS - 1)
+
+static pmailbox_t pmb1;
+static pmb_slot_t pmb_buffer[PMB_SIZE];
+
+static void pmbox_setup(void) {
+
+  chPMBObjectInit(&pmb1, pmb_buffer, PMB_SIZE);
+}
+
+/**
+ * @page test_pmbox_001 Priority ordering
+ *
+ * <h2>Description</h2>
+ * Messages with different priority levels are posted in the mailbox then
+ * fetched, the operation is repeated after a reset.<br>
+ * The test expects the messages to be fetched in priority order and in FIFO
+ * order within the same priority level.
+ */
+
+static void pmbox1_execute(void) {
+  msg_t msg1, msg2;
+  unsigned i;
+
+  for (i = 0; i < 2; i++) {
+    msg1 = chPMBPost(&pmb1, 'D', 0, TIME_INFINITE);
+    test_assert(1, msg1 == MSG_OK, "wrong wake-up message");
+    msg1 = chPMBPost(&pmb1, 'B', PMB_HIGH, TIME_INFINITE);
+    test_assert(2, msg1 == MSG_OK, "wrong wake-up message");
+    msg1 = chPMBPost(&pmb1, 'E', 0, TIME_INFINITE);
+    test_assert(3, msg1 == MSG_OK, "wrong wake-up message");
+    chSysLock();
+    msg1 = chPMBPostI(&pmb1, 'A', PMB_HIGH);
+    msg2 = chPMBPostI(&pmb1, 'C', PMB_HIGH);
+    chSysUnlock();
+    test_assert(4, (msg1 == MSG_OK) && (msg2 == MSG_OK),
+                "wrong wake-up message");
+    test_assert_lock(5, chPMBGetFreeCountI(&pmb1) == 0, "not full");
+    test_assert_lock(6, chPMBGetUsedCountI(&pmb1) == PMB_SIZE, "not full");
+
+    /* Full mailbox, the message must be rejected.*/
+    msg1 = chPMBPost(&pmb1, 'X', PMB_HIGH, TIME_IMMEDIATE);
+    test_assert(7, msg1 == MSG_TIMEOUT, "wrong wake-up message");
+    chSysLock();
+    msg1 = chPMBPostI(&pmb1, 'X', PMB_HIGH);
+    chSysUnlock();
+    test_assert(8, msg1 == MSG_TIMEOUT, "wrong wake-up message");
+
+    if (i == 0) {
+      /* First pass, the content is discarded.*/
+      chPMBReset(&pmb1);
+      test_assert_lock(9, chPMBGetFreeCountI(&pmb1) == PMB_SIZE, "not empty");
+      test_assert_lock(10, chPMBGetUsedCountI(&pmb1) == 0, "still full");
+      continue;
+    }
+
+    msg1 = chPMBFetch(&pmb1, &msg2, TIME_INFINITE);
+    test_assert(11, msg1 == MSG_OK, "wrong wake-up message");
+    test_emit_token(msg2);
+    while (true) {
+      chSysLock();
+      msg1 = chPMBFetchI(&pmb1, &msg2);
+      chSysUnlock();
+      if (msg1 != MSG_OK)
+        break;
+      test_emit_token(msg2);
+    }
+    test_assert_sequence(12, "BACDE");
+    test_assert(13, msg1 == MSG_TIMEOUT, "wrong wake-up message");
+    msg1 = chPMBFetch(&pmb1, &msg2, TIME_IMMEDIATE);
+    test_assert(14, msg1 == MSG_TIMEOUT, "wrong wake-up message");
+    test_assert_lock(15, chPMBGetFreeCountI(&pmb1) == PMB_SIZE, "not empty");
+  }
+}
+
+ROMCONST struct testcase testpmbox1 = {
+  "Priority mailboxes, priority ordering",
+  pmbox_setup,
+  NULL,
+  pmbox1_execute
+};
+
+/**
+ * @page test_pmbox_002 Waiting threads
+ *
+ * <h2>Description</h2>
+ * A thread waits for a message and is resumed by a post, another thread
+ * waits for a message and is resumed by a reset.<br>
+ * The test expects the threads to be resumed with the correct message
+ * and status.
+ */
+
+static msg_t thread1(void *p) {
+  msg_t msg, rdymsg;
+
+  rdymsg = chPMBFetch(&pmb1, &msg, TIME_INFINITE);
+  if (rdymsg == MSG_OK)
+    test_emit_token(msg);
+  else if (rdymsg == MSG_RESET)
+    test_emit_token(*(char *)p);
+  return 0;
+}
+
+static void pmbox2_execute(void) {
+  msg_t msg;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread1, "X");
+  msg = chPMBPost(&pmb1, 'A', 0, TIME_INFINITE);
+  test_assert(1, msg == MSG_OK, "wrong wake-up message");
+  test_wait_threads();
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread1, "B");
+  chPMBReset(&pmb1);
+  test_wait_threads();
+  test_assert_sequence(2, "AB");
+}
+
+ROMCONST struct testcase testpmbox2 = {
+  "Priority mailboxes, waiting threads",
+  pmbox_setup,
+  NULL,
+  pmbox2_execute
+};
+#endif /* CH_CFG_USE_PMAILBOXES */
+
+/**
+ * @brief   Test sequence for priority mailboxes.
+ */
+ROMCONST struct testcase * ROMCONST patternpmbox[] = {
+#if CH_CFG_USE_PMAILBOXES || defined(__DOXYGEN__)
+  &testpmbox1,
+  &testpmbox2,
+#endif
+  NULL
+};
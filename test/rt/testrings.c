@@ -0,0 +1,224 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_rings Lock-free rings test
+ *
+ * File: @ref testrings.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref rings subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref rings
+ * subsystem code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_RINGS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_rings_001
+ * - @subpage test_rings_002
+ * - @subpage test_rings_003
+ * .
+ * @file testrings.c
+ * @brief Lock-free rings test source file
+ * @file testrings.h
+ * @brief Lock-free rings header file
+ */
+
+#if CH_CFG_USE_RINGS || defined(__DOXYGEN__)
+
+#define ALLOWED_DELAY MS2ST(5)
+#define RING_SIZE 4
+
+typedef struct {
+  char                  c;
+  uint16_t              n;
+} ring_rec_t;
+
+static spsc_ring_t ring1;
+static uint8_t ring_buffer[RING_BUFFER_SIZE(RING_SIZE, sizeof (ring_rec_t))];
+
+static void rings_bytes_setup(void) {
+
+  chRingObjectInit(&ring1, ring_buffer, RING_SIZE, 1);
+}
+
+/**
+ * @page test_rings_001 Bytes ring
+ *
+ * <h2>Description</h2>
+ * Bytes are written into and read from a ring, the ring is filled, emptied
+ * and then the pointers are moved across the buffer boundary.<br>
+ * The test expects the ring to report the correct status after each
+ * operation and the bytes order to be preserved.
+ */
+
+static void rings1_execute(void) {
+  unsigned i;
+  msg_t msg;
+
+  test_assert(1, chRingGetX(&ring1) == RING_EMPTY, "not empty");
+  for (i = 0; i < RING_SIZE; i++)
+    test_assert(2, chRingPutX(&ring1, 'A' + i), "full");
+  test_assert(3, !chRingPutX(&ring1, 'X'), "not full");
+  test_assert(4, chRingGetUsedCountX(&ring1) == RING_SIZE, "wrong count");
+  test_assert(5, chRingGetFreeCountX(&ring1) == 0, "wrong count");
+  while ((msg = chRingGetX(&ring1)) != RING_EMPTY)
+    test_emit_token((char)msg);
+  test_assert_sequence(6, "ABCD");
+  test_assert(7, chRingGetFreeCountX(&ring1) == RING_SIZE, "wrong count");
+
+  /* Crossing the buffer boundary several times.*/
+  for (i = 0; i < 3 * RING_SIZE; i++) {
+    test_assert(8, chRingPutX(&ring1, 'A' + i), "full");
+    test_assert(9, chRingPutX(&ring1, 'a' + i), "full");
+    test_assert(10, chRingGetX(&ring1) == (msg_t)('A' + i), "wrong byte");
+    test_assert(11, chRingGetX(&ring1) == (msg_t)('a' + i), "wrong byte");
+  }
+  test_assert(12, chRingGetUsedCountX(&ring1) == 0, "not empty");
+}
+
+ROMCONST struct testcase testrings1 = {
+  "Lock-free rings, bytes ring",
+  rings_bytes_setup,
+  NULL,
+  rings1_execute
+};
+
+/**
+ * @page test_rings_002 Records ring
+ *
+ * <h2>Description</h2>
+ * Records are written into and read from a ring in sequences crossing the
+ * buffer boundary.<br>
+ * The test expects the records to be read unchanged and in order.
+ */
+
+static void rings2_setup(void) {
+
+  chRingObjectInit(&ring1, ring_buffer, RING_SIZE, sizeof (ring_rec_t));
+}
+
+static void rings2_execute(void) {
+  ring_rec_t rec;
+  unsigned i, j;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < RING_SIZE - 1; j++) {
+      rec.c = 'A' + j;
+      rec.n = (uint16_t)(i * 100 + j);
+      test_assert(1, chRingWriteX(&ring1, &rec), "full");
+    }
+    test_assert(2, chRingGetUsedCountX(&ring1) == RING_SIZE - 1,
+                "wrong count");
+    for (j = 0; j < RING_SIZE - 1; j++) {
+      test_assert(3, chRingReadX(&ring1, &rec), "empty");
+      test_assert(4, rec.n == (uint16_t)(i * 100 + j), "wrong record");
+      test_emit_token(rec.c);
+    }
+    test_assert(5, !chRingReadX(&ring1, &rec), "not empty");
+  }
+  test_assert_sequence(6, "ABCABCABC");
+}
+
+ROMCONST struct testcase testrings2 = {
+  "Lock-free rings, records ring",
+  rings2_setup,
+  NULL,
+  rings2_execute
+};
+
+/**
+ * @page test_rings_003 Consumer wakeup
+ *
+ * <h2>Description</h2>
+ * A consumer thread waits for two bytes in a ring, the producer writes the
+ * bytes one at time and invokes the wakeup function after each write.
+ * Then the wait timeout is tested.<br>
+ * The test expects the consumer to be resumed only after the second byte
+ * and the wait to timeout when the ring is empty.
+ */
+
+static msg_t thread1(void *p) {
+  msg_t msg;
+
+  (void)p;
+  if (chRingWaitTimeout(&ring1, 2, TIME_INFINITE) == MSG_OK) {
+    while ((msg = chRingGetX(&ring1)) != RING_EMPTY)
+      test_emit_token((char)msg);
+  }
+  return 0;
+}
+
+static void rings3_execute(void) {
+  systime_t target_time;
+  msg_t msg;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                 thread1, NULL);
+  chRingPutX(&ring1, 'A');
+  test_assert(1, !chRingIsWakeupNeededX(&ring1), "wakeup needed");
+  chSysLock();
+  chRingWakeupI(&ring1);
+  chSchRescheduleS();
+  chSysUnlock();
+  test_assert_sequence(2, "");
+  chRingPutX(&ring1, 'B');
+  test_assert(3, chRingIsWakeupNeededX(&ring1), "wakeup not needed");
+  chSysLock();
+  chRingWakeupI(&ring1);
+  chSchRescheduleS();
+  chSysUnlock();
+  test_assert_sequence(4, "AB");
+  test_wait_threads();
+
+  target_time = chVTGetSystemTime() + MS2ST(5);
+  msg = chRingWaitTimeout(&ring1, 1, MS2ST(5));
+  test_assert(5, msg == MSG_TIMEOUT, "wrong wake-up message");
+  test_assert_time_window(6, target_time, target_time + ALLOWED_DELAY);
+  msg = chRingWaitTimeout(&ring1, 1, TIME_IMMEDIATE);
+  test_assert(7, msg == MSG_TIMEOUT, "wrong wake-up message");
+  test_assert(8, !chRingIsWakeupNeededX(&ring1), "wakeup needed");
+}
+
+ROMCONST struct testcase testrings3 = {
+  "Lock-free rings, consumer wakeup",
+  rings_bytes_setup,
+  NULL,
+  rings3_execute
+};
+#endif /* CH_CFG_USE_RINGS */
+
+/**
+ * @brief   Test sequence for lock-free rings.
+ */
+ROMCONST struct testcase * ROMCONST patternrings[] = {
+#if CH_CFG_USE_RINGS || defined(__DOXYGEN__)
+  &testrings1,
+  &testrings2,
+  &testrings3,
+#endif
+  NULL
+};
@@ -0,0 +1,227 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_rwlocks Reader-Writer Locks test
+ *
+ * File: @ref testrw.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref rwlocks subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref rwlocks code.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_RWLOCKS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_rwlocks_001
+ * - @subpage test_rwlocks_002
+ * - @subpage test_rwlocks_003
+ * .
+ * @file testrw.c
+ * @brief Reader-Writer Locks test source file
+ * @file testrw.h
+ * @brief Reader-Writer Locks test header file
+ */
+
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+
+/*
+ * Note, the static initializer is not really required because the
+ * variable is explicitly initialized in each test case. It is done in order
+ * to test the macro.
+ */
+static RWLOCK_DECL(rw1);
+
+static void rw_setup(void) {
+
+  chRwObjectInit(&rw1);
+}
+
+static msg_t reader(void *p) {
+
+  chRwLockRead(&rw1);
+  test_emit_token(*(char *)p);
+  chRwUnlock(&rw1);
+  return 0;
+}
+
+static msg_t writer(void *p) {
+
+  chRwLockWrite(&rw1);
+  test_emit_token(*(char *)p);
+  chRwUnlock(&rw1);
+  return 0;
+}
+
+/**
+ * @page test_rwlocks_001 Readers concurrency and writers preference
+ *
+ * <h2>Description</h2>
+ * A reader is started while the lock is held in read mode, then a writer
+ * and another reader are started.<br>
+ * The test expects the first reader to share the lock, the writer to wait
+ * for the readers and the second reader to wait for the writer.
+ */
+
+static void rw1_execute(void) {
+
+  tprio_t prio = chThdGetPriorityX();
+  chRwLockRead(&rw1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, reader, "A");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, writer, "B");
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+1, reader, "C");
+  test_assert_sequence(1, "A");
+  chRwUnlock(&rw1);
+  test_wait_threads();
+  test_assert(2, prio == chThdGetPriorityX(), "wrong priority level");
+  test_assert_sequence(3, "BC");
+}
+
+ROMCONST struct testcase testrw1 = {
+  "Reader-Writer Locks, readers and writers",
+  rw_setup,
+  NULL,
+  rw1_execute
+};
+
+/**
+ * @page test_rwlocks_002 Priority inheritance
+ *
+ * <h2>Description</h2>
+ * Higher priority threads are queued on a lock owned by a writer and on a
+ * lock owned by a reader.<br>
+ * The test expects the owners to inherit the priority of the waiting
+ * threads and to return to their own priority after unlocking.
+ */
+
+static msg_t reader_sleep(void *p) {
+
+  chRwLockRead(&rw1);
+  chThdSleepMilliseconds(50);
+  test_emit_token(*(char *)p);
+  chRwUnlock(&rw1);
+  return 0;
+}
+
+static void rw2_execute(void) {
+
+  tprio_t prio = chThdGetPriorityX();
+
+  /* The writer inherits the priority of the waiting reader.*/
+  chRwLockWrite(&rw1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+2, reader, "A");
+  test_assert(1, chThdGetPriorityX() == prio+2, "not boosted");
+  chRwUnlock(&rw1);
+  test_assert(2, chThdGetPriorityX() == prio, "wrong priority level");
+  test_wait_threads();
+
+  /* The reader inherits the priority of the waiting writer.*/
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, reader_sleep, "B");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+3, writer, "C");
+  test_assert(3, threads[0]->p_prio == prio+3, "not boosted");
+  test_wait_threads();
+  test_assert_sequence(4, "ABC");
+}
+
+ROMCONST struct testcase testrw2 = {
+  "Reader-Writer Locks, priority inheritance",
+  rw_setup,
+  NULL,
+  rw2_execute
+};
+
+/**
+ * @page test_rwlocks_003 Timeouts
+ *
+ * <h2>Description</h2>
+ * A writer with timeout is queued on a lock held in read mode, then a
+ * reader is queued behind it. A reader with timeout is then queued on a
+ * lock held in write mode.<br>
+ * The test expects the writer to timeout and the reader to be allowed to
+ * share the lock after the writer is gone, the owners must lose the
+ * inherited priority as soon as the waiting threads are gone.
+ */
+
+static msg_t reader_timeout(void *p) {
+
+  if (chRwLockReadTimeout(&rw1, MS2ST(20)) == MSG_TIMEOUT)
+    test_emit_token(*(char *)p);
+  return 0;
+}
+
+static msg_t writer_timeout(void *p) {
+
+  (void)p;
+  if (chRwLockWriteTimeout(&rw1, TIME_IMMEDIATE) == MSG_TIMEOUT)
+    test_emit_token('A');
+  if (chRwLockWriteTimeout(&rw1, MS2ST(20)) == MSG_TIMEOUT)
+    test_emit_token('C');
+  return 0;
+}
+
+static void rw3_execute(void) {
+
+  tprio_t prio = chThdGetPriorityX();
+  chRwLockRead(&rw1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, writer_timeout, 0);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, reader, "B");
+  test_assert_sequence(1, "A");
+  test_wait_threads();
+  test_assert(2, prio == chThdGetPriorityX(), "priority not restored");
+  chRwUnlock(&rw1);
+  test_assert(3, prio == chThdGetPriorityX(), "wrong priority level");
+  test_assert_sequence(4, "BC");
+
+  /* The priority inherited from a reader is removed on timeout.*/
+  chRwLockWrite(&rw1);
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+2, reader_timeout, "D");
+  test_assert(5, prio+2 == chThdGetPriorityX(), "not boosted");
+  test_wait_threads();
+  test_assert(6, prio == chThdGetPriorityX(), "priority not restored");
+  chRwUnlock(&rw1);
+  test_assert_sequence(7, "D");
+}
+
+ROMCONST struct testcase testrw3 = {
+  "Reader-Writer Locks, timeouts",
+  rw_setup,
+  NULL,
+  rw3_execute
+};
+
+#endif /* CH_CFG_USE_RWLOCKS */
+
+/**
+ * @brief   Test sequence for reader-writer locks.
+ */
+ROMCONST struct testcase * ROMCONST patternrw[] = {
+#if CH_CFG_USE_RWLOCKS || defined(__DOXYGEN__)
+  &testrw1,
+  &testrw2,
+  &testrw3,
+#endif
+  NULL
+};
@@ -120,7 +120,8 @@ ROMCONST struct testcase testsem1 = {
  *
  * <h2>Description</h2>
  * The three possible semaphore waiting modes (do not wait, wait with timeout,
- * wait without timeout) are explored.<br>
+ * wait without timeout) are explored, then waits with absolute deadlines are
+ * tested.<br>
  * The test expects that the semaphore wait function returns the correct value
  * in each of the above scenario and that the semaphore structure status is
  * correct after each operation.
@@ -180,6 +181,23 @@ static void sem2_execute(void) {
   }
   test_assert_sequence(10, "ABCDE");
   test_assert_time_window(11, target_time, target_time + ALLOWED_DELAY);
+
+  /*
+   * Testing deadlines, already passed and then in the future.
+   */
+  test_wait_tick();
+  target_time = chVTGetSystemTime();
+  msg = chSemWaitUntil(&sem1, target_time - 1);
+  test_assert(12, msg == MSG_TIMEOUT, "wrong wake-up message");
+  test_assert_time_window(13, target_time, target_time + 1);
+  for (i = 0; i < 5; i++) {
+    target_time += MS2ST(100);
+    msg = chSemWaitUntil(&sem1, target_time);
+    test_assert(14, msg == MSG_TIMEOUT, "wrong wake-up message");
+    test_assert_time_window(15, target_time, target_time + 1);
+  }
+  test_assert(16, queue_isempty(&sem1.s_queue), "queue not empty");
+  test_assert(17, sem1.s_cnt == 0, "counter not zero");
 }
 
 ROMCONST struct testcase testsem2 = {
@@ -183,7 +183,8 @@ ROMCONST struct testcase testthd3 = {
  *
  * <h2>Description</h2>
  * Delay APIs and associated macros are tested, the invoking thread is verified
- * to wake up at the exact expected time.
+ * to wake up at the exact expected time. Time windows ending at the current
+ * time or overrun are verified to not suspend the thread.
  */
 
 static void thd4_execute(void) {
@@ -210,6 +211,21 @@ static void thd4_execute(void) {
   time = chVTGetSystemTime() + MS2ST(100);
   chThdSleepUntil(time);
   test_assert_time_window(4, time, time + 1);
+
+  /* Windowed absolute timelines.*/
+  time = chVTGetSystemTime();
+  test_assert(5, !chThdSleepUntilWindowed(time, time + MS2ST(100)),
+              "overrun");
+  test_assert_time_window(6, time + MS2ST(100), time + MS2ST(100) + 1);
+  test_assert(7, chThdSleepUntilWindowed(time, time + MS2ST(50)),
+              "overrun not detected");
+  test_assert_time_window(8, time + MS2ST(100), time + MS2ST(100) + 1);
+
+  /* Windowed absolute timelines ending at the current time.*/
+  time = test_wait_tick();
+  test_assert(9, !chThdSleepUntilWindowed(time - MS2ST(10), time),
+              "overrun");
+  test_assert_time_window(10, time, time + 1);
 }
 
 ROMCONST struct testcase testthd4 = {
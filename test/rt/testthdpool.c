@@ -0,0 +1,186 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "test.h"
+
+/**
+ * @page test_thdpool Thread pools test
+ *
+ * File: @ref testthdpool.c
+ *
+ * <h2>Description</h2>
+ * This module implements the test sequence for the @ref thread_pools
+ * subsystem.
+ *
+ * <h2>Objective</h2>
+ * Objective of the test module is to cover 100% of the @ref thread_pools
+ * subsystem code.<br>
+ * Note that the @ref thread_pools subsystem depends on the
+ * @ref dynamic_threads and @ref pmailboxes subsystems that have to met their
+ * testing objectives as well.
+ *
+ * <h2>Preconditions</h2>
+ * The module requires the following kernel options:
+ * - @p CH_CFG_USE_THREAD_POOLS
+ * .
+ * In case some of the required options are not enabled then some or all tests
+ * may be skipped.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_thdpool_001
+ * - @subpage test_thdpool_002
+ * .
+ * @file testthdpool.c
+ * @brief Thread pools test source file
+ * @file testthdpool.h
+ * @brief Thread pools header file
+ */
+
+#if (CH_CFG_USE_THREAD_POOLS && !CH_CFG_USE_MALLOC_HEAP) || defined(__DOXYGEN__)
+
+#define TP_JOBS     4
+#define TP_WORKERS  3
+#define TP_HIGH     (CH_CFG_PMAILBOXES_LEVELS - 1)
+
+static memory_heap_t heap1;
+static thread_pool_t tp1;
+static thread_t *tp_workers[TP_WORKERS];
+static thread_pool_job_t tp_jobs[TP_JOBS];
+static pmb_slot_t tp_slots[TP_JOBS];
+
+static void thdpool_setup(void) {
+
+  chHeapObjectInit(&heap1, test.buffer, sizeof(union test_buffers));
+}
+
+static void job(void *arg) {
+
+  test_emit_token(*(char *)arg);
+}
+
+/**
+ * @page test_thdpool_001 Jobs priority and queue limits
+ *
+ * <h2>Description</h2>
+ * A pool with a single worker at lower priority is filled with jobs of
+ * different priority levels, an extra job is submitted and is expected to
+ * be rejected. The pool is then stopped and the jobs are expected to be
+ * served in priority order before the worker exits.
+ */
+
+static void thdpool1_execute(void) {
+  static const thread_pool_config_t config = {
+    &heap1, WA_SIZE, LOWPRIO, 1, 1, TIME_INFINITE,
+    tp_workers, tp_jobs, tp_slots, TP_JOBS
+  };
+  size_t n, sz;
+  thread_pool_stats_t *sp = chThdPoolGetStatisticsX(&tp1);
+
+  (void)chHeapStatus(&heap1, &sz);
+  chThdPoolObjectInit(&tp1, &config);
+  test_assert(1, !chThdPoolStart(&tp1), "start failed");
+  test_assert_lock(2, chThdPoolGetWorkersI(&tp1) == 1, "wrong workers count");
+
+  test_assert(3, chThdPoolSubmit(&tp1, job, "D", 0) == MSG_OK,
+              "job rejected");
+  test_assert(4, chThdPoolSubmit(&tp1, job, "B", 1) == MSG_OK,
+              "job rejected");
+  test_assert(5, chThdPoolSubmit(&tp1, job, "A", TP_HIGH) == MSG_OK,
+              "job rejected");
+  test_assert(6, chThdPoolSubmit(&tp1, job, "E", 0) == MSG_OK,
+              "job rejected");
+  test_assert(7, chThdPoolSubmit(&tp1, job, "X", TP_HIGH) == MSG_TIMEOUT,
+              "job not rejected");
+  test_assert_lock(8, chThdPoolGetQueuedI(&tp1) == TP_JOBS, "wrong queue");
+
+  chThdPoolStop(&tp1);
+  test_assert_sequence(9, "ABDE");
+  test_assert(10, sp->rejected == 1, "wrong rejected count");
+  test_assert(11, sp->exec.n == TP_JOBS, "wrong executed count");
+  test_assert(12, sp->wait.n == TP_JOBS, "wrong waited count");
+  test_assert_lock(13, chThdPoolGetWorkersI(&tp1) == 0, "workers alive");
+
+  /* Heap status checked again.*/
+  test_assert(14, chHeapStatus(&heap1, &n) == 1, "heap fragmented");
+  test_assert(15, n == sz, "heap size changed");
+}
+
+ROMCONST struct testcase testthdpool1 = {
+  "Thread pools, jobs priority and queue limits",
+  thdpool_setup,
+  NULL,
+  thdpool1_execute
+};
+
+/**
+ * @page test_thdpool_002 Workers growth and shrinking
+ *
+ * <h2>Description</h2>
+ * Jobs are submitted to a pool with busy workers, the pool is expected to
+ * grow up to its maximum size. After the jobs have been served the idle
+ * workers are expected to exit until the minimum size is reached again.
+ */
+
+static void thdpool2_execute(void) {
+  static const thread_pool_config_t config = {
+    &heap1, WA_SIZE, LOWPRIO, 1, TP_WORKERS, MS2ST(10),
+    tp_workers, tp_jobs, tp_slots, TP_JOBS
+  };
+  size_t n, sz;
+
+  (void)chHeapStatus(&heap1, &sz);
+  chThdPoolObjectInit(&tp1, &config);
+  test_assert(1, !chThdPoolStart(&tp1), "start failed");
+
+  /* Workers are at lower priority so all of them are busy.*/
+  (void)chThdPoolSubmit(&tp1, job, "A", 0);
+  (void)chThdPoolSubmit(&tp1, job, "B", 0);
+  (void)chThdPoolSubmit(&tp1, job, "C", 0);
+  (void)chThdPoolSubmit(&tp1, job, "D", 0);
+  test_assert_lock(2, chThdPoolGetWorkersI(&tp1) == TP_WORKERS,
+                   "pool not grown");
+  test_assert(3, chThdPoolGetStatisticsX(&tp1)->peak == TP_WORKERS,
+              "wrong peak");
+
+  /* Jobs served, then idle workers exit.*/
+  chThdSleepMilliseconds(100);
+  test_assert_sequence(4, "ABCD");
+  test_assert_lock(5, chThdPoolGetWorkersI(&tp1) == 1, "pool not shrunk");
+
+  chThdPoolStop(&tp1);
+  test_assert(6, chHeapStatus(&heap1, &n) == 1, "heap fragmented");
+  test_assert(7, n == sz, "heap size changed");
+}
+
+ROMCONST struct testcase testthdpool2 = {
+  "Thread pools, workers growth and shrinking",
+  thdpool_setup,
+  NULL,
+  thdpool2_execute
+};
+#endif /* CH_CFG_USE_THREAD_POOLS && !CH_CFG_USE_MALLOC_HEAP */
+
+/**
+ * @brief   Test sequence for thread pools.
+ */
+ROMCONST struct testcase * ROMCONST patternthdpool[] = {
+#if (CH_CFG_USE_THREAD_POOLS && !CH_CFG_USE_MALLOC_HEAP) || defined(__DOXYGEN__)
+  &testthdpool1,
+  &testthdpool2,
+#endif
+  NULL
+};
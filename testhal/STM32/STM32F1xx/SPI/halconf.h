@@ -231,6 +231,53 @@
 #define MMC_NICE_WAITING            TRUE
 #endif
 
+/**
+ * @brief   Size in bytes of a busy polling burst.
+ */
+#if !defined(MMC_WAIT_BURST) || defined(__DOXYGEN__)
+#define MMC_WAIT_BURST              8
+#endif
+
+/**
+ * @brief   Number of polling bursts before starting to sleep.
+ */
+#if !defined(MMC_WAIT_FAST_BURSTS) || defined(__DOXYGEN__)
+#define MMC_WAIT_FAST_BURSTS        4
+#endif
+
+/**
+ * @brief   Maximum sleep interval between polling bursts.
+ * @note    The sleep interval starts from one full system tick.
+ */
+#if !defined(MMC_WAIT_MAX_DELAY) || defined(__DOXYGEN__)
+#define MMC_WAIT_MAX_DELAY          OSAL_MS2ST(4)
+#endif
+
+/**
+ * @brief   Maximum time the card is allowed to stay busy.
+ */
+#if !defined(MMC_WAIT_TIMEOUT) || defined(__DOXYGEN__)
+#define MMC_WAIT_TIMEOUT            OSAL_MS2ST(500)
+#endif
+
+/**
+ * @brief   Sequential sessions reuse.
+ * @details If enabled the multi-block read or write session opened by a
+ *          block device read or write operation is kept open after the
+ *          operation, a following operation starting at the next block
+ *          continues the same session saving the stop and start commands.
+ */
+#if !defined(MMC_USE_SESSIONS) || defined(__DOXYGEN__)
+#define MMC_USE_SESSIONS            FALSE
+#endif
+
+/**
+ * @brief   Idle time after which an open session is not reused.
+ */
+#if !defined(MMC_SESSION_TIMEOUT) || defined(__DOXYGEN__)
+#define MMC_SESSION_TIMEOUT         OSAL_MS2ST(100)
+#endif
+
 /*===========================================================================*/
 /* SDC driver related settings.                                              */
 /*===========================================================================*/
@@ -262,6 +309,14 @@
 #define SDC_NICE_WAITING            TRUE
 #endif
 
+/**
+ * @brief   Enables the asynchronous APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SDC_USE_ASYNC) || defined(__DOXYGEN__)
+#define SDC_USE_ASYNC               FALSE
+#endif
+
 /*===========================================================================*/
 /* SERIAL driver related settings.                                           */
 /*===========================================================================*/
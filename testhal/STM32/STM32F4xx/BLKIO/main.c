@@ -0,0 +1,551 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006-2013 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+#include "blkcache.h"
+#include "blksched.h"
+
+/*===========================================================================*/
+/* Configurable settings.                                                    */
+/*===========================================================================*/
+
+#ifndef RAMDISK_BLOCKS
+#define RAMDISK_BLOCKS      32
+#endif
+
+#ifndef CACHE_BUFFERS
+#define CACHE_BUFFERS       4
+#endif
+
+#ifndef MERGE_BLOCKS
+#define MERGE_BLOCKS        4
+#endif
+
+#ifndef ITERATIONS
+#define ITERATIONS          10000
+#endif
+
+#ifndef SCHED_THREADS
+#define SCHED_THREADS       4
+#endif
+
+#ifndef THREADS_STACK_SIZE
+#define THREADS_STACK_SIZE  256
+#endif
+
+#define RAMDISK_BLOCK_SIZE  BLKCACHE_BLOCK_SIZE
+
+/*===========================================================================*/
+/* RAM disk, a BaseBlockDevice counting the commands it receives.            */
+/*===========================================================================*/
+
+#define RAMDISK_LOG_SIZE    8
+
+typedef struct {
+  const struct BaseBlockDeviceVMT *vmt;
+  _base_block_device_data
+  uint8_t               *storage;
+  uint32_t              blocks;
+  uint32_t              rdcmds;
+  uint32_t              wrcmds;
+  uint32_t              log[RAMDISK_LOG_SIZE];
+  unsigned              logn;
+} RamDisk;
+
+/*
+ * Records the first block of the commands, in arrival order.
+ */
+static void rd_log(RamDisk *rdp, uint32_t startblk) {
+
+  if (rdp->logn < RAMDISK_LOG_SIZE)
+    rdp->log[rdp->logn++] = startblk;
+}
+
+static bool rd_is_inserted(void *instance) {
+
+  (void)instance;
+  return true;
+}
+
+static bool rd_is_protected(void *instance) {
+
+  (void)instance;
+  return false;
+}
+
+static bool rd_connect(void *instance) {
+
+  ((RamDisk *)instance)->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+static bool rd_disconnect(void *instance) {
+
+  ((RamDisk *)instance)->state = BLK_ACTIVE;
+  return HAL_SUCCESS;
+}
+
+static bool rd_read(void *instance, uint32_t startblk,
+                    uint8_t *buffer, uint32_t n) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if (startblk + n > rdp->blocks)
+    return HAL_FAILED;
+  memcpy(buffer, rdp->storage + startblk * RAMDISK_BLOCK_SIZE,
+         n * RAMDISK_BLOCK_SIZE);
+  rdp->rdcmds++;
+  rd_log(rdp, startblk);
+  return HAL_SUCCESS;
+}
+
+static bool rd_write(void *instance, uint32_t startblk,
+                     const uint8_t *buffer, uint32_t n) {
+  RamDisk *rdp = (RamDisk *)instance;
+
+  if (startblk + n > rdp->blocks)
+    return HAL_FAILED;
+  memcpy(rdp->storage + startblk * RAMDISK_BLOCK_SIZE, buffer,
+         n * RAMDISK_BLOCK_SIZE);
+  rdp->wrcmds++;
+  rd_log(rdp, startblk);
+  return HAL_SUCCESS;
+}
+
+static bool rd_sync(void *instance) {
+
+  (void)instance;
+  return HAL_SUCCESS;
+}
+
+static bool rd_get_info(void *instance, BlockDeviceInfo *bdip) {
+
+  bdip->blk_size = RAMDISK_BLOCK_SIZE;
+  bdip->blk_num  = ((RamDisk *)instance)->blocks;
+  return HAL_SUCCESS;
+}
+
+static const struct BaseBlockDeviceVMT rd_vmt = {
+  rd_is_inserted,
+  rd_is_protected,
+  rd_connect,
+  rd_disconnect,
+  rd_read,
+  rd_write,
+  rd_sync,
+  rd_get_info
+};
+
+/*===========================================================================*/
+/* Common test code.                                                         */
+/*===========================================================================*/
+
+static uint8_t storage[RAMDISK_BLOCKS * RAMDISK_BLOCK_SIZE];
+static uint8_t shadow[RAMDISK_BLOCKS * RAMDISK_BLOCK_SIZE];
+static uint8_t buf[MERGE_BLOCKS * RAMDISK_BLOCK_SIZE];
+static uint8_t mrgbuf[MERGE_BLOCKS * RAMDISK_BLOCK_SIZE];
+
+static RamDisk rd;
+
+static BaseSequentialStream *chp = (BaseSequentialStream *)&SD2;
+static unsigned failures;
+
+static void check(bool condition, const char *msg) {
+
+  if (!condition) {
+    chprintf(chp, "  FAILED: %s\r\n", msg);
+    failures++;
+  }
+}
+
+/*
+ * Starts from a known device content.
+ */
+static void rd_setup(void) {
+  unsigned i;
+
+  for (i = 0; i < sizeof storage; i++)
+    storage[i] = (uint8_t)(i * 7);
+  memcpy(shadow, storage, sizeof storage);
+
+  rd.vmt     = &rd_vmt;
+  rd.state   = BLK_ACTIVE;
+  rd.storage = storage;
+  rd.blocks  = RAMDISK_BLOCKS;
+}
+
+/*
+ * Clears the RAM disk counters and log.
+ */
+static void rd_reset(void) {
+
+  rd.rdcmds = 0;
+  rd.wrcmds = 0;
+  rd.logn   = 0;
+}
+
+/*===========================================================================*/
+/* Block cache tests.                                                        */
+/*===========================================================================*/
+
+static BlockCacheBuffer buffers[CACHE_BUFFERS];
+static BlockCache bc;
+
+static const BlockCacheConfig bccfg = {
+  (BaseBlockDevice *)&rd,
+  buffers,
+  CACHE_BUFFERS,
+  mrgbuf,
+  MERGE_BLOCKS
+};
+
+/*
+ * Starts from a known device content and an empty cache.
+ */
+static void setup(void) {
+
+  rd_setup();
+  bcObjectInit(&bc);
+  bcStart(&bc, &bccfg);
+  bcConnect(&bc);
+  bcResetStatistics(&bc);
+  rd_reset();
+}
+
+/*
+ * Randomized reads, writes and synchronizations compared against a shadow
+ * copy of the device content.
+ */
+static void test_random(void) {
+  unsigned i, j;
+
+  chprintf(chp, "Random accesses\r\n");
+  setup();
+  srand(1);
+  for (i = 0; i < ITERATIONS; i++) {
+    uint32_t n = (rand() % MERGE_BLOCKS) + 1;
+    uint32_t startblk = rand() % (RAMDISK_BLOCKS - n + 1);
+    uint8_t *p = shadow + startblk * RAMDISK_BLOCK_SIZE;
+
+    switch (rand() % 5) {
+    case 0:
+    case 1:
+      check(bcRead(&bc, startblk, buf, n) == HAL_SUCCESS, "read failed");
+      if (memcmp(buf, p, n * RAMDISK_BLOCK_SIZE) != 0) {
+        check(false, "read data mismatch");
+        return;
+      }
+      break;
+    case 2:
+    case 3:
+      for (j = 0; j < n * RAMDISK_BLOCK_SIZE; j++)
+        buf[j] = (uint8_t)rand();
+      check(bcWrite(&bc, startblk, buf, n) == HAL_SUCCESS, "write failed");
+      memcpy(p, buf, n * RAMDISK_BLOCK_SIZE);
+      break;
+    default:
+      check(bcSync(&bc) == HAL_SUCCESS, "sync failed");
+      check(memcmp(storage, shadow, sizeof storage) == 0,
+            "device content mismatch after sync");
+      break;
+    }
+  }
+  check(bcDisconnect(&bc) == HAL_SUCCESS, "disconnect failed");
+  check(memcmp(storage, shadow, sizeof storage) == 0,
+        "device content mismatch after disconnect");
+  chprintf(chp, "  hits %u, misses %u, evictions %u\r\n",
+           bcGetStatistics(&bc)->hits, bcGetStatistics(&bc)->misses,
+           bcGetStatistics(&bc)->evictions);
+  chprintf(chp, "  writebacks %u, write commands %u\r\n",
+           bcGetStatistics(&bc)->writebacks, bcGetStatistics(&bc)->wrcmds);
+}
+
+/*
+ * Consecutive dirty blocks must be written back with a single command.
+ */
+static void test_merge(void) {
+  uint32_t blk;
+
+  chprintf(chp, "Write-back merging\r\n");
+  setup();
+  memset(buf, 0x55, RAMDISK_BLOCK_SIZE);
+  for (blk = 8; blk < 8 + MERGE_BLOCKS; blk++)
+    bcWrite(&bc, blk, buf, 1);
+  check(rd.wrcmds == 0, "write not deferred");
+  check(bcSync(&bc) == HAL_SUCCESS, "sync failed");
+  check(rd.wrcmds == 1, "dirty blocks not merged");
+  check(bcGetStatistics(&bc)->writebacks == MERGE_BLOCKS,
+        "wrong write-back count");
+  check(memcmp(storage + (8 + MERGE_BLOCKS - 1) * RAMDISK_BLOCK_SIZE, buf,
+               RAMDISK_BLOCK_SIZE) == 0,
+        "device content mismatch");
+}
+
+/*
+ * Blocks hit by a multi-block read must become the most recently used ones
+ * and survive the following eviction.
+ */
+static void test_lru(void) {
+  uint32_t blk, rdcmds;
+
+  chprintf(chp, "LRU order on multi-block hits\r\n");
+  setup();
+  for (blk = 0; blk < CACHE_BUFFERS; blk++)
+    bcRead(&bc, blk, buf, 1);
+  bcRead(&bc, 0, buf, 2);
+  check(bcGetStatistics(&bc)->hits == 2, "multi-block read not hit");
+
+  /* Evicts the least recently used block, it must not be block 0.*/
+  bcRead(&bc, RAMDISK_BLOCKS - 1, buf, 1);
+  rdcmds = rd.rdcmds;
+  bcRead(&bc, 0, buf, 1);
+  bcRead(&bc, 1, buf, 1);
+  check(rd.rdcmds == rdcmds, "recently used block evicted");
+  check(memcmp(buf, storage + RAMDISK_BLOCK_SIZE, RAMDISK_BLOCK_SIZE) == 0,
+        "read data mismatch");
+}
+
+/*===========================================================================*/
+/* Block scheduler tests.                                                    */
+/*===========================================================================*/
+
+#define SCHED_REGION        (RAMDISK_BLOCKS / SCHED_THREADS)
+
+static THD_WORKING_AREA(waWorker, THREADS_STACK_SIZE);
+static THD_WORKING_AREA(waSched[SCHED_THREADS], THREADS_STACK_SIZE);
+static uint8_t schedbuf[SCHED_THREADS][MERGE_BLOCKS * RAMDISK_BLOCK_SIZE];
+
+static BlockScheduler bs;
+
+/* The worker has a lower priority than the submitting threads so that the
+   requests submitted in a row are queued before being served.*/
+static const BlockSchedulerConfig bscfg = {
+  (BaseBlockDevice *)&rd,
+  mrgbuf,
+  MERGE_BLOCKS,
+  MS2ST(100),
+  MS2ST(500),
+  waWorker,
+  sizeof waWorker,
+  NORMALPRIO - 1
+};
+
+/*
+ * Starts from a known device content and an empty queue.
+ */
+static void sched_setup(void) {
+
+  rd_setup();
+  bsObjectInit(&bs);
+  bsStart(&bs, &bscfg);
+  bsConnect(&bs);
+  bsResetStatistics(&bs);
+  rd_reset();
+}
+
+/*
+ * Tears down the scheduler, the device content must match the shadow copy.
+ */
+static void sched_teardown(void) {
+
+  check(bsDisconnect(&bs) == HAL_SUCCESS, "disconnect failed");
+  bsStop(&bs);
+  check(memcmp(storage, shadow, sizeof storage) == 0,
+        "device content mismatch");
+}
+
+/*
+ * Each thread reads and writes its own region of the disk through the
+ * synchronous API and checks the data against the shadow copy.
+ */
+static msg_t sched_thread(void *p) {
+  unsigned id = (unsigned)p;
+  uint8_t *b = schedbuf[id];
+  uint32_t seed = id + 1;
+  unsigned i, j;
+
+  for (i = 0; i < ITERATIONS / SCHED_THREADS; i++) {
+    uint32_t n, startblk;
+    uint8_t *s;
+
+    seed = seed * 1103515245 + 12345;
+    n = ((seed >> 16) % MERGE_BLOCKS) + 1;
+    startblk = id * SCHED_REGION + (seed >> 8) % (SCHED_REGION - n + 1);
+    s = shadow + startblk * RAMDISK_BLOCK_SIZE;
+    if (seed & 0x80000000) {
+      if ((bsRead(&bs, startblk, b, n) != HAL_SUCCESS) ||
+          (memcmp(b, s, n * RAMDISK_BLOCK_SIZE) != 0))
+        return MSG_RESET;
+    }
+    else {
+      for (j = 0; j < n * RAMDISK_BLOCK_SIZE; j++)
+        b[j] = (uint8_t)(seed >> (j & 15));
+      memcpy(s, b, n * RAMDISK_BLOCK_SIZE);
+      if (bsWrite(&bs, startblk, b, n) != HAL_SUCCESS)
+        return MSG_RESET;
+    }
+  }
+  return MSG_OK;
+}
+
+/*
+ * Concurrent accesses from several threads.
+ */
+static void test_sched_random(void) {
+  thread_t *tps[SCHED_THREADS];
+  unsigned i;
+
+  chprintf(chp, "Scheduler concurrent accesses\r\n");
+  sched_setup();
+  for (i = 0; i < SCHED_THREADS; i++)
+    tps[i] = chThdCreateStatic(waSched[i], sizeof waSched[i],
+                               NORMALPRIO, sched_thread, (void *)i);
+  for (i = 0; i < SCHED_THREADS; i++)
+    check(chThdWait(tps[i]) == MSG_OK, "thread data mismatch");
+  chprintf(chp, "  requests %u, commands %u, merged %u, expired %u\r\n",
+           bsGetStatistics(&bs)->requests, bsGetStatistics(&bs)->commands,
+           bsGetStatistics(&bs)->merged, bsGetStatistics(&bs)->expired);
+  sched_teardown();
+}
+
+/*
+ * Adjacent requests queued together must be served with a single command.
+ */
+static void test_sched_merge(void) {
+  BlockRequest reqs[MERGE_BLOCKS];
+  unsigned i;
+
+  chprintf(chp, "Scheduler merging\r\n");
+  sched_setup();
+  for (i = 0; i < MERGE_BLOCKS; i++) {
+    memset(buf + i * RAMDISK_BLOCK_SIZE, 0x30 + i, RAMDISK_BLOCK_SIZE);
+    bsRequestObjectInit(&reqs[i], NULL, 0);
+  }
+  memcpy(shadow + 8 * RAMDISK_BLOCK_SIZE, buf,
+         MERGE_BLOCKS * RAMDISK_BLOCK_SIZE);
+
+  /* Submitted in reverse order.*/
+  for (i = MERGE_BLOCKS; i > 0; i--)
+    bsSubmitWrite(&bs, &reqs[i - 1], 8 + i - 1,
+                  buf + (i - 1) * RAMDISK_BLOCK_SIZE, 1);
+  for (i = 0; i < MERGE_BLOCKS; i++)
+    check(bsWaitRequest(&reqs[i]) == HAL_SUCCESS, "write failed");
+  check(rd.wrcmds == 1, "requests not merged");
+  check(bsGetStatistics(&bs)->merged == MERGE_BLOCKS,
+        "wrong merged count");
+  sched_teardown();
+}
+
+/*
+ * Requests are served in ascending block order from the current position,
+ * conflicting requests keep the submission order.
+ */
+static void test_sched_order(void) {
+  static const uint32_t blocks[] = {20, 5, 12, 3};
+  BlockRequest reqs[4], wr1, wr2;
+  uint8_t data[3][RAMDISK_BLOCK_SIZE];
+  unsigned i;
+
+  chprintf(chp, "Scheduler ordering\r\n");
+  sched_setup();
+
+  /* Elevator order starting after block 10.*/
+  check(bsRead(&bs, 10, buf, 1) == HAL_SUCCESS, "read failed");
+  for (i = 0; i < 4; i++) {
+    bsRequestObjectInit(&reqs[i], NULL, 0);
+    bsSubmitRead(&bs, &reqs[i], blocks[i], buf + i * RAMDISK_BLOCK_SIZE, 1);
+  }
+  for (i = 0; i < 4; i++)
+    bsWaitRequest(&reqs[i]);
+  check((rd.logn == 5) && (rd.log[1] == 12) && (rd.log[2] == 20) &&
+        (rd.log[3] == 3) && (rd.log[4] == 5), "wrong elevator order");
+
+  /* Write, read and write of the same block.*/
+  memset(data[0], 0xA5, RAMDISK_BLOCK_SIZE);
+  memset(data[2], 0x5A, RAMDISK_BLOCK_SIZE);
+  bsRequestObjectInit(&wr1, NULL, 0);
+  bsRequestObjectInit(&reqs[0], NULL, 0);
+  bsRequestObjectInit(&wr2, NULL, 0);
+  bsSubmitWrite(&bs, &wr1, 7, data[0], 1);
+  bsSubmitRead(&bs, &reqs[0], 7, data[1], 1);
+  bsSubmitWrite(&bs, &wr2, 7, data[2], 1);
+  bsWaitRequest(&wr2);
+  check(bsIsRequestDoneI(&wr1) && bsIsRequestDoneI(&reqs[0]),
+        "conflicting requests reordered");
+  check(memcmp(data[1], data[0], RAMDISK_BLOCK_SIZE) == 0,
+        "read data mismatch");
+  memcpy(shadow + 7 * RAMDISK_BLOCK_SIZE, data[2], RAMDISK_BLOCK_SIZE);
+  sched_teardown();
+}
+
+/*===========================================================================*/
+/* Generic demo code.                                                        */
+/*===========================================================================*/
+
+/*
+ * Application entry point.
+ */
+int main(void) {
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Activates the serial driver 2 using the driver default configuration.
+   */
+  sdStart(&SD2, NULL);          /* Default is 38400-8-N-1.*/
+  palSetPadMode(GPIOA, 2, PAL_MODE_ALTERNATE(7));
+  palSetPadMode(GPIOA, 3, PAL_MODE_ALTERNATE(7));
+
+  /*
+   * Test procedure.
+   */
+  chprintf(chp, "\r\n*** ChibiOS/RT block I/O test\r\n");
+  chprintf(chp, "*** RAM disk blocks: %u\r\n", RAMDISK_BLOCKS);
+  chprintf(chp, "*** Cache buffers:   %u\r\n", CACHE_BUFFERS);
+  chprintf(chp, "*** Merge blocks:    %u\r\n", MERGE_BLOCKS);
+  chprintf(chp, "*** Threads:         %u\r\n\r\n", SCHED_THREADS);
+
+  failures = 0;
+  test_random();
+  test_merge();
+  test_lru();
+  test_sched_random();
+  test_sched_merge();
+  test_sched_order();
+  chprintf(chp, "\r\nFinal result: %s\r\n", failures ? "FAILURE" : "SUCCESS");
+
+  /*
+   * Normal main() thread activity, the green LED blinks on success, the
+   * red one on failure.
+   */
+  while (TRUE) {
+    palTogglePad(GPIOD, failures ? GPIOD_LED5 : GPIOD_LED4);
+    chThdSleepMilliseconds(500);
+  }
+}